@@ -0,0 +1,73 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// The latency of foreground commits while a backup of the same database runs in a loop on another thread, by pages per step.
+// The database is in rollback journal mode, where a step holds the shared lock that a commit has to wait for. Argument 0 runs no backup.
+
+namespace {
+
+const char *const databaseName = "backupBenchmark.db";
+const int rowCount = 200000;
+
+void createDatabase() {
+	std::remove(databaseName);
+	Sqlite::SqliteConnection connection(databaseName);
+	sqliteExecute(connection, "create table items (id integer primary key, name text, score int)");
+	Sqlite::BulkInserter inserter(connection, "insert into items values (?, ?, ?)");
+	for (int row = 0; row < rowCount; ++row) {
+		inserter.insert(row, "benchmark item with a longer name", row % 100);
+	}
+	inserter.finish();
+}
+
+void foregroundCommit(benchmark::State &state) {
+	createDatabase();
+	const int pagesPerStep = static_cast<int>(state.range(0));
+	std::atomic<bool> stopping{false};
+	std::thread backups([&] {
+		if (pagesPerStep == 0) {
+			return;
+		}
+		const Sqlite::SqliteConnection source(databaseName);
+		while (!stopping) {
+			const Sqlite::SqliteConnection destination(":memory:");
+			Sqlite::Backup backup(destination, source, Sqlite::BackupOptions{pagesPerStep, std::chrono::milliseconds(0)});
+			backup.run([&](int, int) {
+				if (stopping) {
+					backup.cancel();
+				}
+			});
+		}
+	});
+
+	Sqlite::SqliteConnection connection(databaseName);
+	sqlite3_busy_timeout(connection.getABI(), 10000);
+	sqliteExecute(connection, "PRAGMA synchronous=OFF");
+	std::vector<double> latencies;
+	int id = 0;
+	for (auto _ : state) {
+		const auto start = std::chrono::steady_clock::now();
+		sqliteExecute(connection, "update items set score = score + 1 where id = ?", id);
+		latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+		id = (id + 7919) % rowCount;
+	}
+	stopping = true;
+	backups.join();
+
+	std::sort(latencies.begin(), latencies.end());
+	state.counters["p50_us"] = latencies[latencies.size() / 2];
+	state.counters["p99_us"] = latencies[latencies.size() * 99 / 100];
+	state.counters["max_us"] = latencies.back();
+}
+
+}
+
+BENCHMARK(foregroundCommit)->Arg(0)->Arg(16)->Arg(256)->Arg(4096)->Arg(-1)->Unit(benchmark::kMicrosecond)->UseRealTime()->MinTime(1.0);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const char *const databaseName = "bulkInsertBenchmark.db";
+
+Sqlite::SqliteConnection freshDatabase() {
+	std::remove(databaseName);
+	Sqlite::SqliteConnection connection(databaseName);
+	sqliteExecute(connection, "create table items (id int, name text, score int)");
+	return connection;
+}
+
+// one autocommit transaction, and one journal sync, per row
+void naiveLoop(benchmark::State &state) {
+	const auto rows = static_cast<int>(state.range(0));
+	const std::string name = "benchmark item";
+	for (auto _ : state) {
+		state.PauseTiming();
+		Sqlite::SqliteConnection connection = freshDatabase();
+		state.ResumeTiming();
+
+		Sqlite::SqliteStatement statement(connection, "insert into items values (?, ?, ?)");
+		for (int row = 0; row < rows; ++row) {
+			statement.reset(row, name, row % 100);
+			statement.execute();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * rows);
+}
+
+void bulkInserter(benchmark::State &state) {
+	const auto rows = static_cast<int>(state.range(0));
+	const auto rowsPerTransaction = static_cast<std::size_t>(state.range(1));
+	const std::string name = "benchmark item";
+	for (auto _ : state) {
+		state.PauseTiming();
+		Sqlite::SqliteConnection connection = freshDatabase();
+		state.ResumeTiming();
+
+		Sqlite::BulkInserter inserter(connection, "insert into items values (?, ?, ?)", Sqlite::BulkInsertOptions{rowsPerTransaction, 0});
+		for (int row = 0; row < rows; ++row) {
+			inserter.insert(row, name, row % 100);
+		}
+		const Sqlite::BulkInsertStats stats = inserter.finish();
+		state.counters["rows/s"] = stats.rowsPerSecond();
+	}
+	state.SetItemsProcessed(state.iterations() * rows);
+}
+
+}
+
+BENCHMARK(naiveLoop)->Arg(500)->Unit(benchmark::kMillisecond);
+BENCHMARK(bulkInserter)->Args({500, 10000})->Args({100000, 1000})->Args({100000, 10000})->Args({100000, 100000})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
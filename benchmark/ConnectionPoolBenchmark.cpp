@@ -0,0 +1,71 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+const char *const databaseName = "connectionPoolBenchmark.db";
+const int rowCount = 100000;
+
+const int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+void createDatabase() {
+	static std::once_flag created;
+	std::call_once(created, [] {
+		std::remove(databaseName);
+		Sqlite::SqliteConnection connection(databaseName);
+		sqliteExecute(connection, "PRAGMA journal_mode=WAL");
+		sqliteExecute(connection, "create table items (id integer primary key, name text, score int)");
+		Sqlite::BulkInserter inserter(connection, "insert into items values (?, ?, ?)");
+		for (int row = 0; row < rowCount; ++row) {
+			inserter.insert(row, "benchmark item", row % 100);
+		}
+		inserter.finish();
+	});
+}
+
+Sqlite::ConnectionPool &pool() {
+	createDatabase();
+	static Sqlite::ConnectionPool pool(databaseName, static_cast<std::size_t>(maxThreads));
+	return pool;
+}
+
+// every thread serializes on one connection
+void sharedConnection(benchmark::State &state) {
+	createDatabase();
+	static Sqlite::SqliteConnection connection(databaseName, SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX);
+	static std::mutex connectionMutex;
+
+	int id = state.thread_index();
+	for (auto _ : state) {
+		std::lock_guard<std::mutex> lock(connectionMutex);
+		Sqlite::CachedStatement statement(connection, "select score from items where id = ?", id);
+		statement.execute();
+		benchmark::DoNotOptimize(statement.getInt());
+		id = (id + 7919) % rowCount;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+void pooledReaders(benchmark::State &state) {
+	Sqlite::ConnectionPool &readers = pool();
+
+	int id = state.thread_index();
+	for (auto _ : state) {
+		const Sqlite::ConnectionPool::Lease lease = readers.reader();
+		Sqlite::CachedStatement statement(lease, "select score from items where id = ?", id);
+		statement.execute();
+		benchmark::DoNotOptimize(statement.getInt());
+		id = (id + 7919) % rowCount;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+}
+
+BENCHMARK(sharedConnection)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK(pooledReaders)->ThreadRange(1, maxThreads)->UseRealTime();
+
+BENCHMARK_MAIN();
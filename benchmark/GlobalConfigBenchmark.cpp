@@ -0,0 +1,138 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Random lookups spread over many connections to one database, with SQLite's defaults (argument 0), the shared page cache (1),
+// the pooled allocator (2) and both (3). sqlite3_config only applies before SQLite is initialized, so every run is a child
+// process, which reports the time of the lookups and its peak and final resident set size.
+
+namespace {
+
+const char *const databaseName = "globalConfigBenchmark.db";
+const int rowCount = 300000;
+const int connectionCount = 200;
+const int lookupCount = 400000;
+const std::size_t sharedCacheBytes = 64 * 1024 * 1024;
+
+struct childOutcome {
+	double seconds_;
+	double peakRssMiB_;
+	double rssMiB_;
+};
+
+double statusMiB(const char *const field) {
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.compare(0, std::strlen(field), field) == 0) {
+			return std::stod(line.substr(std::strlen(field))) / 1024;
+		}
+	}
+	return 0;
+}
+
+template <typename Work>
+childOutcome inChild(Work &&work) {
+	int channel[2];
+	if (pipe(channel) != 0) {
+		return childOutcome{};
+	}
+	const pid_t child = fork();
+	if (child == 0) {
+		close(channel[0]);
+		const childOutcome outcome = work();
+		const bool written = write(channel[1], &outcome, sizeof(outcome)) == static_cast<ssize_t>(sizeof(outcome));
+		_exit(written ? 0 : 1);
+	}
+	close(channel[1]);
+	childOutcome outcome{};
+	const bool read = child > 0 && ::read(channel[0], &outcome, sizeof(outcome)) == static_cast<ssize_t>(sizeof(outcome));
+	close(channel[0]);
+	if (child > 0) {
+		waitpid(child, nullptr, 0);
+	}
+	return read ? outcome : childOutcome{};
+}
+
+void createDatabase() {
+	static std::once_flag created;
+	std::call_once(created, [] {
+		inChild([] {
+			std::remove(databaseName);
+			Sqlite::SqliteConnection connection(databaseName);
+			sqliteExecute(connection, "create table items (id integer primary key, name text, payload blob)");
+			Sqlite::BulkInserter inserter(connection, "insert into items values (?, ?, zeroblob(?))");
+			for (int row = 0; row < rowCount; ++row) {
+				inserter.insert(row, "benchmark item " + std::to_string(row), 100 + row % 200);
+			}
+			inserter.finish();
+			return childOutcome{};
+		});
+	});
+}
+
+childOutcome lookups(const int configuration) {
+	if (configuration != 0) {
+		Sqlite::GlobalOptions options;
+		options.sharedPageCache_ = (configuration & 1) != 0;
+		options.pageCacheBytes_ = sharedCacheBytes;
+		options.pooledAllocator_ = (configuration & 2) != 0;
+		Sqlite::configureSqlite(options);
+	}
+	std::vector<std::unique_ptr<Sqlite::SqliteConnection>> connections;
+	std::vector<std::unique_ptr<Sqlite::SqliteStatement>> statements;
+	for (int connection = 0; connection < connectionCount; ++connection) {
+		connections.push_back(std::make_unique<Sqlite::SqliteConnection>(databaseName, SQLITE_OPEN_READONLY));
+		statements.push_back(std::make_unique<Sqlite::SqliteStatement>(*connections.back(), "select name, length(payload) from items where id = ?"));
+	}
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> ids(0, rowCount - 1);
+	const auto start = std::chrono::steady_clock::now();
+	for (int lookup = 0; lookup < lookupCount; ++lookup) {
+		Sqlite::SqliteStatement &statement = *statements[static_cast<std::size_t>(lookup % connectionCount)];
+		statement.reset(ids(random));
+		statement.execute();
+		benchmark::DoNotOptimize(statement.get<std::string_view>(0));
+		statement.reset();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return childOutcome{seconds, statusMiB("VmHWM:"), statusMiB("VmRSS:")};
+}
+
+void manyConnections(benchmark::State &state) {
+	createDatabase();
+	const int configuration = static_cast<int>(state.range(0));
+	double peakRss = 0;
+	double rss = 0;
+	for (auto _ : state) {
+		const childOutcome outcome = inChild([configuration] {
+			return lookups(configuration);
+		});
+		if (outcome.seconds_ == 0) {
+			state.SkipWithError("the child process failed");
+			break;
+		}
+		state.SetIterationTime(outcome.seconds_);
+		peakRss = std::max(peakRss, outcome.peakRssMiB_);
+		rss = outcome.rssMiB_;
+	}
+	state.SetItemsProcessed(state.iterations() * lookupCount);
+	state.counters["peakRSS_MiB"] = peakRss;
+	state.counters["RSS_MiB"] = rss;
+}
+
+}
+
+BENCHMARK(manyConnections)->ArgName("configuration")->DenseRange(0, 3)->Iterations(3)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,52 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+
+namespace {
+
+const char *const databaseName = "groupCommitBenchmark.db";
+const int maxThreads = 16;
+
+std::atomic<int> nextId{0};
+
+void createDatabase() {
+	static std::once_flag created;
+	std::call_once(created, [] {
+		std::remove(databaseName);
+		Sqlite::SqliteConnection connection(databaseName, Sqlite::OpenOptions::durable());
+		sqliteExecute(connection, "create table events (id integer primary key, payload text)");
+	});
+}
+
+// every thread commits its own inserts, and waits for the write lock of the others
+void connectionPerThread(benchmark::State &state) {
+	createDatabase();
+	Sqlite::SqliteConnection connection(databaseName, Sqlite::OpenOptions::durable());
+	for (auto _ : state) {
+		sqliteExecute(connection, "insert into events values (?, ?)", nextId++, "small event");
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+void groupCommit(benchmark::State &state) {
+	createDatabase();
+	static Sqlite::GroupCommitWriter writer(databaseName);
+	const Sqlite::GroupCommitWriter::Stats before = writer.stats();
+	for (auto _ : state) {
+		writer.execute("insert into events values (?, ?)", nextId++, "small event").get();
+	}
+	state.SetItemsProcessed(state.iterations());
+	if (state.thread_index() == 0) {
+		const Sqlite::GroupCommitWriter::Stats after = writer.stats();
+		state.counters["jobs/batch"] = after.batches_ == before.batches_ ? 0.0 : static_cast<double>(after.jobs_ - before.jobs_) / static_cast<double>(after.batches_ - before.batches_);
+	}
+}
+
+}
+
+BENCHMARK(connectionPerThread)->ThreadRange(1, maxThreads)->UseRealTime();
+BENCHMARK(groupCommit)->ThreadRange(1, maxThreads)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,80 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fcntl.h>
+#include <mutex>
+#include <unistd.h>
+
+// A full-table scan through the stock unix VFS against the io_uring VFS and its read-ahead.
+// Argument 1 evicts the database file from the page cache with posix_fadvise before every scan, argument 0 scans it warm.
+
+namespace {
+
+const char *const databaseName = "ioUringVfsBenchmark.db";
+const int rowCount = 1000000;
+
+void createDatabase() {
+	static std::once_flag created;
+	std::call_once(created, [] {
+		std::remove(databaseName);
+		Sqlite::SqliteConnection connection(databaseName);
+		sqliteExecute(connection, "create table items (id integer primary key, name text, payload blob)");
+		Sqlite::BulkInserter inserter(connection, "insert into items values (?, ?, zeroblob(?))");
+		for (int row = 0; row < rowCount; ++row) {
+			inserter.insert(row, "benchmark item", 100 + row % 200);
+		}
+		inserter.finish();
+	});
+}
+
+//returns the size of the file
+long long evictDatabase() {
+	const int descriptor = open(databaseName, O_RDONLY);
+	const long long size = lseek(descriptor, 0, SEEK_END);
+	fdatasync(descriptor);
+	posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+	close(descriptor);
+	return size;
+}
+
+void scan(benchmark::State &state, const char *const vfs) {
+	createDatabase();
+	const long long size = evictDatabase();
+	const bool cold = state.range(0) != 0;
+	for (auto _ : state) {
+		if (cold) {
+			state.PauseTiming();
+			evictDatabase();
+			state.ResumeTiming();
+		}
+		const Sqlite::SqliteConnection connection(databaseName, SQLITE_OPEN_READONLY, vfs);
+		Sqlite::SqliteStatement statement(connection, "select sum(length(name) + length(payload)) from items");
+		statement.execute();
+		benchmark::DoNotOptimize(statement.get<long long>(0));
+	}
+	state.SetBytesProcessed(state.iterations() * size);
+}
+
+void stockVfs(benchmark::State &state) {
+	scan(state, nullptr);
+}
+
+void ioUringVfs(benchmark::State &state) {
+	if (!Sqlite::registerIoUringVfs()) {
+		state.SkipWithError("io_uring is unavailable, the VFS only forwards to the stock one");
+		return;
+	}
+	const Sqlite::IoUringVfsStats before = Sqlite::ioUringVfsStats();
+	scan(state, Sqlite::ioUringVfsName);
+	const Sqlite::IoUringVfsStats after = Sqlite::ioUringVfsStats();
+	const auto reads = static_cast<double>(after.reads_ - before.reads_ + after.readAheadHits_ - before.readAheadHits_);
+	state.counters["readAheadHitRate"] = reads == 0 ? 0 : static_cast<double>(after.readAheadHits_ - before.readAheadHits_) / reads;
+	state.counters["syscalls/scan"] = benchmark::Counter(static_cast<double>(after.submissions_ - before.submissions_), benchmark::Counter::kAvgIterations);
+}
+
+}
+
+BENCHMARK(stockVfs)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(ioUringVfs)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,102 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+// Binding the 40 parameters of a wide insert by position, by name through sqlite3_bind_parameter_index, by name through the
+// parameter index of the statement, and 40 binds of four compile-time names. Only the binds are timed, the statement is never stepped.
+
+namespace {
+
+const int columnCount = 40;
+
+std::string insertText() {
+	std::string columns;
+	std::string parameters;
+	for (int column = 0; column < columnCount; ++column) {
+		columns += (column == 0 ? "c" : ", c") + std::to_string(column);
+		parameters += (column == 0 ? ":c" : ", :c") + std::to_string(column);
+	}
+	return "insert into items (" + columns + ") values (" + parameters + ")";
+}
+
+Sqlite::SqliteConnection wideDatabase() {
+	Sqlite::SqliteConnection connection(":memory:");
+	std::string columns;
+	for (int column = 0; column < columnCount; ++column) {
+		columns += (column == 0 ? "c" : ", c") + std::to_string(column) + " integer";
+	}
+	sqliteExecute(connection, ("create table items (" + columns + ")").c_str());
+	return connection;
+}
+
+const std::vector<std::string> &parameterNames() {
+	static const std::vector<std::string> names = [] {
+		std::vector<std::string> entries;
+		for (int column = 0; column < columnCount; ++column) {
+			entries.push_back(":c" + std::to_string(column));
+		}
+		return entries;
+	}();
+	return names;
+}
+
+void positionalBind(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = wideDatabase();
+	const Sqlite::SqliteStatement statement(connection, insertText().c_str());
+	for (auto _ : state) {
+		for (int column = 0; column < columnCount; ++column) {
+			statement.bind(column + 1, column);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * columnCount);
+}
+
+void rawNamedBind(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = wideDatabase();
+	const Sqlite::SqliteStatement statement(connection, insertText().c_str());
+	for (auto _ : state) {
+		for (int column = 0; column < columnCount; ++column) {
+			sqlite3_bind_int(statement.getABI(), sqlite3_bind_parameter_index(statement.getABI(), parameterNames()[column].c_str()), column);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * columnCount);
+}
+
+void namedBind(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = wideDatabase();
+	const Sqlite::SqliteStatement statement(connection, insertText().c_str());
+	for (auto _ : state) {
+		for (int column = 0; column < columnCount; ++column) {
+			statement.bind(parameterNames()[column], column);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * columnCount);
+}
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+void compileTimeBind(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = wideDatabase();
+	const Sqlite::SqliteStatement statement(connection, insertText().c_str());
+	for (auto _ : state) {
+		for (int repeat = 0; repeat < columnCount / 4; ++repeat) {
+			statement.bind<":c0">(repeat);
+			statement.bind<":c1">(repeat);
+			statement.bind<":c38">(repeat);
+			statement.bind<":c39">(repeat);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * columnCount);
+}
+#endif
+
+}
+
+BENCHMARK(positionalBind);
+BENCHMARK(rawNamedBind);
+BENCHMARK(namedBind);
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+BENCHMARK(compileTimeBind);
+#endif
+
+BENCHMARK_MAIN();
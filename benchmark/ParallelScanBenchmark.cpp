@@ -0,0 +1,63 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+// A full-table aggregation on one statement, against ParallelScan with 1 to N readers.
+
+namespace {
+
+const char *const databaseName = "parallelScanBenchmark.db";
+const int rowCount = 1000000;
+
+const int maxReaders = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+void createDatabase() {
+	static std::once_flag created;
+	std::call_once(created, [] {
+		std::remove(databaseName);
+		Sqlite::SqliteConnection connection(databaseName);
+		sqliteExecute(connection, "PRAGMA journal_mode=WAL");
+		sqliteExecute(connection, "create table items (id integer primary key, name text, score int)");
+		Sqlite::BulkInserter inserter(connection, "insert into items values (?, ?, ?)");
+		for (int row = 0; row < rowCount; ++row) {
+			inserter.insert(row, "benchmark item", row % 100);
+		}
+		inserter.finish();
+	});
+}
+
+void singleStatement(benchmark::State &state) {
+	createDatabase();
+	const Sqlite::SqliteConnection connection(databaseName, SQLITE_OPEN_READONLY);
+	for (auto _ : state) {
+		Sqlite::SqliteStatement statement(connection, "select sum(score * length(name)) from items");
+		statement.execute();
+		benchmark::DoNotOptimize(statement.get<long long>(0));
+	}
+	state.SetItemsProcessed(state.iterations() * rowCount);
+}
+
+void parallelScan(benchmark::State &state) {
+	createDatabase();
+	Sqlite::ParallelScan scan(databaseName, static_cast<std::size_t>(state.range(0)));
+	const auto partial = [](Sqlite::SqliteStatement &statement) {
+		statement.execute();
+		return statement.get<long long>(0);
+	};
+	const auto sum = [](const long long left, const long long right) {
+		return left + right;
+	};
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(scan.scan("items", "rowid", "select coalesce(sum(score * length(name)), 0) from items where rowid between ? and ?", 0LL, partial, sum));
+	}
+	state.SetItemsProcessed(state.iterations() * rowCount);
+}
+
+}
+
+BENCHMARK(singleStatement)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(parallelScan)->RangeMultiplier(2)->Range(1, maxReaders)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
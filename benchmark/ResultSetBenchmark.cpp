@@ -0,0 +1,154 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Reading a whole result row by row into vectors of values, against fetchAll into a fresh or a reused ResultSet.
+// The allocations per row are counted by replacing the global operator new.
+
+namespace {
+
+std::atomic<std::size_t> allocationCount{0};
+
+const int rowCount = 10000;
+const char *const scanText = "select id, name, score, payload from items";
+
+Sqlite::SqliteConnection populatedDatabase() {
+	Sqlite::SqliteConnection connection(":memory:");
+	sqliteExecute(connection, "create table items (id integer primary key, name text, score real, payload blob)");
+	Sqlite::BulkInserter inserter(connection, "insert into items values (?, ?, ?, ?)");
+	const std::vector<std::byte> payload(24, std::byte{'x'});
+	for (int row = 0; row < rowCount; ++row) {
+		if (row % 10 == 0) {
+			inserter.insert(row, nullptr, row * 0.5, nullptr);
+		}
+		else {
+			inserter.insert(row, "benchmark item " + std::to_string(row), row * 0.5, payload);
+		}
+	}
+	inserter.finish();
+	return connection;
+}
+
+void reportAllocations(benchmark::State &state, const std::size_t before) {
+	state.counters["allocs/row"] = benchmark::Counter(static_cast<double>(allocationCount.load() - before) / (static_cast<double>(state.iterations()) * rowCount));
+	state.SetItemsProcessed(state.iterations() * rowCount);
+}
+
+void rowByRow(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase();
+	Sqlite::SqliteStatement statement(connection, scanText);
+	const std::size_t before = allocationCount.load();
+	for (auto _ : state) {
+		std::vector<long long> ids;
+		std::vector<std::string> names;
+		std::vector<double> scores;
+		std::vector<std::string> payloads;
+		statement.reset();
+		while (statement.execute()) {
+			ids.push_back(sqlite3_column_int64(statement.getABI(), 0));
+			names.emplace_back(statement.get<std::string_view>(1));
+			scores.push_back(sqlite3_column_double(statement.getABI(), 2));
+			payloads.emplace_back(statement.get<std::string_view>(3));
+		}
+		benchmark::DoNotOptimize(payloads.data());
+	}
+	reportAllocations(state, before);
+}
+
+void freshResultSet(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase();
+	Sqlite::SqliteStatement statement(connection, scanText);
+	const std::size_t before = allocationCount.load();
+	for (auto _ : state) {
+		statement.reset();
+		const Sqlite::ResultSet result = statement.fetchAll();
+		benchmark::DoNotOptimize(result.column(3).data().data());
+	}
+	reportAllocations(state, before);
+}
+
+void reusedResultSet(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase();
+	Sqlite::SqliteStatement statement(connection, scanText);
+	Sqlite::ResultSet result;
+	const std::size_t before = allocationCount.load();
+	for (auto _ : state) {
+		statement.reset();
+		statement.fetchAll(result);
+		benchmark::DoNotOptimize(result.column(3).data().data());
+	}
+	reportAllocations(state, before);
+}
+
+}
+
+// Every form is replaced, so that each allocation is counted and freed by its own pair. They are kept out of line,
+// since once inlined GCC sees malloc paired with operator delete and reports -Wmismatched-new-delete.
+[[gnu::noinline]] void *operator new(const std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void *const memory = std::malloc(size == 0 ? 1 : size)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void *operator new[](const std::size_t size) {
+	return operator new(size);
+}
+
+[[gnu::noinline]] void *operator new(const std::size_t size, const std::align_val_t alignment) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	const auto bytes = static_cast<std::size_t>(alignment);
+	//aligned_alloc wants a multiple of the alignment
+	if (void *const memory = std::aligned_alloc(bytes, (size + bytes - 1) / bytes * bytes)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void *operator new[](const std::size_t size, const std::align_val_t alignment) {
+	return operator new(size, alignment);
+}
+
+[[gnu::noinline]] void operator delete(void *const memory) noexcept {
+	std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete[](void *const memory) noexcept {
+	std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void *const memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete[](void *const memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void *const memory, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete[](void *const memory, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void *const memory, std::size_t, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete[](void *const memory, std::size_t, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+BENCHMARK(rowByRow)->Unit(benchmark::kMicrosecond);
+BENCHMARK(freshResultSet)->Unit(benchmark::kMicrosecond);
+BENCHMARK(reusedResultSet)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,62 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+// Running a migration script of N inserts through sqliteExecuteScript, against sqlite3_exec and against a walk that passes the
+// text without its terminating NUL, which makes SQLite copy the rest of the script on every prepare. Time per statement should stay flat with N.
+
+namespace {
+
+std::string migration(const int statements) {
+	std::string script = "create table items (id integer primary key, name text, score int);\n";
+	for (int statement = 0; statement < statements; ++statement) {
+		script += "insert into items values (" + std::to_string(statement) + ", 'migrated item', " + std::to_string(statement % 100) + ");\n";
+	}
+	return script;
+}
+
+void scriptRunner(benchmark::State &state) {
+	const std::string script = migration(static_cast<int>(state.range(0)));
+	for (auto _ : state) {
+		const Sqlite::SqliteConnection connection(":memory:");
+		benchmark::DoNotOptimize(Sqlite::sqliteExecuteScript(connection, script, Sqlite::ScriptOptions{true}).size());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void sqliteExec(benchmark::State &state) {
+	const std::string script = "BEGIN;\n" + migration(static_cast<int>(state.range(0))) + "COMMIT;\n";
+	for (auto _ : state) {
+		const Sqlite::SqliteConnection connection(":memory:");
+		sqlite3_exec(connection.getABI(), script.c_str(), nullptr, nullptr, nullptr);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void unterminatedWalk(benchmark::State &state) {
+	const std::string script = migration(static_cast<int>(state.range(0)));
+	for (auto _ : state) {
+		const Sqlite::SqliteConnection connection(":memory:");
+		const Sqlite::Transaction transaction(connection);
+		const char *text = script.c_str();
+		const char *const end = text + script.size();
+		while (text != end) {
+			sqlite3_stmt *statement = nullptr;
+			sqlite3_prepare_v2(connection.getABI(), text, static_cast<int>(end - text), &statement, &text);
+			sqlite3_step(statement);
+			sqlite3_finalize(statement);
+			while (text != end && *text == '\n') {
+				++text;
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(scriptRunner)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(sqliteExec)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(unterminatedWalk)->Arg(1000)->Arg(10000)->Arg(30000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
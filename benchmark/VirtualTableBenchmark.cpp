@@ -0,0 +1,72 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <map>
+
+// Joining a table against an in-memory std::map: loaded into a temp table first, against read in place through a virtual table.
+
+namespace {
+
+const int entryCount = 200000;
+const int orderCount = 10000;
+const char *const joinText = "select sum(orders.quantity * prices.price) from orders join prices on prices.id = orders.item";
+
+const std::map<long long, double> &prices() {
+	static const std::map<long long, double> prices = [] {
+		std::map<long long, double> entries;
+		for (int entry = 0; entry < entryCount; ++entry) {
+			entries.emplace(entry, entry * 0.01);
+		}
+		return entries;
+	}();
+	return prices;
+}
+
+Sqlite::SqliteConnection ordersDatabase() {
+	Sqlite::SqliteConnection connection(":memory:");
+	sqliteExecute(connection, "create table orders (id integer primary key, item integer, quantity integer)");
+	Sqlite::BulkInserter inserter(connection, "insert into orders values (?, ?, ?)");
+	for (int order = 0; order < orderCount; ++order) {
+		inserter.insert(order, (order * 7919) % entryCount, order % 10);
+	}
+	inserter.finish();
+	return connection;
+}
+
+void tempTableJoin(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = ordersDatabase();
+	for (auto _ : state) {
+		sqliteExecute(connection, "create temp table prices (id integer primary key, price real)");
+		Sqlite::BulkInserter inserter(connection, "insert into prices values (?, ?)");
+		for (const auto &[id, price] : prices()) {
+			inserter.insert(id, price);
+		}
+		inserter.finish();
+
+		Sqlite::SqliteStatement statement(connection, joinText);
+		statement.execute();
+		benchmark::DoNotOptimize(statement.getDouble(0));
+		statement.reset();
+		sqliteExecute(connection, "drop table temp.prices");
+	}
+}
+
+void virtualTableJoin(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = ordersDatabase();
+	connection.createVirtualTable("prices", prices(), Sqlite::keyColumn("id", [](const auto &entry) {
+		return entry.first;
+	}), Sqlite::tableColumn("price", [](const auto &entry) {
+		return entry.second;
+	}));
+	for (auto _ : state) {
+		Sqlite::SqliteStatement statement(connection, joinText);
+		statement.execute();
+		benchmark::DoNotOptimize(statement.getDouble(0));
+	}
+}
+
+}
+
+BENCHMARK(tempTableJoin)->Unit(benchmark::kMillisecond);
+BENCHMARK(virtualTableJoin)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <clocale>
+#include <cwchar>
+#include <string>
+
+// Reading and binding wchar_t text: the wrapper's conversions into per-statement buffers, against a per-character std::mbrtowc loop
+// into a fresh std::wstring per cell. The argument selects ASCII (0) or mixed Latin, Cyrillic and CJK (1) text.
+
+namespace {
+
+const int rowCount = 10000;
+
+std::wstring cellText(const int row, const bool mixed) {
+	std::wstring text = L"wide benchmark row " + std::to_wstring(row) + L" with a longer description text ";
+	if (mixed) {
+		text += L"déjà vu, Привет мир, 你好世界";
+	}
+	return text;
+}
+
+Sqlite::SqliteConnection wideDatabase(const bool mixed) {
+	Sqlite::SqliteConnection connection(":memory:");
+	sqliteExecute(connection, "create table items (id integer primary key, name text)");
+	Sqlite::SqliteStatement insert(connection, "insert into items values (?, ?)");
+	for (int row = 0; row < rowCount; ++row) {
+		insert.bindAll(row, cellText(row, mixed));
+		insert.execute();
+		insert.reset();
+	}
+	return connection;
+}
+
+void wrapperRead(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = wideDatabase(state.range(0) != 0);
+	Sqlite::SqliteStatement statement(connection, "select name from items");
+	for (auto _ : state) {
+		statement.reset();
+		std::size_t characters = 0;
+		while (statement.execute()) {
+			characters += statement.getWideStringView(0).size();
+		}
+		benchmark::DoNotOptimize(characters);
+	}
+	state.SetItemsProcessed(state.iterations() * rowCount);
+}
+
+void mbrtowcRead(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = wideDatabase(state.range(0) != 0);
+	Sqlite::SqliteStatement statement(connection, "select name from items");
+	std::setlocale(LC_CTYPE, "C.UTF-8");
+	for (auto _ : state) {
+		statement.reset();
+		std::size_t characters = 0;
+		while (statement.execute()) {
+			const std::string_view text = statement.get<std::string_view>(0);
+			std::wstring wide;
+			std::mbstate_t shift{};
+			for (std::size_t read = 0; read < text.size();) {
+				wchar_t character;
+				const std::size_t used = std::mbrtowc(&character, text.data() + read, text.size() - read, &shift);
+				if (used == static_cast<std::size_t>(-1) || used == static_cast<std::size_t>(-2) || used == 0) {
+					break;
+				}
+				wide.push_back(character);
+				read += used;
+			}
+			characters += wide.size();
+		}
+		benchmark::DoNotOptimize(characters);
+	}
+	state.SetItemsProcessed(state.iterations() * rowCount);
+}
+
+void wrapperBind(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection(":memory:");
+	Sqlite::SqliteStatement statement(connection, "select length(?)");
+	const std::wstring text = cellText(0, state.range(0) != 0);
+	for (auto _ : state) {
+		statement.bind(1, text);
+		statement.execute();
+		benchmark::DoNotOptimize(statement.getInt(0));
+		statement.reset();
+	}
+}
+
+}
+
+BENCHMARK(wrapperRead)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(mbrtowcRead)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(wrapperBind)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,212 @@
+#include "SqliteWrapper.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <string>
+
+// Every wrapper benchmark has a hand-written sqlite3 C API twin, the argument selects an in-memory (0) or file-backed (1) database.
+
+namespace {
+
+const char *const databaseName = "wrapperOverheadBenchmark.db";
+const int rowCount = 10000;
+const char *const selectText = "select id, name, score from items where id = ?";
+const char *const scanText = "select id, name, score from items";
+const char *const insertText = "insert into items values (?, ?, ?)";
+const std::string name = "benchmark item";
+
+Sqlite::SqliteConnection emptyDatabase(const benchmark::State &state) {
+	Sqlite::SqliteConnection connection;
+	if (state.range(0) == 0) {
+		connection.open(":memory:");
+	}
+	else {
+		std::remove(databaseName);
+		connection.open(databaseName);
+	}
+	sqliteExecute(connection, "create table items (id integer primary key, name text, score real)");
+	return connection;
+}
+
+Sqlite::SqliteConnection populatedDatabase(const benchmark::State &state) {
+	Sqlite::SqliteConnection connection = emptyDatabase(state);
+	Sqlite::BulkInserter inserter(connection, insertText);
+	for (int row = 0; row < rowCount; ++row) {
+		inserter.insert(row, name, row * 0.5);
+	}
+	inserter.finish();
+	return connection;
+}
+
+void rawPrepare(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase(state);
+	for (auto _ : state) {
+		sqlite3_stmt *statement = nullptr;
+		sqlite3_prepare_v2(connection.getABI(), selectText, -1, &statement, nullptr);
+		benchmark::DoNotOptimize(statement);
+		sqlite3_finalize(statement);
+	}
+}
+
+void wrapperPrepare(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase(state);
+	for (auto _ : state) {
+		Sqlite::SqliteStatement statement(connection, selectText);
+		benchmark::DoNotOptimize(statement.getABI());
+	}
+}
+
+void rawBind(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase(state);
+	sqlite3_stmt *statement = nullptr;
+	sqlite3_prepare_v2(connection.getABI(), insertText, -1, &statement, nullptr);
+	for (auto _ : state) {
+		sqlite3_bind_int(statement, 1, 42);
+		sqlite3_bind_text(statement, 2, name.c_str(), static_cast<int>(name.size()), SQLITE_STATIC);
+		sqlite3_bind_double(statement, 3, 0.5);
+	}
+	sqlite3_finalize(statement);
+}
+
+void wrapperBind(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase(state);
+	const Sqlite::SqliteStatement statement(connection, insertText);
+	for (auto _ : state) {
+		statement.bindAll(42, name, 0.5);
+	}
+}
+
+// a point lookup by primary key: reset, bind and step
+void rawStep(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase(state);
+	sqlite3_stmt *statement = nullptr;
+	sqlite3_prepare_v2(connection.getABI(), selectText, -1, &statement, nullptr);
+	int id = 0;
+	for (auto _ : state) {
+		sqlite3_reset(statement);
+		sqlite3_bind_int(statement, 1, id++ % rowCount);
+		benchmark::DoNotOptimize(sqlite3_step(statement));
+	}
+	sqlite3_finalize(statement);
+}
+
+void wrapperStep(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase(state);
+	Sqlite::SqliteStatement statement(connection, selectText);
+	int id = 0;
+	for (auto _ : state) {
+		statement.reset(id++ % rowCount);
+		benchmark::DoNotOptimize(statement.execute());
+	}
+}
+
+void rawColumnRead(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase(state);
+	sqlite3_stmt *statement = nullptr;
+	sqlite3_prepare_v2(connection.getABI(), selectText, -1, &statement, nullptr);
+	sqlite3_bind_int(statement, 1, rowCount / 2);
+	sqlite3_step(statement);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(sqlite3_column_int(statement, 0));
+		benchmark::DoNotOptimize(sqlite3_column_text(statement, 1));
+		benchmark::DoNotOptimize(sqlite3_column_bytes(statement, 1));
+		benchmark::DoNotOptimize(sqlite3_column_double(statement, 2));
+	}
+	sqlite3_finalize(statement);
+}
+
+void wrapperColumnRead(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase(state);
+	const Sqlite::SqliteStatement statement(connection, selectText, rowCount / 2);
+	statement.execute();
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(statement.getInt(0));
+		benchmark::DoNotOptimize(statement.get<std::string_view>(1));
+		benchmark::DoNotOptimize(statement.getDouble(2));
+	}
+}
+
+void rawIterate(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase(state);
+	sqlite3_stmt *statement = nullptr;
+	sqlite3_prepare_v2(connection.getABI(), scanText, -1, &statement, nullptr);
+	for (auto _ : state) {
+		long long sum = 0;
+		while (sqlite3_step(statement) == SQLITE_ROW) {
+			sum += sqlite3_column_int(statement, 0);
+		}
+		sqlite3_reset(statement);
+		benchmark::DoNotOptimize(sum);
+	}
+	sqlite3_finalize(statement);
+	state.SetItemsProcessed(state.iterations() * rowCount);
+}
+
+void wrapperIterate(benchmark::State &state) {
+	const Sqlite::SqliteConnection connection = populatedDatabase(state);
+	Sqlite::SqliteStatement statement(connection, scanText);
+	for (auto _ : state) {
+		long long sum = 0;
+		for (auto row : statement) {
+			sum += row.getInt(0);
+		}
+		statement.reset();
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * rowCount);
+}
+
+// rowCount rows in one transaction
+void rawBulkInsert(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		const Sqlite::SqliteConnection connection = emptyDatabase(state);
+		state.ResumeTiming();
+
+		sqlite3 *const database = connection.getABI();
+		sqlite3_exec(database, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr);
+		sqlite3_stmt *statement = nullptr;
+		sqlite3_prepare_v2(database, insertText, -1, &statement, nullptr);
+		for (int row = 0; row < rowCount; ++row) {
+			sqlite3_bind_int(statement, 1, row);
+			sqlite3_bind_text(statement, 2, name.c_str(), static_cast<int>(name.size()), SQLITE_STATIC);
+			sqlite3_bind_double(statement, 3, row * 0.5);
+			sqlite3_step(statement);
+			sqlite3_reset(statement);
+		}
+		sqlite3_finalize(statement);
+		sqlite3_exec(database, "COMMIT", nullptr, nullptr, nullptr);
+	}
+	state.SetItemsProcessed(state.iterations() * rowCount);
+}
+
+void wrapperBulkInsert(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		const Sqlite::SqliteConnection connection = emptyDatabase(state);
+		state.ResumeTiming();
+
+		Sqlite::BulkInserter inserter(connection, insertText, Sqlite::BulkInsertOptions{rowCount, 0});
+		for (int row = 0; row < rowCount; ++row) {
+			inserter.insert(row, name, row * 0.5);
+		}
+		inserter.finish();
+	}
+	state.SetItemsProcessed(state.iterations() * rowCount);
+}
+
+}
+
+BENCHMARK(rawPrepare)->Arg(0)->Arg(1);
+BENCHMARK(wrapperPrepare)->Arg(0)->Arg(1);
+BENCHMARK(rawBind)->Arg(0)->Arg(1);
+BENCHMARK(wrapperBind)->Arg(0)->Arg(1);
+BENCHMARK(rawStep)->Arg(0)->Arg(1);
+BENCHMARK(wrapperStep)->Arg(0)->Arg(1);
+BENCHMARK(rawColumnRead)->Arg(0)->Arg(1);
+BENCHMARK(wrapperColumnRead)->Arg(0)->Arg(1);
+BENCHMARK(rawIterate)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(wrapperIterate)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(rawBulkInsert)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(wrapperBulkInsert)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -25,8 +25,89 @@
 #ifndef IncludeSQLiteCpp_
 #define IncludeSQLiteCpp_
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#if __has_include(<span>)
+#include <span>
+#endif
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
 #include <sqlite3.h>
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#define SQLITECPP_IO_URING
+#endif
+
+// The Apache Arrow C Data Interface, as given by its specification, so that no Arrow headers are needed
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+	const char *format;
+	const char *name;
+	const char *metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema **children;
+	struct ArrowSchema *dictionary;
+	void (*release)(struct ArrowSchema *);
+	void *private_data;
+};
+
+struct ArrowArray {
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void **buffers;
+	struct ArrowArray **children;
+	struct ArrowArray *dictionary;
+	void (*release)(struct ArrowArray *);
+	void *private_data;
+};
+
+#endif
 
 
 namespace Sqlite {
@@ -67,7 +148,7 @@ class UniqueHandle{
 	{
 	}
 	
-	UniqueHandle operator=(UniqueHandle &&other){
+	UniqueHandle &operator=(UniqueHandle &&other) noexcept {
 		if (this != &other) {
 			reset(other.release());
 		}
@@ -128,238 +209,6162 @@ struct exception {
 	exception(sqlite3 *connection) : errorCode_{sqlite3_extended_errcode(connection)}, errorMessage_{sqlite3_errmsg(connection)}
 	{
 	}
+	
+	exception(const int errorCode, std::string errorMessage) : errorCode_{errorCode}, errorMessage_{std::move(errorMessage)}
+	{
+	}
 };
 
-  
 
-class SqliteConnection {
-	
-	struct SqliteConnectionTraits : public nullHandleTraits<sqlite3 *> {
-		static void close(sqlite3 *value) noexcept {
-			sqlite3_close(value);
+
+#ifdef SQLITECPP_ENABLE_PROFILING
+
+// Counters of every run of one SQL text, summed over the statements prepared from it.
+struct StatementProfile {
+	std::string sql_;
+	unsigned long long prepares_{0};
+	unsigned long long runs_{0};
+	unsigned long long steps_{0};
+	unsigned long long rows_{0};
+	std::chrono::nanoseconds prepareTime_{0};
+	//measured by SQLite with the clock of the VFS, which has a resolution of one millisecond with the unix VFS
+	std::chrono::nanoseconds runTime_{0};
+	//sqlite3_stmt_status counters
+	unsigned long long fullscanSteps_{0};
+	unsigned long long sorts_{0};
+	unsigned long long autoindexes_{0};
+	unsigned long long vmSteps_{0};
+};
+
+
+// Per SQL text profiles of a SqliteConnection, only compiled in with SQLITECPP_ENABLE_PROFILING.
+// Run times and sqlite3_stmt_status counters come from the SQLITE_TRACE_PROFILE callback, prepare times, steps and rows from the statements of this wrapper.
+class StatementProfiler {
+
+	mutable std::mutex mutex_;
+	std::list<StatementProfile> profiles_;
+	std::unordered_map<std::string_view, StatementProfile *> index_;
+	std::atomic<bool> enabled_{false};
+
+	//called with the mutex held
+	StatementProfile &profile(sqlite3_stmt *const statement) {
+		const char *const text = sqlite3_sql(statement);
+		const std::string_view sql = text ? text : "";
+		const auto found = index_.find(sql);
+		if (found != index_.end()) {
+			return *found->second;
 		}
-	};
-	UniqueHandle<SqliteConnectionTraits> connectionHandle_;
+		StatementProfile &profile = profiles_.emplace_back();
+		profile.sql_ = sql;
+		index_.emplace(profile.sql_, &profile);
+		return profile;
+	}
 
-	template <typename Function, typename CharacterSet>
-	void internalOpen(Function openFunction, const CharacterSet *const filename) {
-		SqliteConnection tempConnection;
-	
-		if (SQLITE_OK != openFunction(filename, tempConnection.connectionHandle_.set())) {
-			tempConnection.throwLastError();
+	static int trace(const unsigned type, void *const context, void *const statement, void *const nanoseconds) noexcept {
+		if (type == SQLITE_TRACE_PROFILE) {
+			static_cast<StatementProfiler *>(context)->recordRun(static_cast<sqlite3_stmt *>(statement), std::chrono::nanoseconds(*static_cast<const sqlite3_int64 *>(nanoseconds)));
 		}
-	
-		swap(connectionHandle_, tempConnection.connectionHandle_);
+		return 0;
 	}
 
   public:
-	SqliteConnection() = default;
-	
-	template <typename CharacterSet>
-	explicit SqliteConnection(const CharacterSet *const filename) {
-		open(filename);
-	}
 
-	explicit operator bool() const noexcept {
-		return static_cast<bool>(connectionHandle_);
+	StatementProfiler() = default;
+
+	StatementProfiler(const StatementProfiler &) = delete;
+	StatementProfiler &operator=(const StatementProfiler &) = delete;
+
+	bool enabled() const noexcept {
+		return enabled_.load(std::memory_order_relaxed);
 	}
 
-	static SqliteConnection memory() {
-		return SqliteConnection(":memory:");
+	void attach(sqlite3 *const connection) noexcept {
+		sqlite3_trace_v2(connection, SQLITE_TRACE_PROFILE, &trace, this);
+		enabled_.store(true, std::memory_order_relaxed);
 	}
 
-	static SqliteConnection wideMemory() {
-		return SqliteConnection(L":memory:");
+	void detach(sqlite3 *const connection) noexcept {
+		sqlite3_trace_v2(connection, 0, nullptr, nullptr);
+		enabled_.store(false, std::memory_order_relaxed);
 	}
 
-	sqlite3 *getABI() const noexcept {
-		return connectionHandle_.get();
+	//a profile that cannot be allocated is dropped, profiling never fails the statement
+	void recordPrepare(sqlite3_stmt *const statement, const std::chrono::nanoseconds elapsed) noexcept {
+		try {
+			const std::lock_guard<std::mutex> lock(mutex_);
+			StatementProfile &profile = this->profile(statement);
+			++profile.prepares_;
+			profile.prepareTime_ += elapsed;
+		}
+		catch (...) {
+		}
 	}
-	
-	void throwLastError() const  {
-		throw exception(getABI());
+
+	void recordSteps(sqlite3_stmt *const statement, const unsigned long long steps, const unsigned long long rows) noexcept {
+		try {
+			const std::lock_guard<std::mutex> lock(mutex_);
+			StatementProfile &profile = this->profile(statement);
+			profile.steps_ += steps;
+			profile.rows_ += rows;
+		}
+		catch (...) {
+		}
 	}
 
-	void open(const char *const filename) {
-		internalOpen(sqlite3_open, filename);
+	void recordRun(sqlite3_stmt *const statement, const std::chrono::nanoseconds elapsed) noexcept {
+		try {
+			const std::lock_guard<std::mutex> lock(mutex_);
+			StatementProfile &profile = this->profile(statement);
+			++profile.runs_;
+			profile.runTime_ += elapsed;
+			//reset after reading, so that every run adds only its own counts
+			profile.fullscanSteps_ += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+			profile.sorts_ += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_SORT, 1);
+			profile.autoindexes_ += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+			profile.vmSteps_ += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_VM_STEP, 1);
+		}
+		catch (...) {
+		}
 	}
 
-	void open(const wchar_t *const filename) {
-		internalOpen(sqlite3_open16, filename);
+	//copy of the profiles, slowest total run time first
+	std::vector<StatementProfile> snapshot() const {
+		std::vector<StatementProfile> profiles;
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			profiles.assign(profiles_.begin(), profiles_.end());
+		}
+		std::sort(profiles.begin(), profiles.end(), [](const StatementProfile &left, const StatementProfile &right) { return left.runTime_ > right.runTime_; });
+		return profiles;
 	}
-	
-	long long lastRowId() const noexcept {
-		return sqlite3_last_insert_rowid(getABI());
+
+	void clear() noexcept {
+		const std::lock_guard<std::mutex> lock(mutex_);
+		index_.clear();
+		profiles_.clear();
 	}
 };
 
-  
+#endif
 
-template <typename T>
-struct sqliteReader {
-	
-	constexpr int getInt(const int columnNum = 0) const noexcept {
-		return sqlite3_column_int(static_cast<const T *>(this)->getABI(), columnNum);
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+// Parameter name as a template argument, SqliteStatement::bind<":name">(value).
+template <std::size_t Size>
+struct parameterName {
+	char text_[Size]{};
+
+	constexpr parameterName(const char (&text)[Size]) noexcept {
+		for (std::size_t character = 0; character < Size; ++character) {
+			text_[character] = text[character];
+		}
 	}
 
-	constexpr const char *getString(const int columnNum = 0) const noexcept {
-		return reinterpret_cast<const char *>(sqlite3_column_text(static_cast<const T *>(this)->getABI(), columnNum));
+	constexpr std::string_view view() const noexcept {
+		return std::string_view(text_, Size - 1);
 	}
+};
+#endif
+
 
-	constexpr const wchar_t *getWideString(const int columnNum = 0) const noexcept {
-		return static_cast<const wchar_t *>(sqlite3_column_text16(static_cast<const T *>(this)->getABI(), columnNum));
+  
+// Index of the named parameters (:name, @name, $name, ?NNN) of a prepared statement, read on the first lookup by name,
+// so that statements bound by position only never build it. The names point into the prepared statement, which keeps them
+// until it is finalized. Lookups are binary searches, and the indexes of the compile-time names bound to the statement
+// are remembered by name slot, so that rebinding them costs no string comparison.
+class StatementParameters {
+
+	//sorted by name
+	mutable std::vector<std::pair<std::string_view, int>> names_;
+	mutable bool read_{false};
+	//sorted by slot, at most one entry per named parameter of the statement
+	mutable std::vector<std::pair<std::size_t, int>> slots_;
+
+	void read(sqlite3_stmt *const statement) const {
+		const int count = sqlite3_bind_parameter_count(statement);
+		for (int index = 1; index <= count; ++index) {
+			//anonymous ? parameters have no name
+			if (const char *const name = sqlite3_bind_parameter_name(statement, index)) {
+				names_.emplace_back(name, index);
+			}
+		}
+		std::sort(names_.begin(), names_.end());
+		read_ = true;
 	}
 
-	constexpr int getStringLength(const int columnNum) const noexcept {
-		return sqlite3_column_bytes(static_cast<const T *>(this)->getABI(), columnNum);
+  public:
+	//0 when statement has no parameter of that name, the name includes its prefix character
+	int index(sqlite3_stmt *const statement, const std::string_view name) const {
+		if (!read_) {
+			read(statement);
+		}
+		const auto found = std::lower_bound(names_.begin(), names_.end(), name, [](const std::pair<std::string_view, int> &entry, const std::string_view key) {
+			return entry.first < key;
+		});
+		return found != names_.end() && found->first == name ? found->second : 0;
 	}
 
-	constexpr int getWideStringLength(const int columnNum) const noexcept {
-		return (sqlite3_column_bytes16(static_cast<const T *>(this)->getABI(), columnNum) / sizeof(wchar_t));
+	int index(sqlite3_stmt *const statement, const std::size_t slot, const std::string_view name) const {
+		const auto found = std::lower_bound(slots_.begin(), slots_.end(), slot, [](const std::pair<std::size_t, int> &entry, const std::size_t key) {
+			return entry.first < key;
+		});
+		if (found != slots_.end() && found->first == slot) {
+			return found->second;
+		}
+		const int resolved = index(statement, name);
+		//a name the statement does not have is not remembered, it throws anyway
+		if (resolved != 0) {
+			slots_.emplace(found, slot, resolved);
+		}
+		return resolved;
 	}
 
+	//a slot per compile-time name, numbered in the order of first use in the process
+	static std::size_t nextSlot() noexcept {
+		static std::atomic<std::size_t> next{0};
+		return next.fetch_add(1, std::memory_order_relaxed);
+	}
 };
 
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+template <parameterName Name>
+std::size_t parameterSlot() noexcept {
+	static const std::size_t slot = StatementParameters::nextSlot();
+	return slot;
+}
+#endif
+
+
 
   
-class SqliteStatement : public sqliteReader<SqliteStatement> {
-	
-	struct SqliteStatementTraits : public nullHandleTraits<sqlite3_stmt *> {
+// LRU cache of prepared statements owned by a SqliteConnection.
+// Leased statements are taken out of the cache and returned, reset and with cleared bindings, on release.
+// The cache is guarded by the mutex of its connection, unless that was opened with SQLITE_OPEN_NOMUTEX.
+class StatementCache {
+
+  public:
+
+	struct Entry {
+		std::string text_;
+		sqlite3_stmt *statement_;
+		//lent to the CachedStatement along with the statement
+		StatementParameters parameters_;
+	};
+
+	using Lease = std::list<Entry>::iterator;
+
+	struct Stats {
+		unsigned long long hits_{0};
+		unsigned long long misses_{0};
+		unsigned long long evictions_{0};
+		std::size_t size_{0};
+		std::size_t capacity_{0};
+	};
+
+	static constexpr std::size_t defaultCapacity = 32;
+
+  private:
+
+	//most recently used first
+	std::list<Entry> idle_;
+	std::list<Entry> leased_;
+	std::unordered_map<std::string_view, Lease> index_;
+	std::size_t capacity_;
+	Stats stats_;
+	//the mutex of a serialized connection, nullptr for a NOMUTEX one (sqlite3_mutex_enter ignores it)
+	sqlite3_mutex *mutex_{nullptr};
+#ifdef SQLITECPP_ENABLE_PROFILING
+	StatementProfiler *profiler_{nullptr};
+#endif
+
+	struct preparedTraits : public nullHandleTraits<sqlite3_stmt *> {
 		static void close(sqlite3_stmt *value) noexcept {
 			sqlite3_finalize(value);
 		}
 	};
 
-	UniqueHandle<SqliteStatementTraits> statementHandle_;
+	class lock {
+		sqlite3_mutex *const mutex_;
 
+	  public:
+		lock(const lock &) = delete;
+		lock &operator=(const lock &) = delete;
 
-	template <typename PrepareFunction, typename CharacterSet, typename... VALUES>
-	void internalPrepare(const SqliteConnection &connection, const PrepareFunction prepare, const CharacterSet *const text, VALUES &&... values) {
-		if (SQLITE_OK != prepare(connection.getABI(), text, -1, statementHandle_.set(), nullptr)) {
-			connection.throwLastError();
+		explicit lock(sqlite3_mutex *const mutex) noexcept : mutex_{mutex} {
+			sqlite3_mutex_enter(mutex_);
+		}
+
+		~lock() noexcept {
+			sqlite3_mutex_leave(mutex_);
+		}
+	};
+
+	void trim() noexcept {
+		while (idle_.size() > capacity_) {
+			index_.erase(idle_.back().text_);
+			sqlite3_finalize(idle_.back().statement_);
+			idle_.pop_back();
+			++stats_.evictions_;
 		}
-		bindAll(std::forward<VALUES>(values)...);
 	}
-	
-	void internalBindAll(const int) const noexcept
-	{
+
+  public:
+
+	StatementCache(const StatementCache &) = delete;
+	StatementCache &operator=(const StatementCache &) = delete;
+
+	explicit StatementCache(const std::size_t capacity = defaultCapacity) noexcept : capacity_{capacity} {
 	}
-	
-	template <typename FIRST, typename... REST_VALUES>
-	void internalBindAll(const int index, FIRST &&first, REST_VALUES &&... restValues) const {
-		bind(index, std::forward<FIRST>(first));
-		internalBindAll(index + 1, std::forward<REST_VALUES>(restValues)...);
+
+	~StatementCache() noexcept {
+		clear();
 	}
 
-  public:
-  
-	SqliteStatement() = default;
-	
-	template <typename CharacterSet, typename... VALUES>
-	SqliteStatement(const SqliteConnection &connection, const CharacterSet *const text, VALUES &&... values) {
-		prepare(connection, text, std::forward<VALUES>(values)...);
+	//called by SqliteConnection once the connection is open
+	void attach(sqlite3 *const connection) noexcept {
+		mutex_ = sqlite3_db_mutex(connection);
 	}
 
-	explicit operator bool() const noexcept {
-		return static_cast<bool>(statementHandle_);
+	Lease acquire(sqlite3 *const connection, const char *const text) {
+		const lock guard(mutex_);
+		const auto found = index_.find(text);
+		if (found != index_.end()) {
+			const Lease lease = found->second;
+			index_.erase(found);
+			leased_.splice(leased_.begin(), idle_, lease);
+			++stats_.hits_;
+			return lease;
+		}
+
+		++stats_.misses_;
+		//finalized unless the list node holding it is created
+		UniqueHandle<preparedTraits> statement;
+#ifdef SQLITECPP_ENABLE_PROFILING
+		const auto start = std::chrono::steady_clock::now();
+#endif
+		if (SQLITE_OK != sqlite3_prepare_v2(connection, text, -1, statement.set(), nullptr)) {
+			throw exception(connection);
+		}
+#ifdef SQLITECPP_ENABLE_PROFILING
+		if (profiler_) {
+			profiler_->recordPrepare(statement.get(), std::chrono::steady_clock::now() - start);
+		}
+#endif
+		leased_.push_front(Entry{text, nullptr, StatementParameters()});
+		leased_.front().statement_ = statement.release();
+		return leased_.begin();
 	}
 
-	sqlite3_stmt *getABI() const noexcept {
-		return statementHandle_.get();
+	void release(const Lease lease) noexcept {
+		const lock guard(mutex_);
+		sqlite3_stmt *const statement = lease->statement_;
+		sqlite3_reset(statement);
+		sqlite3_clear_bindings(statement);
+
+		//an idle copy of the same text is already cached (or there is nothing to cache)
+		if (statement == nullptr || capacity_ == 0 || index_.count(lease->text_) != 0) {
+			sqlite3_finalize(statement);
+			leased_.erase(lease);
+			return;
+		}
+
+		idle_.splice(idle_.begin(), leased_, lease);
+		index_.emplace(lease->text_, lease);
+		trim();
 	}
 
-	void throwLastError() const {
-		throw exception(sqlite3_db_handle(getABI()));
+	void clear() noexcept {
+		const lock guard(mutex_);
+		index_.clear();
+		for (const Entry &entry : idle_) {
+			sqlite3_finalize(entry.statement_);
+		}
+		idle_.clear();
 	}
 
-	template <typename... VALUES>
-	void prepare(const SqliteConnection &connection, const char *const characterSet, VALUES &&... values) {
-		internalPrepare(connection, sqlite3_prepare_v2, characterSet, std::forward<VALUES>(values)...);
+	std::size_t capacity() const noexcept {
+		const lock guard(mutex_);
+		return capacity_;
 	}
-	
-	template <typename... VALUES>
-	void prepare(const SqliteConnection &connection, const wchar_t *const characterSet, VALUES &&... values) {
-		internalPrepare(connection, sqlite3_prepare16_v2, characterSet, std::forward<VALUES>(values)...);
+
+	void setCapacity(const std::size_t capacity) noexcept {
+		const lock guard(mutex_);
+		capacity_ = capacity;
+		trim();
 	}
 
-	bool execute() const {
-		const int result = sqlite3_step(getABI());
-		if (result == SQLITE_ROW)
-			return true;
-		else if (result == SQLITE_DONE)
-			return false;
-		else {
-			throwLastError();
-			//the control will never reach here, as exception will be thrown
-			//added return false, just to remove warning: control may reach end of non-void function [-Wreturn-type]
-			return false;
+#ifdef SQLITECPP_ENABLE_PROFILING
+	void setProfiler(StatementProfiler *const profiler) noexcept {
+		profiler_ = profiler;
+	}
+#endif
+
+	Stats stats() const noexcept {
+		const lock guard(mutex_);
+		Stats stats = stats_;
+		stats.size_ = idle_.size();
+		stats.capacity_ = capacity_;
+		return stats;
+	}
+};
+
+
+  
+// Transcoding between wchar_t text and UTF-8. Where wchar_t is 4 bytes (Linux, macOS) it holds UTF-32, which SQLite has no
+// API for, so wide text is stored and read as UTF-8. Where it is 2 bytes (Windows) it is UTF-16 and goes to the sqlite3_*16 functions as it is.
+// Runs of ASCII are converted 16 characters at a time with SSE2, or 32 with AVX2 when the code is compiled for it, the rest one character at a time.
+// Lone surrogates, code points above U+10FFFF and malformed UTF-8 sequences are replaced by U+FFFD.
+
+constexpr bool wideIsUtf32 = sizeof(wchar_t) == 4;
+
+constexpr std::uint32_t replacementCharacter = 0xFFFD;
+
+//characters are converted one at a time for at least this many after a vector of them held non-ASCII text
+constexpr std::size_t scalarRun = 16;
+
+//converts the leading ASCII characters of wide a vector at a time, returns how many
+inline std::size_t asciiToUtf8(const wchar_t *const wide, const std::size_t size, char *const utf8) noexcept {
+	std::size_t done = 0;
+#if defined(__AVX2__)
+	{
+		const __m256i nonAscii = _mm256_set1_epi32(~0x7F);
+		//packs work within 128-bit lanes, this puts the four 32-bit groups of each lane back in order
+		const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		for (; done + 32 <= size; done += 32) {
+			const __m256i *const source = reinterpret_cast<const __m256i *>(wide + done);
+			const __m256i first = _mm256_loadu_si256(source);
+			const __m256i second = _mm256_loadu_si256(source + 1);
+			const __m256i third = _mm256_loadu_si256(source + 2);
+			const __m256i fourth = _mm256_loadu_si256(source + 3);
+			if (!_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(first, second), _mm256_or_si256(third, fourth)), nonAscii)) {
+				break;
+			}
+			const __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(first, second), _mm256_packs_epi32(third, fourth));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(utf8 + done), _mm256_permutevar8x32_epi32(bytes, order));
 		}
 	}
-	
-	void bind(const int index, const int value) const {
-		if (SQLITE_OK != sqlite3_bind_int(getABI(), index, value)) {
-			throwLastError();
+#endif
+#if defined(__SSE2__)
+	{
+		const __m128i nonAscii = _mm_set1_epi32(~0x7F);
+		const __m128i zero = _mm_setzero_si128();
+		for (; done + 16 <= size; done += 16) {
+			const __m128i *const source = reinterpret_cast<const __m128i *>(wide + done);
+			const __m128i first = _mm_loadu_si128(source);
+			const __m128i second = _mm_loadu_si128(source + 1);
+			const __m128i third = _mm_loadu_si128(source + 2);
+			const __m128i fourth = _mm_loadu_si128(source + 3);
+			const __m128i high = _mm_and_si128(_mm_or_si128(_mm_or_si128(first, second), _mm_or_si128(third, fourth)), nonAscii);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, zero)) != 0xFFFF) {
+				break;
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(utf8 + done), _mm_packus_epi16(_mm_packs_epi32(first, second), _mm_packs_epi32(third, fourth)));
 		}
 	}
-	
-	void bind(const int index, const char *const strValue, const int size = -1) const {
-		if (SQLITE_OK != sqlite3_bind_text(getABI(), index, strValue, size, SQLITE_STATIC)) {
-			throwLastError();
+#endif
+	return done;
+}
+
+//converts the leading ASCII bytes of utf8 a vector at a time, returns how many
+inline std::size_t asciiToWide(const char *const utf8, const std::size_t size, wchar_t *const wide) noexcept {
+	std::size_t done = 0;
+#if defined(__AVX2__)
+	for (; done + 32 <= size; done += 32) {
+		const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(utf8 + done));
+		if (_mm256_movemask_epi8(bytes) != 0) {
+			break;
 		}
+		const __m128i low = _mm256_castsi256_si128(bytes);
+		const __m128i high = _mm256_extracti128_si256(bytes, 1);
+		__m256i *const target = reinterpret_cast<__m256i *>(wide + done);
+		_mm256_storeu_si256(target, _mm256_cvtepu8_epi32(low));
+		_mm256_storeu_si256(target + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+		_mm256_storeu_si256(target + 2, _mm256_cvtepu8_epi32(high));
+		_mm256_storeu_si256(target + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
 	}
-	
-	void bind(const int index, const wchar_t *const strValue, const int size = -1) const {
-		if (SQLITE_OK != sqlite3_bind_text16(getABI(), index, strValue, size, SQLITE_STATIC)) {
-			throwLastError();
+#endif
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	for (; done + 16 <= size; done += 16) {
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8 + done));
+		if (_mm_movemask_epi8(bytes) != 0) {
+			break;
 		}
+		const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+		const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+		__m128i *const target = reinterpret_cast<__m128i *>(wide + done);
+		_mm_storeu_si128(target, _mm_unpacklo_epi16(low, zero));
+		_mm_storeu_si128(target + 1, _mm_unpackhi_epi16(low, zero));
+		_mm_storeu_si128(target + 2, _mm_unpacklo_epi16(high, zero));
+		_mm_storeu_si128(target + 3, _mm_unpackhi_epi16(high, zero));
 	}
-	
-	void bind(const int index, const std::string &strValue) const {
-		bind(index, strValue.c_str(), static_cast<int>(strValue.size()));
+#endif
+	return done;
+}
+
+inline std::size_t encodeUtf8(std::uint32_t code, char *const utf8) noexcept {
+	if (code < 0x80) {
+		utf8[0] = static_cast<char>(code);
+		return 1;
 	}
-	
-	void bind(const int index, const std::wstring &strValue) const {
-		bind(index, strValue.c_str(), static_cast<int>((strValue.size() * sizeof(wchar_t))));
+	if (code < 0x800) {
+		utf8[0] = static_cast<char>(0xC0 | (code >> 6));
+		utf8[1] = static_cast<char>(0x80 | (code & 0x3F));
+		return 2;
 	}
-	
-	void bind(const int index, const std::string &&strValue) const {
-		if (SQLITE_OK != sqlite3_bind_text(getABI(), index, strValue.c_str(), static_cast<int>(strValue.size()), SQLITE_TRANSIENT)) {
-			throwLastError();
-		}
+	if ((code >= 0xD800 && code <= 0xDFFF) || code > 0x10FFFF) {
+		code = replacementCharacter;
 	}
-	
-	void bind(const int index, const std::wstring &&strValue) const {
-		if (SQLITE_OK != sqlite3_bind_text16(getABI(), index, strValue.c_str(), static_cast<int>((strValue.size() * sizeof(wchar_t))), SQLITE_TRANSIENT)) {
-			throwLastError();
-		}
+	if (code < 0x10000) {
+		utf8[0] = static_cast<char>(0xE0 | (code >> 12));
+		utf8[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+		utf8[2] = static_cast<char>(0x80 | (code & 0x3F));
+		return 3;
 	}
+	utf8[0] = static_cast<char>(0xF0 | (code >> 18));
+	utf8[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+	utf8[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+	utf8[3] = static_cast<char>(0x80 | (code & 0x3F));
+	return 4;
+}
 
-	template <typename... Values>
-	void bindAll(Values &&... values) const {
-		internalBindAll(1, std::forward<Values>(values)...);
+//decodes the sequence at utf8[0], a malformed one becomes one U+FFFD per maximal valid prefix, returns the bytes consumed
+inline std::size_t decodeUtf8(const unsigned char *const utf8, const std::size_t size, std::uint32_t &code) noexcept {
+	const unsigned char lead = utf8[0];
+	if (lead < 0x80) {
+		code = lead;
+		return 1;
 	}
-	
-	template <typename ...Values>
-	void reset (Values&&... values) {
-		if (SQLITE_OK != sqlite3_reset(getABI ())) {
-			throwLastError ();
+	std::size_t length = 0;
+	unsigned char low = 0x80;
+	unsigned char high = 0xBF;
+	if (lead >= 0xC2 && lead <= 0xDF) {
+		length = 2;
+		code = lead & 0x1F;
+	}
+	else if (lead >= 0xE0 && lead <= 0xEF) {
+		length = 3;
+		code = lead & 0x0F;
+		//no overlong forms and no surrogates
+		low = lead == 0xE0 ? 0xA0 : 0x80;
+		high = lead == 0xED ? 0x9F : 0xBF;
+	}
+	else if (lead >= 0xF0 && lead <= 0xF4) {
+		length = 4;
+		code = lead & 0x07;
+		//no overlong forms and nothing above U+10FFFF
+		low = lead == 0xF0 ? 0x90 : 0x80;
+		high = lead == 0xF4 ? 0x8F : 0xBF;
+	}
+	else {
+		code = replacementCharacter;
+		return 1;
+	}
+	std::size_t used = 1;
+	for (; used < length && used < size; ++used) {
+		const unsigned char next = utf8[used];
+		if (next < low || next > high) {
+			break;
 		}
-		bindAll(std:: forward<Values> (values)...);
+		code = (code << 6) | (next & 0x3F);
+		low = 0x80;
+		high = 0xBF;
 	}
-};
+	if (used != length) {
+		code = replacementCharacter;
+	}
+	return used;
+}
 
+//UTF-32 to UTF-8, utf8 holds at least 4 * size bytes, returns the bytes written
+inline std::size_t wideToUtf8(const wchar_t *const wide, const std::size_t size, char *const utf8) noexcept {
+	std::size_t read = 0;
+	std::size_t written = 0;
+	while (read < size) {
+		const std::size_t ascii = asciiToUtf8(wide + read, size - read, utf8 + written);
+		read += ascii;
+		written += ascii;
+		const std::size_t end = std::min(size, read + scalarRun);
+		for (; read < end; ++read) {
+			written += encodeUtf8(static_cast<std::uint32_t>(wide[read]), utf8 + written);
+		}
+	}
+	return written;
+}
 
-  
-template <typename CharacterSet, typename... Values>
-void sqliteExecute(const SqliteConnection &connection, const CharacterSet *const text, Values &&... values) {
-	SqliteStatement(connection, text, std::forward<Values>(values)...).execute();
+//UTF-8 to UTF-32, wide holds at least size characters, returns the characters written
+inline std::size_t utf8ToWide(const char *const utf8, const std::size_t size, wchar_t *const wide) noexcept {
+	const unsigned char *const bytes = reinterpret_cast<const unsigned char *>(utf8);
+	std::size_t read = 0;
+	std::size_t written = 0;
+	while (read < size) {
+		const std::size_t ascii = asciiToWide(utf8 + read, size - read, wide + written);
+		read += ascii;
+		written += ascii;
+		const std::size_t end = std::min(size, read + scalarRun);
+		while (read < end) {
+			std::uint32_t code;
+			read += decodeUtf8(bytes + read, size - read, code);
+			wide[written++] = static_cast<wchar_t>(code);
+		}
+	}
+	return written;
 }
 
+inline void wideToUtf8(const std::wstring_view wide, std::string &utf8) {
+	utf8.resize(wide.size() * 4);
+	utf8.resize(wideToUtf8(wide.data(), wide.size(), utf8.data()));
+}
 
 
-class SqliteRow : public sqliteReader<SqliteRow> {
+  
+// The wide text of the columns and the UTF-8 of the wide parameters of one statement, where wchar_t is UTF-32.
+// The buffers only grow, so that reading or binding the same columns row after row does not allocate once they are large enough.
+class wideTextBuffers {
+
+	std::vector<std::vector<wchar_t>> columns_;
+	std::vector<std::vector<char>> parameters_;
+
+  public:
+
+	//NUL terminated, valid until the column is converted again or the statement is stepped, reset or finalized, a null data() for NULL
+	std::wstring_view column(sqlite3_stmt *const statement, const int column) {
+		if constexpr (!wideIsUtf32) {
+			const wchar_t *const text = static_cast<const wchar_t *>(sqlite3_column_text16(statement, column));
+			return std::wstring_view(text, text ? static_cast<std::size_t>(sqlite3_column_bytes16(statement, column)) / sizeof(wchar_t) : 0);
+		}
+		const char *const text = reinterpret_cast<const char *>(sqlite3_column_text(statement, column));
+		if (!text) {
+			return std::wstring_view();
+		}
+		const std::size_t size = static_cast<std::size_t>(sqlite3_column_bytes(statement, column));
+		if (columns_.size() <= static_cast<std::size_t>(column)) {
+			columns_.resize(static_cast<std::size_t>(column) + 1);
+		}
+		std::vector<wchar_t> &buffer = columns_[static_cast<std::size_t>(column)];
+		if (buffer.size() < size + 1) {
+			buffer.resize(size + 1);
+		}
+		const std::size_t length = utf8ToWide(text, size, buffer.data());
+		buffer[length] = L'\0';
+		return std::wstring_view(buffer.data(), length);
+	}
+
+	//kept until the parameter is converted again, so that it can be bound with SQLITE_STATIC
+	std::string_view parameter(const int index, const std::wstring_view text) {
+		//left to sqlite3_bind_text to reject
+		if (index < 0) {
+			return std::string_view();
+		}
+		if (parameters_.size() <= static_cast<std::size_t>(index)) {
+			parameters_.resize(static_cast<std::size_t>(index) + 1);
+		}
+		std::vector<char> &buffer = parameters_[static_cast<std::size_t>(index)];
+		//at least one byte, so that an empty string is bound as text and not as NULL
+		if (buffer.size() < text.size() * 4 + 1) {
+			buffer.resize(text.size() * 4 + 1);
+		}
+		return std::string_view(buffer.data(), wideToUtf8(text.data(), text.size(), buffer.data()));
+	}
+};
+
+
+
+enum class JournalMode {
+	Delete,
+	Truncate,
+	Persist,
+	Memory,
+	Wal,
+	Off
+};
+
+enum class SynchronousMode {
+	Off,
+	Normal,
+	Full,
+	Extra
+};
+
+enum class TempStore {
+	Default,
+	File,
+	Memory
+};
+
+enum class ThreadingMode {
+	Default,
+	//SQLITE_OPEN_NOMUTEX, the connection must not be used by two threads at once
+	MultiThread,
+	//SQLITE_OPEN_FULLMUTEX
+	Serialized
+};
+
+enum class CacheMode {
+	Default,
+	Shared,
+	Private
+};
+
+
+  
+// Open flags, VFS and tuning pragmas applied by SqliteConnection::open before the connection is handed out.
+// Pragmas that are not set keep the SQLite defaults.
+struct OpenOptions {
+	bool readOnly_{false};
+	bool create_{true};
+	bool uri_{false};
+	ThreadingMode threading_{ThreadingMode::Default};
+	CacheMode cache_{CacheMode::Default};
+	//empty for the default VFS
+	std::string vfs_;
+
+	std::optional<JournalMode> journalMode_;
+	std::optional<SynchronousMode> synchronous_;
+	//PRAGMA cache_size, pages when positive and KiB when negative
+	std::optional<int> cacheSize_;
+	std::optional<long long> mmapSize_;
+	std::optional<TempStore> tempStore_;
+	std::optional<int> busyTimeoutMilliseconds_;
+
+	int flags() const noexcept {
+		int flags = readOnly_ ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE;
+		if (create_ && !readOnly_) {
+			flags |= SQLITE_OPEN_CREATE;
+		}
+		if (uri_) {
+			flags |= SQLITE_OPEN_URI;
+		}
+		if (threading_ == ThreadingMode::MultiThread) {
+			flags |= SQLITE_OPEN_NOMUTEX;
+		}
+		else if (threading_ == ThreadingMode::Serialized) {
+			flags |= SQLITE_OPEN_FULLMUTEX;
+		}
+		if (cache_ == CacheMode::Shared) {
+			flags |= SQLITE_OPEN_SHAREDCACHE;
+		}
+		else if (cache_ == CacheMode::Private) {
+			flags |= SQLITE_OPEN_PRIVATECACHE;
+		}
+		return flags;
+	}
+
+	//the pragma statements for the set options
+	std::string pragmas() const {
+		static const char *const journalModes[] = {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"};
+		static const char *const synchronousModes[] = {"OFF", "NORMAL", "FULL", "EXTRA"};
+		static const char *const tempStores[] = {"DEFAULT", "FILE", "MEMORY"};
+
+		std::string text;
+		if (journalMode_) {
+			text += std::string("PRAGMA journal_mode=") + journalModes[static_cast<int>(*journalMode_)] + ';';
+		}
+		if (synchronous_) {
+			text += std::string("PRAGMA synchronous=") + synchronousModes[static_cast<int>(*synchronous_)] + ';';
+		}
+		if (cacheSize_) {
+			text += "PRAGMA cache_size=" + std::to_string(*cacheSize_) + ';';
+		}
+		if (mmapSize_) {
+			text += "PRAGMA mmap_size=" + std::to_string(*mmapSize_) + ';';
+		}
+		if (tempStore_) {
+			text += std::string("PRAGMA temp_store=") + tempStores[static_cast<int>(*tempStore_)] + ';';
+		}
+		return text;
+	}
+
+	//WAL without syncs and a 256 MiB page cache. An application crash can lose the last transactions but does not corrupt the
+	//database, an OS crash or a power failure can corrupt it; use SynchronousMode::Normal when that matters
+	static OpenOptions bulkLoad() {
+		OpenOptions options;
+		options.journalMode_ = JournalMode::Wal;
+		options.synchronous_ = SynchronousMode::Off;
+		options.cacheSize_ = -262144;
+		options.tempStore_ = TempStore::Memory;
+		options.busyTimeoutMilliseconds_ = 5000;
+		return options;
+	}
+
+	//WAL, so that readers do not block the writer, a 64 MiB page cache and 256 MiB of memory mapped I/O
+	static OpenOptions readHeavy() {
+		OpenOptions options;
+		options.journalMode_ = JournalMode::Wal;
+		options.synchronous_ = SynchronousMode::Normal;
+		options.cacheSize_ = -65536;
+		options.mmapSize_ = 268435456;
+		options.tempStore_ = TempStore::Memory;
+		options.busyTimeoutMilliseconds_ = 5000;
+		return options;
+	}
+
+	//WAL with a sync on every commit
+	static OpenOptions durable() {
+		OpenOptions options;
+		options.journalMode_ = JournalMode::Wal;
+		options.synchronous_ = SynchronousMode::Full;
+		options.busyTimeoutMilliseconds_ = 5000;
+		return options;
+	}
+};
+
+
+  
+// Typed access to the arguments and the result of SQL functions, see SqliteConnection::createFunction and createAggregate.
+
+template <typename Value, typename Enable = void>
+struct valueReader;
+
+template <typename Value>
+struct valueReader<Value, std::enable_if_t<std::is_integral_v<Value>>> {
+	static Value read(sqlite3_value *const value) noexcept {
+		if constexpr (sizeof(Value) <= sizeof(int)) {
+			return static_cast<Value>(sqlite3_value_int(value));
+		}
+		else {
+			return static_cast<Value>(sqlite3_value_int64(value));
+		}
+	}
+};
+
+template <typename Value>
+struct valueReader<Value, std::enable_if_t<std::is_floating_point_v<Value>>> {
+	static Value read(sqlite3_value *const value) noexcept {
+		return static_cast<Value>(sqlite3_value_double(value));
+	}
+};
+
+template <>
+struct valueReader<const char *> {
+	static const char *read(sqlite3_value *const value) noexcept {
+		return reinterpret_cast<const char *>(sqlite3_value_text(value));
+	}
+};
+
+template <>
+struct valueReader<std::string_view> {
+	static std::string_view read(sqlite3_value *const value) noexcept {
+		//sqlite3_value_bytes must be called after sqlite3_value_text, which may convert the value
+		const char *const text = reinterpret_cast<const char *>(sqlite3_value_text(value));
+		return std::string_view(text, static_cast<std::size_t>(sqlite3_value_bytes(value)));
+	}
+};
+
+template <>
+struct valueReader<std::string> {
+	static std::string read(sqlite3_value *const value) {
+		return std::string(valueReader<std::string_view>::read(value));
+	}
+};
+
+#ifdef __cpp_lib_span
+template <>
+struct valueReader<std::span<const std::byte>> {
+	static std::span<const std::byte> read(sqlite3_value *const value) noexcept {
+		const std::byte *const blob = static_cast<const std::byte *>(sqlite3_value_blob(value));
+		return std::span<const std::byte>(blob, static_cast<std::size_t>(sqlite3_value_bytes(value)));
+	}
+};
+#endif
+
+//the argument as it is, for functions taking values of any type
+template <>
+struct valueReader<sqlite3_value *> {
+	static sqlite3_value *read(sqlite3_value *const value) noexcept {
+		return value;
+	}
+};
+
+template <typename Value>
+struct valueReader<std::optional<Value>> {
+	static std::optional<Value> read(sqlite3_value *const value) noexcept(noexcept(valueReader<Value>::read(value))) {
+		if (sqlite3_value_type(value) == SQLITE_NULL) {
+			return std::nullopt;
+		}
+		return valueReader<Value>::read(value);
+	}
+};
+
+template <typename Value, typename Enable = void>
+struct resultWriter;
+
+template <typename Value>
+struct resultWriter<Value, std::enable_if_t<std::is_integral_v<Value>>> {
+	static void write(sqlite3_context *const context, const Value value) noexcept {
+		if constexpr (sizeof(Value) < sizeof(int) || (sizeof(Value) == sizeof(int) && std::is_signed_v<Value>)) {
+			sqlite3_result_int(context, value);
+		}
+		else {
+			sqlite3_result_int64(context, static_cast<sqlite3_int64>(value));
+		}
+	}
+};
+
+template <typename Value>
+struct resultWriter<Value, std::enable_if_t<std::is_floating_point_v<Value>>> {
+	static void write(sqlite3_context *const context, const Value value) noexcept {
+		sqlite3_result_double(context, static_cast<double>(value));
+	}
+};
+
+//text and blobs are copied by SQLite, since the function's result is gone once it returns
+template <>
+struct resultWriter<std::string_view> {
+	static void write(sqlite3_context *const context, const std::string_view value) noexcept {
+		//a null pointer would make the result NULL instead of empty
+		sqlite3_result_text64(context, value.data() != nullptr ? value.data() : "", value.size(), SQLITE_TRANSIENT, SQLITE_UTF8);
+	}
+};
+
+template <>
+struct resultWriter<std::string> {
+	static void write(sqlite3_context *const context, const std::string &value) noexcept {
+		resultWriter<std::string_view>::write(context, value);
+	}
+};
+
+template <>
+struct resultWriter<const char *> {
+	static void write(sqlite3_context *const context, const char *const value) noexcept {
+		if (value == nullptr) {
+			sqlite3_result_null(context);
+		}
+		else {
+			sqlite3_result_text(context, value, -1, SQLITE_TRANSIENT);
+		}
+	}
+};
+
+template <>
+struct resultWriter<std::vector<std::byte>> {
+	static void write(sqlite3_context *const context, const std::vector<std::byte> &value) noexcept {
+		if (value.empty()) {
+			sqlite3_result_zeroblob(context, 0);
+		}
+		else {
+			sqlite3_result_blob64(context, value.data(), value.size(), SQLITE_TRANSIENT);
+		}
+	}
+};
+
+#ifdef __cpp_lib_span
+template <>
+struct resultWriter<std::span<const std::byte>> {
+	static void write(sqlite3_context *const context, const std::span<const std::byte> value) noexcept {
+		if (value.empty()) {
+			sqlite3_result_zeroblob(context, 0);
+		}
+		else {
+			sqlite3_result_blob64(context, value.data(), value.size(), SQLITE_TRANSIENT);
+		}
+	}
+};
+#endif
+
+template <>
+struct resultWriter<std::nullptr_t> {
+	static void write(sqlite3_context *const context, std::nullptr_t) noexcept {
+		sqlite3_result_null(context);
+	}
+};
+
+template <typename Value>
+struct resultWriter<std::optional<Value>> {
+	static void write(sqlite3_context *const context, const std::optional<Value> &value) noexcept {
+		if (value) {
+			resultWriter<Value>::write(context, *value);
+		}
+		else {
+			sqlite3_result_null(context);
+		}
+	}
+};
+
+// The argument types of a function, a function pointer or a callable object, such as a lambda.
+template <typename Function>
+struct functionTraits : public functionTraits<decltype(&Function::operator())> {
+};
+
+template <typename Result, typename... Arguments>
+struct functionTraits<Result (*)(Arguments...)> {
+	using arguments = std::tuple<Arguments...>;
+};
+
+template <typename Result, typename... Arguments>
+struct functionTraits<Result (*)(Arguments...) noexcept> : public functionTraits<Result (*)(Arguments...)> {
+};
+
+template <typename Class, typename Result, typename... Arguments>
+struct functionTraits<Result (Class::*)(Arguments...)> : public functionTraits<Result (*)(Arguments...)> {
+};
+
+template <typename Class, typename Result, typename... Arguments>
+struct functionTraits<Result (Class::*)(Arguments...) noexcept> : public functionTraits<Result (*)(Arguments...)> {
+};
+
+template <typename Class, typename Result, typename... Arguments>
+struct functionTraits<Result (Class::*)(Arguments...) const> : public functionTraits<Result (*)(Arguments...)> {
+};
+
+template <typename Class, typename Result, typename... Arguments>
+struct functionTraits<Result (Class::*)(Arguments...) const noexcept> : public functionTraits<Result (*)(Arguments...)> {
+};
+
+//runs call and hands what it returns, if anything, to SQLite as the result of the function
+template <typename Call>
+void setFunctionResult(sqlite3_context *const context, Call &&call) {
+	if constexpr (std::is_void_v<decltype(call())>) {
+		call();
+	}
+	else {
+		resultWriter<std::decay_t<decltype(call())>>::write(context, call());
+	}
+}
+
+//reports the exception being handled as the error of the function, the query fails with it
+inline void setFunctionError(sqlite3_context *const context) noexcept {
+	try {
+		throw;
+	}
+	catch (const exception &error) {
+		sqlite3_result_error(context, error.errorMessage_.c_str(), -1);
+		sqlite3_result_error_code(context, error.errorCode_ != SQLITE_OK ? error.errorCode_ : SQLITE_ERROR);
+	}
+	catch (const std::bad_alloc &) {
+		sqlite3_result_error_nomem(context);
+	}
+	catch (const std::exception &error) {
+		sqlite3_result_error(context, error.what(), -1);
+	}
+	catch (...) {
+		sqlite3_result_error(context, "unknown exception", -1);
+	}
+}
+
+template <typename Data>
+void destroyFunctionData(void *const data) noexcept {
+	delete static_cast<Data *>(data);
+}
+
+template <typename Function, typename Arguments = typename functionTraits<Function>::arguments>
+struct scalarFunction;
+
+template <typename Function, typename... Arguments>
+struct scalarFunction<Function, std::tuple<Arguments...>> {
+	template <std::size_t... Indexes>
+	static void invoke(sqlite3_context *const context, Function &function, sqlite3_value **const values, std::index_sequence<Indexes...>) {
+		setFunctionResult(context, [&]() -> decltype(auto) {
+			return function(valueReader<std::decay_t<Arguments>>::read(values[Indexes])...);
+		});
+	}
+
+	static void call(sqlite3_context *const context, int, sqlite3_value **const values) noexcept {
+		try {
+			invoke(context, *static_cast<Function *>(sqlite3_user_data(context)), values, std::index_sequence_for<Arguments...>{});
+		}
+		catch (...) {
+			setFunctionError(context);
+		}
+	}
+};
+
+// step(State &, Arguments...) folds a row into the state, which is value-initialized for every group, and finish(State &) returns the result.
+template <typename Step, typename Finish, typename Arguments = typename functionTraits<Step>::arguments>
+struct aggregateFunction;
+
+template <typename Step, typename Finish, typename State, typename... Arguments>
+struct aggregateFunction<Step, Finish, std::tuple<State &, Arguments...>> {
+	Step step_;
+	Finish finish_;
+
+	template <std::size_t... Indexes>
+	void callStep(State &state, sqlite3_value **const values, std::index_sequence<Indexes...>) {
+		step_(state, valueReader<std::decay_t<Arguments>>::read(values[Indexes])...);
+	}
+
+	//the aggregate context of SQLite holds a pointer to the state, so that the state is constructed and destroyed like a C++ object
+	static void step(sqlite3_context *const context, int, sqlite3_value **const values) noexcept {
+		try {
+			State **const slot = static_cast<State **>(sqlite3_aggregate_context(context, sizeof(State *)));
+			if (slot == nullptr) {
+				throw std::bad_alloc();
+			}
+			if (*slot == nullptr) {
+				*slot = new State();
+			}
+			static_cast<aggregateFunction *>(sqlite3_user_data(context))->callStep(**slot, values, std::index_sequence_for<Arguments...>{});
+		}
+		catch (...) {
+			setFunctionError(context);
+		}
+	}
+
+	static void finish(sqlite3_context *const context) noexcept {
+		State **const slot = static_cast<State **>(sqlite3_aggregate_context(context, 0));
+		std::unique_ptr<State> state(slot != nullptr ? *slot : nullptr);
+		try {
+			//a group without rows still has a result, from a fresh state
+			if (!state) {
+				state = std::make_unique<State>();
+			}
+			aggregateFunction &function = *static_cast<aggregateFunction *>(sqlite3_user_data(context));
+			setFunctionResult(context, [&]() -> decltype(auto) {
+				return function.finish_(*state);
+			});
+		}
+		catch (...) {
+			setFunctionError(context);
+		}
+	}
+};
+
+// Memory and page cache counters of a connection (sqlite3_db_status) and of the whole process (sqlite3_status64), see SqliteConnection::stats.
+struct ConnectionStats {
+	//heap bytes of the connection: its page cache, the part of a shared cache charged to it, its schemas and its prepared statements
+	long long cacheUsed_{0};
+	long long cacheUsedShared_{0};
+	long long schemaUsed_{0};
+	long long statementUsed_{0};
+	//page cache lookups and writes since the connection was opened or the counters were reset
+	long long cacheHits_{0};
+	long long cacheMisses_{0};
+	long long cacheWrites_{0};
+	long long cacheSpills_{0};
+	//lookaside slots in use now and at most, and the allocations served from them or missed because the slots were too small or all taken
+	long long lookasideUsed_{0};
+	long long lookasideHighwater_{0};
+	long long lookasideHits_{0};
+	long long lookasideMissesSize_{0};
+	long long lookasideMissesFull_{0};
+	//the heap of the process as counted by SQLite, for all connections
+	long long memoryUsed_{0};
+	long long memoryHighwater_{0};
+	long long allocations_{0};
+	long long largestAllocation_{0};
+	long long pagecacheOverflow_{0};
+
+	double cacheHitRate() const noexcept {
+		const long long lookups = cacheHits_ + cacheMisses_;
+		return lookups == 0 ? 0.0 : static_cast<double>(cacheHits_) / static_cast<double>(lookups);
+	}
+};
+
+template <typename Container, typename... Columns>
+class containerModule;
+
+
+  
+class SqliteConnection {
+	
+	struct SqliteConnectionTraits : public nullHandleTraits<sqlite3 *> {
+		static void close(sqlite3 *value) noexcept {
+			sqlite3_close(value);
+		}
+	};
+#ifdef SQLITECPP_ENABLE_PROFILING
+	//declared before the handle, so that it outlives the trace callback
+	std::unique_ptr<StatementProfiler> profiler_;
+#endif
+	UniqueHandle<SqliteConnectionTraits> connectionHandle_;
+	
+	//declared after the handle, so that the cached statements are finalized before the connection is closed
+	std::unique_ptr<StatementCache> statementCache_{std::make_unique<StatementCache>()};
+
+	//leases from and returns to statementCache_, which synchronizes itself
+	friend class CachedStatement;
+
+	template <typename Function, typename CharacterSet>
+	void internalOpen(Function openFunction, const CharacterSet *const filename, const OpenOptions *const options = nullptr) {
+		SqliteConnection tempConnection;
+	
+		if (SQLITE_OK != openFunction(filename, tempConnection.connectionHandle_.set())) {
+			tempConnection.throwLastError();
+		}
+		tempConnection.statementCache_->attach(tempConnection.getABI());
+		
+		if (options) {
+			tempConnection.configure(*options);
+		}
+		
+		if (statementCache_) {
+			tempConnection.statementCache_->setCapacity(statementCache_->capacity());
+		}
+	
+		swap(connectionHandle_, tempConnection.connectionHandle_);
+		statementCache_.swap(tempConnection.statementCache_);
+#ifdef SQLITECPP_ENABLE_PROFILING
+		if (profiler_ && profiler_->enabled()) {
+			enableProfiling();
+		}
+#endif
+	}
+	
+	void configure(const OpenOptions &options) {
+		if (options.busyTimeoutMilliseconds_) {
+			sqlite3_busy_timeout(getABI(), *options.busyTimeoutMilliseconds_);
+		}
+		const std::string pragmas = options.pragmas();
+		if (!pragmas.empty() && SQLITE_OK != sqlite3_exec(getABI(), pragmas.c_str(), nullptr, nullptr, nullptr)) {
+			throwLastError();
+		}
+	}
+
+	void pragma(const std::string &text) const {
+		if (SQLITE_OK != sqlite3_exec(getABI(), text.c_str(), nullptr, nullptr, nullptr)) {
+			throwLastError();
+		}
+	}
+
+  public:
+	SqliteConnection() = default;
+	
+	template <typename CharacterSet>
+	explicit SqliteConnection(const CharacterSet *const filename) {
+		open(filename);
+	}
+	
+	SqliteConnection(const char *const filename, const int flags, const char *const vfs = nullptr) {
+		open(filename, flags, vfs);
+	}
+	
+	SqliteConnection(const char *const filename, const OpenOptions &options) {
+		open(filename, options);
+	}
+
+	explicit operator bool() const noexcept {
+		return static_cast<bool>(connectionHandle_);
+	}
+
+	static SqliteConnection memory() {
+		return SqliteConnection(":memory:");
+	}
+
+	static SqliteConnection wideMemory() {
+		return SqliteConnection(L":memory:");
+	}
+
+	sqlite3 *getABI() const noexcept {
+		return connectionHandle_.get();
+	}
+	
+	const StatementCache &statementCache() const noexcept {
+		return *statementCache_;
+	}
+
+	StatementCache &statementCache() noexcept {
+		return *statementCache_;
+	}
+	
+	void throwLastError() const  {
+		throw exception(getABI());
+	}
+	
+#ifdef SQLITECPP_ENABLE_PROFILING
+	//the profiler of the statements, nullptr while profiling is disabled
+	StatementProfiler *profiler() const noexcept {
+		return profiler_ && profiler_->enabled() ? profiler_.get() : nullptr;
+	}
+	
+	//the profiles are kept when profiling is disabled and enabled again
+	void enableProfiling() {
+		if (!profiler_) {
+			profiler_ = std::make_unique<StatementProfiler>();
+		}
+		profiler_->attach(getABI());
+		statementCache_->setProfiler(profiler_.get());
+	}
+	
+	void disableProfiling() noexcept {
+		if (profiler_) {
+			profiler_->detach(getABI());
+		}
+		statementCache_->setProfiler(nullptr);
+	}
+	
+	std::vector<StatementProfile> profile() const {
+		return profiler_ ? profiler_->snapshot() : std::vector<StatementProfile>{};
+	}
+#endif
+
+	void open(const char *const filename) {
+		internalOpen(sqlite3_open, filename);
+	}
+
+	void open(const wchar_t *const filename) {
+		if constexpr (wideIsUtf32) {
+			std::string utf8;
+			wideToUtf8(filename, utf8);
+			internalOpen(sqlite3_open, utf8.c_str());
+		}
+		else {
+			internalOpen(sqlite3_open16, filename);
+		}
+	}
+	
+	//opens with sqlite3_open_v2, flags are the SQLITE_OPEN_* flags
+	void open(const char *const filename, const int flags, const char *const vfs = nullptr) {
+		internalOpen([flags, vfs](const char *const name, sqlite3 **const handle) { return sqlite3_open_v2(name, handle, flags, vfs); }, filename);
+	}
+	
+	void open(const char *const filename, const OpenOptions &options) {
+		const char *const vfs = options.vfs_.empty() ? nullptr : options.vfs_.c_str();
+		internalOpen([&options, vfs](const char *const name, sqlite3 **const handle) { return sqlite3_open_v2(name, handle, options.flags(), vfs); }, filename, &options);
+	}
+	
+	//reset starts the hit, miss, write and spill counters and the lookaside highwaters of the connection over
+	ConnectionStats stats(const bool reset = false) const {
+		ConnectionStats stats;
+		int current = 0;
+		int highwater = 0;
+		const auto status = [&](const int operation) {
+			current = 0;
+			highwater = 0;
+			sqlite3_db_status(getABI(), operation, &current, &highwater, reset ? 1 : 0);
+		};
+		status(SQLITE_DBSTATUS_CACHE_USED);
+		stats.cacheUsed_ = current;
+		status(SQLITE_DBSTATUS_CACHE_USED_SHARED);
+		stats.cacheUsedShared_ = current;
+		status(SQLITE_DBSTATUS_SCHEMA_USED);
+		stats.schemaUsed_ = current;
+		status(SQLITE_DBSTATUS_STMT_USED);
+		stats.statementUsed_ = current;
+		status(SQLITE_DBSTATUS_CACHE_HIT);
+		stats.cacheHits_ = current;
+		status(SQLITE_DBSTATUS_CACHE_MISS);
+		stats.cacheMisses_ = current;
+		status(SQLITE_DBSTATUS_CACHE_WRITE);
+		stats.cacheWrites_ = current;
+#ifdef SQLITE_DBSTATUS_CACHE_SPILL
+		status(SQLITE_DBSTATUS_CACHE_SPILL);
+		stats.cacheSpills_ = current;
+#endif
+		status(SQLITE_DBSTATUS_LOOKASIDE_USED);
+		stats.lookasideUsed_ = current;
+		stats.lookasideHighwater_ = highwater;
+		//these only have a highwater
+		status(SQLITE_DBSTATUS_LOOKASIDE_HIT);
+		stats.lookasideHits_ = highwater;
+		status(SQLITE_DBSTATUS_LOOKASIDE_MISS_SIZE);
+		stats.lookasideMissesSize_ = highwater;
+		status(SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL);
+		stats.lookasideMissesFull_ = highwater;
+
+		sqlite3_int64 used = 0;
+		sqlite3_int64 most = 0;
+		sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &used, &most, 0);
+		stats.memoryUsed_ = used;
+		stats.memoryHighwater_ = most;
+		sqlite3_status64(SQLITE_STATUS_MALLOC_COUNT, &used, &most, 0);
+		stats.allocations_ = used;
+		sqlite3_status64(SQLITE_STATUS_MALLOC_SIZE, &used, &most, 0);
+		stats.largestAllocation_ = most;
+		sqlite3_status64(SQLITE_STATUS_PAGECACHE_OVERFLOW, &used, &most, 0);
+		stats.pagecacheOverflow_ = used;
+		return stats;
+	}
+
+	//bytes of the database file read through a memory map, 0 turns it off, capped by SQLITE_MAX_MMAP_SIZE
+	void setMmapSize(const long long bytes) const {
+		pragma("PRAGMA mmap_size=" + std::to_string(bytes));
+	}
+
+	//pages when positive, KiB when negative, like PRAGMA cache_size
+	void setCacheSize(const long long size) const {
+		pragma("PRAGMA cache_size=" + std::to_string(size));
+	}
+
+	//slotCount slots of slotSize bytes, allocated by SQLite, for the small allocations of the connection, fails with SQLITE_BUSY while a slot is in use
+	void configureLookaside(const int slotSize, const int slotCount) const {
+		const int result = sqlite3_db_config(getABI(), SQLITE_DBCONFIG_LOOKASIDE, nullptr, slotSize, slotCount);
+		if (SQLITE_OK != result) {
+			throw exception(result, sqlite3_errstr(result));
+		}
+	}
+
+	//registers function as the SQL function name, its arguments are read like get<Argument>() reads columns and its result is returned to SQL
+	//flags are added to SQLITE_UTF8, e.g. SQLITE_DETERMINISTIC, which lets the planner factor out calls and index the function, or SQLITE_INNOCUOUS
+	template <typename Function>
+	void createFunction(const char *const name, Function function, const int flags = 0) const {
+		using Arguments = typename functionTraits<Function>::arguments;
+		//SQLite deletes the function when the registration fails, is replaced or the connection is closed
+		if (SQLITE_OK != sqlite3_create_function_v2(getABI(), name, static_cast<int>(std::tuple_size_v<Arguments>), SQLITE_UTF8 | flags, new Function(std::move(function)), &scalarFunction<Function>::call, nullptr, nullptr, &destroyFunctionData<Function>)) {
+			throwLastError();
+		}
+	}
+
+	//registers an aggregate SQL function: step(State &, Arguments...) is called for every row of a group and finish(State &) returns its result
+	template <typename Step, typename Finish>
+	void createAggregate(const char *const name, Step step, Finish finish, const int flags = 0) const {
+		using Function = aggregateFunction<Step, Finish>;
+		const int argumentCount = static_cast<int>(std::tuple_size_v<typename functionTraits<Step>::arguments>) - 1;
+		if (SQLITE_OK != sqlite3_create_function_v2(getABI(), name, argumentCount, SQLITE_UTF8 | flags, new Function{std::move(step), std::move(finish)}, nullptr, &Function::step, &Function::finish, &destroyFunctionData<Function>)) {
+			throwLastError();
+		}
+	}
+
+	//exposes container to SQL as the read-only eponymous virtual table name, with the columns made by tableColumn and keyColumn
+	//the container is read in place, so it must outlive the connection and not change while a query reads it
+	template <typename Container, typename... Columns>
+	void createVirtualTable(const char *const name, const Container &container, Columns... columns) const {
+		using Module = containerModule<Container, Columns...>;
+		//SQLite deletes the module when the registration fails, is replaced or the connection is closed
+		if (SQLITE_OK != sqlite3_create_module_v2(getABI(), name, Module::module(), new Module(container, std::move(columns)...), &destroyFunctionData<Module>)) {
+			throwLastError();
+		}
+	}
+
+	long long lastRowId() const noexcept {
+		return sqlite3_last_insert_rowid(getABI());
+	}
+};
+
+
+  
+// A column of a virtual table over a container, getter_(element) returns its value, of any type a function created by createFunction may return.
+template <typename Getter, bool Key>
+struct virtualColumn {
+	const char *name_;
+	Getter getter_;
+};
+
+template <typename Getter>
+virtualColumn<Getter, false> tableColumn(const char *const name, Getter getter) {
+	return virtualColumn<Getter, false>{name, std::move(getter)};
+}
+
+//the column the container is looked up by: the key of an associative container, or the column a sequence is sorted by
+template <typename Getter>
+virtualColumn<Getter, true> keyColumn(const char *const name, Getter getter) {
+	return virtualColumn<Getter, true>{name, std::move(getter)};
+}
+
+// The sqlite3_module of an eponymous, read-only virtual table over a container, registered by SqliteConnection::createVirtualTable.
+// Equality constraints on the key column are looked up with equal_range, and range constraints with lower_bound and upper_bound unless the
+// container is hashed or not ordered by std::less. SQLite checks the constraints again on the rows returned, so a value that does not compare
+// like the key (another type, or another collation than BINARY) falls back to a full scan instead of a wrong lookup,
+// and an integer past the range of the key type makes its bound always true or always false instead of wrapping.
+template <typename Container, typename... Columns>
+class containerModule {
+
+	static_assert(sizeof...(Columns) > 0, "a virtual table has at least one column");
+
+	template <typename Column>
+	struct isKeyColumn : public std::false_type {
+	};
+
+	template <typename Getter>
+	struct isKeyColumn<virtualColumn<Getter, true>> : public std::true_type {
+	};
+
+	static_assert((0 + ... + static_cast<int>(isKeyColumn<Columns>::value)) <= 1, "a virtual table has at most one key column");
+
+	//the key of an associative container, otherwise the value of the key column
+	template <typename Type, typename Value, typename = void>
+	struct lookupKey {
+		using type = Value;
+		static constexpr bool associative = false;
+	};
+
+	template <typename Type, typename Value>
+	struct lookupKey<Type, Value, std::void_t<typename Type::key_type>> {
+		using type = typename Type::key_type;
+		static constexpr bool associative = true;
+	};
+
+	template <typename Type, typename = void>
+	struct isHashed : public std::false_type {
+	};
+
+	template <typename Type>
+	struct isHashed<Type, std::void_t<typename Type::hasher>> : public std::true_type {
+	};
+
+	//lower_bound and upper_bound walk the keys in ascending order, a sequence is sorted by its key column
+	template <typename Type, typename = void>
+	struct hasAscendingKeys : public std::true_type {
+	};
+
+	template <typename Type>
+	struct hasAscendingKeys<Type, std::void_t<typename Type::key_compare>> : public std::bool_constant<std::is_same_v<typename Type::key_compare, std::less<typename Type::key_type>> || std::is_same_v<typename Type::key_compare, std::less<>>> {
+	};
+
+	template <typename Type, typename = void>
+	struct hasUniqueKeys : public std::false_type {
+	};
+
+	template <typename Type>
+	struct hasUniqueKeys<Type, std::enable_if_t<std::is_same_v<decltype(std::declval<Type &>().insert(std::declval<const typename Type::value_type &>())), std::pair<typename Type::iterator, bool>>>> : public std::true_type {
+	};
+
+	static constexpr int findKeyColumn() noexcept {
+		constexpr bool keys[] = {isKeyColumn<Columns>::value...};
+		for (int column = 0; column != static_cast<int>(sizeof...(Columns)); ++column) {
+			if (keys[column]) {
+				return column;
+			}
+		}
+		return -1;
+	}
+
+	using Iterator = typename Container::const_iterator;
+	using Element = typename Container::value_type;
+	static constexpr int keyIndex = findKeyColumn();
+	using KeyColumn = std::tuple_element_t<keyIndex < 0 ? 0 : keyIndex, std::tuple<Columns...>>;
+	using KeyLookup = lookupKey<Container, std::decay_t<decltype(std::declval<const KeyColumn &>().getter_(std::declval<const Element &>()))>>;
+	using Key = typename KeyLookup::type;
+	static constexpr bool associative = KeyLookup::associative;
+	static constexpr bool hashed = isHashed<Container>::value;
+	//whether range constraints and ORDER BY on the key can be pushed down, not with another order than SQL's
+	static constexpr bool ordered = !hashed && hasAscendingKeys<Container>::value;
+	static constexpr bool uniqueKeys = associative && hasUniqueKeys<Container>::value;
+
+	//idxNum of the plan chosen by bestIndex
+	static constexpr int planEqual = 1;
+	static constexpr int planLower = 2;
+	static constexpr int planLowerExclusive = 4;
+	static constexpr int planUpper = 8;
+	static constexpr int planUpperExclusive = 16;
+
+	struct table : public sqlite3_vtab {
+		containerModule *module_;
+	};
+
+	struct cursor : public sqlite3_vtab_cursor {
+		Iterator current_;
+		Iterator end_;
+	};
+
+	const Container &container_;
+	std::tuple<Columns...> columns_;
+	std::string declaration_;
+
+	static void appendName(std::string &declaration, const char *name) {
+		declaration += '"';
+		for (; *name != '\0'; ++name) {
+			if (*name == '"') {
+				declaration += '"';
+			}
+			declaration += *name;
+		}
+		declaration += "\",";
+	}
+
+	static int fail(sqlite3_vtab *const table) noexcept {
+		sqlite3_free(table->zErrMsg);
+		table->zErrMsg = nullptr;
+		try {
+			throw;
+		}
+		catch (const exception &error) {
+			table->zErrMsg = sqlite3_mprintf("%s", error.errorMessage_.c_str());
+			return error.errorCode_ != SQLITE_OK ? error.errorCode_ : SQLITE_ERROR;
+		}
+		catch (const std::bad_alloc &) {
+			return SQLITE_NOMEM;
+		}
+		catch (const std::exception &error) {
+			table->zErrMsg = sqlite3_mprintf("%s", error.what());
+		}
+		catch (...) {
+			table->zErrMsg = sqlite3_mprintf("unknown exception");
+		}
+		return SQLITE_ERROR;
+	}
+
+	//whether the value compares with the keys like SQL compares it with the key column, which has no affinity
+	static bool comparable(sqlite3_value *const value) noexcept {
+		const int type = sqlite3_value_type(value);
+		if constexpr (std::is_integral_v<Key>) {
+			return type == SQLITE_INTEGER;
+		}
+		else if constexpr (std::is_floating_point_v<Key>) {
+			if (type == SQLITE_INTEGER && std::numeric_limits<Key>::digits < 63) {
+				//a rounded integer would move the bound past keys equal to it
+				const sqlite3_int64 exact = sqlite3_int64{1} << std::numeric_limits<Key>::digits;
+				const sqlite3_int64 integer = sqlite3_value_int64(value);
+				return integer >= -exact && integer <= exact;
+			}
+			return type == SQLITE_INTEGER || type == SQLITE_FLOAT;
+		}
+		else {
+			return type == SQLITE_TEXT;
+		}
+	}
+
+	//where a comparable value falls against the keys: -1 below every possible key, 1 above, 0 when it converts to a key without wrapping
+	static int keyRange(sqlite3_value *const value) noexcept {
+		if constexpr (std::is_integral_v<Key>) {
+			const sqlite3_int64 integer = sqlite3_value_int64(value);
+			if constexpr (std::is_signed_v<Key>) {
+				if (integer < static_cast<sqlite3_int64>(std::numeric_limits<Key>::min())) {
+					return -1;
+				}
+				if (integer > static_cast<sqlite3_int64>(std::numeric_limits<Key>::max())) {
+					return 1;
+				}
+			}
+			else {
+				if (integer < 0) {
+					return -1;
+				}
+				if (static_cast<sqlite3_uint64>(integer) > static_cast<sqlite3_uint64>(std::numeric_limits<Key>::max())) {
+					return 1;
+				}
+			}
+		}
+		return 0;
+	}
+
+	bool less(const Key &left, const Key &right) const {
+		if constexpr (associative && !hashed) {
+			return container_.key_comp()(left, right);
+		}
+		else {
+			return left < right;
+		}
+	}
+
+	Iterator lowerBound(const Key &key) const {
+		if constexpr (associative) {
+			return container_.lower_bound(key);
+		}
+		else {
+			const auto &getter = std::get<keyIndex>(columns_).getter_;
+			return std::lower_bound(container_.begin(), container_.end(), key, [&](const Element &element, const Key &value) {
+				return getter(element) < value;
+			});
+		}
+	}
+
+	Iterator upperBound(const Key &key) const {
+		if constexpr (associative) {
+			return container_.upper_bound(key);
+		}
+		else {
+			const auto &getter = std::get<keyIndex>(columns_).getter_;
+			return std::upper_bound(container_.begin(), container_.end(), key, [&](const Key &value, const Element &element) {
+				return value < getter(element);
+			});
+		}
+	}
+
+	void find(cursor &position, const int plan, const int argumentCount, sqlite3_value **const values) const {
+		position.current_ = container_.begin();
+		position.end_ = container_.end();
+		if constexpr (keyIndex >= 0) {
+			for (int argument = 0; argument != argumentCount; ++argument) {
+				//nothing compares true with NULL
+				if (sqlite3_value_type(values[argument]) == SQLITE_NULL) {
+					position.current_ = position.end_;
+					return;
+				}
+				if (!comparable(values[argument])) {
+					return;
+				}
+			}
+			if (plan & planEqual) {
+				if (keyRange(values[0]) != 0) {
+					position.current_ = position.end_;
+					return;
+				}
+				const Key key = valueReader<Key>::read(values[0]);
+				if constexpr (associative) {
+					std::tie(position.current_, position.end_) = container_.equal_range(key);
+				}
+				else {
+					position.current_ = lowerBound(key);
+					position.end_ = upperBound(key);
+				}
+			}
+			else if constexpr (ordered) {
+				int argument = 0;
+				std::optional<Key> lower;
+				std::optional<Key> upper;
+				//a bound past the range of the keys is always true, or never
+				if (plan & planLower) {
+					const int range = keyRange(values[argument]);
+					if (range > 0) {
+						position.current_ = position.end_;
+						return;
+					}
+					if (range == 0) {
+						lower = valueReader<Key>::read(values[argument]);
+						position.current_ = plan & planLowerExclusive ? upperBound(*lower) : lowerBound(*lower);
+					}
+					++argument;
+				}
+				if (plan & planUpper) {
+					const int range = keyRange(values[argument]);
+					if (range < 0) {
+						position.current_ = position.end_;
+						return;
+					}
+					if (range == 0) {
+						upper = valueReader<Key>::read(values[argument]);
+						position.end_ = plan & planUpperExclusive ? lowerBound(*upper) : upperBound(*upper);
+					}
+				}
+				//the bounds would be out of order
+				if (lower && upper && (less(*upper, *lower) || (!less(*lower, *upper) && (plan & (planLowerExclusive | planUpperExclusive))))) {
+					position.current_ = position.end_;
+				}
+			}
+		}
+	}
+
+	template <std::size_t... Indexes>
+	void columnValue(sqlite3_context *const context, const Element &element, const int column, std::index_sequence<Indexes...>) const {
+		((column == static_cast<int>(Indexes) ? (setFunctionResult(context, [&]() -> decltype(auto) {
+			return std::get<Indexes>(columns_).getter_(element);
+		}), true) : false) || ...);
+	}
+
+	static int connect(sqlite3 *const connection, void *const data, int, const char *const *, sqlite3_vtab **const out, char **) noexcept {
+		containerModule *const module = static_cast<containerModule *>(data);
+		const int result = sqlite3_declare_vtab(connection, module->declaration_.c_str());
+		if (SQLITE_OK != result) {
+			return result;
+		}
+		table *const created = new (std::nothrow) table();
+		if (created == nullptr) {
+			return SQLITE_NOMEM;
+		}
+		created->module_ = module;
+		*out = created;
+		return SQLITE_OK;
+	}
+
+	static int disconnect(sqlite3_vtab *const base) noexcept {
+		delete static_cast<table *>(base);
+		return SQLITE_OK;
+	}
+
+	static int bestIndex(sqlite3_vtab *const base, sqlite3_index_info *const info) noexcept {
+		const containerModule &module = *static_cast<table *>(base)->module_;
+		const double rows = static_cast<double>(std::max<std::size_t>(module.container_.size(), 1));
+		int equal = -1;
+		int lower = -1;
+		int upper = -1;
+		if constexpr (keyIndex >= 0) {
+			for (int index = 0; index != info->nConstraint; ++index) {
+				const auto &constraint = info->aConstraint[index];
+				if (!constraint.usable || constraint.iColumn != keyIndex) {
+					continue;
+				}
+				const char *const collation = sqlite3_vtab_collation(info, index);
+				if (collation != nullptr && sqlite3_stricmp(collation, "BINARY") != 0) {
+					continue;
+				}
+				if (constraint.op == SQLITE_INDEX_CONSTRAINT_EQ) {
+					equal = index;
+				}
+				else if (ordered && (constraint.op == SQLITE_INDEX_CONSTRAINT_GT || constraint.op == SQLITE_INDEX_CONSTRAINT_GE)) {
+					lower = index;
+				}
+				else if (ordered && (constraint.op == SQLITE_INDEX_CONSTRAINT_LT || constraint.op == SQLITE_INDEX_CONSTRAINT_LE)) {
+					upper = index;
+				}
+			}
+		}
+
+		//the constraints are not omitted, SQLite checks them again on the rows returned
+		int plan = 0;
+		double estimate = rows;
+		double cost = rows;
+		if (equal >= 0) {
+			plan = planEqual;
+			info->aConstraintUsage[equal].argvIndex = 1;
+			estimate = uniqueKeys ? 1 : std::min(rows, 10.0);
+			cost = (hashed ? 1 : std::log2(rows)) + estimate;
+			if (uniqueKeys) {
+				info->idxFlags |= SQLITE_INDEX_SCAN_UNIQUE;
+			}
+		}
+		else if (lower >= 0 || upper >= 0) {
+			int argument = 0;
+			if (lower >= 0) {
+				plan |= planLower | (info->aConstraint[lower].op == SQLITE_INDEX_CONSTRAINT_GT ? planLowerExclusive : 0);
+				info->aConstraintUsage[lower].argvIndex = ++argument;
+				estimate /= 4;
+			}
+			if (upper >= 0) {
+				plan |= planUpper | (info->aConstraint[upper].op == SQLITE_INDEX_CONSTRAINT_LT ? planUpperExclusive : 0);
+				info->aConstraintUsage[upper].argvIndex = ++argument;
+				estimate /= 4;
+			}
+			cost = std::log2(rows) + estimate;
+		}
+		info->idxNum = plan;
+		info->estimatedRows = static_cast<sqlite3_int64>(estimate);
+		info->estimatedCost = cost;
+
+		//ordered containers and sorted sequences are walked in the order of their key
+		if (keyIndex >= 0 && ordered && info->nOrderBy == 1 && info->aOrderBy[0].iColumn == keyIndex && !info->aOrderBy[0].desc) {
+			info->orderByConsumed = 1;
+		}
+		return SQLITE_OK;
+	}
+
+	static int open(sqlite3_vtab *, sqlite3_vtab_cursor **const out) noexcept {
+		cursor *const created = new (std::nothrow) cursor();
+		if (created == nullptr) {
+			return SQLITE_NOMEM;
+		}
+		*out = created;
+		return SQLITE_OK;
+	}
+
+	static int close(sqlite3_vtab_cursor *const base) noexcept {
+		delete static_cast<cursor *>(base);
+		return SQLITE_OK;
+	}
+
+	static int filter(sqlite3_vtab_cursor *const base, const int plan, const char *, const int argumentCount, sqlite3_value **const values) noexcept {
+		try {
+			static_cast<table *>(base->pVtab)->module_->find(*static_cast<cursor *>(base), plan, argumentCount, values);
+			return SQLITE_OK;
+		}
+		catch (...) {
+			return fail(base->pVtab);
+		}
+	}
+
+	static int next(sqlite3_vtab_cursor *const base) noexcept {
+		++static_cast<cursor *>(base)->current_;
+		return SQLITE_OK;
+	}
+
+	static int eof(sqlite3_vtab_cursor *const base) noexcept {
+		const cursor &position = *static_cast<cursor *>(base);
+		return position.current_ == position.end_;
+	}
+
+	static int column(sqlite3_vtab_cursor *const base, sqlite3_context *const context, const int column) noexcept {
+		try {
+			static_cast<table *>(base->pVtab)->module_->columnValue(context, *static_cast<cursor *>(base)->current_, column, std::index_sequence_for<Columns...>{});
+			return SQLITE_OK;
+		}
+		catch (...) {
+			setFunctionError(context);
+			return SQLITE_ERROR;
+		}
+	}
+
+	//the address of the element, which stays the same whichever lookup finds it
+	static int rowId(sqlite3_vtab_cursor *const base, sqlite3_int64 *const out) noexcept {
+		*out = static_cast<sqlite3_int64>(reinterpret_cast<std::uintptr_t>(std::addressof(*static_cast<cursor *>(base)->current_)));
+		return SQLITE_OK;
+	}
+
+  public:
+
+	containerModule(const Container &container, Columns... columns) : container_{container}, columns_{std::move(columns)...} {
+		declaration_ = "create table x(";
+		std::apply([this](const Columns &... column) {
+			(appendName(declaration_, column.name_), ...);
+		}, columns_);
+		declaration_.back() = ')';
+	}
+
+	//without xCreate, the table is eponymous only: it is used by the name of the module, without CREATE VIRTUAL TABLE
+	static const sqlite3_module *module() noexcept {
+		static const sqlite3_module module = [] {
+			sqlite3_module callbacks{};
+			callbacks.xConnect = &connect;
+			callbacks.xBestIndex = &bestIndex;
+			callbacks.xDisconnect = &disconnect;
+			callbacks.xDestroy = &disconnect;
+			callbacks.xOpen = &open;
+			callbacks.xClose = &close;
+			callbacks.xFilter = &filter;
+			callbacks.xNext = &next;
+			callbacks.xEof = &eof;
+			callbacks.xColumn = &column;
+			callbacks.xRowid = &rowId;
+			return callbacks;
+		}();
+		return &module;
+	}
+};
+
+  
+
+// Converts a column of the current row, specialized per C++ type so that the conversion is chosen at compile time.
+// Text and blob views point into the statement and are valid until the next step, reset or conversion of the column.
+template <typename Value, typename Enable = void>
+struct columnReader;
+
+template <typename Value>
+struct columnReader<Value, std::enable_if_t<std::is_integral_v<Value>>> {
+	static Value read(sqlite3_stmt *const statement, const int columnNum) noexcept {
+		if constexpr (sizeof(Value) <= sizeof(int)) {
+			return static_cast<Value>(sqlite3_column_int(statement, columnNum));
+		}
+		else {
+			return static_cast<Value>(sqlite3_column_int64(statement, columnNum));
+		}
+	}
+};
+
+template <typename Value>
+struct columnReader<Value, std::enable_if_t<std::is_floating_point_v<Value>>> {
+	static Value read(sqlite3_stmt *const statement, const int columnNum) noexcept {
+		return static_cast<Value>(sqlite3_column_double(statement, columnNum));
+	}
+};
+
+template <>
+struct columnReader<const char *> {
+	static const char *read(sqlite3_stmt *const statement, const int columnNum) noexcept {
+		return reinterpret_cast<const char *>(sqlite3_column_text(statement, columnNum));
+	}
+};
+
+template <>
+struct columnReader<std::string_view> {
+	static std::string_view read(sqlite3_stmt *const statement, const int columnNum) noexcept {
+		//sqlite3_column_bytes must be called after sqlite3_column_text, which may convert the value
+		const char *const text = reinterpret_cast<const char *>(sqlite3_column_text(statement, columnNum));
+		return std::string_view(text, static_cast<std::size_t>(sqlite3_column_bytes(statement, columnNum)));
+	}
+};
+
+template <>
+struct columnReader<std::string> {
+	static std::string read(sqlite3_stmt *const statement, const int columnNum) {
+		return std::string(columnReader<std::string_view>::read(statement, columnNum));
+	}
+};
+
+#ifdef __cpp_lib_span
+template <>
+struct columnReader<std::span<const std::byte>> {
+	static std::span<const std::byte> read(sqlite3_stmt *const statement, const int columnNum) noexcept {
+		const std::byte *const blob = static_cast<const std::byte *>(sqlite3_column_blob(statement, columnNum));
+		return std::span<const std::byte>(blob, static_cast<std::size_t>(sqlite3_column_bytes(statement, columnNum)));
+	}
+};
+#endif
+
+template <typename Value>
+struct columnReader<std::optional<Value>> {
+	static std::optional<Value> read(sqlite3_stmt *const statement, const int columnNum) noexcept(noexcept(columnReader<Value>::read(statement, columnNum))) {
+		if (sqlite3_column_type(statement, columnNum) == SQLITE_NULL) {
+			return std::nullopt;
+		}
+		return columnReader<Value>::read(statement, columnNum);
+	}
+};
+
+
+  
+template <typename T>
+struct sqliteReader {
+	
+	constexpr int getInt(const int columnNum = 0) const noexcept {
+		return sqlite3_column_int(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	constexpr const char *getString(const int columnNum = 0) const noexcept {
+		return reinterpret_cast<const char *>(sqlite3_column_text(static_cast<const T *>(this)->getABI(), columnNum));
+	}
+
+	//where wchar_t is UTF-32 the text is converted from UTF-8 into a buffer of the statement, valid until the next step or conversion of the column
+	const wchar_t *getWideString(const int columnNum = 0) const {
+		return getWideStringView(columnNum).data();
+	}
+
+	std::wstring_view getWideStringView(const int columnNum = 0) const {
+		return static_cast<const T *>(this)->wideText().column(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+
+	constexpr int getStringLength(const int columnNum) const noexcept {
+		return sqlite3_column_bytes(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	//converts the column again where wchar_t is UTF-32, getWideStringView returns the text and its length in one conversion
+	int getWideStringLength(const int columnNum) const {
+		return static_cast<int>(getWideStringView(columnNum).size());
+	}
+
+	long long getInt64(const int columnNum = 0) const noexcept {
+		return sqlite3_column_int64(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	double getDouble(const int columnNum = 0) const noexcept {
+		return sqlite3_column_double(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	const void *getBlob(const int columnNum = 0) const noexcept {
+		return sqlite3_column_blob(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	int getBlobLength(const int columnNum) const noexcept {
+		return sqlite3_column_bytes(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	//SQLITE_INTEGER, SQLITE_FLOAT, SQLITE_TEXT, SQLITE_BLOB or SQLITE_NULL
+	int getType(const int columnNum = 0) const noexcept {
+		return sqlite3_column_type(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	bool isNull(const int columnNum = 0) const noexcept {
+		return getType(columnNum) == SQLITE_NULL;
+	}
+
+	int getColumnCount() const noexcept {
+		return sqlite3_column_count(static_cast<const T *>(this)->getABI());
+	}
+
+	//get<std::string_view>, get<std::span<const std::byte>>, get<long long>, get<double>, get<std::optional<...>>, ... without copying text or blobs
+	template <typename Value>
+	Value get(const int columnNum = 0) const noexcept(noexcept(columnReader<Value>::read(nullptr, 0))) {
+		return columnReader<Value>::read(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+};
+
+
+// Rows of a query materialized column by column, Arrow style: integers and reals in contiguous arrays, text and blobs
+// in one data buffer per column with an array of offsets, and a validity bitmap with a bit set for every value that is not null.
+// clear() keeps the buffers, so that a ResultSet reused across queries stops allocating once it has grown.
+class ResultSet {
+
+  public:
+
+	class Column {
+
+		friend class ResultSet;
+
+		std::string name_;
+		int type_{SQLITE_NULL};
+		std::size_t size_{0};
+		std::size_t nullCount_{0};
+		std::vector<std::uint8_t> validity_;
+		std::vector<long long> integers_;
+		std::vector<double> reals_;
+		std::vector<std::int32_t> offsets_{0};
+		std::vector<char> data_;
+
+		void clear() noexcept {
+			type_ = SQLITE_NULL;
+			size_ = 0;
+			nullCount_ = 0;
+			validity_.clear();
+			integers_.clear();
+			reals_.clear();
+			offsets_.assign(1, 0);
+			data_.clear();
+		}
+
+		//the rows appended so far are all null
+		void setType(const int type) {
+			type_ = type;
+			if (type == SQLITE_INTEGER) {
+				integers_.resize(size_);
+			}
+			else if (type == SQLITE_FLOAT) {
+				reals_.resize(size_);
+			}
+			else {
+				offsets_.resize(size_ + 1);
+			}
+		}
+
+		void appendBytes(const void *const bytes, const int size) {
+			if (data_.size() + static_cast<std::size_t>(size) > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+				throw exception(SQLITE_TOOBIG, "the text or blobs of column " + name_ + " exceed 2 GiB");
+			}
+			const char *const begin = static_cast<const char *>(bytes);
+			data_.insert(data_.end(), begin, begin + size);
+			offsets_.push_back(static_cast<std::int32_t>(data_.size()));
+		}
+
+		void append(sqlite3_stmt *const statement, const int column) {
+			const bool valid = sqlite3_column_type(statement, column) != SQLITE_NULL;
+			if (valid && type_ == SQLITE_NULL) {
+				setType(sqlite3_column_type(statement, column));
+			}
+			if (size_ % 8 == 0) {
+				validity_.push_back(0);
+			}
+			if (valid) {
+				validity_.back() |= static_cast<std::uint8_t>(1u << (size_ % 8));
+			}
+			else {
+				++nullCount_;
+			}
+			++size_;
+
+			//the values are converted to the type of the column, like sqlite3_column_* does
+			switch (type_) {
+				case SQLITE_INTEGER:
+					integers_.push_back(valid ? sqlite3_column_int64(statement, column) : 0);
+					break;
+				case SQLITE_FLOAT:
+					reals_.push_back(valid ? sqlite3_column_double(statement, column) : 0.0);
+					break;
+				case SQLITE_TEXT:
+					if (valid) {
+						const unsigned char *const text = sqlite3_column_text(statement, column);
+						appendBytes(text, sqlite3_column_bytes(statement, column));
+					}
+					else {
+						offsets_.push_back(offsets_.back());
+					}
+					break;
+				case SQLITE_BLOB:
+					if (valid) {
+						const void *const blob = sqlite3_column_blob(statement, column);
+						appendBytes(blob, sqlite3_column_bytes(statement, column));
+					}
+					else {
+						offsets_.push_back(offsets_.back());
+					}
+					break;
+				default:
+					break;
+			}
+		}
+
+	  public:
+
+		const std::string &name() const noexcept {
+			return name_;
+		}
+
+		//SQLITE_INTEGER, SQLITE_FLOAT, SQLITE_TEXT, SQLITE_BLOB, or SQLITE_NULL while every value is null
+		int type() const noexcept {
+			return type_;
+		}
+
+		std::size_t size() const noexcept {
+			return size_;
+		}
+
+		std::size_t nullCount() const noexcept {
+			return nullCount_;
+		}
+
+		bool isNull(const std::size_t row) const noexcept {
+			return ((validity_[row / 8] >> (row % 8)) & 1u) == 0;
+		}
+
+		long long getInt64(const std::size_t row) const noexcept {
+			return integers_[row];
+		}
+
+		double getDouble(const std::size_t row) const noexcept {
+			return reals_[row];
+		}
+
+		std::string_view getText(const std::size_t row) const noexcept {
+			return std::string_view(data_.data() + offsets_[row], static_cast<std::size_t>(offsets_[row + 1] - offsets_[row]));
+		}
+
+		const void *getBlob(const std::size_t row) const noexcept {
+			return data_.data() + offsets_[row];
+		}
+
+		int getBlobLength(const std::size_t row) const noexcept {
+			return offsets_[row + 1] - offsets_[row];
+		}
+
+		//the buffers, for scans and zero-copy export
+		const std::vector<std::uint8_t> &validity() const noexcept {
+			return validity_;
+		}
+
+		const std::vector<long long> &integers() const noexcept {
+			return integers_;
+		}
+
+		const std::vector<double> &reals() const noexcept {
+			return reals_;
+		}
+
+		const std::vector<std::int32_t> &offsets() const noexcept {
+			return offsets_;
+		}
+
+		const std::vector<char> &data() const noexcept {
+			return data_;
+		}
+	};
+
+  private:
+
+	//may hold more columns than columnCount_, kept with their buffers from a previous query
+	std::vector<Column> columns_;
+	std::size_t columnCount_{0};
+	std::size_t rowCount_{0};
+
+	static bool containsNoCase(const char *const text, const std::string_view word) noexcept {
+		const std::string_view view(text);
+		return std::search(view.begin(), view.end(), word.begin(), word.end(), [](const char left, const char right) { return std::toupper(static_cast<unsigned char>(left)) == right; }) != view.end();
+	}
+
+	//the type given by the affinity of the declared type, SQLITE_NULL when it is taken from the first value instead
+	static int declaredType(const char *const declared) noexcept {
+		if (declared == nullptr) {
+			return SQLITE_NULL;
+		}
+		if (containsNoCase(declared, "INT")) {
+			return SQLITE_INTEGER;
+		}
+		if (containsNoCase(declared, "CHAR") || containsNoCase(declared, "CLOB") || containsNoCase(declared, "TEXT")) {
+			return SQLITE_TEXT;
+		}
+		if (containsNoCase(declared, "REAL") || containsNoCase(declared, "FLOA") || containsNoCase(declared, "DOUB")) {
+			return SQLITE_FLOAT;
+		}
+		return SQLITE_NULL;
+	}
+
+  public:
+
+	void clear() noexcept {
+		for (std::size_t column = 0; column < columnCount_; ++column) {
+			columns_[column].clear();
+		}
+		columnCount_ = 0;
+		rowCount_ = 0;
+	}
+
+	//clears the result and sets up its columns from the statement
+	void start(sqlite3_stmt *const statement) {
+		clear();
+		columnCount_ = static_cast<std::size_t>(sqlite3_column_count(statement));
+		if (columns_.size() < columnCount_) {
+			columns_.resize(columnCount_);
+		}
+		for (std::size_t column = 0; column < columnCount_; ++column) {
+			const int index = static_cast<int>(column);
+			columns_[column].name_ = sqlite3_column_name(statement, index);
+			const int type = declaredType(sqlite3_column_decltype(statement, index));
+			if (type != SQLITE_NULL) {
+				columns_[column].setType(type);
+			}
+		}
+	}
+
+	//appends the current row of the statement
+	void appendRow(sqlite3_stmt *const statement) {
+		for (std::size_t column = 0; column < columnCount_; ++column) {
+			columns_[column].append(statement, static_cast<int>(column));
+		}
+		++rowCount_;
+	}
+
+	std::size_t rowCount() const noexcept {
+		return rowCount_;
+	}
+
+	std::size_t columnCount() const noexcept {
+		return columnCount_;
+	}
+
+	const Column &column(const std::size_t column) const noexcept {
+		return columns_[column];
+	}
+
+	const Column &operator[](const std::size_t column) const noexcept {
+		return columns_[column];
+	}
+
+	//fixes the type of a column whose values so far are all null, instead of taking it from its next value
+	void setColumnType(const std::size_t column, const int type) {
+		Column &values = columns_[column];
+		if (values.type_ == type) {
+			return;
+		}
+		if (values.type_ != SQLITE_NULL) {
+			throw exception(SQLITE_MISUSE, "column " + values.name_ + " already has a type");
+		}
+		values.setType(type);
+	}
+
+	//-1 when no column has that name
+	int columnIndex(const std::string_view name) const noexcept {
+		for (std::size_t column = 0; column < columnCount_; ++column) {
+			if (columns_[column].name_ == name) {
+				return static_cast<int>(column);
+			}
+		}
+		return -1;
+	}
+};
+
+
+  
+//placeholder bound as a BLOB of size_ zero bytes, to be filled later through a BlobStream
+struct zeroBlob {
+	sqlite3_uint64 size_;
+};
+
+
+  
+// Decoders of a whole row, the column conversions are expanded at compile time from the column types.
+template <typename... Values>
+struct tupleDecoder {
+	using value_type = std::tuple<Values...>;
+
+	static constexpr int columnCount = sizeof...(Values);
+
+	static value_type decode(sqlite3_stmt *const statement) {
+		return decode(statement, std::index_sequence_for<Values...>{});
+	}
+
+	template <std::size_t... Columns>
+	static value_type decode(sqlite3_stmt *const statement, std::index_sequence<Columns...>) {
+		return value_type(columnReader<Values>::read(statement, static_cast<int>(Columns))...);
+	}
+};
+
+template <typename Struct, typename... Values>
+struct structDecoder {
+	using value_type = Struct;
+
+	static constexpr int columnCount = sizeof...(Values);
+
+	static value_type decode(sqlite3_stmt *const statement) {
+		return decode(statement, std::index_sequence_for<Values...>{});
+	}
+
+	template <std::size_t... Columns>
+	static value_type decode(sqlite3_stmt *const statement, std::index_sequence<Columns...>) {
+		return value_type{columnReader<Values>::read(statement, static_cast<int>(Columns))...};
+	}
+};
+
+template <typename Decoder>
+class typedRows;
+
+
+  
+class SqliteStatement : public sqliteReader<SqliteStatement> {
+	
+	struct SqliteStatementTraits : public nullHandleTraits<sqlite3_stmt *> {
+		static void close(sqlite3_stmt *value) noexcept {
+			sqlite3_finalize(value);
+		}
+	};
+
+	UniqueHandle<SqliteStatementTraits> statementHandle_;
+	
+	StatementParameters parameters_;
+	
+	mutable wideTextBuffers wideText_;
+	
+	//moved-in values bound with SQLITE_STATIC, by parameter index
+	mutable std::vector<std::pair<int, std::shared_ptr<void>>> ownedValues_;
+	
+	void keepAlive(const int index, std::shared_ptr<void> value) const {
+		for (auto &owned : ownedValues_) {
+			if (owned.first == index) {
+				owned.second = std::move(value);
+				return;
+			}
+		}
+		ownedValues_.emplace_back(index, std::move(value));
+	}
+	
+#ifdef SQLITECPP_ENABLE_PROFILING
+	StatementProfiler *profiler_{nullptr};
+	mutable unsigned long long steps_{0};
+	mutable unsigned long long rows_{0};
+	
+	//hands the steps of the current run to the profiler, when it ends or the statement is reset
+	void flushProfile() const noexcept {
+		if (profiler_ && steps_ != 0 && profiler_->enabled()) {
+			profiler_->recordSteps(getABI(), steps_, rows_);
+		}
+		steps_ = 0;
+		rows_ = 0;
+	}
+#endif
+
+
+	template <typename PrepareFunction, typename CharacterSet, typename... VALUES>
+	void internalPrepare(const SqliteConnection &connection, const PrepareFunction prepare, const CharacterSet *const text, VALUES &&... values) {
+#ifdef SQLITECPP_ENABLE_PROFILING
+		profiler_ = connection.profiler();
+		const auto start = std::chrono::steady_clock::now();
+#endif
+		if (SQLITE_OK != prepare(connection.getABI(), text, -1, statementHandle_.set(), nullptr)) {
+			connection.throwLastError();
+		}
+		parameters_ = StatementParameters();
+#ifdef SQLITECPP_ENABLE_PROFILING
+		if (profiler_) {
+			profiler_->recordPrepare(getABI(), std::chrono::steady_clock::now() - start);
+		}
+#endif
+		bindAll(std::forward<VALUES>(values)...);
+	}
+	
+	//throws SQLITE_RANGE when index is 0, the statement has no parameter named name
+	int namedIndex(const int index, const std::string_view name) const {
+		if (index == 0) {
+			throw exception(SQLITE_RANGE, "the statement has no parameter named " + std::string(name));
+		}
+		return index;
+	}
+	
+	void internalBindAll(const int) const noexcept
+	{
+	}
+	
+	template <typename FIRST, typename... REST_VALUES>
+	void internalBindAll(const int index, FIRST &&first, REST_VALUES &&... restValues) const {
+		bind(index, std::forward<FIRST>(first));
+		internalBindAll(index + 1, std::forward<REST_VALUES>(restValues)...);
+	}
+
+  protected:
+  
+	SqliteStatement(sqlite3_stmt *const statement, StatementParameters &&parameters) noexcept : statementHandle_{statement}, parameters_{std::move(parameters)} {
+	}
+	
+	StatementParameters releaseParameters() noexcept {
+		return std::move(parameters_);
+	}
+	
+	sqlite3_stmt *releaseABI() noexcept {
+#ifdef SQLITECPP_ENABLE_PROFILING
+		flushProfile();
+#endif
+		return statementHandle_.release();
+	}
+	
+#ifdef SQLITECPP_ENABLE_PROFILING
+	void setProfiler(StatementProfiler *const profiler) noexcept {
+		profiler_ = profiler;
+	}
+#endif
+
+  public:
+  
+	SqliteStatement() = default;
+	
+	template <typename CharacterSet, typename... VALUES>
+	SqliteStatement(const SqliteConnection &connection, const CharacterSet *const text, VALUES &&... values) {
+		prepare(connection, text, std::forward<VALUES>(values)...);
+	}
+
+	explicit operator bool() const noexcept {
+		return static_cast<bool>(statementHandle_);
+	}
+
+	sqlite3_stmt *getABI() const noexcept {
+		return statementHandle_.get();
+	}
+
+	void throwLastError() const {
+		throw exception(sqlite3_db_handle(getABI()));
+	}
+
+	//conversion buffers of the wide text columns and parameters
+	wideTextBuffers &wideText() const noexcept {
+		return wideText_;
+	}
+
+	template <typename... VALUES>
+	void prepare(const SqliteConnection &connection, const char *const characterSet, VALUES &&... values) {
+		internalPrepare(connection, sqlite3_prepare_v2, characterSet, std::forward<VALUES>(values)...);
+	}
+	
+	template <typename... VALUES>
+	void prepare(const SqliteConnection &connection, const wchar_t *const characterSet, VALUES &&... values) {
+		if constexpr (wideIsUtf32) {
+			std::string text;
+			wideToUtf8(characterSet, text);
+			internalPrepare(connection, sqlite3_prepare_v2, text.c_str(), std::forward<VALUES>(values)...);
+		}
+		else {
+			internalPrepare(connection, sqlite3_prepare16_v2, characterSet, std::forward<VALUES>(values)...);
+		}
+	}
+
+	bool execute() const {
+		const int result = sqlite3_step(getABI());
+#ifdef SQLITECPP_ENABLE_PROFILING
+		++steps_;
+		if (result == SQLITE_ROW) {
+			++rows_;
+		}
+		else {
+			flushProfile();
+		}
+#endif
+		if (result == SQLITE_ROW)
+			return true;
+		else if (result == SQLITE_DONE)
+			return false;
+		else {
+			throwLastError();
+			//the control will never reach here, as exception will be thrown
+			//added return false, just to remove warning: control may reach end of non-void function [-Wreturn-type]
+			return false;
+		}
+	}
+	
+	void bind(const int index, const int value) const {
+		if (SQLITE_OK != sqlite3_bind_int(getABI(), index, value)) {
+			throwLastError();
+		}
+	}
+	
+	void bind(const int index, const char *const strValue, const int size = -1) const {
+		if (SQLITE_OK != sqlite3_bind_text(getABI(), index, strValue, size, SQLITE_STATIC)) {
+			throwLastError();
+		}
+	}
+	
+	//size in bytes, where wchar_t is UTF-32 the text is bound as UTF-8 converted into a buffer of the statement
+	void bind(const int index, const wchar_t *const strValue, const int size = -1) const {
+		if constexpr (wideIsUtf32) {
+			if (!strValue) {
+				bind(index, nullptr);
+				return;
+			}
+			const std::wstring_view text(strValue, size < 0 ? std::char_traits<wchar_t>::length(strValue) : static_cast<std::size_t>(size) / sizeof(wchar_t));
+			const std::string_view utf8 = wideText_.parameter(index, text);
+			if (SQLITE_OK != sqlite3_bind_text64(getABI(), index, utf8.data(), utf8.size(), SQLITE_STATIC, SQLITE_UTF8)) {
+				throwLastError();
+			}
+		}
+		else if (SQLITE_OK != sqlite3_bind_text16(getABI(), index, strValue, size, SQLITE_STATIC)) {
+			throwLastError();
+		}
+	}
+	
+	void bind(const int index, const std::string &strValue) const {
+		bind(index, strValue.c_str(), static_cast<int>(strValue.size()));
+	}
+	
+	void bind(const int index, const std::wstring &strValue) const {
+		bind(index, strValue.c_str(), static_cast<int>((strValue.size() * sizeof(wchar_t))));
+	}
+	
+	void bind(const int index, std::string &&strValue) const {
+		//the statement keeps the moved string alive instead of SQLite copying it with SQLITE_TRANSIENT
+		const auto owned = std::make_shared<std::string>(std::move(strValue));
+		bind(index, owned->c_str(), static_cast<int>(owned->size()));
+		keepAlive(index, owned);
+	}
+	
+	void bind(const int index, std::wstring &&strValue) const {
+		//converted into a buffer of the statement anyway
+		if constexpr (wideIsUtf32) {
+			bind(index, static_cast<const std::wstring &>(strValue));
+			return;
+		}
+		const auto owned = std::make_shared<std::wstring>(std::move(strValue));
+		bind(index, owned->c_str(), static_cast<int>((owned->size() * sizeof(wchar_t))));
+		keepAlive(index, owned);
+	}
+	
+	//every integer type but int, which has its own overload, and bool, which goes through it; unsigned values past the range of sqlite3_int64 throw SQLITE_RANGE
+	template <typename Integer, std::enable_if_t<std::is_integral_v<Integer> && !std::is_same_v<Integer, int> && !std::is_same_v<Integer, bool>, int> = 0>
+	void bind(const int index, const Integer value) const {
+		if constexpr (std::is_unsigned_v<Integer> && sizeof(Integer) >= sizeof(sqlite3_int64)) {
+			if (value > static_cast<Integer>(std::numeric_limits<sqlite3_int64>::max())) {
+				throw exception(SQLITE_RANGE, "the unsigned value does not fit in a 64-bit signed integer");
+			}
+		}
+		if (SQLITE_OK != sqlite3_bind_int64(getABI(), index, static_cast<sqlite3_int64>(value))) {
+			throwLastError();
+		}
+	}
+	
+	void bind(const int index, const double value) const {
+		if (SQLITE_OK != sqlite3_bind_double(getABI(), index, value)) {
+			throwLastError();
+		}
+	}
+	
+	void bind(const int index, std::nullptr_t) const {
+		if (SQLITE_OK != sqlite3_bind_null(getABI(), index)) {
+			throwLastError();
+		}
+	}
+	
+	template <typename Value>
+	void bind(const int index, const std::optional<Value> &value) const {
+		if (value) {
+			bind(index, *value);
+		}
+		else {
+			bind(index, nullptr);
+		}
+	}
+	
+	template <typename Value>
+	void bind(const int index, std::optional<Value> &&value) const {
+		if (value) {
+			bind(index, std::move(*value));
+		}
+		else {
+			bind(index, nullptr);
+		}
+	}
+	
+	void bind(const int index, const std::string_view strValue) const {
+		//a null pointer would bind NULL instead of an empty text
+		if (SQLITE_OK != sqlite3_bind_text64(getABI(), index, strValue.data() != nullptr ? strValue.data() : "", strValue.size(), SQLITE_STATIC, SQLITE_UTF8)) {
+			throwLastError();
+		}
+	}
+	
+	void bindBlob(const int index, const void *const blob, const sqlite3_uint64 size) const {
+		//a null pointer would bind NULL instead of an empty blob
+		if (SQLITE_OK != (blob != nullptr ? sqlite3_bind_blob64(getABI(), index, blob, size, SQLITE_STATIC) : sqlite3_bind_zeroblob(getABI(), index, 0))) {
+			throwLastError();
+		}
+	}
+	
+	void bind(const int index, const std::vector<std::byte> &blob) const {
+		bindBlob(index, blob.data(), blob.size());
+	}
+	
+	void bind(const int index, std::vector<std::byte> &&blob) const {
+		const auto owned = std::make_shared<std::vector<std::byte>>(std::move(blob));
+		bindBlob(index, owned->data(), owned->size());
+		keepAlive(index, owned);
+	}
+	
+	void bind(const int index, const zeroBlob blob) const {
+		if (SQLITE_OK != sqlite3_bind_zeroblob64(getABI(), index, blob.size_)) {
+			throwLastError();
+		}
+	}
+	
+#ifdef __cpp_lib_span
+	void bind(const int index, const std::span<const std::byte> blob) const {
+		bindBlob(index, blob.data(), blob.size());
+	}
+#endif
+	
+	//hands the buffer over to SQLite, which deletes it when it is no longer bound
+	void bind(const int index, std::unique_ptr<std::byte[]> &&blob, const sqlite3_uint64 size) const {
+		if (SQLITE_OK != sqlite3_bind_blob64(getABI(), index, blob.release(), size, [](void *const owned) { delete[] static_cast<std::byte *>(owned); })) {
+			throwLastError();
+		}
+	}
+	
+	void bind(const int index, std::unique_ptr<char[]> &&strValue, const sqlite3_uint64 size) const {
+		if (SQLITE_OK != sqlite3_bind_text64(getABI(), index, strValue.release(), size, [](void *const owned) { delete[] static_cast<char *>(owned); }, SQLITE_UTF8)) {
+			throwLastError();
+		}
+	}
+
+	//index of the parameter named name, with its prefix character (":id", "@id", "$id"), 0 when there is none
+	int parameterIndex(const std::string_view name) const {
+		return parameters_.index(getABI(), name);
+	}
+	
+	template <typename Value>
+	void bind(const std::string_view name, Value &&value) const {
+		bind(namedIndex(parameters_.index(getABI(), name), name), std::forward<Value>(value));
+	}
+	
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+	//the index is looked up on the first bind of Name to this prepared statement only
+	template <parameterName Name, typename Value>
+	void bind(Value &&value) const {
+		static_assert(Name.text_[0] == ':' || Name.text_[0] == '@' || Name.text_[0] == '$' || Name.text_[0] == '?', "a parameter name starts with :, @, $ or ?");
+		bind(namedIndex(parameters_.index(getABI(), parameterSlot<Name>(), Name.view()), Name.view()), std::forward<Value>(value));
+	}
+#endif
+	
+	template <typename... Values>
+	void bindAll(Values &&... values) const {
+		internalBindAll(1, std::forward<Values>(values)...);
+	}
+	
+	template <typename ...Values>
+	void reset (Values&&... values) {
+#ifdef SQLITECPP_ENABLE_PROFILING
+		flushProfile();
+#endif
+		if (SQLITE_OK != sqlite3_reset(getABI ())) {
+			throwLastError ();
+		}
+		bindAll(std:: forward<Values> (values)...);
+	}
+
+	//steps through the remaining rows into result, which keeps its buffers from a previous query
+	void fetchAll(ResultSet &result) const {
+		result.start(getABI());
+		while (execute()) {
+			result.appendRow(getABI());
+		}
+	}
+	
+	ResultSet fetchAll() const {
+		ResultSet result;
+		fetchAll(result);
+		return result;
+	}
+
+	//the rows as std::tuple<Values...>
+	template <typename... Values>
+	typedRows<tupleDecoder<Values...>> rows() const {
+		return typedRows<tupleDecoder<Values...>>(*this);
+	}
+
+	//the rows as Struct{Values...}, one value per column
+	template <typename Struct, typename... Values>
+	typedRows<structDecoder<Struct, Values...>> rowsAs() const {
+		return typedRows<structDecoder<Struct, Values...>>(*this);
+	}
+};
+
+
+  
+template <typename Decoder>
+class typedRowIterator {
+
+	SqliteStatement const *statement_{nullptr};
+
+  public:
+
+	typedRowIterator() noexcept = default;
+
+	explicit typedRowIterator(const SqliteStatement &statement) {
+		if (statement.execute()) {
+			statement_ = &statement;
+		}
+	}
+
+	typedRowIterator &operator++() {
+		if (!statement_->execute()) {
+			statement_ = nullptr;
+		}
+		return *this;
+	}
+
+	bool operator!=(const typedRowIterator &other) const noexcept {
+		return statement_ != other.statement_;
+	}
+
+	typename Decoder::value_type operator*() const {
+		return Decoder::decode(statement_->getABI());
+	}
+};
+
+// Range over the rows of a statement decoded by Decoder, the column count is checked once when the range is created.
+template <typename Decoder>
+class typedRows {
+
+	const SqliteStatement *statement_;
+
+  public:
+
+	explicit typedRows(const SqliteStatement &statement) : statement_{&statement} {
+		const int columnCount = sqlite3_column_count(statement.getABI());
+		if (columnCount != Decoder::columnCount) {
+			throw exception(SQLITE_RANGE, "the statement returns " + std::to_string(columnCount) + " columns, " + std::to_string(Decoder::columnCount) + " are decoded");
+		}
+	}
+
+	typedRowIterator<Decoder> begin() const {
+		return typedRowIterator<Decoder>(*statement_);
+	}
+
+	typedRowIterator<Decoder> end() const noexcept {
+		return typedRowIterator<Decoder>();
+	}
+};
+
+
+
+  
+// SqliteStatement leased from the statement cache of the connection, the prepared statement is returned to the cache instead of being finalized
+class CachedStatement : public SqliteStatement {
+
+	StatementCache *cache_{nullptr};
+	StatementCache::Lease lease_;
+
+	CachedStatement(StatementCache &cache, const StatementCache::Lease lease) noexcept : SqliteStatement(lease->statement_, std::move(lease->parameters_)), cache_{&cache}, lease_{lease} {
+	}
+
+  public:
+
+	template <typename... VALUES>
+	CachedStatement(const SqliteConnection &connection, const char *const text, VALUES &&... values) : CachedStatement(*connection.statementCache_, connection.statementCache_->acquire(connection.getABI(), text)) {
+#ifdef SQLITECPP_ENABLE_PROFILING
+		setProfiler(connection.profiler());
+#endif
+		bindAll(std::forward<VALUES>(values)...);
+	}
+
+	CachedStatement(CachedStatement &&other) noexcept : SqliteStatement(std::move(other)), cache_{other.cache_}, lease_{other.lease_} {
+		other.cache_ = nullptr;
+	}
+
+	CachedStatement &operator=(CachedStatement &&) = delete;
+
+	~CachedStatement() noexcept {
+		if (cache_) {
+			lease_->parameters_ = releaseParameters();
+			releaseABI();
+			cache_->release(lease_);
+		}
+	}
+};
+
+
+  
+template <typename CharacterSet, typename... Values>
+void sqliteExecute(const SqliteConnection &connection, const CharacterSet *const text, Values &&... values) {
+	SqliteStatement(connection, text, std::forward<Values>(values)...).execute();
+}
+
+template <typename... Values>
+void sqliteExecute(const SqliteConnection &connection, const char *const text, Values &&... values) {
+	CachedStatement(connection, text, std::forward<Values>(values)...).execute();
+}
+
+
+
+enum class TransactionMode {
+	Deferred,
+	Immediate,
+	Exclusive
+};
+
+
+  
+// Begins a transaction, which is committed by commit() or rolled back by the destructor.
+// Immediate and exclusive transactions take the write lock up front, so a writer never fails to upgrade a read lock with SQLITE_BUSY.
+// The BEGIN/COMMIT/ROLLBACK statements are prepared once through the statement cache of the connection.
+class Transaction {
+
+	const SqliteConnection *connection_;
+	bool active_{false};
+
+	static const char *beginText(const TransactionMode mode) noexcept {
+		switch (mode) {
+			case TransactionMode::Immediate:
+				return "BEGIN IMMEDIATE";
+			case TransactionMode::Exclusive:
+				return "BEGIN EXCLUSIVE";
+			default:
+				return "BEGIN DEFERRED";
+		}
+	}
+
+  public:
+
+	explicit Transaction(const SqliteConnection &connection, const TransactionMode mode = TransactionMode::Deferred) : connection_{&connection} {
+		sqliteExecute(connection, beginText(mode));
+		active_ = true;
+	}
+
+	Transaction(const Transaction &) = delete;
+	Transaction &operator=(const Transaction &) = delete;
+
+	Transaction(Transaction &&other) noexcept : connection_{other.connection_}, active_{other.active_} {
+		other.active_ = false;
+	}
+
+	~Transaction() noexcept {
+		if (active_) {
+			try {
+				rollback();
+			}
+			catch (...) {
+			}
+		}
+	}
+
+	bool active() const noexcept {
+		return active_;
+	}
+
+	void commit() {
+		sqliteExecute(*connection_, "COMMIT");
+		active_ = false;
+	}
+
+	void rollback() {
+		active_ = false;
+		//SQLite may already have rolled the transaction back after an error
+		if (!sqlite3_get_autocommit(connection_->getABI())) {
+			sqliteExecute(*connection_, "ROLLBACK");
+		}
+	}
+};
+
+
+  
+//name as a quoted SQL identifier, with its double quotes doubled so that it cannot end the identifier
+inline std::string quotedIdentifier(const std::string &name) {
+	std::string quoted(1, '"');
+	for (const char character : name) {
+		if (character == '"') {
+			quoted += '"';
+		}
+		quoted += character;
+	}
+	quoted += '"';
+	return quoted;
+}
+
+
+// Nested transaction, released by commit() or rolled back to its start by the destructor.
+class Savepoint {
+
+	const SqliteConnection *connection_;
+	std::string release_;
+	std::string rollback_;
+	bool active_{false};
+
+  public:
+
+	explicit Savepoint(const SqliteConnection &connection, const std::string &name = "sqlitecpp") : connection_{&connection}, release_{"RELEASE " + quotedIdentifier(name)}, rollback_{"ROLLBACK TO " + quotedIdentifier(name)} {
+		sqliteExecute(connection, ("SAVEPOINT " + quotedIdentifier(name)).c_str());
+		active_ = true;
+	}
+
+	Savepoint(const Savepoint &) = delete;
+	Savepoint &operator=(const Savepoint &) = delete;
+
+	Savepoint(Savepoint &&other) noexcept : connection_{other.connection_}, release_{std::move(other.release_)}, rollback_{std::move(other.rollback_)}, active_{other.active_} {
+		other.active_ = false;
+	}
+
+	~Savepoint() noexcept {
+		if (active_) {
+			try {
+				rollback();
+			}
+			catch (...) {
+			}
+		}
+	}
+
+	bool active() const noexcept {
+		return active_;
+	}
+
+	void commit() {
+		sqliteExecute(*connection_, release_.c_str());
+		active_ = false;
+	}
+
+	void rollback() {
+		active_ = false;
+		if (!sqlite3_get_autocommit(connection_->getABI())) {
+			sqliteExecute(*connection_, rollback_.c_str());
+			sqliteExecute(*connection_, release_.c_str());
+		}
+	}
+};
+
+
+  
+struct ScriptOptions {
+	//runs the whole script in one transaction, rolled back when a statement fails, the script must not begin or commit its own then
+	bool transaction_{false};
+	TransactionMode mode_{TransactionMode::Immediate};
+};
+
+struct ScriptStatement {
+	//points into the script, from the end of the previous statement to the end of this one, without the whitespace in between
+	std::string_view text_;
+	//prepare and all steps
+	std::chrono::nanoseconds elapsed_{0};
+	//sqlite3_changes after the statement, meaningful for INSERT, UPDATE and DELETE only
+	int changes_{0};
+};
+
+
+struct scriptStatementTraits : public nullHandleTraits<sqlite3_stmt *> {
+	static void close(sqlite3_stmt *value) noexcept {
+		sqlite3_finalize(value);
+	}
+};
+
+[[noreturn]] inline void throwScriptError(const SqliteConnection &connection, const std::size_t offset) {
+	throw exception(sqlite3_extended_errcode(connection.getABI()), std::string(sqlite3_errmsg(connection.getABI())) + " (statement at byte " + std::to_string(offset) + ')');
+}
+
+inline std::vector<ScriptStatement> runScript(const SqliteConnection &connection, const char *const script, const std::size_t length, const ScriptOptions &options) {
+	std::optional<Transaction> transaction;
+	if (options.transaction_) {
+		transaction.emplace(connection, options.mode_);
+	}
+#ifdef SQLITECPP_ENABLE_PROFILING
+	StatementProfiler *const profiler = connection.profiler();
+#endif
+	std::vector<ScriptStatement> statements;
+	const char *const end = script + length;
+	const char *text = script;
+	while (text < end) {
+		while (text != end && (std::isspace(static_cast<unsigned char>(*text)) || *text == ';')) {
+			++text;
+		}
+		if (text == end) {
+			break;
+		}
+		//the terminating NUL is counted, so that SQLite parses the text in place
+		const std::size_t remaining = static_cast<std::size_t>(end - text) + 1;
+		const int size = remaining > static_cast<std::size_t>(INT_MAX) ? -1 : static_cast<int>(remaining);
+		const auto start = std::chrono::steady_clock::now();
+		UniqueHandle<scriptStatementTraits> statement;
+		const char *tail = nullptr;
+		if (SQLITE_OK != sqlite3_prepare_v2(connection.getABI(), text, size, statement.set(), &tail)) {
+			throwScriptError(connection, static_cast<std::size_t>(text - script));
+		}
+		//comments only, or an embedded NUL where SQLite stops reading, which ends the script
+		if (!statement) {
+			if (tail == text) {
+				break;
+			}
+			text = tail;
+			continue;
+		}
+#ifdef SQLITECPP_ENABLE_PROFILING
+		if (profiler && profiler->enabled()) {
+			profiler->recordPrepare(statement.get(), std::chrono::steady_clock::now() - start);
+		}
+		unsigned long long rows = 0;
+#endif
+		int result;
+		while (SQLITE_ROW == (result = sqlite3_step(statement.get()))) {
+#ifdef SQLITECPP_ENABLE_PROFILING
+			++rows;
+#endif
+		}
+#ifdef SQLITECPP_ENABLE_PROFILING
+		if (profiler && profiler->enabled()) {
+			profiler->recordSteps(statement.get(), rows + 1, rows);
+		}
+#endif
+		if (SQLITE_DONE != result) {
+			throwScriptError(connection, static_cast<std::size_t>(text - script));
+		}
+		statements.push_back(ScriptStatement{std::string_view(text, static_cast<std::size_t>(tail - text)), std::chrono::steady_clock::now() - start, sqlite3_changes(connection.getABI())});
+		text = tail;
+	}
+	if (transaction) {
+		transaction->commit();
+	}
+	return statements;
+}
+
+// Runs every statement of a script in order, walking the tail pointer of sqlite3_prepare_v2 through the text, and times each one.
+// The text must be NUL terminated: SQLite copies the rest of an unterminated text on every prepare, which is quadratic on a long script.
+// As for SQLite, a NUL inside a std::string ends the script.
+// A failing statement throws, with the byte offset of the statement in the script appended to the message.
+inline std::vector<ScriptStatement> sqliteExecuteScript(const SqliteConnection &connection, const char *const script, const ScriptOptions &options = ScriptOptions{}) {
+	return runScript(connection, script, std::strlen(script), options);
+}
+
+inline std::vector<ScriptStatement> sqliteExecuteScript(const SqliteConnection &connection, const std::string &script, const ScriptOptions &options = ScriptOptions{}) {
+	return runScript(connection, script.c_str(), script.size(), options);
+}
+
+
+
+//approximate number of bytes a bound value adds to a transaction
+inline std::size_t boundSize(const char *const value) noexcept {
+	return std::char_traits<char>::length(value);
+}
+
+inline std::size_t boundSize(const wchar_t *const value) noexcept {
+	return std::char_traits<wchar_t>::length(value) * sizeof(wchar_t);
+}
+
+inline std::size_t boundSize(const std::string &value) noexcept {
+	return value.size();
+}
+
+inline std::size_t boundSize(const std::wstring &value) noexcept {
+	return value.size() * sizeof(wchar_t);
+}
+
+inline std::size_t boundSize(const std::string_view value) noexcept {
+	return value.size();
+}
+
+inline std::size_t boundSize(const std::vector<std::byte> &value) noexcept {
+	return value.size();
+}
+
+inline std::size_t boundSize(const zeroBlob value) noexcept {
+	return value.size_;
+}
+
+inline std::size_t boundSize(std::nullptr_t) noexcept {
+	return 0;
+}
+
+template <typename T>
+std::size_t boundSize(const std::optional<T> &value) noexcept {
+	return value ? boundSize(*value) : 0;
+}
+
+template <typename T>
+constexpr std::size_t boundSize(const T &) noexcept {
+	return sizeof(T);
+}
+
+
+
+struct BulkInsertOptions {
+	std::size_t rowsPerTransaction_{10000};
+	//0 disables the limit on the bytes bound per transaction
+	std::size_t bytesPerTransaction_{0};
+};
+
+struct BulkInsertStats {
+	unsigned long long rows_{0};
+	unsigned long long bytes_{0};
+	unsigned long long transactions_{0};
+	std::chrono::nanoseconds elapsed_{0};
+
+	double rowsPerSecond() const noexcept {
+		return elapsed_.count() == 0 ? 0.0 : rows_ * 1e9 / elapsed_.count();
+	}
+};
+
+
+  
+// Reuses one prepared insert statement and commits every rowsPerTransaction_ rows (or bytesPerTransaction_ bytes) in a BEGIN IMMEDIATE transaction.
+// The rows of the last, uncommitted chunk are rolled back if the inserter is destroyed before flush() or finish().
+class BulkInserter {
+
+	const SqliteConnection *connection_;
+	SqliteStatement statement_;
+	BulkInsertOptions options_;
+	BulkInsertStats stats_;
+	std::chrono::steady_clock::time_point start_{std::chrono::steady_clock::now()};
+	std::size_t pendingRows_{0};
+	std::size_t pendingBytes_{0};
+	std::optional<Transaction> transaction_;
+
+	void beginChunk() {
+		if (!transaction_) {
+			transaction_.emplace(*connection_, TransactionMode::Immediate);
+		}
+	}
+
+	void endChunk() {
+		if (pendingRows_ >= options_.rowsPerTransaction_ || (options_.bytesPerTransaction_ != 0 && pendingBytes_ >= options_.bytesPerTransaction_)) {
+			flush();
+		}
+	}
+
+  public:
+
+	template <typename CharacterSet>
+	BulkInserter(const SqliteConnection &connection, const CharacterSet *const text, const BulkInsertOptions options = BulkInsertOptions{}) : connection_{&connection}, statement_{connection, text}, options_{options} {
+	}
+
+	BulkInserter(const BulkInserter &) = delete;
+	BulkInserter &operator=(const BulkInserter &) = delete;
+
+	template <typename... Values>
+	void insert(Values &&... values) {
+		beginChunk();
+		//the error of a failed step was already thrown by execute(), so the result of the reset is not checked
+		sqlite3_reset(statement_.getABI());
+		if (options_.bytesPerTransaction_ != 0) {
+			pendingBytes_ += (std::size_t{0} + ... + boundSize(values));
+		}
+		statement_.bindAll(std::forward<Values>(values)...);
+		statement_.execute();
+		++pendingRows_;
+		endChunk();
+	}
+
+	//inserts every tuple of the range
+	template <typename Range>
+	void insertAll(const Range &rows) {
+		for (const auto &row : rows) {
+			std::apply([this](const auto &... values) { insert(values...); }, row);
+		}
+	}
+
+	//inserts the tuples returned by the generator until it returns an empty std::optional
+	template <typename Generator>
+	void insertFrom(Generator &&generator) {
+		while (auto row = generator()) {
+			std::apply([this](auto &&... values) { insert(std::forward<decltype(values)>(values)...); }, std::move(*row));
+		}
+	}
+
+	void flush() {
+		if (transaction_) {
+			transaction_->commit();
+			transaction_.reset();
+			stats_.rows_ += pendingRows_;
+			stats_.bytes_ += pendingBytes_;
+			++stats_.transactions_;
+			pendingRows_ = 0;
+			pendingBytes_ = 0;
+		}
+	}
+
+	BulkInsertStats finish() {
+		flush();
+		sqlite3_clear_bindings(statement_.getABI());
+		return stats();
+	}
+
+	//statistics of the committed rows
+	BulkInsertStats stats() const noexcept {
+		BulkInsertStats stats = stats_;
+		stats.elapsed_ = std::chrono::steady_clock::now() - start_;
+		return stats;
+	}
+};
+
+
+
+  
+// One read-write connection and N read-only connections to the same database file in WAL mode.
+// Readers never block each other, every lease keeps its own connection, with its own statement cache, until it is destroyed.
+class ConnectionPool {
+
+	struct Reader {
+		SqliteConnection connection_;
+		std::atomic<bool> busy_{false};
+	};
+
+	SqliteConnection writer_;
+	std::mutex writerMutex_;
+	std::unique_ptr<Reader[]> readers_;
+	std::size_t readerCount_;
+	std::mutex waitMutex_;
+	std::condition_variable released_;
+	std::atomic<std::size_t> waiters_{0};
+
+	Reader *tryAcquireReader(const std::size_t start) noexcept {
+		for (std::size_t offset = 0; offset != readerCount_; ++offset) {
+			Reader &reader = readers_[(start + offset) % readerCount_];
+			//sequentially consistent like the store in releaseReader: a waiter stores waiters_ and loads busy_, the releaser stores
+			//busy_ and loads waiters_, and a weaker load could let both miss the other's store and the waiter sleep forever
+			if (!reader.busy_.load() && !reader.busy_.exchange(true)) {
+				return &reader;
+			}
+		}
+		return nullptr;
+	}
+
+	void releaseReader(Reader &reader) noexcept {
+		reader.busy_.store(false);
+		if (waiters_.load() != 0) {
+			std::lock_guard<std::mutex> lock(waitMutex_);
+			released_.notify_one();
+		}
+	}
+
+  public:
+
+	class Lease {
+
+		friend class ConnectionPool;
+
+		ConnectionPool *pool_{nullptr};
+		Reader *reader_{nullptr};
+		const SqliteConnection *connection_{nullptr};
+		std::unique_lock<std::mutex> writerLock_;
+
+		Lease(ConnectionPool &pool, Reader &reader) noexcept : pool_{&pool}, reader_{&reader}, connection_{&reader.connection_} {
+		}
+
+		Lease(ConnectionPool &pool, std::unique_lock<std::mutex> &&writerLock) noexcept : pool_{&pool}, connection_{&pool.writer_}, writerLock_{std::move(writerLock)} {
+		}
+
+	  public:
+
+		Lease(const Lease &) = delete;
+		Lease &operator=(const Lease &) = delete;
+
+		Lease(Lease &&other) noexcept : pool_{other.pool_}, reader_{other.reader_}, connection_{other.connection_}, writerLock_{std::move(other.writerLock_)} {
+			other.reader_ = nullptr;
+		}
+
+		~Lease() noexcept {
+			if (reader_) {
+				pool_->releaseReader(*reader_);
+			}
+		}
+
+		const SqliteConnection &get() const noexcept {
+			return *connection_;
+		}
+
+		operator const SqliteConnection &() const noexcept {
+			return *connection_;
+		}
+
+		const SqliteConnection *operator->() const noexcept {
+			return connection_;
+		}
+	};
+
+	//the writer is opened with the options in WAL mode, the readers with the options as read-only connections
+	ConnectionPool(const char *const filename, const std::size_t readers = std::max(1u, std::thread::hardware_concurrency()), const OpenOptions &options = OpenOptions::readHeavy()) : readers_{std::make_unique<Reader[]>(std::max<std::size_t>(readers, 1))}, readerCount_{std::max<std::size_t>(readers, 1)} {
+		OpenOptions writerOptions = options;
+		writerOptions.readOnly_ = false;
+		writerOptions.threading_ = ThreadingMode::MultiThread;
+		writerOptions.journalMode_ = JournalMode::Wal;
+		writer_.open(filename, writerOptions);
+
+		OpenOptions readerOptions = options;
+		readerOptions.readOnly_ = true;
+		readerOptions.threading_ = ThreadingMode::MultiThread;
+		readerOptions.journalMode_.reset();
+		for (std::size_t index = 0; index != readerCount_; ++index) {
+			readers_[index].connection_.open(filename, readerOptions);
+		}
+	}
+
+	ConnectionPool(const ConnectionPool &) = delete;
+	ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+	//read-only connection, blocks while every reader is leased
+	Lease reader() {
+		//every thread starts looking at its own reader, so that threads rarely compete for the same one
+		const std::size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id()) % readerCount_;
+		if (Reader *const reader = tryAcquireReader(start)) {
+			return Lease(*this, *reader);
+		}
+
+		std::unique_lock<std::mutex> lock(waitMutex_);
+		++waiters_;
+		Reader *reader = nullptr;
+		released_.wait(lock, [&] { return (reader = tryAcquireReader(start)) != nullptr; });
+		--waiters_;
+		return Lease(*this, *reader);
+	}
+
+	//the read-write connection, blocks while another thread holds it
+	Lease writer() {
+		return Lease(*this, std::unique_lock<std::mutex>(writerMutex_));
+	}
+
+	std::size_t readerCount() const noexcept {
+		return readerCount_;
+	}
+};
+
+
+  
+// The first and last key of a partition of a ParallelScan, both included.
+struct KeyRange {
+	long long first_;
+	long long last_;
+};
+
+
+  
+// Runs one query over partitions of a table in parallel, on N read-only connections with a worker thread each, and combines the partial results.
+// The readers all read from the same snapshot of the database: with SQLITE_ENABLE_SNAPSHOT (for an SQLite built with it) they open the snapshot
+// of the first reader with sqlite3_snapshot_open, otherwise the read-write connection holds the write lock while their read transactions begin.
+class ParallelScan {
+
+#ifdef SQLITE_ENABLE_SNAPSHOT
+	struct SnapshotTraits : public nullHandleTraits<sqlite3_snapshot *> {
+		static void close(sqlite3_snapshot *value) noexcept {
+			sqlite3_snapshot_free(value);
+		}
+	};
+#endif
+
+	//more partitions than readers, so that the readers done early take over the remaining ones
+	static constexpr std::size_t partitionsPerReader = 4;
+
+	SqliteConnection writer_;
+	std::unique_ptr<SqliteConnection[]> readers_;
+	std::size_t readerCount_;
+	std::vector<std::thread> workers_;
+	std::mutex scanMutex_;
+
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable finished_;
+	std::function<void(std::size_t)> task_;
+	std::size_t generation_{0};
+	std::size_t running_{0};
+	bool stopping_{false};
+	std::exception_ptr error_;
+	std::atomic<bool> failed_{false};
+
+	void work(const std::size_t reader) {
+		std::size_t generation = 0;
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (true) {
+			wake_.wait(lock, [&] { return stopping_ || generation_ != generation; });
+			if (stopping_) {
+				return;
+			}
+			generation = generation_;
+			lock.unlock();
+
+			std::exception_ptr error;
+			try {
+				task_(reader);
+			}
+			catch (...) {
+				failed_ = true;
+				error = std::current_exception();
+			}
+
+			lock.lock();
+			if (error && !error_) {
+				error_ = std::move(error);
+			}
+			if (--running_ == 0) {
+				finished_.notify_one();
+			}
+		}
+	}
+
+	void stop() noexcept {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		wake_.notify_all();
+		for (std::thread &worker : workers_) {
+			worker.join();
+		}
+	}
+
+	//runs task(reader) on every worker and waits for them, rethrowing the first exception
+	void runOnReaders(std::function<void(std::size_t)> task) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			task_ = std::move(task);
+			error_ = nullptr;
+			failed_ = false;
+			running_ = readerCount_;
+			++generation_;
+		}
+		wake_.notify_all();
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		finished_.wait(lock, [this] { return running_ == 0; });
+		task_ = nullptr;
+		if (error_) {
+			std::rethrow_exception(std::exchange(error_, nullptr));
+		}
+	}
+
+	//a read transaction begins with its first read, not with BEGIN
+	static void startRead(const SqliteConnection &connection) {
+		sqliteExecute(connection, "select 1 from sqlite_master limit 1");
+	}
+
+	std::vector<Transaction> beginReads() {
+		std::vector<Transaction> reads;
+		reads.reserve(readerCount_);
+#ifdef SQLITE_ENABLE_SNAPSHOT
+		reads.emplace_back(readers_[0]);
+		startRead(readers_[0]);
+		UniqueHandle<SnapshotTraits> snapshot;
+		int result = sqlite3_snapshot_get(readers_[0].getABI(), "main", snapshot.set());
+		if (SQLITE_OK != result) {
+			throw exception(result, sqlite3_errstr(result));
+		}
+		for (std::size_t reader = 1; reader != readerCount_; ++reader) {
+			reads.emplace_back(readers_[reader]);
+			result = sqlite3_snapshot_open(readers_[reader].getABI(), "main", snapshot.get());
+			if (SQLITE_OK != result) {
+				throw exception(result, sqlite3_errstr(result));
+			}
+		}
+#else
+		const Transaction writeLock(writer_, TransactionMode::Immediate);
+		for (std::size_t reader = 0; reader != readerCount_; ++reader) {
+			reads.emplace_back(readers_[reader]);
+			startRead(readers_[reader]);
+		}
+#endif
+		return reads;
+	}
+
+	//at most count ranges of equal width between the smallest and the largest key, looked up in two subqueries, since only a lone min() or max() is answered from the index
+	static std::vector<KeyRange> partition(const SqliteConnection &connection, const char *const table, const char *const key, std::size_t count) {
+		const std::string quotedKey = quotedIdentifier(key);
+		const std::string quotedTable = quotedIdentifier(table);
+		const std::string text = "select (select min(" + quotedKey + ") from " + quotedTable + "), (select max(" + quotedKey + ") from " + quotedTable + ")";
+		SqliteStatement bounds(connection, text.c_str());
+		std::vector<KeyRange> ranges;
+		if (!bounds.execute() || sqlite3_column_type(bounds.getABI(), 0) == SQLITE_NULL) {
+			return ranges;
+		}
+
+		const long long first = bounds.get<long long>(0);
+		const unsigned long long span = static_cast<unsigned long long>(bounds.get<long long>(1)) - static_cast<unsigned long long>(first);
+		if (span < count) {
+			count = static_cast<std::size_t>(span) + 1;
+		}
+		const unsigned long long width = std::max<unsigned long long>(span / count, 1);
+		ranges.reserve(count);
+		for (std::size_t index = 0; index != count; ++index) {
+			const unsigned long long lower = static_cast<unsigned long long>(first) + width * index;
+			const unsigned long long upper = index + 1 == count ? static_cast<unsigned long long>(first) + span : lower + width - 1;
+			ranges.push_back(KeyRange{static_cast<long long>(lower), static_cast<long long>(upper)});
+		}
+		return ranges;
+	}
+
+	template <typename Result, typename Partial, typename Reduce>
+	Result run(const std::vector<KeyRange> &ranges, const char *const query, Result initial, Partial &partial, Reduce &reduce) {
+		std::vector<std::optional<Result>> results(readerCount_);
+		std::atomic<std::size_t> next{0};
+		runOnReaders([&](const std::size_t reader) {
+			std::optional<SqliteStatement> statement;
+			for (std::size_t index = next++; index < ranges.size() && !failed_; index = next++) {
+				if (!statement) {
+					statement.emplace(readers_[reader], query);
+				}
+				statement->reset(ranges[index].first_, ranges[index].last_);
+				if (results[reader]) {
+					results[reader] = reduce(std::move(*results[reader]), partial(*statement));
+				}
+				else {
+					results[reader] = partial(*statement);
+				}
+			}
+		});
+
+		for (std::optional<Result> &result : results) {
+			if (result) {
+				initial = reduce(std::move(initial), std::move(*result));
+			}
+		}
+		return initial;
+	}
+
+  public:
+
+	//the read-write connection is opened with the options in WAL mode, the readers with the options as read-only connections
+	ParallelScan(const char *const filename, const std::size_t readers = std::max(1u, std::thread::hardware_concurrency()), const OpenOptions &options = OpenOptions::readHeavy()) : readers_{std::make_unique<SqliteConnection[]>(std::max<std::size_t>(readers, 1))}, readerCount_{std::max<std::size_t>(readers, 1)} {
+		OpenOptions writerOptions = options;
+		writerOptions.readOnly_ = false;
+		writerOptions.threading_ = ThreadingMode::MultiThread;
+		writerOptions.journalMode_ = JournalMode::Wal;
+		writer_.open(filename, writerOptions);
+
+		OpenOptions readerOptions = options;
+		readerOptions.readOnly_ = true;
+		readerOptions.threading_ = ThreadingMode::MultiThread;
+		readerOptions.journalMode_.reset();
+		for (std::size_t reader = 0; reader != readerCount_; ++reader) {
+			readers_[reader].open(filename, readerOptions);
+		}
+
+		workers_.reserve(readerCount_);
+		try {
+			for (std::size_t reader = 0; reader != readerCount_; ++reader) {
+				workers_.emplace_back([this, reader] { work(reader); });
+			}
+		}
+		catch (...) {
+			stop();
+			throw;
+		}
+	}
+
+	ParallelScan(const ParallelScan &) = delete;
+	ParallelScan &operator=(const ParallelScan &) = delete;
+
+	~ParallelScan() noexcept {
+		stop();
+	}
+
+	std::size_t readerCount() const noexcept {
+		return readerCount_;
+	}
+
+	//splits the integer key of table into ranges and runs query, whose two parameters are bound to the first and last key of a range, once per range
+	//partial(SqliteStatement &) returns the result of a range and reduce(Result, Result) combines two results
+	//partial, and reduce for the results of one reader, run on the worker threads; reduce then folds the results of the readers into initial on the calling thread
+	//the smallest and largest key are looked up with min() and max(), which only an index on the key (or the rowid) makes cheap
+	template <typename Result, typename Partial, typename Reduce>
+	Result scan(const char *const table, const char *const key, const char *const query, Result initial, Partial partial, Reduce reduce) {
+		std::lock_guard<std::mutex> lock(scanMutex_);
+		const std::vector<Transaction> reads = beginReads();
+		const std::vector<KeyRange> ranges = partition(readers_[0], table, key, readerCount_ * partitionsPerReader);
+		return run(ranges, query, std::move(initial), partial, reduce);
+	}
+
+	//the same, over ranges given by the caller
+	template <typename Result, typename Partial, typename Reduce>
+	Result scan(const std::vector<KeyRange> &ranges, const char *const query, Result initial, Partial partial, Reduce reduce) {
+		std::lock_guard<std::mutex> lock(scanMutex_);
+		const std::vector<Transaction> reads = beginReads();
+		return run(ranges, query, std::move(initial), partial, reduce);
+	}
+};
+
+
+  
+// Incremental I/O on one BLOB, built on sqlite3_blob_open, so that large values are streamed through caller buffers with bounded memory.
+// The size of a BLOB cannot be changed through the stream, space for writing is allocated with zeroBlob.
+class BlobStream {
+
+	struct BlobStreamTraits : public nullHandleTraits<sqlite3_blob *> {
+		static void close(sqlite3_blob *value) noexcept {
+			sqlite3_blob_close(value);
+		}
+	};
+
+	UniqueHandle<BlobStreamTraits> blobHandle_;
+	sqlite3 *connection_{nullptr};
+	int position_{0};
+
+  public:
+
+	BlobStream() = default;
+
+	BlobStream(const SqliteConnection &connection, const char *const table, const char *const column, const long long rowId, const bool writable = false, const char *const database = "main") : connection_{connection.getABI()} {
+		if (SQLITE_OK != sqlite3_blob_open(connection_, database, table, column, rowId, writable ? 1 : 0, blobHandle_.set())) {
+			throwLastError();
+		}
+	}
+
+	explicit operator bool() const noexcept {
+		return static_cast<bool>(blobHandle_);
+	}
+
+	sqlite3_blob *getABI() const noexcept {
+		return blobHandle_.get();
+	}
+
+	void throwLastError() const {
+		throw exception(connection_);
+	}
+
+	int size() const noexcept {
+		return sqlite3_blob_bytes(getABI());
+	}
+
+	int position() const noexcept {
+		return position_;
+	}
+
+	void seek(const int position) noexcept {
+		position_ = position;
+	}
+
+	void read(void *const buffer, const int size, const int offset) const {
+		if (SQLITE_OK != sqlite3_blob_read(getABI(), buffer, size, offset)) {
+			throwLastError();
+		}
+	}
+
+	void write(const void *const buffer, const int size, const int offset) const {
+		if (SQLITE_OK != sqlite3_blob_write(getABI(), buffer, size, offset)) {
+			throwLastError();
+		}
+	}
+
+	//reads up to size bytes at the position and advances it, returns 0 at the end of the BLOB
+	int readNext(void *const buffer, const int size) {
+		const int count = std::min(size, this->size() - position_);
+		if (count <= 0) {
+			return 0;
+		}
+		read(buffer, count, position_);
+		position_ += count;
+		return count;
+	}
+
+	void writeNext(const void *const buffer, const int size) {
+		write(buffer, size, position_);
+		position_ += size;
+	}
+
+	//moves the open handle to the same column of another row, without allocating a new one
+	void reopen(const long long rowId) {
+		if (SQLITE_OK != sqlite3_blob_reopen(getABI(), rowId)) {
+			throwLastError();
+		}
+		position_ = 0;
+	}
+};
+
+
+  
+struct BackupOptions {
+	//pages copied by one sqlite3_backup_step, -1 copies the whole database in one step, with the source locked throughout
+	int pagesPerStep_{256};
+	//how long the source is left unlocked between two steps, the thread only yields when it is zero
+	std::chrono::milliseconds pause_{0};
+};
+
+
+  
+// Online backup of a database into another connection with sqlite3_backup_init/step/finish, a few pages per step.
+// The source is locked only during a step, so the foreground traffic goes on between steps. A write through another connection
+// restarts the copy from the first page, a write through the source connection is copied along.
+class Backup {
+
+	struct BackupTraits : public nullHandleTraits<sqlite3_backup *> {
+		static void close(sqlite3_backup *value) noexcept {
+			sqlite3_backup_finish(value);
+		}
+	};
+
+	UniqueHandle<BackupTraits> backupHandle_;
+	BackupOptions options_;
+	std::atomic<bool> cancelled_{false};
+	//as of the last step, finish() releases the handle they are read from
+	int remaining_{0};
+	int pageCount_{0};
+
+	void pause() const {
+		if (options_.pause_.count() > 0) {
+			std::this_thread::sleep_for(options_.pause_);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+  public:
+
+	//destinationName and sourceName are the schema names, "main", "temp" or the name of an attached database
+	Backup(const SqliteConnection &destination, const SqliteConnection &source, const BackupOptions &options = BackupOptions{}, const char *const destinationName = "main", const char *const sourceName = "main") : options_{options} {
+		backupHandle_.reset(sqlite3_backup_init(destination.getABI(), destinationName, source.getABI(), sourceName));
+		if (!backupHandle_) {
+			throw exception(destination.getABI());
+		}
+	}
+
+	Backup(const Backup &) = delete;
+	Backup &operator=(const Backup &) = delete;
+
+	sqlite3_backup *getABI() const noexcept {
+		return backupHandle_.get();
+	}
+
+	//copies up to pagesPerStep_ pages, false once the copy is complete, a busy or locked source is a step copying nothing
+	//throws SQLITE_MISUSE after finish()
+	bool step() {
+		if (!backupHandle_) {
+			throw exception(SQLITE_MISUSE, "the backup is already finished");
+		}
+		const int result = sqlite3_backup_step(getABI(), options_.pagesPerStep_);
+		remaining_ = sqlite3_backup_remaining(getABI());
+		pageCount_ = sqlite3_backup_pagecount(getABI());
+		if (result == SQLITE_DONE) {
+			return false;
+		}
+		if (result != SQLITE_OK && result != SQLITE_BUSY && result != SQLITE_LOCKED) {
+			throw exception(result, sqlite3_errstr(result));
+		}
+		return true;
+	}
+
+	//both known after the first step, and still after finish()
+	int remaining() const noexcept {
+		return remaining_;
+	}
+
+	int pageCount() const noexcept {
+		return pageCount_;
+	}
+
+	//steps until the copy is complete, pausing between steps, and calls progress(remaining(), pageCount()) after every step
+	//false when cancel() stopped it, finishing the backup then rolls the destination back
+	template <typename Progress>
+	bool run(Progress &&progress) {
+		while (!cancelled_.load(std::memory_order_relaxed)) {
+			const bool copying = step();
+			progress(remaining(), pageCount());
+			if (!copying) {
+				return true;
+			}
+			pause();
+		}
+		return false;
+	}
+
+	bool run() {
+		return run([](int, int) {});
+	}
+
+	//from any thread, run() returns after the step in progress
+	void cancel() noexcept {
+		cancelled_.store(true, std::memory_order_relaxed);
+	}
+
+	bool cancelled() const noexcept {
+		return cancelled_.load(std::memory_order_relaxed);
+	}
+
+	//releases the handle and the locks, throwing the error of a failed step, which the destructor ignores
+	void finish() {
+		const int result = sqlite3_backup_finish(backupHandle_.release());
+		if (result != SQLITE_OK) {
+			throw exception(result, sqlite3_errstr(result));
+		}
+	}
+
+	//hot copy of the main database of source into the database file filename
+	static void toFile(const SqliteConnection &source, const char *const filename, const BackupOptions &options = BackupOptions{}) {
+		const SqliteConnection destination(filename);
+		Backup backup(destination, source, options);
+		backup.run();
+		backup.finish();
+	}
+};
+
+  
+// Runs a statement and exports its rows through the Arrow C Data Interface, in record batches of at most batchSize_ rows:
+// a struct array ("+s") with an int64 ("l"), float64 ("g"), utf8 ("u") or binary ("z") child per column.
+// The column types are taken from the declared types and the first batch, a column of nulls only is exported as utf8.
+// The buffers of a batch are those of the ResultSet it was read into, which lives until the consumer releases the batch.
+class ArrowExporter {
+
+	//what an exported array or schema points into, shared with its children, so that a child moved out by the consumer outlives its parent
+	struct exportedData {
+		std::atomic<std::size_t> references_{0};
+
+		virtual ~exportedData() = default;
+	};
+
+	struct batchData : public exportedData {
+		ResultSet result_;
+		std::vector<ArrowArray> children_;
+		std::vector<ArrowArray *> childPointers_;
+		std::vector<std::array<const void *, 3>> buffers_;
+		const void *structBuffers_[1]{nullptr};
+	};
+
+	struct schemaData : public exportedData {
+		//the consumer may keep the schema after the exporter is gone
+		std::vector<std::string> names_;
+		std::vector<ArrowSchema> children_;
+		std::vector<ArrowSchema *> childPointers_;
+	};
+
+	const SqliteStatement &statement_;
+	std::size_t batchSize_;
+	std::vector<std::string> names_;
+	std::vector<int> types_;
+	//the first batch, read when the schema is exported
+	ResultSet pending_;
+	bool started_{false};
+	bool hasPending_{false};
+	bool done_{false};
+
+	template <typename Structure>
+	static void release(Structure *const structure) noexcept {
+		for (int64_t child = 0; child < structure->n_children; ++child) {
+			if (structure->children[child]->release != nullptr) {
+				structure->children[child]->release(structure->children[child]);
+			}
+		}
+		exportedData *const data = static_cast<exportedData *>(structure->private_data);
+		if (data->references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			delete data;
+		}
+		structure->release = nullptr;
+	}
+
+	static const char *format(const int type) noexcept {
+		switch (type) {
+			case SQLITE_INTEGER:
+				return "l";
+			case SQLITE_FLOAT:
+				return "g";
+			case SQLITE_BLOB:
+				return "z";
+			default:
+				return "u";
+		}
+	}
+
+	void fill(ResultSet &result) {
+		result.start(statement_.getABI());
+		for (std::size_t column = 0; column < types_.size(); ++column) {
+			result.setColumnType(column, types_[column]);
+		}
+		//stepping again after the last row would rerun the statement
+		while (!done_ && result.rowCount() < batchSize_) {
+			if (statement_.execute()) {
+				result.appendRow(statement_.getABI());
+			}
+			else {
+				done_ = true;
+			}
+		}
+	}
+
+	void start() {
+		fill(pending_);
+		started_ = true;
+		hasPending_ = true;
+		for (std::size_t column = 0; column < pending_.columnCount(); ++column) {
+			if (pending_.column(column).type() == SQLITE_NULL) {
+				pending_.setColumnType(column, SQLITE_TEXT);
+			}
+			names_.push_back(pending_.column(column).name());
+			types_.push_back(pending_.column(column).type());
+		}
+	}
+
+  public:
+
+	//the statement is stepped from where it is, with its parameters already bound
+	explicit ArrowExporter(const SqliteStatement &statement, const std::size_t batchSize = 65536) : statement_{statement}, batchSize_{std::max<std::size_t>(batchSize, 1)} {
+	}
+
+	ArrowExporter(const ArrowExporter &) = delete;
+	ArrowExporter &operator=(const ArrowExporter &) = delete;
+
+	void exportSchema(ArrowSchema *const out) {
+		if (!started_) {
+			start();
+		}
+		std::unique_ptr<schemaData> data = std::make_unique<schemaData>();
+		const std::size_t count = types_.size();
+		data->names_ = names_;
+		data->children_.resize(count);
+		data->childPointers_.resize(count);
+		for (std::size_t column = 0; column < count; ++column) {
+			ArrowSchema &child = data->children_[column];
+			child = ArrowSchema{format(types_[column]), data->names_[column].c_str(), nullptr, ARROW_FLAG_NULLABLE, 0, nullptr, nullptr, &release<ArrowSchema>, data.get()};
+			data->childPointers_[column] = &child;
+		}
+		data->references_ = count + 1;
+		*out = ArrowSchema{"+s", "", nullptr, 0, static_cast<int64_t>(count), data->childPointers_.data(), nullptr, &release<ArrowSchema>, data.get()};
+		data.release();
+	}
+
+	//false once every row has been exported, out is left untouched then
+	bool exportBatch(ArrowArray *const out) {
+		if (!started_) {
+			start();
+		}
+		if (!hasPending_ && done_) {
+			return false;
+		}
+		std::unique_ptr<batchData> data = std::make_unique<batchData>();
+		if (hasPending_) {
+			data->result_ = std::move(pending_);
+			hasPending_ = false;
+		}
+		else {
+			fill(data->result_);
+		}
+		const ResultSet &result = data->result_;
+		if (result.rowCount() == 0) {
+			return false;
+		}
+
+		const std::size_t count = result.columnCount();
+		const int64_t length = static_cast<int64_t>(result.rowCount());
+		data->children_.resize(count);
+		data->childPointers_.resize(count);
+		data->buffers_.resize(count);
+		for (std::size_t column = 0; column < count; ++column) {
+			const ResultSet::Column &values = result.column(column);
+			std::array<const void *, 3> &buffers = data->buffers_[column];
+			buffers[0] = values.nullCount() == 0 ? nullptr : values.validity().data();
+			int64_t bufferCount = 2;
+			if (values.type() == SQLITE_INTEGER) {
+				buffers[1] = values.integers().data();
+			}
+			else if (values.type() == SQLITE_FLOAT) {
+				buffers[1] = values.reals().data();
+			}
+			else {
+				buffers[1] = values.offsets().data();
+				buffers[2] = values.data().data();
+				bufferCount = 3;
+			}
+			ArrowArray &child = data->children_[column];
+			child = ArrowArray{length, static_cast<int64_t>(values.nullCount()), 0, bufferCount, 0, buffers.data(), nullptr, nullptr, &release<ArrowArray>, data.get()};
+			data->childPointers_[column] = &child;
+		}
+		data->references_ = count + 1;
+		*out = ArrowArray{length, 0, 0, 1, static_cast<int64_t>(count), data->structBuffers_, data->childPointers_.data(), nullptr, &release<ArrowArray>, data.get()};
+		data.release();
+		return true;
+	}
+};
+
+
+  
+// The result of a job, or the exception it threw, kept on the worker thread until the job is completed.
+template <typename Result>
+class asyncOutcome {
+
+	std::optional<std::conditional_t<std::is_void_v<Result>, bool, Result>> value_;
+	std::exception_ptr error_;
+
+  public:
+
+	template <typename Function>
+	bool run(Function &function, const SqliteConnection &connection) noexcept {
+		try {
+			if constexpr (std::is_void_v<Result>) {
+				function(connection);
+				value_.emplace(true);
+			}
+			else {
+				value_.emplace(function(connection));
+			}
+			return true;
+		}
+		catch (...) {
+			error_ = std::current_exception();
+			return false;
+		}
+	}
+
+	void fail(std::exception_ptr error) noexcept {
+		value_.reset();
+		error_ = std::move(error);
+	}
+
+	void deliver(std::promise<Result> &promise) noexcept {
+		try {
+			if (error_) {
+				promise.set_exception(std::move(error_));
+			}
+			else if constexpr (std::is_void_v<Result>) {
+				promise.set_value();
+			}
+			else {
+				promise.set_value(std::move(*value_));
+			}
+		}
+		catch (...) {
+		}
+	}
+
+	Result take() {
+		if (error_) {
+			std::rethrow_exception(error_);
+		}
+		if constexpr (!std::is_void_v<Result>) {
+			return std::move(*value_);
+		}
+	}
+};
+
+
+class asyncJob {
+
+  public:
+
+	const bool write_;
+
+	explicit asyncJob(const bool write) noexcept : write_{write} {
+	}
+
+	virtual ~asyncJob() = default;
+
+	//runs the work and keeps its outcome, returns false when it threw
+	virtual bool run(const SqliteConnection &connection) noexcept = 0;
+
+	//replaces the outcome, when the transaction of a batch of writes failed
+	virtual void fail(std::exception_ptr error) noexcept = 0;
+
+	//hands the outcome to the caller, once the work is committed
+	virtual void complete() noexcept = 0;
+};
+
+
+template <typename Function, typename Result>
+class futureJob : public asyncJob {
+
+	Function function_;
+	asyncOutcome<Result> outcome_;
+	std::promise<Result> promise_;
+
+  public:
+
+	template <typename Work>
+	futureJob(const bool write, Work &&function) : asyncJob(write), function_(std::forward<Work>(function)) {
+	}
+
+	std::future<Result> future() {
+		return promise_.get_future();
+	}
+
+	bool run(const SqliteConnection &connection) noexcept override {
+		return outcome_.run(function_, connection);
+	}
+
+	void fail(std::exception_ptr error) noexcept override {
+		outcome_.fail(std::move(error));
+	}
+
+	void complete() noexcept override {
+		outcome_.deliver(promise_);
+	}
+};
+
+
+#ifdef __cpp_lib_coroutine
+template <typename Result>
+struct asyncAwaitState {
+	enum Stage { Pending, Waiting, Done };
+
+	asyncOutcome<Result> outcome_;
+	std::coroutine_handle<> continuation_;
+	std::atomic<int> stage_{Pending};
+};
+
+
+// co_await on it suspends the coroutine until the job is completed, the coroutine is then resumed on the worker thread.
+template <typename Result>
+class asyncAwaitable {
+
+	std::shared_ptr<asyncAwaitState<Result>> state_;
+
+  public:
+
+	explicit asyncAwaitable(std::shared_ptr<asyncAwaitState<Result>> state) noexcept : state_{std::move(state)} {
+	}
+
+	bool await_ready() const noexcept {
+		return state_->stage_.load(std::memory_order_acquire) == asyncAwaitState<Result>::Done;
+	}
+
+	bool await_suspend(const std::coroutine_handle<> continuation) noexcept {
+		state_->continuation_ = continuation;
+		int expected = asyncAwaitState<Result>::Pending;
+		//fails when the job completed in the meantime, the coroutine then goes on without suspending
+		return state_->stage_.compare_exchange_strong(expected, asyncAwaitState<Result>::Waiting, std::memory_order_acq_rel);
+	}
+
+	Result await_resume() {
+		return state_->outcome_.take();
+	}
+};
+
+
+template <typename Function, typename Result>
+class awaitJob : public asyncJob {
+
+	Function function_;
+	std::shared_ptr<asyncAwaitState<Result>> state_;
+
+  public:
+
+	template <typename Work>
+	awaitJob(const bool write, Work &&function, std::shared_ptr<asyncAwaitState<Result>> state) : asyncJob(write), function_(std::forward<Work>(function)), state_{std::move(state)} {
+	}
+
+	bool run(const SqliteConnection &connection) noexcept override {
+		return state_->outcome_.run(function_, connection);
+	}
+
+	void fail(std::exception_ptr error) noexcept override {
+		state_->outcome_.fail(std::move(error));
+	}
+
+	void complete() noexcept override {
+		if (state_->stage_.exchange(asyncAwaitState<Result>::Done, std::memory_order_acq_rel) == asyncAwaitState<Result>::Waiting) {
+			state_->continuation_.resume();
+		}
+	}
+};
+#endif
+
+
+template <typename Function>
+using jobResult = std::invoke_result_t<std::decay_t<Function> &, const SqliteConnection &>;
+
+
+// Runs the jobs in one immediate transaction, each in its own savepoint so that a failing job is rolled back alone,
+// and completes them once the transaction is committed, or with the error of the transaction.
+inline void commitBatch(const SqliteConnection &connection, const std::vector<std::unique_ptr<asyncJob>> &batch) noexcept {
+	const asyncJob *rolledBackBy = nullptr;
+	try {
+		Transaction transaction(connection, TransactionMode::Immediate);
+		for (const auto &job : batch) {
+			Savepoint savepoint(connection);
+			if (job->run(connection)) {
+				savepoint.commit();
+			}
+			else if (sqlite3_get_autocommit(connection.getABI())) {
+				//SQLite rolled the whole transaction back (SQLITE_FULL, SQLITE_IOERR, SQLITE_BUSY, SQLITE_NOMEM), the job keeps its own error
+				rolledBackBy = job.get();
+				throw exception(SQLITE_ABORT, "the transaction of the batch was rolled back by a failed job");
+			}
+		}
+		transaction.commit();
+	}
+	catch (...) {
+		for (const auto &job : batch) {
+			if (job.get() != rolledBackBy) {
+				job->fail(std::current_exception());
+			}
+		}
+	}
+	for (const auto &job : batch) {
+		job->complete();
+	}
+}
+
+
+// The type a deferred value is kept as: views and C strings are copied into owning strings and vectors,
+// since they are bound on the worker thread after the caller may have released what they point to.
+template <typename Value>
+struct ownedValue {
+	using type = Value;
+};
+
+//a null pointer still binds NULL
+template <>
+struct ownedValue<const char *> {
+	using type = std::optional<std::string>;
+};
+
+template <>
+struct ownedValue<char *> : ownedValue<const char *> {
+};
+
+template <>
+struct ownedValue<const wchar_t *> {
+	using type = std::optional<std::wstring>;
+};
+
+template <>
+struct ownedValue<wchar_t *> : ownedValue<const wchar_t *> {
+};
+
+template <>
+struct ownedValue<std::string_view> {
+	using type = std::string;
+};
+
+#ifdef __cpp_lib_span
+template <>
+struct ownedValue<std::span<const std::byte>> {
+	using type = std::vector<std::byte>;
+};
+
+template <>
+struct ownedValue<std::span<std::byte>> : ownedValue<std::span<const std::byte>> {
+};
+#endif
+
+template <typename Value>
+using ownedValueType = typename ownedValue<std::decay_t<Value>>::type;
+
+template <typename Value>
+ownedValueType<Value> ownedCopy(Value &&value) {
+	using Owned = ownedValueType<Value>;
+	if constexpr (std::is_same_v<Owned, std::decay_t<Value>>) {
+		return std::forward<Value>(value);
+	}
+	else if constexpr (std::is_pointer_v<std::remove_reference_t<Value>>) {
+		return value != nullptr ? Owned(value) : Owned();
+	}
+	else if constexpr (std::is_array_v<std::remove_reference_t<Value>>) {
+		//a string literal or another array, which cannot be null
+		return Owned(value);
+	}
+	else {
+		return Owned(value.begin(), value.end());
+	}
+}
+
+
+// A job that prepares text through the statement cache and binds the values, which are copied into the job
+// and moved into the statement when it is prepared on the worker thread.
+template <typename... Values>
+auto deferredStatement(const char *const text, Values &&... values) {
+	return [text = std::string(text), values = std::make_tuple(ownedCopy(std::forward<Values>(values))...)](const SqliteConnection &connection) mutable {
+		CachedStatement statement(connection, text.c_str());
+		std::apply([&statement](auto &... owned) { statement.bindAll(std::move(owned)...); }, values);
+		return statement;
+	};
+}
+
+
+template <typename... Columns>
+class AsyncCursor;
+
+
+// Runs queries on a worker thread which owns the connection, so that the calling threads never wait on sqlite3_step.
+// Jobs run in submission order. Writes queued one after another are committed together in one transaction, each in its own savepoint,
+// so a failing write is rolled back alone, and their results are delivered after the COMMIT.
+class AsyncExecutor {
+
+	SqliteConnection connection_;
+	const std::size_t maxWriteBatch_;
+
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::deque<std::unique_ptr<asyncJob>> queue_;
+	bool stopping_{false};
+
+	//declared last, so that it starts once everything else is constructed
+	std::thread worker_;
+
+	void push(std::unique_ptr<asyncJob> job) {
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			queue_.push_back(std::move(job));
+		}
+		condition_.notify_one();
+	}
+
+	void work() noexcept {
+		std::vector<std::unique_ptr<asyncJob>> batch;
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				condition_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+				if (queue_.empty()) {
+					return;
+				}
+				batch.push_back(std::move(queue_.front()));
+				queue_.pop_front();
+				while (batch.front()->write_ && !queue_.empty() && queue_.front()->write_ && batch.size() < maxWriteBatch_) {
+					batch.push_back(std::move(queue_.front()));
+					queue_.pop_front();
+				}
+			}
+			if (batch.front()->write_) {
+				commitBatch(connection_, batch);
+			}
+			else {
+				batch.front()->run(connection_);
+				batch.front()->complete();
+			}
+			batch.clear();
+		}
+	}
+
+	template <typename Function>
+	std::future<jobResult<Function>> enqueue(const bool write, Function &&function) {
+		auto job = std::make_unique<futureJob<std::decay_t<Function>, jobResult<Function>>>(write, std::forward<Function>(function));
+		std::future<jobResult<Function>> future = job->future();
+		push(std::move(job));
+		return future;
+	}
+
+	template <typename... Columns, typename... Values>
+	static auto queryJob(const char *const text, Values &&... values) {
+		return [prepare = deferredStatement(text, std::forward<Values>(values)...)](const SqliteConnection &connection) mutable {
+			const CachedStatement statement = prepare(connection);
+			std::vector<std::tuple<Columns...>> rows;
+			for (auto &&row : statement.template rows<Columns...>()) {
+				rows.push_back(std::move(row));
+			}
+			return rows;
+		};
+	}
+
+#ifdef __cpp_lib_coroutine
+	template <typename Function>
+	asyncAwaitable<jobResult<Function>> enqueueAwaitable(const bool write, Function &&function) {
+		auto state = std::make_shared<asyncAwaitState<jobResult<Function>>>();
+		push(std::make_unique<awaitJob<std::decay_t<Function>, jobResult<Function>>>(write, std::forward<Function>(function), state));
+		return asyncAwaitable<jobResult<Function>>(std::move(state));
+	}
+#endif
+
+  public:
+
+	static constexpr std::size_t defaultMaxWriteBatch = 1000;
+
+	explicit AsyncExecutor(const char *const filename, const OpenOptions &options = OpenOptions{}, const std::size_t maxWriteBatch = defaultMaxWriteBatch) : connection_(filename, options), maxWriteBatch_{std::max<std::size_t>(maxWriteBatch, 1)}, worker_([this] { work(); }) {
+	}
+
+	AsyncExecutor(const AsyncExecutor &) = delete;
+	AsyncExecutor &operator=(const AsyncExecutor &) = delete;
+
+	//the queued jobs are still run
+	~AsyncExecutor() noexcept {
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		condition_.notify_one();
+		worker_.join();
+	}
+
+	//function(const SqliteConnection &) runs on the worker thread, outside of any transaction
+	template <typename Function>
+	std::future<jobResult<Function>> submit(Function &&function) {
+		return enqueue(false, std::forward<Function>(function));
+	}
+
+	//function(const SqliteConnection &) runs on the worker thread, in a savepoint of a transaction shared with the writes queued next to it
+	template <typename Function>
+	std::future<jobResult<Function>> submitWrite(Function &&function) {
+		return enqueue(true, std::forward<Function>(function));
+	}
+
+	//the values are copied, so the rows should be of owning types (std::string rather than std::string_view)
+	template <typename... Columns, typename... Values>
+	std::future<std::vector<std::tuple<Columns...>>> query(const char *const text, Values &&... values) {
+		return submit(queryJob<Columns...>(text, std::forward<Values>(values)...));
+	}
+
+	template <typename... Values>
+	std::future<void> execute(const char *const text, Values &&... values) {
+		return submitWrite([prepare = deferredStatement(text, std::forward<Values>(values)...)](const SqliteConnection &connection) mutable {
+			const CachedStatement statement = prepare(connection);
+			while (statement.execute()) {
+			}
+		});
+	}
+
+	template <typename... Columns, typename... Values>
+	AsyncCursor<Columns...> cursor(const char *const text, Values &&... values) {
+		return AsyncCursor<Columns...>(*this, text, std::forward<Values>(values)...);
+	}
+
+#ifdef __cpp_lib_coroutine
+	template <typename Function>
+	asyncAwaitable<jobResult<Function>> async(Function &&function) {
+		return enqueueAwaitable(false, std::forward<Function>(function));
+	}
+
+	template <typename Function>
+	asyncAwaitable<jobResult<Function>> asyncWrite(Function &&function) {
+		return enqueueAwaitable(true, std::forward<Function>(function));
+	}
+
+	template <typename... Columns, typename... Values>
+	asyncAwaitable<std::vector<std::tuple<Columns...>>> asyncQuery(const char *const text, Values &&... values) {
+		return async(queryJob<Columns...>(text, std::forward<Values>(values)...));
+	}
+#endif
+};
+
+
+// Streams the rows of a query from an AsyncExecutor, fetch(count) returns the next count rows at most, and no rows at the end.
+// The statement is prepared, stepped and finalized on the worker thread, the executor must outlive the cursor.
+template <typename... Columns>
+class AsyncCursor {
+
+	struct State {
+		std::optional<CachedStatement> statement_;
+		std::exception_ptr error_;
+		bool done_{false};
+	};
+
+	AsyncExecutor *executor_;
+	std::shared_ptr<State> state_;
+
+	auto fetchJob(const std::size_t count) const {
+		return [state = state_, count](const SqliteConnection &) {
+			if (state->error_) {
+				std::rethrow_exception(state->error_);
+			}
+			std::vector<std::tuple<Columns...>> rows;
+			while (!state->done_ && rows.size() < count) {
+				if (!state->statement_->execute()) {
+					//ends the read transaction, without waiting for the cursor to be destroyed
+					state->done_ = true;
+					state->statement_->reset();
+					break;
+				}
+				rows.push_back(tupleDecoder<Columns...>::decode(state->statement_->getABI()));
+			}
+			return rows;
+		};
+	}
+
+  public:
+
+	template <typename... Values>
+	AsyncCursor(AsyncExecutor &executor, const char *const text, Values &&... values) : executor_{&executor}, state_{std::make_shared<State>()} {
+		executor.submit([state = state_, prepare = deferredStatement(text, std::forward<Values>(values)...)](const SqliteConnection &connection) mutable {
+			try {
+				state->statement_.emplace(prepare(connection));
+				//checks the column count
+				state->statement_->template rows<Columns...>();
+			}
+			catch (...) {
+				state->error_ = std::current_exception();
+			}
+		});
+	}
+
+	AsyncCursor(AsyncCursor &&) noexcept = default;
+	AsyncCursor &operator=(AsyncCursor &&) = delete;
+
+	~AsyncCursor() noexcept {
+		if (state_) {
+			try {
+				executor_->submit([state = std::move(state_)](const SqliteConnection &) {});
+			}
+			catch (...) {
+			}
+		}
+	}
+
+	std::future<std::vector<std::tuple<Columns...>>> fetch(const std::size_t count) {
+		return executor_->submit(fetchJob(count));
+	}
+
+#ifdef __cpp_lib_coroutine
+	asyncAwaitable<std::vector<std::tuple<Columns...>>> asyncFetch(const std::size_t count) {
+		return executor_->async(fetchJob(count));
+	}
+#endif
+};
+
+  
+// Link of the intrusive queue of mpscQueue.
+struct mpscNode {
+	std::atomic<mpscNode *> next_{nullptr};
+};
+
+
+// Intrusive multiple producers, single consumer queue of Dmitry Vyukov.
+// push() is wait-free from any thread, pop() is lock-free and only called by the consumer.
+class mpscQueue {
+
+	alignas(64) std::atomic<mpscNode *> head_;
+	alignas(64) mpscNode *tail_;
+	mpscNode stub_;
+
+  public:
+
+	mpscQueue() noexcept : head_{&stub_}, tail_{&stub_} {
+	}
+
+	mpscQueue(const mpscQueue &) = delete;
+	mpscQueue &operator=(const mpscQueue &) = delete;
+
+	void push(mpscNode *const node) noexcept {
+		node->next_.store(nullptr, std::memory_order_relaxed);
+		mpscNode *const previous = head_.exchange(node);
+		previous->next_.store(node, std::memory_order_release);
+	}
+
+	//nullptr when the queue is empty, or while the node pushed last is not linked yet
+	mpscNode *pop() noexcept {
+		mpscNode *tail = tail_;
+		mpscNode *next = tail->next_.load(std::memory_order_acquire);
+		if (tail == &stub_) {
+			if (next == nullptr) {
+				return nullptr;
+			}
+			tail_ = next;
+			tail = next;
+			next = next->next_.load(std::memory_order_acquire);
+		}
+		if (next != nullptr) {
+			tail_ = next;
+			return tail;
+		}
+		if (tail != head_.load()) {
+			return nullptr;
+		}
+		push(&stub_);
+		next = tail->next_.load(std::memory_order_acquire);
+		if (next != nullptr) {
+			tail_ = next;
+			return tail;
+		}
+		return nullptr;
+	}
+
+	//false while a node is being pushed, the sequentially consistent load of head_ pairs with the exchange in push()
+	bool empty() const noexcept {
+		return tail_ == &stub_ && head_.load() == &stub_;
+	}
+};
+
+
+// A write job of GroupCommitWriter, the queue links it through the node it holds.
+struct groupCommitNode : mpscNode {
+	asyncJob *const job_;
+
+	explicit groupCommitNode(asyncJob *const job) noexcept : job_{job} {
+	}
+};
+
+
+template <typename Function, typename Result>
+class groupCommitJob : public futureJob<Function, Result> {
+
+  public:
+
+	groupCommitNode node_{this};
+
+	using futureJob<Function, Result>::futureJob;
+};
+
+
+struct GroupCommitOptions {
+	std::size_t maxBatch_{1000};
+	//how long the first job of a batch waits for more jobs, 0 commits whatever was queued during the previous commit
+	std::chrono::microseconds maxLatency_{0};
+};
+
+
+// Group commit: write jobs are queued from any thread without locking, and a writer thread commits them in batches,
+// so that concurrent writers share one write lock and one journal sync per batch instead of paying one each and failing with SQLITE_BUSY.
+// Every job runs in its own savepoint, and its future is ready once the transaction of the batch is committed.
+class GroupCommitWriter {
+
+  public:
+
+	struct Stats {
+		unsigned long long jobs_{0};
+		unsigned long long batches_{0};
+	};
+
+  private:
+
+	SqliteConnection connection_;
+	const GroupCommitOptions options_;
+	mpscQueue queue_;
+
+	std::atomic<bool> idle_{false};
+	std::atomic<bool> stopping_{false};
+	std::atomic<unsigned long long> jobs_{0};
+	std::atomic<unsigned long long> batches_{0};
+	//only used to park the idle writer thread
+	std::mutex mutex_;
+	std::condition_variable condition_;
+
+	//declared last, so that it starts once everything else is constructed
+	std::thread worker_;
+
+	void push(groupCommitNode *const node) noexcept {
+		queue_.push(node);
+		if (idle_.load()) {
+			//taking the mutex orders the notification after the writer either checked the queue or started waiting
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+			}
+			condition_.notify_one();
+		}
+	}
+
+	std::unique_ptr<asyncJob> pop() noexcept {
+		mpscNode *const node = queue_.pop();
+		return std::unique_ptr<asyncJob>(node ? static_cast<groupCommitNode *>(node)->job_ : nullptr);
+	}
+
+	bool ready() const noexcept {
+		return !queue_.empty() || stopping_.load();
+	}
+
+	//idle_ is set before the queue is checked, so a producer either sees it and notifies, or pushed before the check
+	void park() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		idle_.store(true);
+		condition_.wait(lock, [this] { return ready(); });
+		idle_.store(false);
+	}
+
+	void parkUntil(const std::chrono::steady_clock::time_point deadline) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		idle_.store(true);
+		condition_.wait_until(lock, deadline, [this] { return ready(); });
+		idle_.store(false);
+	}
+
+	void work() noexcept {
+		std::vector<std::unique_ptr<asyncJob>> batch;
+		for (;;) {
+			std::unique_ptr<asyncJob> job = pop();
+			if (!job) {
+				if (!queue_.empty()) {
+					//a producer is between its exchange and its link
+					std::this_thread::yield();
+				}
+				else if (stopping_.load()) {
+					return;
+				}
+				else {
+					park();
+				}
+				continue;
+			}
+
+			batch.push_back(std::move(job));
+			const auto deadline = std::chrono::steady_clock::now() + options_.maxLatency_;
+			while (batch.size() < options_.maxBatch_) {
+				if ((job = pop())) {
+					batch.push_back(std::move(job));
+				}
+				else if (options_.maxLatency_.count() == 0 || std::chrono::steady_clock::now() >= deadline) {
+					break;
+				}
+				else if (queue_.empty()) {
+					parkUntil(deadline);
+				}
+				else {
+					std::this_thread::yield();
+				}
+			}
+
+			commitBatch(connection_, batch);
+			jobs_.fetch_add(batch.size(), std::memory_order_relaxed);
+			batches_.fetch_add(1, std::memory_order_relaxed);
+			batch.clear();
+		}
+	}
+
+  public:
+
+	explicit GroupCommitWriter(const char *const filename, const GroupCommitOptions &options = GroupCommitOptions{}, const OpenOptions &openOptions = OpenOptions::durable()) : connection_(filename, openOptions), options_{std::max<std::size_t>(options.maxBatch_, 1), options.maxLatency_}, worker_([this] { work(); }) {
+	}
+
+	GroupCommitWriter(const GroupCommitWriter &) = delete;
+	GroupCommitWriter &operator=(const GroupCommitWriter &) = delete;
+
+	//the queued jobs are still committed
+	~GroupCommitWriter() noexcept {
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			stopping_.store(true);
+		}
+		condition_.notify_one();
+		worker_.join();
+	}
+
+	//function(const SqliteConnection &) runs on the writer thread, in a savepoint of the transaction of its batch
+	template <typename Function>
+	std::future<jobResult<Function>> submit(Function &&function) {
+		auto job = std::make_unique<groupCommitJob<std::decay_t<Function>, jobResult<Function>>>(true, std::forward<Function>(function));
+		std::future<jobResult<Function>> future = job->future();
+		push(&job.release()->node_);
+		return future;
+	}
+
+	template <typename... Values>
+	std::future<void> execute(const char *const text, Values &&... values) {
+		return submit([prepare = deferredStatement(text, std::forward<Values>(values)...)](const SqliteConnection &connection) mutable {
+			const CachedStatement statement = prepare(connection);
+			while (statement.execute()) {
+			}
+		});
+	}
+
+	Stats stats() const noexcept {
+		return Stats{jobs_.load(std::memory_order_relaxed), batches_.load(std::memory_order_relaxed)};
+	}
+};
+
+  
+struct GlobalOptions {
+	//one page cache for every connection of the process, with one byte budget, instead of a page cache per connection
+	bool sharedPageCache_{false};
+	//bytes of clean pages the shared cache keeps for all connections together, PRAGMA cache_size no longer applies
+	std::size_t pageCacheBytes_{64 * 1024 * 1024};
+	//lock stripes of the shared cache, the pages of a connection live in one of them
+	std::size_t pageCacheShards_{16};
+	//size-class pools for SQLite's allocations of up to 1 KiB, with a cache of free blocks per thread, larger ones go to malloc
+	bool pooledAllocator_{false};
+};
+
+struct GlobalMemoryStats {
+	//the shared page cache, its bytes count the pages of on-disk databases, pinned or not
+	std::size_t pageCacheBytes_{0};
+	unsigned long long pageCacheHits_{0};
+	unsigned long long pageCacheMisses_{0};
+	unsigned long long pageCacheEvictions_{0};
+	//the pooled allocator, slabs are kept for the life of the process
+	std::size_t poolSlabBytes_{0};
+	std::size_t poolLargeBytes_{0};
+};
+
+struct sharedPage;
+
+//the unpinned pages of one lock stripe, the oldest is evicted first
+struct pageCacheShard {
+	std::mutex mutex_;
+	sharedPage *oldest_{nullptr};
+	sharedPage *newest_{nullptr};
+};
+
+//the cache of one pager, guarded by the mutex of its stripe since evictions for other caches remove its pages
+struct sharedCache {
+	pageCacheShard *shard_;
+	std::size_t pageBytes_;
+	int pageSize_;
+	int extraSize_;
+	bool purgeable_;
+	std::vector<sharedPage *> buckets_;
+	unsigned pages_{0};
+};
+
+struct sharedPage {
+	sqlite3_pcache_page page_;
+	sharedCache *owner_;
+	sharedPage *hashNext_;
+	sharedPage *older_;
+	sharedPage *newer_;
+	std::size_t size_;
+	unsigned key_;
+	bool pinned_;
+};
+
+//the page buffer and the extra bytes follow the header in the same allocation
+constexpr std::size_t sharedPageHeader = (sizeof(sharedPage) + 7) & ~std::size_t{7};
+
+struct sharedPageCache {
+	std::unique_ptr<pageCacheShard[]> shards_;
+	std::size_t shardCount_{1};
+	std::size_t budget_{0};
+	std::atomic<std::size_t> bytes_{0};
+	std::atomic<std::size_t> nextShard_{0};
+	std::atomic<unsigned long long> hits_{0};
+	std::atomic<unsigned long long> misses_{0};
+	std::atomic<unsigned long long> evictions_{0};
+
+	bool overBudget(const std::size_t adding) const noexcept {
+		return bytes_.load(std::memory_order_relaxed) + adding > budget_;
+	}
+};
+
+//never destroyed, SQLite may release pages from the destructors of other statics
+inline sharedPageCache &sharedPages() noexcept {
+	static sharedPageCache *const cache = new sharedPageCache;
+	return *cache;
+}
+
+inline sharedCache &sharedCacheOf(sqlite3_pcache *const cache) noexcept {
+	return *reinterpret_cast<sharedCache *>(cache);
+}
+
+inline sharedPage *&sharedBucket(sharedCache &cache, const unsigned key) noexcept {
+	return cache.buckets_[key % cache.buckets_.size()];
+}
+
+inline sharedPage *findSharedPage(sharedCache &cache, const unsigned key) noexcept {
+	sharedPage *page = sharedBucket(cache, key);
+	while (page && page->key_ != key) {
+		page = page->hashNext_;
+	}
+	return page;
+}
+
+inline void linkSharedPage(sharedCache &cache, sharedPage &page) noexcept {
+	if (cache.pages_ >= cache.buckets_.size()) {
+		//without a larger table the chains only grow longer
+		try {
+			std::vector<sharedPage *> buckets(cache.buckets_.size() * 2, nullptr);
+			for (sharedPage *chain : cache.buckets_) {
+				while (chain) {
+					sharedPage *const next = chain->hashNext_;
+					chain->hashNext_ = buckets[chain->key_ % buckets.size()];
+					buckets[chain->key_ % buckets.size()] = chain;
+					chain = next;
+				}
+			}
+			cache.buckets_.swap(buckets);
+		}
+		catch (...) {
+		}
+	}
+	sharedPage *&bucket = sharedBucket(cache, page.key_);
+	page.hashNext_ = bucket;
+	bucket = &page;
+}
+
+inline void unlinkSharedPage(sharedCache &cache, sharedPage &page) noexcept {
+	sharedPage **link = &sharedBucket(cache, page.key_);
+	while (*link != &page) {
+		link = &(*link)->hashNext_;
+	}
+	*link = page.hashNext_;
+}
+
+inline void pushUnpinned(pageCacheShard &shard, sharedPage &page) noexcept {
+	page.newer_ = nullptr;
+	page.older_ = shard.newest_;
+	(shard.newest_ ? shard.newest_->newer_ : shard.oldest_) = &page;
+	shard.newest_ = &page;
+}
+
+inline void unlinkUnpinned(pageCacheShard &shard, sharedPage &page) noexcept {
+	(page.older_ ? page.older_->newer_ : shard.oldest_) = page.newer_;
+	(page.newer_ ? page.newer_->older_ : shard.newest_) = page.older_;
+}
+
+//takes the page out of its cache and of the budget, the caller frees or reuses it
+inline void removeSharedPage(sharedCache &cache, sharedPage &page) noexcept {
+	unlinkSharedPage(cache, page);
+	if (!page.pinned_) {
+		unlinkUnpinned(*cache.shard_, page);
+	}
+	--cache.pages_;
+	if (cache.purgeable_) {
+		sharedPages().bytes_.fetch_sub(page.size_, std::memory_order_relaxed);
+	}
+}
+
+//evicts the oldest unpinned pages of the stripe while the cache is over budget, returns one of size bytes for reuse
+inline sharedPage *evictFromShard(pageCacheShard &shard, const std::size_t size) noexcept {
+	sharedPageCache &pages = sharedPages();
+	sharedPage *reusable = nullptr;
+	while (shard.oldest_ && pages.overBudget(size)) {
+		sharedPage &victim = *shard.oldest_;
+		removeSharedPage(*victim.owner_, victim);
+		pages.evictions_.fetch_add(1, std::memory_order_relaxed);
+		if (!reusable && victim.size_ == size) {
+			reusable = &victim;
+		}
+		else {
+			sqlite3_free(&victim);
+		}
+	}
+	return reusable;
+}
+
+//other stripes, one lock at a time, for a stripe whose own pages are all pinned
+inline void evictFromOtherShards(const pageCacheShard &own, const std::size_t size) noexcept {
+	sharedPageCache &pages = sharedPages();
+	const std::size_t first = static_cast<std::size_t>(&own - pages.shards_.get());
+	for (std::size_t offset = 1; offset < pages.shardCount_ && pages.overBudget(size); ++offset) {
+		pageCacheShard &shard = pages.shards_[(first + offset) % pages.shardCount_];
+		const std::lock_guard<std::mutex> lock(shard.mutex_);
+		sqlite3_free(evictFromShard(shard, size));
+	}
+}
+
+inline void truncateSharedCache(sharedCache &cache, const unsigned limit) noexcept {
+	for (sharedPage *&bucket : cache.buckets_) {
+		sharedPage **link = &bucket;
+		while (sharedPage *const page = *link) {
+			if (page->key_ < limit) {
+				link = &page->hashNext_;
+				continue;
+			}
+			removeSharedPage(cache, *page);
+			sqlite3_free(page);
+		}
+	}
+}
+
+inline sqlite3_pcache *sharedCreate(const int pageSize, const int extraSize, const int purgeable) {
+	sharedPageCache &pages = sharedPages();
+	std::unique_ptr<sharedCache> cache(new (std::nothrow) sharedCache);
+	if (!cache) {
+		return nullptr;
+	}
+	try {
+		cache->buckets_.assign(64, nullptr);
+	}
+	catch (...) {
+		return nullptr;
+	}
+	cache->shard_ = &pages.shards_[pages.nextShard_.fetch_add(1, std::memory_order_relaxed) % pages.shardCount_];
+	cache->pageSize_ = pageSize;
+	cache->extraSize_ = extraSize;
+	cache->pageBytes_ = (sharedPageHeader + static_cast<std::size_t>(pageSize) + static_cast<std::size_t>(extraSize) + 7) & ~std::size_t{7};
+	cache->purgeable_ = purgeable != 0;
+	return reinterpret_cast<sqlite3_pcache *>(cache.release());
+}
+
+inline sqlite3_pcache_page *sharedFetch(sqlite3_pcache *const handle, const unsigned key, const int create) {
+	sharedCache &cache = sharedCacheOf(handle);
+	sharedPageCache &pages = sharedPages();
+	std::unique_lock<std::mutex> lock(cache.shard_->mutex_);
+	if (sharedPage *const page = findSharedPage(cache, key)) {
+		if (!page->pinned_) {
+			unlinkUnpinned(*cache.shard_, *page);
+			page->pinned_ = true;
+		}
+		pages.hits_.fetch_add(1, std::memory_order_relaxed);
+		return &page->page_;
+	}
+	if (create == 0) {
+		return nullptr;
+	}
+	pages.misses_.fetch_add(1, std::memory_order_relaxed);
+
+	sharedPage *page = nullptr;
+	if (cache.purgeable_) {
+		page = evictFromShard(*cache.shard_, cache.pageBytes_);
+		if (!page && pages.overBudget(cache.pageBytes_)) {
+			//only this cache adds its keys and SQLite serializes its calls, so the key cannot appear meanwhile
+			lock.unlock();
+			evictFromOtherShards(*cache.shard_, cache.pageBytes_);
+			lock.lock();
+			//SQLite spills dirty pages to unpin some and asks again with 2
+			if (create == 1 && pages.overBudget(cache.pageBytes_)) {
+				return nullptr;
+			}
+		}
+		pages.bytes_.fetch_add(cache.pageBytes_, std::memory_order_relaxed);
+	}
+	if (!page) {
+		page = static_cast<sharedPage *>(sqlite3_malloc64(cache.pageBytes_));
+		if (!page) {
+			if (cache.purgeable_) {
+				pages.bytes_.fetch_sub(cache.pageBytes_, std::memory_order_relaxed);
+			}
+			return nullptr;
+		}
+	}
+	char *const buffer = reinterpret_cast<char *>(page) + sharedPageHeader;
+	page->page_.pBuf = buffer;
+	page->page_.pExtra = buffer + cache.pageSize_;
+	//SQLite initializes a page whose extra bytes start with a null pointer
+	std::memset(page->page_.pExtra, 0, static_cast<std::size_t>(cache.extraSize_));
+	page->owner_ = &cache;
+	page->size_ = cache.pageBytes_;
+	page->key_ = key;
+	page->pinned_ = true;
+	linkSharedPage(cache, *page);
+	++cache.pages_;
+	return &page->page_;
+}
+
+inline void sharedUnpin(sqlite3_pcache *const handle, sqlite3_pcache_page *const unpinned, const int discard) {
+	sharedCache &cache = sharedCacheOf(handle);
+	sharedPage &page = *reinterpret_cast<sharedPage *>(unpinned);
+	const std::lock_guard<std::mutex> lock(cache.shard_->mutex_);
+	if (discard || !cache.purgeable_) {
+		removeSharedPage(cache, page);
+		sqlite3_free(&page);
+		return;
+	}
+	page.pinned_ = false;
+	pushUnpinned(*cache.shard_, page);
+	sqlite3_free(evictFromShard(*cache.shard_, 0));
+}
+
+inline void sharedRekey(sqlite3_pcache *const handle, sqlite3_pcache_page *const rekeyed, const unsigned, const unsigned newKey) {
+	sharedCache &cache = sharedCacheOf(handle);
+	sharedPage &page = *reinterpret_cast<sharedPage *>(rekeyed);
+	const std::lock_guard<std::mutex> lock(cache.shard_->mutex_);
+	if (sharedPage *const existing = findSharedPage(cache, newKey)) {
+		removeSharedPage(cache, *existing);
+		sqlite3_free(existing);
+	}
+	unlinkSharedPage(cache, page);
+	page.key_ = newKey;
+	page.hashNext_ = sharedBucket(cache, newKey);
+	sharedBucket(cache, newKey) = &page;
+}
+
+inline void sharedTruncate(sqlite3_pcache *const handle, const unsigned limit) {
+	sharedCache &cache = sharedCacheOf(handle);
+	const std::lock_guard<std::mutex> lock(cache.shard_->mutex_);
+	truncateSharedCache(cache, limit);
+}
+
+inline void sharedDestroy(sqlite3_pcache *const handle) {
+	sharedCache *const cache = &sharedCacheOf(handle);
+	{
+		const std::lock_guard<std::mutex> lock(cache->shard_->mutex_);
+		truncateSharedCache(*cache, 0);
+	}
+	delete cache;
+}
+
+inline void sharedShrink(sqlite3_pcache *const handle) {
+	sharedCache &cache = sharedCacheOf(handle);
+	const std::lock_guard<std::mutex> lock(cache.shard_->mutex_);
+	for (sharedPage *&bucket : cache.buckets_) {
+		sharedPage **link = &bucket;
+		while (sharedPage *const page = *link) {
+			if (page->pinned_) {
+				link = &page->hashNext_;
+				continue;
+			}
+			removeSharedPage(cache, *page);
+			sqlite3_free(page);
+		}
+	}
+}
+
+inline int sharedPageCount(sqlite3_pcache *const handle) {
+	sharedCache &cache = sharedCacheOf(handle);
+	const std::lock_guard<std::mutex> lock(cache.shard_->mutex_);
+	return static_cast<int>(cache.pages_);
+}
+
+inline sqlite3_pcache_methods2 sharedPageCacheMethods() noexcept {
+	sqlite3_pcache_methods2 methods{};
+	methods.iVersion = 1;
+	methods.xInit = [](void *) {
+		return SQLITE_OK;
+	};
+	methods.xCreate = sharedCreate;
+	//the budget is global, a per-connection size does not apply
+	methods.xCachesize = [](sqlite3_pcache *, int) {
+	};
+	methods.xPagecount = sharedPageCount;
+	methods.xFetch = sharedFetch;
+	methods.xUnpin = sharedUnpin;
+	methods.xRekey = sharedRekey;
+	methods.xTruncate = sharedTruncate;
+	methods.xDestroy = sharedDestroy;
+	methods.xShrink = sharedShrink;
+	return methods;
+}
+
+//block sizes of the pooled allocator, 16 bytes apart up to 128 and four classes per power of two above
+constexpr std::array<std::uint32_t, 20> poolSizes{16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+constexpr std::size_t poolClassCount = poolSizes.size();
+constexpr std::size_t poolLargest = poolSizes.back();
+constexpr std::size_t poolSlabBytes = 64 * 1024;
+//blocks moved between a thread and the shared lists at a time, and the most a thread keeps of a class
+constexpr unsigned poolBatch = 32;
+constexpr unsigned poolThreadLimit = 2 * poolBatch;
+//the size in front of every block keeps the 8-byte alignment SQLite needs
+constexpr std::size_t poolHeader = 8;
+
+constexpr std::array<std::uint8_t, poolLargest / 16 + 1> poolClassTable = [] {
+	std::array<std::uint8_t, poolLargest / 16 + 1> table{};
+	std::size_t sizeClass = 0;
+	for (std::size_t slot = 0; slot < table.size(); ++slot) {
+		while (poolSizes[sizeClass] < slot * 16) {
+			++sizeClass;
+		}
+		table[slot] = static_cast<std::uint8_t>(sizeClass);
+	}
+	return table;
+}();
+
+inline std::size_t poolClassOf(const std::size_t size) noexcept {
+	return poolClassTable[(size + 15) / 16];
+}
+
+struct poolBlock {
+	poolBlock *next_;
+};
+
+struct poolList {
+	std::mutex mutex_;
+	poolBlock *free_{nullptr};
+};
+
+struct poolShared {
+	std::array<poolList, poolClassCount> lists_;
+	std::atomic<std::size_t> slabBytes_{0};
+	std::atomic<std::size_t> largeBytes_{0};
+};
+
+//never destroyed, blocks are freed until the very end of the process
+inline poolShared &poolLists() noexcept {
+	static poolShared *const lists = new poolShared;
+	return *lists;
+}
+
+//takes up to a batch of blocks of a class from the shared list, carving a new slab when it is empty
+inline poolBlock *poolRefill(const std::size_t sizeClass, unsigned &count) noexcept {
+	poolShared &shared = poolLists();
+	poolList &list = shared.lists_[sizeClass];
+	const std::size_t stride = poolHeader + poolSizes[sizeClass];
+	const std::lock_guard<std::mutex> lock(list.mutex_);
+	if (!list.free_) {
+		char *const slab = static_cast<char *>(std::malloc(poolSlabBytes));
+		if (!slab) {
+			return nullptr;
+		}
+		shared.slabBytes_.fetch_add(poolSlabBytes, std::memory_order_relaxed);
+		for (std::size_t offset = 0; offset + stride <= poolSlabBytes; offset += stride) {
+			poolBlock *const block = reinterpret_cast<poolBlock *>(slab + offset);
+			block->next_ = list.free_;
+			list.free_ = block;
+		}
+	}
+	poolBlock *const first = list.free_;
+	poolBlock *last = first;
+	count = 1;
+	while (count < poolBatch && last->next_) {
+		last = last->next_;
+		++count;
+	}
+	list.free_ = last->next_;
+	last->next_ = nullptr;
+	return first;
+}
+
+inline void poolRelease(const std::size_t sizeClass, poolBlock *const first, poolBlock *const last) noexcept {
+	poolList &list = poolLists().lists_[sizeClass];
+	const std::lock_guard<std::mutex> lock(list.mutex_);
+	last->next_ = list.free_;
+	list.free_ = first;
+}
+
+//0 before the cache of the thread exists, 1 while it does, 2 after its destructor ran, when blocks go to the shared lists directly
+inline int &poolThreadState() noexcept {
+	thread_local int state = 0;
+	return state;
+}
+
+struct poolThreadCache {
+	std::array<poolBlock *, poolClassCount> free_{};
+	std::array<unsigned, poolClassCount> count_{};
+
+	~poolThreadCache() {
+		for (std::size_t sizeClass = 0; sizeClass < poolClassCount; ++sizeClass) {
+			if (poolBlock *const first = free_[sizeClass]) {
+				poolBlock *last = first;
+				while (last->next_) {
+					last = last->next_;
+				}
+				poolRelease(sizeClass, first, last);
+			}
+		}
+		poolThreadState() = 2;
+	}
+};
+
+inline poolThreadCache *poolCache() noexcept {
+	if (poolThreadState() == 2) {
+		return nullptr;
+	}
+	thread_local poolThreadCache cache;
+	poolThreadState() = 1;
+	return &cache;
+}
+
+inline void *poolAllocate(const std::size_t size) noexcept {
+	std::uint64_t *header;
+	if (size > poolLargest) {
+		header = static_cast<std::uint64_t *>(std::malloc(poolHeader + size));
+		if (!header) {
+			return nullptr;
+		}
+		poolLists().largeBytes_.fetch_add(size, std::memory_order_relaxed);
+	}
+	else {
+		const std::size_t sizeClass = poolClassOf(size);
+		poolBlock *block;
+		if (poolThreadCache *const cache = poolCache()) {
+			if (!cache->free_[sizeClass]) {
+				cache->free_[sizeClass] = poolRefill(sizeClass, cache->count_[sizeClass]);
+				if (!cache->free_[sizeClass]) {
+					return nullptr;
+				}
+			}
+			block = cache->free_[sizeClass];
+			cache->free_[sizeClass] = block->next_;
+			--cache->count_[sizeClass];
+		}
+		else {
+			unsigned count = 0;
+			block = poolRefill(sizeClass, count);
+			if (!block) {
+				return nullptr;
+			}
+			if (block->next_) {
+				poolBlock *last = block->next_;
+				while (last->next_) {
+					last = last->next_;
+				}
+				poolRelease(sizeClass, block->next_, last);
+			}
+		}
+		header = reinterpret_cast<std::uint64_t *>(block);
+	}
+	*header = size > poolLargest ? size : poolSizes[poolClassOf(size)];
+	return header + 1;
+}
+
+inline std::size_t poolSize(void *const memory) noexcept {
+	return static_cast<std::size_t>(static_cast<std::uint64_t *>(memory)[-1]);
+}
+
+inline void poolFree(void *const memory) noexcept {
+	std::uint64_t *const header = static_cast<std::uint64_t *>(memory) - 1;
+	const std::size_t size = static_cast<std::size_t>(*header);
+	if (size > poolLargest) {
+		poolLists().largeBytes_.fetch_sub(size, std::memory_order_relaxed);
+		std::free(header);
+		return;
+	}
+	const std::size_t sizeClass = poolClassOf(size);
+	poolBlock *const block = reinterpret_cast<poolBlock *>(header);
+	poolThreadCache *const cache = poolCache();
+	if (!cache) {
+		block->next_ = nullptr;
+		poolRelease(sizeClass, block, block);
+		return;
+	}
+	block->next_ = cache->free_[sizeClass];
+	cache->free_[sizeClass] = block;
+	if (++cache->count_[sizeClass] > poolThreadLimit) {
+		//the blocks of a thread that frees what others allocated go back a batch at a time
+		poolBlock *last = block;
+		for (unsigned released = 1; released < poolBatch; ++released) {
+			last = last->next_;
+		}
+		cache->free_[sizeClass] = last->next_;
+		cache->count_[sizeClass] -= poolBatch;
+		poolRelease(sizeClass, block, last);
+	}
+}
+
+inline std::size_t poolRoundup(const std::size_t size) noexcept {
+	return size > poolLargest ? (size + 7) & ~std::size_t{7} : poolSizes[poolClassOf(size)];
+}
+
+inline sqlite3_mem_methods pooledAllocatorMethods() noexcept {
+	sqlite3_mem_methods methods{};
+	methods.xMalloc = [](const int size) {
+		return poolAllocate(poolRoundup(static_cast<std::size_t>(size)));
+	};
+	methods.xFree = poolFree;
+	methods.xRealloc = [](void *const memory, const int size) -> void * {
+		const std::size_t wanted = poolRoundup(static_cast<std::size_t>(size));
+		const std::size_t current = poolSize(memory);
+		if (wanted == current) {
+			return memory;
+		}
+		if (wanted > poolLargest && current > poolLargest) {
+			std::uint64_t *const header = static_cast<std::uint64_t *>(std::realloc(static_cast<std::uint64_t *>(memory) - 1, poolHeader + wanted));
+			if (!header) {
+				return nullptr;
+			}
+			poolLists().largeBytes_.fetch_add(wanted - current, std::memory_order_relaxed);
+			*header = wanted;
+			return header + 1;
+		}
+		void *const moved = poolAllocate(wanted);
+		if (moved) {
+			std::memcpy(moved, memory, std::min(wanted, current));
+			poolFree(memory);
+		}
+		return moved;
+	};
+	methods.xSize = [](void *const memory) {
+		return static_cast<int>(poolSize(memory));
+	};
+	methods.xRoundup = [](const int size) {
+		return static_cast<int>(poolRoundup(static_cast<std::size_t>(size)));
+	};
+	methods.xInit = [](void *) {
+		return SQLITE_OK;
+	};
+	methods.xShutdown = [](void *) {
+	};
+	return methods;
+}
+
+
+  
+// Process-wide configuration installed with sqlite3_config, which SQLite only accepts before it is initialized: configureSqlite
+// has to run before the first connection is opened, or anything else that initializes SQLite (registerIoUringVfs included).
+// The shared page cache is a sqlite3_pcache_methods2: the connections keep their own pages, as SQLite requires, but a single LRU per lock stripe
+// and one global budget decide which clean pages stay, so memory goes to the busiest connections instead of being reserved by every one of them.
+// When a stripe has nothing left to evict, the others are searched before a new page is refused or allocated over the budget.
+// The pooled allocator is a sqlite3_mem_methods carving the small allocations out of 64 KiB slabs by size class, which keeps
+// the short-lived parser, VDBE and value allocations of many connections from fragmenting the heap.
+
+//throws SQLITE_MISUSE when SQLite is already initialized or the configuration was already installed
+inline void configureSqlite(const GlobalOptions &options) {
+	static std::mutex mutex;
+	static bool configured = false;
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (configured) {
+		throw exception(SQLITE_MISUSE, "the global configuration is already installed");
+	}
+	//what is installed now, put back when a later step fails so that configureSqlite can be called again
+	sqlite3_mem_methods previousAllocator{};
+	sqlite3_pcache_methods2 previousPageCache{};
+	int result = sqlite3_config(SQLITE_CONFIG_GETMALLOC, &previousAllocator);
+	if (result == SQLITE_OK) {
+		result = sqlite3_config(SQLITE_CONFIG_GETPCACHE2, &previousPageCache);
+	}
+	if (result != SQLITE_OK) {
+		throw exception(result, "configureSqlite has to run before SQLite is initialized");
+	}
+	const auto restore = [&previousAllocator, &previousPageCache] {
+		sqlite3_config(SQLITE_CONFIG_PCACHE2, &previousPageCache);
+		sqlite3_config(SQLITE_CONFIG_MALLOC, &previousAllocator);
+	};
+	if (options.sharedPageCache_) {
+		sharedPageCache &pages = sharedPages();
+		pages.shardCount_ = std::max<std::size_t>(1, options.pageCacheShards_);
+		pages.shards_.reset(new pageCacheShard[pages.shardCount_]);
+		pages.budget_ = options.pageCacheBytes_;
+		const sqlite3_pcache_methods2 methods = sharedPageCacheMethods();
+		result = sqlite3_config(SQLITE_CONFIG_PCACHE2, &methods);
+	}
+	if (result == SQLITE_OK && options.pooledAllocator_) {
+		const sqlite3_mem_methods methods = pooledAllocatorMethods();
+		result = sqlite3_config(SQLITE_CONFIG_MALLOC, &methods);
+	}
+	if (result == SQLITE_OK) {
+		result = sqlite3_initialize();
+	}
+	if (result != SQLITE_OK) {
+		restore();
+		throw exception(result, sqlite3_errstr(result));
+	}
+	configured = true;
+}
+
+inline GlobalMemoryStats globalMemoryStats() noexcept {
+	const sharedPageCache &pages = sharedPages();
+	const poolShared &pool = poolLists();
+	return GlobalMemoryStats{pages.bytes_.load(std::memory_order_relaxed), pages.hits_.load(std::memory_order_relaxed), pages.misses_.load(std::memory_order_relaxed),
+		pages.evictions_.load(std::memory_order_relaxed), pool.slabBytes_.load(std::memory_order_relaxed), pool.largeBytes_.load(std::memory_order_relaxed)};
+}
+
+  
+struct IoUringVfsOptions {
+	//bytes of one read-ahead request, rounded up to a power of two of at least 64 KiB, so that no page straddles two requests
+	std::size_t readAheadSize_{256 * 1024};
+	//read-ahead requests kept in flight in front of a sequential scan
+	std::size_t readAheadDepth_{4};
+	//consecutive reads of adjacent pages before the read-ahead starts
+	int sequentialReads_{4};
+};
+
+struct IoUringVfsStats {
+	//reads of the database files that went to the kernel, and those served from a read-ahead request
+	unsigned long long reads_{0};
+	unsigned long long readAheadHits_{0};
+	unsigned long long readAheads_{0};
+	unsigned long long writes_{0};
+	//io_uring_enter calls, one for a read together with the read-ahead requests it starts
+	unsigned long long submissions_{0};
+};
+
+constexpr const char *ioUringVfsName = "io_uring";
+
+struct uringCounters {
+	std::atomic<unsigned long long> reads_{0};
+	std::atomic<unsigned long long> readAheadHits_{0};
+	std::atomic<unsigned long long> readAheads_{0};
+	std::atomic<unsigned long long> writes_{0};
+	std::atomic<unsigned long long> submissions_{0};
+};
+
+inline uringCounters &uringCounts() noexcept {
+	static uringCounters counts;
+	return counts;
+}
+
+inline void uringCount(std::atomic<unsigned long long> &counter) noexcept {
+	counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+//the completion of one submitted read or write, the user_data of its submission entry
+struct uringRequest {
+	int result_{0};
+	bool done_{true};
+};
+
+enum class uringOperation {
+	Read,
+	Write
+};
+
+#ifdef SQLITECPP_IO_URING
+
+// The submission and completion rings shared with the kernel, driven with the raw system calls so that liburing is not needed.
+// Requests in flight are kept below the size of the submission ring, the completion ring is twice as large and never overflows.
+class uringQueue {
+	int descriptor_{-1};
+	void *submissionRing_{MAP_FAILED};
+	std::size_t submissionRingSize_{0};
+	void *completionRing_{MAP_FAILED};
+	std::size_t completionRingSize_{0};
+	void *entries_{MAP_FAILED};
+	std::size_t entriesSize_{0};
+
+	unsigned *submissionTail_{nullptr};
+	unsigned *submissionArray_{nullptr};
+	unsigned submissionMask_{0};
+	unsigned *completionHead_{nullptr};
+	unsigned *completionTail_{nullptr};
+	io_uring_cqe *completions_{nullptr};
+	unsigned completionMask_{0};
+
+	unsigned capacity_{0};
+	unsigned tail_{0};
+	unsigned prepared_{0};
+	unsigned inFlight_{0};
+	//the completion of the cancellation settle() submits
+	uringRequest cancel_;
+
+	void *map(const std::size_t size, const long long offset) const noexcept {
+		return mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor_, offset);
+	}
+
+  public:
+
+	uringQueue() = default;
+	uringQueue(const uringQueue &) = delete;
+	uringQueue &operator=(const uringQueue &) = delete;
+
+	~uringQueue() {
+		close();
+	}
+
+	bool open(const unsigned depth) noexcept {
+		io_uring_params parameters{};
+		descriptor_ = static_cast<int>(syscall(__NR_io_uring_setup, depth, &parameters));
+		//IORING_OP_READ and IORING_OP_WRITE came with IORING_FEAT_RW_CUR_POS, in Linux 5.6
+		if (descriptor_ < 0 || !(parameters.features & IORING_FEAT_RW_CUR_POS)) {
+			close();
+			return false;
+		}
+		submissionRingSize_ = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+		completionRingSize_ = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+		const bool singleMap = (parameters.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (singleMap) {
+			submissionRingSize_ = completionRingSize_ = std::max(submissionRingSize_, completionRingSize_);
+		}
+		submissionRing_ = map(submissionRingSize_, IORING_OFF_SQ_RING);
+		completionRing_ = singleMap ? submissionRing_ : map(completionRingSize_, IORING_OFF_CQ_RING);
+		entriesSize_ = parameters.sq_entries * sizeof(io_uring_sqe);
+		entries_ = map(entriesSize_, IORING_OFF_SQES);
+		if (submissionRing_ == MAP_FAILED || completionRing_ == MAP_FAILED || entries_ == MAP_FAILED) {
+			close();
+			return false;
+		}
+
+		char *const submission = static_cast<char *>(submissionRing_);
+		submissionTail_ = reinterpret_cast<unsigned *>(submission + parameters.sq_off.tail);
+		submissionArray_ = reinterpret_cast<unsigned *>(submission + parameters.sq_off.array);
+		submissionMask_ = *reinterpret_cast<unsigned *>(submission + parameters.sq_off.ring_mask);
+		char *const completion = static_cast<char *>(completionRing_);
+		completionHead_ = reinterpret_cast<unsigned *>(completion + parameters.cq_off.head);
+		completionTail_ = reinterpret_cast<unsigned *>(completion + parameters.cq_off.tail);
+		completions_ = reinterpret_cast<io_uring_cqe *>(completion + parameters.cq_off.cqes);
+		completionMask_ = *reinterpret_cast<unsigned *>(completion + parameters.cq_off.ring_mask);
+		capacity_ = parameters.sq_entries;
+		tail_ = *submissionTail_;
+		return true;
+	}
+
+	void close() noexcept {
+		if (entries_ != MAP_FAILED) {
+			munmap(entries_, entriesSize_);
+		}
+		if (completionRing_ != MAP_FAILED && completionRing_ != submissionRing_) {
+			munmap(completionRing_, completionRingSize_);
+		}
+		if (submissionRing_ != MAP_FAILED) {
+			munmap(submissionRing_, submissionRingSize_);
+		}
+		if (descriptor_ >= 0) {
+			::close(descriptor_);
+		}
+		descriptor_ = -1;
+		submissionRing_ = completionRing_ = entries_ = MAP_FAILED;
+	}
+
+	io_uring_sqe &nextEntry(uringRequest &request) noexcept {
+		const unsigned index = tail_ & submissionMask_;
+		io_uring_sqe &entry = static_cast<io_uring_sqe *>(entries_)[index];
+		std::memset(&entry, 0, sizeof(entry));
+		entry.user_data = reinterpret_cast<unsigned long long>(&request);
+		submissionArray_[index] = index;
+		++tail_;
+		++prepared_;
+		++inFlight_;
+		request.done_ = false;
+		return entry;
+	}
+
+	//takes back the entries the kernel has not consumed, which it only does inside io_uring_enter, their requests end with -ECANCELED
+	void withdraw() noexcept {
+		for (; prepared_ > 0; --prepared_) {
+			--tail_;
+			--inFlight_;
+			const io_uring_sqe &entry = static_cast<io_uring_sqe *>(entries_)[tail_ & submissionMask_];
+			uringRequest &request = *reinterpret_cast<uringRequest *>(entry.user_data);
+			request.result_ = -ECANCELED;
+			request.done_ = true;
+		}
+		__atomic_store_n(submissionTail_, tail_, __ATOMIC_RELEASE);
+	}
+
+	// After io_uring_enter failed: the kernel may still read or write the buffer of request, which belongs to the caller,
+	// so it is cancelled and waited for. Completions are posted to the shared ring whether or not io_uring_enter succeeds.
+	void settle(uringRequest &request) noexcept {
+		withdraw();
+		reap();
+		if (!request.done_ && cancel_.done_ && inFlight_ < capacity_) {
+			io_uring_sqe &entry = nextEntry(cancel_);
+			entry.opcode = IORING_OP_ASYNC_CANCEL;
+			entry.fd = -1;
+			entry.addr = reinterpret_cast<unsigned long long>(&request);
+			if (!submit(false)) {
+				withdraw();
+			}
+		}
+		while (!request.done_ || !cancel_.done_) {
+			if (!submit(true)) {
+				std::this_thread::yield();
+			}
+			reap();
+		}
+	}
+
+	//queues a read or write of size bytes at offset without submitting it, false when the ring is full
+	bool prepare(const uringOperation operation, const int file, void *const buffer, const unsigned size, const long long offset, uringRequest &request) noexcept {
+		if (inFlight_ == capacity_) {
+			return false;
+		}
+		io_uring_sqe &entry = nextEntry(request);
+		entry.opcode = operation == uringOperation::Read ? IORING_OP_READ : IORING_OP_WRITE;
+		entry.fd = file;
+		entry.addr = reinterpret_cast<unsigned long long>(buffer);
+		entry.len = size;
+		entry.off = static_cast<unsigned long long>(offset);
+		return true;
+	}
+
+	//hands every prepared entry to the kernel in one call, which also waits for a completion when wait is set
+	bool submit(const bool wait) noexcept {
+		if (prepared_ == 0 && !wait) {
+			return true;
+		}
+		__atomic_store_n(submissionTail_, tail_, __ATOMIC_RELEASE);
+		for (;;) {
+			const long submitted = syscall(__NR_io_uring_enter, descriptor_, prepared_, wait ? 1u : 0u, wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+			if (submitted < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return false;
+			}
+			uringCount(uringCounts().submissions_);
+			prepared_ -= static_cast<unsigned>(submitted);
+			if (prepared_ == 0) {
+				return true;
+			}
+		}
+	}
+
+	//marks the requests the kernel completed as done
+	void reap() noexcept {
+		unsigned head = *completionHead_;
+		const unsigned tail = __atomic_load_n(completionTail_, __ATOMIC_ACQUIRE);
+		for (; head != tail; ++head) {
+			const io_uring_cqe &completion = completions_[head & completionMask_];
+			uringRequest &request = *reinterpret_cast<uringRequest *>(completion.user_data);
+			request.result_ = completion.res;
+			request.done_ = true;
+			--inFlight_;
+		}
+		__atomic_store_n(completionHead_, head, __ATOMIC_RELEASE);
+	}
+
+	//submits what is prepared and waits until request is done, false when io_uring_enter failed, the request is then cancelled or done anyway
+	bool wait(uringRequest &request) noexcept {
+		reap();
+		while (!request.done_) {
+			if (!submit(true)) {
+				settle(request);
+				return false;
+			}
+			reap();
+		}
+		return true;
+	}
+};
+
+// The unix VFS keeps the descriptor after the methods, VFS and inode pointers of its unixFile, a layout unchanged since 3.7.
+// It is only used when fstat finds the file opened under that name behind it, every other file stays with the unix VFS.
+inline int unixDescriptor(sqlite3_file *const real, const char *const name) noexcept {
+	struct unixFilePrefix {
+		const sqlite3_io_methods *methods_;
+		sqlite3_vfs *vfs_;
+		void *inode_;
+		int descriptor_;
+	};
+	const int descriptor = reinterpret_cast<const unixFilePrefix *>(real)->descriptor_;
+	struct stat opened{};
+	struct stat named{};
+	if (descriptor < 0 || fstat(descriptor, &opened) != 0 || stat(name, &named) != 0 || opened.st_dev != named.st_dev || opened.st_ino != named.st_ino) {
+		return -1;
+	}
+	return descriptor;
+}
+
+inline bool uringTransient(const int result) noexcept {
+	return result == -EINTR || result == -EAGAIN;
+}
+
+inline bool uringFull(const int result) noexcept {
+	return result == -ENOSPC || result == -EDQUOT;
+}
+
+#else
+
+class uringQueue {
+  public:
+
+	bool open(const unsigned) noexcept {
+		return false;
+	}
+
+	bool prepare(const uringOperation, const int, void *const, const unsigned, const long long, uringRequest &) noexcept {
+		return false;
+	}
+
+	bool submit(const bool) noexcept {
+		return false;
+	}
+
+	void reap() noexcept {
+	}
+
+	bool wait(uringRequest &request) noexcept {
+		return request.done_;
+	}
+};
+
+inline int unixDescriptor(sqlite3_file *const, const char *const) noexcept {
+	return -1;
+}
+
+inline bool uringTransient(const int) noexcept {
+	return false;
+}
+
+inline bool uringFull(const int) noexcept {
+	return false;
+}
+
+#endif
+
+//one read-ahead request, offset_ is -1 once it is dropped, its buffer is reused only after the kernel is done with it
+struct readAheadBlock {
+	std::unique_ptr<char[]> buffer_;
+	long long offset_{-1};
+	uringRequest request_;
+};
+
+struct uringFileState {
+	uringQueue queue_;
+	int descriptor_{-1};
+	long long blockSize_{0};
+	int sequentialReads_{0};
+	std::vector<readAheadBlock> blocks_;
+	//where the next read starts if the access is sequential, and how many reads in a row were
+	long long nextOffset_{-1};
+	int streak_{0};
+};
+
+struct uringFile {
+	sqlite3_file base_;
+	sqlite3_file *real_;
+	uringFileState *state_;
+};
+
+//the file of the unix VFS follows the wrapper in the memory SQLite allocates for szOsFile
+constexpr std::size_t uringRealFileOffset = (sizeof(uringFile) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+inline uringFile &uringFileOf(sqlite3_file *const file) noexcept {
+	return *reinterpret_cast<uringFile *>(file);
+}
+
+inline sqlite3_file *uringReal(sqlite3_file *const file) noexcept {
+	return uringFileOf(file).real_;
+}
+
+inline readAheadBlock *findReadAhead(uringFileState &state, const long long offset, const int amount) noexcept {
+	for (readAheadBlock &block : state.blocks_) {
+		if (block.offset_ >= 0 && block.offset_ <= offset && offset + amount <= block.offset_ + state.blockSize_) {
+			return &block;
+		}
+	}
+	return nullptr;
+}
+
+inline void dropReadAhead(uringFileState &state, const long long offset = 0, const long long end = LLONG_MAX) noexcept {
+	for (readAheadBlock &block : state.blocks_) {
+		if (block.offset_ >= 0 && block.offset_ < end && offset < block.offset_ + state.blockSize_) {
+			block.offset_ = -1;
+		}
+	}
+}
+
+//prepares requests for the blocks from the one holding offset on, into blocks the scan has passed, without submitting them
+inline void startReadAhead(uringFileState &state, const long long offset) noexcept {
+	if (state.streak_ < state.sequentialReads_) {
+		return;
+	}
+	state.queue_.reap();
+	const long long first = offset & ~(state.blockSize_ - 1);
+	for (std::size_t ahead = 0; ahead < state.blocks_.size(); ++ahead) {
+		const long long wanted = first + static_cast<long long>(ahead) * state.blockSize_;
+		if (std::any_of(state.blocks_.begin(), state.blocks_.end(), [wanted](const readAheadBlock &block) { return block.offset_ == wanted; })) {
+			continue;
+		}
+		const auto passed = std::find_if(state.blocks_.begin(), state.blocks_.end(), [first](const readAheadBlock &block) {
+			return block.request_.done_ && block.offset_ < first;
+		});
+		if (passed == state.blocks_.end()) {
+			return;
+		}
+		if (!passed->buffer_) {
+			passed->buffer_.reset(new (std::nothrow) char[static_cast<std::size_t>(state.blockSize_)]);
+		}
+		if (!passed->buffer_ || !state.queue_.prepare(uringOperation::Read, state.descriptor_, passed->buffer_.get(), static_cast<unsigned>(state.blockSize_), wanted, passed->request_)) {
+			return;
+		}
+		passed->offset_ = wanted;
+		uringCount(uringCounts().readAheads_);
+	}
+}
+
+inline int readFromReadAhead(uringFileState &state, readAheadBlock &block, char *const target, const int amount, const long long offset) noexcept {
+	const long long available = std::clamp<long long>(block.request_.result_ - (offset - block.offset_), 0, amount);
+	std::memcpy(target, block.buffer_.get() + (offset - block.offset_), static_cast<std::size_t>(available));
+	uringCount(uringCounts().readAheadHits_);
+	//a read the read-ahead served keeps it going, even when the scan skipped a page
+	state.streak_ = std::max(state.streak_, state.sequentialReads_);
+	startReadAhead(state, offset + amount);
+	state.queue_.submit(false);
+	if (available < amount) {
+		std::memset(target + available, 0, static_cast<std::size_t>(amount - available));
+		return SQLITE_IOERR_SHORT_READ;
+	}
+	return SQLITE_OK;
+}
+
+inline int uringRead(sqlite3_file *const file, void *const buffer, const int amount, const sqlite3_int64 offset) {
+	uringFile &self = uringFileOf(file);
+	if (!self.state_) {
+		return self.real_->pMethods->xRead(self.real_, buffer, amount, offset);
+	}
+	uringFileState &state = *self.state_;
+	state.streak_ = offset == state.nextOffset_ ? state.streak_ + 1 : 0;
+	state.nextOffset_ = offset + amount;
+	char *const target = static_cast<char *>(buffer);
+	if (readAheadBlock *const block = findReadAhead(state, offset, amount)) {
+		if (!state.queue_.wait(block->request_)) {
+			return SQLITE_IOERR_READ;
+		}
+		if (block->request_.result_ >= 0) {
+			return readFromReadAhead(state, *block, target, amount, offset);
+		}
+		block->offset_ = -1;
+	}
+
+	//the read goes to the kernel in the same submission as the read-ahead it starts
+	int done = 0;
+	while (done < amount) {
+		uringRequest request;
+		if (!state.queue_.prepare(uringOperation::Read, state.descriptor_, target + done, static_cast<unsigned>(amount - done), offset + done, request)) {
+			return SQLITE_IOERR_READ;
+		}
+		if (done == 0) {
+			startReadAhead(state, offset + amount);
+		}
+		if (!state.queue_.wait(request)) {
+			return SQLITE_IOERR_READ;
+		}
+		uringCount(uringCounts().reads_);
+		if (uringTransient(request.result_)) {
+			continue;
+		}
+		if (request.result_ < 0) {
+			return SQLITE_IOERR_READ;
+		}
+		if (request.result_ == 0) {
+			std::memset(target + done, 0, static_cast<std::size_t>(amount - done));
+			return SQLITE_IOERR_SHORT_READ;
+		}
+		done += request.result_;
+	}
+	return SQLITE_OK;
+}
+
+inline int uringWrite(sqlite3_file *const file, const void *const buffer, const int amount, const sqlite3_int64 offset) {
+	uringFile &self = uringFileOf(file);
+	if (!self.state_) {
+		return self.real_->pMethods->xWrite(self.real_, buffer, amount, offset);
+	}
+	uringFileState &state = *self.state_;
+	dropReadAhead(state, offset, offset + amount);
+	char *const source = static_cast<char *>(const_cast<void *>(buffer));
+	int done = 0;
+	while (done < amount) {
+		uringRequest request;
+		if (!state.queue_.prepare(uringOperation::Write, state.descriptor_, source + done, static_cast<unsigned>(amount - done), offset + done, request) || !state.queue_.wait(request)) {
+			return SQLITE_IOERR_WRITE;
+		}
+		if (uringTransient(request.result_)) {
+			continue;
+		}
+		if (uringFull(request.result_)) {
+			return SQLITE_FULL;
+		}
+		if (request.result_ <= 0) {
+			return SQLITE_IOERR_WRITE;
+		}
+		done += request.result_;
+	}
+	uringCount(uringCounts().writes_);
+	return SQLITE_OK;
+}
+
+inline int uringClose(sqlite3_file *const file) {
+	uringFile &self = uringFileOf(file);
+	if (uringFileState *const state = self.state_) {
+		//the kernel may still be reading into dropped blocks, their buffers are leaked if it cannot be waited for
+		if (std::all_of(state->blocks_.begin(), state->blocks_.end(), [state](readAheadBlock &block) { return state->queue_.wait(block.request_); })) {
+			delete state;
+		}
+		self.state_ = nullptr;
+	}
+	return self.real_->pMethods->xClose(self.real_);
+}
+
+//a lock change can follow writes of another connection, so the read-ahead is dropped
+inline void dropOnLockChange(sqlite3_file *const file) noexcept {
+	if (uringFileState *const state = uringFileOf(file).state_) {
+		dropReadAhead(*state);
+	}
+}
+
+inline const sqlite3_io_methods *uringMethods(const int version) noexcept {
+	static const std::array<sqlite3_io_methods, 3> versions = [] {
+		std::array<sqlite3_io_methods, 3> methods{};
+		for (int level = 1; level <= 3; ++level) {
+			sqlite3_io_methods &method = methods[level - 1];
+			method.iVersion = level;
+			method.xClose = uringClose;
+			method.xRead = uringRead;
+			method.xWrite = uringWrite;
+			method.xTruncate = [](sqlite3_file *const file, const sqlite3_int64 size) {
+				dropOnLockChange(file);
+				return uringReal(file)->pMethods->xTruncate(uringReal(file), size);
+			};
+			method.xSync = [](sqlite3_file *const file, const int flags) {
+				return uringReal(file)->pMethods->xSync(uringReal(file), flags);
+			};
+			method.xFileSize = [](sqlite3_file *const file, sqlite3_int64 *const size) {
+				return uringReal(file)->pMethods->xFileSize(uringReal(file), size);
+			};
+			method.xLock = [](sqlite3_file *const file, const int lock) {
+				dropOnLockChange(file);
+				return uringReal(file)->pMethods->xLock(uringReal(file), lock);
+			};
+			method.xUnlock = [](sqlite3_file *const file, const int lock) {
+				dropOnLockChange(file);
+				return uringReal(file)->pMethods->xUnlock(uringReal(file), lock);
+			};
+			method.xCheckReservedLock = [](sqlite3_file *const file, int *const reserved) {
+				return uringReal(file)->pMethods->xCheckReservedLock(uringReal(file), reserved);
+			};
+			method.xFileControl = [](sqlite3_file *const file, const int operation, void *const argument) {
+				return uringReal(file)->pMethods->xFileControl(uringReal(file), operation, argument);
+			};
+			method.xSectorSize = [](sqlite3_file *const file) {
+				return uringReal(file)->pMethods->xSectorSize(uringReal(file));
+			};
+			method.xDeviceCharacteristics = [](sqlite3_file *const file) {
+				return uringReal(file)->pMethods->xDeviceCharacteristics(uringReal(file));
+			};
+			if (level >= 2) {
+				method.xShmMap = [](sqlite3_file *const file, const int page, const int pageSize, const int extend, void volatile **const memory) {
+					return uringReal(file)->pMethods->xShmMap(uringReal(file), page, pageSize, extend, memory);
+				};
+				//every WAL read transaction starts with a shared memory lock, which covers checkpoints of other connections
+				method.xShmLock = [](sqlite3_file *const file, const int offset, const int count, const int flags) {
+					dropOnLockChange(file);
+					return uringReal(file)->pMethods->xShmLock(uringReal(file), offset, count, flags);
+				};
+				method.xShmBarrier = [](sqlite3_file *const file) {
+					dropOnLockChange(file);
+					uringReal(file)->pMethods->xShmBarrier(uringReal(file));
+				};
+				method.xShmUnmap = [](sqlite3_file *const file, const int deleteFlag) {
+					return uringReal(file)->pMethods->xShmUnmap(uringReal(file), deleteFlag);
+				};
+			}
+			if (level >= 3) {
+				method.xFetch = [](sqlite3_file *const file, const sqlite3_int64 offset, const int amount, void **const pointer) {
+					return uringReal(file)->pMethods->xFetch(uringReal(file), offset, amount, pointer);
+				};
+				method.xUnfetch = [](sqlite3_file *const file, const sqlite3_int64 offset, void *const pointer) {
+					return uringReal(file)->pMethods->xUnfetch(uringReal(file), offset, pointer);
+				};
+			}
+		}
+		return methods;
+	}();
+	return &versions[static_cast<std::size_t>(std::clamp(version, 1, 3) - 1)];
+}
+
+struct uringVfs {
+	sqlite3_vfs vfs_{};
+	sqlite3_vfs *base_{nullptr};
+	long long blockSize_{0};
+	std::size_t depth_{0};
+	int sequentialReads_{0};
+	bool available_{false};
+};
+
+inline sqlite3_vfs *uringBase(sqlite3_vfs *const vfs) noexcept {
+	return static_cast<uringVfs *>(vfs->pAppData)->base_;
+}
+
+inline uringFileState *openUringState(const uringVfs &vfs, sqlite3_file *const real, const char *const name) noexcept {
+	const int descriptor = unixDescriptor(real, name);
+	if (descriptor < 0) {
+		return nullptr;
+	}
+	try {
+		auto state = std::make_unique<uringFileState>();
+		state->descriptor_ = descriptor;
+		state->blockSize_ = vfs.blockSize_;
+		state->sequentialReads_ = vfs.sequentialReads_;
+		state->blocks_.resize(vfs.depth_);
+		//one entry for the read or the write, one to spare
+		if (!state->queue_.open(static_cast<unsigned>(vfs.depth_) + 2)) {
+			return nullptr;
+		}
+		return state.release();
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+inline int uringOpen(sqlite3_vfs *const vfs, const char *const name, sqlite3_file *const file, const int flags, int *const outFlags) {
+	const uringVfs &self = *static_cast<const uringVfs *>(vfs->pAppData);
+	uringFile &wrapper = uringFileOf(file);
+	wrapper.base_.pMethods = nullptr;
+	wrapper.real_ = reinterpret_cast<sqlite3_file *>(reinterpret_cast<char *>(file) + uringRealFileOffset);
+	wrapper.state_ = nullptr;
+	const int result = self.base_->xOpen(self.base_, name, wrapper.real_, flags, outFlags);
+	//SQLite closes a file with methods even when opening it failed
+	if (wrapper.real_->pMethods) {
+		if (result == SQLITE_OK && self.available_ && name && (flags & SQLITE_OPEN_MAIN_DB)) {
+			wrapper.state_ = openUringState(self, wrapper.real_, name);
+		}
+		wrapper.base_.pMethods = uringMethods(wrapper.real_->pMethods->iVersion);
+	}
+	return result;
+}
+
+inline void forwardToBase(sqlite3_vfs &vfs) noexcept {
+	vfs.xOpen = uringOpen;
+	vfs.xDelete = [](sqlite3_vfs *const self, const char *const name, const int syncDirectory) {
+		return uringBase(self)->xDelete(uringBase(self), name, syncDirectory);
+	};
+	vfs.xAccess = [](sqlite3_vfs *const self, const char *const name, const int flags, int *const result) {
+		return uringBase(self)->xAccess(uringBase(self), name, flags, result);
+	};
+	vfs.xFullPathname = [](sqlite3_vfs *const self, const char *const name, const int size, char *const path) {
+		return uringBase(self)->xFullPathname(uringBase(self), name, size, path);
+	};
+	vfs.xDlOpen = [](sqlite3_vfs *const self, const char *const name) {
+		return uringBase(self)->xDlOpen(uringBase(self), name);
+	};
+	vfs.xDlError = [](sqlite3_vfs *const self, const int size, char *const message) {
+		uringBase(self)->xDlError(uringBase(self), size, message);
+	};
+	vfs.xDlSym = [](sqlite3_vfs *const self, void *const library, const char *const symbol) {
+		return uringBase(self)->xDlSym(uringBase(self), library, symbol);
+	};
+	vfs.xDlClose = [](sqlite3_vfs *const self, void *const library) {
+		uringBase(self)->xDlClose(uringBase(self), library);
+	};
+	vfs.xRandomness = [](sqlite3_vfs *const self, const int size, char *const output) {
+		return uringBase(self)->xRandomness(uringBase(self), size, output);
+	};
+	vfs.xSleep = [](sqlite3_vfs *const self, const int microseconds) {
+		return uringBase(self)->xSleep(uringBase(self), microseconds);
+	};
+	vfs.xCurrentTime = [](sqlite3_vfs *const self, double *const time) {
+		return uringBase(self)->xCurrentTime(uringBase(self), time);
+	};
+	vfs.xGetLastError = [](sqlite3_vfs *const self, const int size, char *const message) {
+		return uringBase(self)->xGetLastError(uringBase(self), size, message);
+	};
+	vfs.xCurrentTimeInt64 = [](sqlite3_vfs *const self, sqlite3_int64 *const time) {
+		return uringBase(self)->xCurrentTimeInt64(uringBase(self), time);
+	};
+	vfs.xSetSystemCall = [](sqlite3_vfs *const self, const char *const name, const sqlite3_syscall_ptr call) {
+		return uringBase(self)->xSetSystemCall(uringBase(self), name, call);
+	};
+	vfs.xGetSystemCall = [](sqlite3_vfs *const self, const char *const name) {
+		return uringBase(self)->xGetSystemCall(uringBase(self), name);
+	};
+	vfs.xNextSystemCall = [](sqlite3_vfs *const self, const char *const name) {
+		return uringBase(self)->xNextSystemCall(uringBase(self), name);
+	};
+}
+
+
+  
+// A VFS named "io_uring" over the default one ("unix"), to be selected with SqliteConnection::open or OpenOptions::vfs_.
+// Reads and writes of main database files go through an io_uring per open file, the locks, shared memory, syncs and the
+// journal and WAL files stay with the default VFS. After a few reads of adjacent pages, the next readAheadDepth_ blocks of
+// the file are requested asynchronously in the same submission as the read, so a scan finds its pages already read.
+// The read-ahead is dropped on every lock change and on writes over it, so it never outlives the transaction it was read in.
+// Writes are not deferred past xWrite: SQLite orders them against journal deletion and WAL index updates, which the VFS
+// does not see. Where io_uring is unavailable (not Linux, a kernel before 5.6, or io_uring disabled) every call goes to the default VFS.
+
+//registers the VFS once per process, later calls only make it the default, returns whether io_uring is in use
+inline bool registerIoUringVfs(const IoUringVfsOptions &options = IoUringVfsOptions{}, const bool makeDefault = false) {
+	static std::mutex mutex;
+	static uringVfs vfs;
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (vfs.base_) {
+		if (makeDefault) {
+			sqlite3_vfs_register(&vfs.vfs_, 1);
+		}
+		return vfs.available_;
+	}
+
+	sqlite3_vfs *const base = sqlite3_vfs_find(nullptr);
+	if (!base) {
+		throw exception(SQLITE_ERROR, "no default VFS to register the io_uring VFS over");
+	}
+	long long blockSize = 64 * 1024;
+	while (blockSize < static_cast<long long>(options.readAheadSize_) && blockSize < (1LL << 30)) {
+		blockSize *= 2;
+	}
+	vfs.blockSize_ = blockSize;
+	vfs.depth_ = std::min<std::size_t>(options.readAheadDepth_, 64);
+	vfs.sequentialReads_ = options.sequentialReads_;
+	uringQueue probe;
+	vfs.available_ = std::strncmp(base->zName, "unix", 4) == 0 && probe.open(2);
+
+	vfs.vfs_.iVersion = base->iVersion;
+	vfs.vfs_.szOsFile = static_cast<int>(uringRealFileOffset) + base->szOsFile;
+	vfs.vfs_.mxPathname = base->mxPathname;
+	vfs.vfs_.zName = ioUringVfsName;
+	vfs.vfs_.pAppData = &vfs;
+	forwardToBase(vfs.vfs_);
+	vfs.base_ = base;
+	const int result = sqlite3_vfs_register(&vfs.vfs_, makeDefault ? 1 : 0);
+	if (result != SQLITE_OK) {
+		vfs.base_ = nullptr;
+		throw exception(result, sqlite3_errstr(result));
+	}
+	return vfs.available_;
+}
+
+//counts of every file opened through the VFS since the process started
+inline IoUringVfsStats ioUringVfsStats() noexcept {
+	const uringCounters &counts = uringCounts();
+	return IoUringVfsStats{counts.reads_.load(std::memory_order_relaxed), counts.readAheadHits_.load(std::memory_order_relaxed), counts.readAheads_.load(std::memory_order_relaxed),
+		counts.writes_.load(std::memory_order_relaxed), counts.submissions_.load(std::memory_order_relaxed)};
+}
+
+
+class SqliteRow : public sqliteReader<SqliteRow> {
 
 	sqlite3_stmt *statement_{nullptr};
+	wideTextBuffers *wideText_{nullptr};
+	//for a row made from a bare statement handle
+	mutable wideTextBuffers ownWideText_;
 
   public:
   
@@ -369,6 +6374,13 @@ class SqliteRow : public sqliteReader<SqliteRow> {
 	
 	SqliteRow(sqlite3_stmt *const statement) noexcept : statement_{statement} {
 	}
+	
+	SqliteRow(const SqliteStatement &statement) noexcept : statement_{statement.getABI()}, wideText_{&statement.wideText()} {
+	}
+
+	wideTextBuffers &wideText() const noexcept {
+		return wideText_ ? *wideText_ : ownWideText_;
+	}
 };
 
 
@@ -399,7 +6411,7 @@ class rowIterator {
 	}
 
 	SqliteRow operator*() const noexcept {
-		return SqliteRow(statement_->getABI());
+		return SqliteRow(*statement_);
 	}
 };
 
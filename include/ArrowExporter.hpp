@@ -0,0 +1,123 @@
+#ifndef IncludeSqliteArrowExporter_
+#define IncludeSqliteArrowExporter_
+
+#include "SqliteStatement.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// The Apache Arrow C Data Interface, as given by its specification, so that no Arrow headers are needed
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+	const char *format;
+	const char *name;
+	const char *metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema **children;
+	struct ArrowSchema *dictionary;
+	void (*release)(struct ArrowSchema *);
+	void *private_data;
+};
+
+struct ArrowArray {
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void **buffers;
+	struct ArrowArray **children;
+	struct ArrowArray *dictionary;
+	void (*release)(struct ArrowArray *);
+	void *private_data;
+};
+
+#endif
+
+
+namespace Sqlite {
+
+// Runs a statement and exports its rows through the Arrow C Data Interface, in record batches of at most batchSize_ rows:
+// a struct array ("+s") with an int64 ("l"), float64 ("g"), utf8 ("u") or binary ("z") child per column.
+// The column types are taken from the declared types and the first batch, a column of nulls only is exported as utf8.
+// The buffers of a batch are those of the ResultSet it was read into, which lives until the consumer releases the batch.
+class ArrowExporter {
+
+	//what an exported array or schema points into, shared with its children, so that a child moved out by the consumer outlives its parent
+	struct exportedData {
+		std::atomic<std::size_t> references_{0};
+
+		virtual ~exportedData() = default;
+	};
+
+	struct batchData : public exportedData {
+		ResultSet result_;
+		std::vector<ArrowArray> children_;
+		std::vector<ArrowArray *> childPointers_;
+		std::vector<std::array<const void *, 3>> buffers_;
+		const void *structBuffers_[1]{nullptr};
+	};
+
+	struct schemaData : public exportedData {
+		//the consumer may keep the schema after the exporter is gone
+		std::vector<std::string> names_;
+		std::vector<ArrowSchema> children_;
+		std::vector<ArrowSchema *> childPointers_;
+	};
+
+	const SqliteStatement &statement_;
+	std::size_t batchSize_;
+	std::vector<std::string> names_;
+	std::vector<int> types_;
+	//the first batch, read when the schema is exported
+	ResultSet pending_;
+	bool started_{false};
+	bool hasPending_{false};
+	bool done_{false};
+
+	template <typename Structure>
+	static void release(Structure *const structure) noexcept {
+		for (int64_t child = 0; child < structure->n_children; ++child) {
+			if (structure->children[child]->release != nullptr) {
+				structure->children[child]->release(structure->children[child]);
+			}
+		}
+		exportedData *const data = static_cast<exportedData *>(structure->private_data);
+		if (data->references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			delete data;
+		}
+		structure->release = nullptr;
+	}
+
+	static const char *format(const int type) noexcept;
+
+	void fill(ResultSet &result);
+
+	void start();
+
+  public:
+
+	//the statement is stepped from where it is, with its parameters already bound
+	explicit ArrowExporter(const SqliteStatement &statement, const std::size_t batchSize = 65536) : statement_{statement}, batchSize_{std::max<std::size_t>(batchSize, 1)} {
+	}
+
+	ArrowExporter(const ArrowExporter &) = delete;
+	ArrowExporter &operator=(const ArrowExporter &) = delete;
+
+	void exportSchema(ArrowSchema *const out);
+
+	//false once every row has been exported, out is left untouched then
+	bool exportBatch(ArrowArray *const out);
+};
+
+}
+
+#endif
@@ -0,0 +1,475 @@
+#ifndef IncludeSqliteAsyncExecutor_
+#define IncludeSqliteAsyncExecutor_
+
+#include "Transaction.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
+namespace Sqlite {
+
+// The result of a job, or the exception it threw, kept on the worker thread until the job is completed.
+template <typename Result>
+class asyncOutcome {
+
+	std::optional<std::conditional_t<std::is_void_v<Result>, bool, Result>> value_;
+	std::exception_ptr error_;
+
+  public:
+
+	template <typename Function>
+	bool run(Function &function, const SqliteConnection &connection) noexcept {
+		try {
+			if constexpr (std::is_void_v<Result>) {
+				function(connection);
+				value_.emplace(true);
+			}
+			else {
+				value_.emplace(function(connection));
+			}
+			return true;
+		}
+		catch (...) {
+			error_ = std::current_exception();
+			return false;
+		}
+	}
+
+	void fail(std::exception_ptr error) noexcept {
+		value_.reset();
+		error_ = std::move(error);
+	}
+
+	void deliver(std::promise<Result> &promise) noexcept {
+		try {
+			if (error_) {
+				promise.set_exception(std::move(error_));
+			}
+			else if constexpr (std::is_void_v<Result>) {
+				promise.set_value();
+			}
+			else {
+				promise.set_value(std::move(*value_));
+			}
+		}
+		catch (...) {
+		}
+	}
+
+	Result take() {
+		if (error_) {
+			std::rethrow_exception(error_);
+		}
+		if constexpr (!std::is_void_v<Result>) {
+			return std::move(*value_);
+		}
+	}
+};
+
+
+class asyncJob {
+
+  public:
+
+	const bool write_;
+
+	explicit asyncJob(const bool write) noexcept : write_{write} {
+	}
+
+	virtual ~asyncJob() = default;
+
+	//runs the work and keeps its outcome, returns false when it threw
+	virtual bool run(const SqliteConnection &connection) noexcept = 0;
+
+	//replaces the outcome, when the transaction of a batch of writes failed
+	virtual void fail(std::exception_ptr error) noexcept = 0;
+
+	//hands the outcome to the caller, once the work is committed
+	virtual void complete() noexcept = 0;
+};
+
+
+template <typename Function, typename Result>
+class futureJob : public asyncJob {
+
+	Function function_;
+	asyncOutcome<Result> outcome_;
+	std::promise<Result> promise_;
+
+  public:
+
+	template <typename Work>
+	futureJob(const bool write, Work &&function) : asyncJob(write), function_(std::forward<Work>(function)) {
+	}
+
+	std::future<Result> future() {
+		return promise_.get_future();
+	}
+
+	bool run(const SqliteConnection &connection) noexcept override {
+		return outcome_.run(function_, connection);
+	}
+
+	void fail(std::exception_ptr error) noexcept override {
+		outcome_.fail(std::move(error));
+	}
+
+	void complete() noexcept override {
+		outcome_.deliver(promise_);
+	}
+};
+
+
+#ifdef __cpp_lib_coroutine
+template <typename Result>
+struct asyncAwaitState {
+	enum Stage { Pending, Waiting, Done };
+
+	asyncOutcome<Result> outcome_;
+	std::coroutine_handle<> continuation_;
+	std::atomic<int> stage_{Pending};
+};
+
+
+// co_await on it suspends the coroutine until the job is completed, the coroutine is then resumed on the worker thread.
+template <typename Result>
+class asyncAwaitable {
+
+	std::shared_ptr<asyncAwaitState<Result>> state_;
+
+  public:
+
+	explicit asyncAwaitable(std::shared_ptr<asyncAwaitState<Result>> state) noexcept : state_{std::move(state)} {
+	}
+
+	bool await_ready() const noexcept {
+		return state_->stage_.load(std::memory_order_acquire) == asyncAwaitState<Result>::Done;
+	}
+
+	bool await_suspend(const std::coroutine_handle<> continuation) noexcept {
+		state_->continuation_ = continuation;
+		int expected = asyncAwaitState<Result>::Pending;
+		//fails when the job completed in the meantime, the coroutine then goes on without suspending
+		return state_->stage_.compare_exchange_strong(expected, asyncAwaitState<Result>::Waiting, std::memory_order_acq_rel);
+	}
+
+	Result await_resume() {
+		return state_->outcome_.take();
+	}
+};
+
+
+template <typename Function, typename Result>
+class awaitJob : public asyncJob {
+
+	Function function_;
+	std::shared_ptr<asyncAwaitState<Result>> state_;
+
+  public:
+
+	template <typename Work>
+	awaitJob(const bool write, Work &&function, std::shared_ptr<asyncAwaitState<Result>> state) : asyncJob(write), function_(std::forward<Work>(function)), state_{std::move(state)} {
+	}
+
+	bool run(const SqliteConnection &connection) noexcept override {
+		return state_->outcome_.run(function_, connection);
+	}
+
+	void fail(std::exception_ptr error) noexcept override {
+		state_->outcome_.fail(std::move(error));
+	}
+
+	void complete() noexcept override {
+		if (state_->stage_.exchange(asyncAwaitState<Result>::Done, std::memory_order_acq_rel) == asyncAwaitState<Result>::Waiting) {
+			state_->continuation_.resume();
+		}
+	}
+};
+#endif
+
+
+template <typename Function>
+using jobResult = std::invoke_result_t<std::decay_t<Function> &, const SqliteConnection &>;
+
+
+// Runs the jobs in one immediate transaction, each in its own savepoint so that a failing job is rolled back alone,
+// and completes them once the transaction is committed, or with the error of the transaction.
+void commitBatch(const SqliteConnection &connection, const std::vector<std::unique_ptr<asyncJob>> &batch) noexcept;
+
+
+// The type a deferred value is kept as: views and C strings are copied into owning strings and vectors,
+// since they are bound on the worker thread after the caller may have released what they point to.
+template <typename Value>
+struct ownedValue {
+	using type = Value;
+};
+
+//a null pointer still binds NULL
+template <>
+struct ownedValue<const char *> {
+	using type = std::optional<std::string>;
+};
+
+template <>
+struct ownedValue<char *> : ownedValue<const char *> {
+};
+
+template <>
+struct ownedValue<const wchar_t *> {
+	using type = std::optional<std::wstring>;
+};
+
+template <>
+struct ownedValue<wchar_t *> : ownedValue<const wchar_t *> {
+};
+
+template <>
+struct ownedValue<std::string_view> {
+	using type = std::string;
+};
+
+#ifdef __cpp_lib_span
+template <>
+struct ownedValue<std::span<const std::byte>> {
+	using type = std::vector<std::byte>;
+};
+
+template <>
+struct ownedValue<std::span<std::byte>> : ownedValue<std::span<const std::byte>> {
+};
+#endif
+
+template <typename Value>
+using ownedValueType = typename ownedValue<std::decay_t<Value>>::type;
+
+template <typename Value>
+ownedValueType<Value> ownedCopy(Value &&value) {
+	using Owned = ownedValueType<Value>;
+	if constexpr (std::is_same_v<Owned, std::decay_t<Value>>) {
+		return std::forward<Value>(value);
+	}
+	else if constexpr (std::is_pointer_v<std::remove_reference_t<Value>>) {
+		return value != nullptr ? Owned(value) : Owned();
+	}
+	else if constexpr (std::is_array_v<std::remove_reference_t<Value>>) {
+		//a string literal or another array, which cannot be null
+		return Owned(value);
+	}
+	else {
+		return Owned(value.begin(), value.end());
+	}
+}
+
+
+// A job that prepares text through the statement cache and binds the values, which are copied into the job
+// and moved into the statement when it is prepared on the worker thread.
+template <typename... Values>
+auto deferredStatement(const char *const text, Values &&... values) {
+	return [text = std::string(text), values = std::make_tuple(ownedCopy(std::forward<Values>(values))...)](const SqliteConnection &connection) mutable {
+		CachedStatement statement(connection, text.c_str());
+		std::apply([&statement](auto &... owned) { statement.bindAll(std::move(owned)...); }, values);
+		return statement;
+	};
+}
+
+
+template <typename... Columns>
+class AsyncCursor;
+
+
+// Runs queries on a worker thread which owns the connection, so that the calling threads never wait on sqlite3_step.
+// Jobs run in submission order. Writes queued one after another are committed together in one transaction, each in its own savepoint,
+// so a failing write is rolled back alone, and their results are delivered after the COMMIT.
+class AsyncExecutor {
+
+	SqliteConnection connection_;
+	const std::size_t maxWriteBatch_;
+
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::deque<std::unique_ptr<asyncJob>> queue_;
+	bool stopping_{false};
+
+	//declared last, so that it starts once everything else is constructed
+	std::thread worker_;
+
+	void push(std::unique_ptr<asyncJob> job);
+
+	void work() noexcept;
+
+	template <typename Function>
+	std::future<jobResult<Function>> enqueue(const bool write, Function &&function) {
+		auto job = std::make_unique<futureJob<std::decay_t<Function>, jobResult<Function>>>(write, std::forward<Function>(function));
+		std::future<jobResult<Function>> future = job->future();
+		push(std::move(job));
+		return future;
+	}
+
+	template <typename... Columns, typename... Values>
+	static auto queryJob(const char *const text, Values &&... values) {
+		return [prepare = deferredStatement(text, std::forward<Values>(values)...)](const SqliteConnection &connection) mutable {
+			const CachedStatement statement = prepare(connection);
+			std::vector<std::tuple<Columns...>> rows;
+			for (auto &&row : statement.template rows<Columns...>()) {
+				rows.push_back(std::move(row));
+			}
+			return rows;
+		};
+	}
+
+#ifdef __cpp_lib_coroutine
+	template <typename Function>
+	asyncAwaitable<jobResult<Function>> enqueueAwaitable(const bool write, Function &&function) {
+		auto state = std::make_shared<asyncAwaitState<jobResult<Function>>>();
+		push(std::make_unique<awaitJob<std::decay_t<Function>, jobResult<Function>>>(write, std::forward<Function>(function), state));
+		return asyncAwaitable<jobResult<Function>>(std::move(state));
+	}
+#endif
+
+  public:
+
+	static constexpr std::size_t defaultMaxWriteBatch = 1000;
+
+	explicit AsyncExecutor(const char *const filename, const OpenOptions &options = OpenOptions{}, const std::size_t maxWriteBatch = defaultMaxWriteBatch);
+
+	AsyncExecutor(const AsyncExecutor &) = delete;
+	AsyncExecutor &operator=(const AsyncExecutor &) = delete;
+
+	//the queued jobs are still run
+	~AsyncExecutor() noexcept;
+
+	//function(const SqliteConnection &) runs on the worker thread, outside of any transaction
+	template <typename Function>
+	std::future<jobResult<Function>> submit(Function &&function) {
+		return enqueue(false, std::forward<Function>(function));
+	}
+
+	//function(const SqliteConnection &) runs on the worker thread, in a savepoint of a transaction shared with the writes queued next to it
+	template <typename Function>
+	std::future<jobResult<Function>> submitWrite(Function &&function) {
+		return enqueue(true, std::forward<Function>(function));
+	}
+
+	//the values are copied, so the rows should be of owning types (std::string rather than std::string_view)
+	template <typename... Columns, typename... Values>
+	std::future<std::vector<std::tuple<Columns...>>> query(const char *const text, Values &&... values) {
+		return submit(queryJob<Columns...>(text, std::forward<Values>(values)...));
+	}
+
+	template <typename... Values>
+	std::future<void> execute(const char *const text, Values &&... values) {
+		return submitWrite([prepare = deferredStatement(text, std::forward<Values>(values)...)](const SqliteConnection &connection) mutable {
+			const CachedStatement statement = prepare(connection);
+			while (statement.execute()) {
+			}
+		});
+	}
+
+	template <typename... Columns, typename... Values>
+	AsyncCursor<Columns...> cursor(const char *const text, Values &&... values) {
+		return AsyncCursor<Columns...>(*this, text, std::forward<Values>(values)...);
+	}
+
+#ifdef __cpp_lib_coroutine
+	template <typename Function>
+	asyncAwaitable<jobResult<Function>> async(Function &&function) {
+		return enqueueAwaitable(false, std::forward<Function>(function));
+	}
+
+	template <typename Function>
+	asyncAwaitable<jobResult<Function>> asyncWrite(Function &&function) {
+		return enqueueAwaitable(true, std::forward<Function>(function));
+	}
+
+	template <typename... Columns, typename... Values>
+	asyncAwaitable<std::vector<std::tuple<Columns...>>> asyncQuery(const char *const text, Values &&... values) {
+		return async(queryJob<Columns...>(text, std::forward<Values>(values)...));
+	}
+#endif
+};
+
+
+// Streams the rows of a query from an AsyncExecutor, fetch(count) returns the next count rows at most, and no rows at the end.
+// The statement is prepared, stepped and finalized on the worker thread, the executor must outlive the cursor.
+template <typename... Columns>
+class AsyncCursor {
+
+	struct State {
+		std::optional<CachedStatement> statement_;
+		std::exception_ptr error_;
+		bool done_{false};
+	};
+
+	AsyncExecutor *executor_;
+	std::shared_ptr<State> state_;
+
+	auto fetchJob(const std::size_t count) const {
+		return [state = state_, count](const SqliteConnection &) {
+			if (state->error_) {
+				std::rethrow_exception(state->error_);
+			}
+			std::vector<std::tuple<Columns...>> rows;
+			while (!state->done_ && rows.size() < count) {
+				if (!state->statement_->execute()) {
+					//ends the read transaction, without waiting for the cursor to be destroyed
+					state->done_ = true;
+					state->statement_->reset();
+					break;
+				}
+				rows.push_back(tupleDecoder<Columns...>::decode(state->statement_->getABI()));
+			}
+			return rows;
+		};
+	}
+
+  public:
+
+	template <typename... Values>
+	AsyncCursor(AsyncExecutor &executor, const char *const text, Values &&... values) : executor_{&executor}, state_{std::make_shared<State>()} {
+		executor.submit([state = state_, prepare = deferredStatement(text, std::forward<Values>(values)...)](const SqliteConnection &connection) mutable {
+			try {
+				state->statement_.emplace(prepare(connection));
+				//checks the column count
+				state->statement_->template rows<Columns...>();
+			}
+			catch (...) {
+				state->error_ = std::current_exception();
+			}
+		});
+	}
+
+	AsyncCursor(AsyncCursor &&) noexcept = default;
+	AsyncCursor &operator=(AsyncCursor &&) = delete;
+
+	~AsyncCursor() noexcept {
+		if (state_) {
+			try {
+				executor_->submit([state = std::move(state_)](const SqliteConnection &) {});
+			}
+			catch (...) {
+			}
+		}
+	}
+
+	std::future<std::vector<std::tuple<Columns...>>> fetch(const std::size_t count) {
+		return executor_->submit(fetchJob(count));
+	}
+
+#ifdef __cpp_lib_coroutine
+	asyncAwaitable<std::vector<std::tuple<Columns...>>> asyncFetch(const std::size_t count) {
+		return executor_->async(fetchJob(count));
+	}
+#endif
+};
+
+}
+
+#endif
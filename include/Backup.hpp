@@ -0,0 +1,101 @@
+#ifndef IncludeSqliteBackup_
+#define IncludeSqliteBackup_
+
+#include "SqliteConnection.hpp"
+#include <atomic>
+#include <chrono>
+
+namespace Sqlite {
+
+struct BackupOptions {
+	//pages copied by one sqlite3_backup_step, -1 copies the whole database in one step, with the source locked throughout
+	int pagesPerStep_{256};
+	//how long the source is left unlocked between two steps, the thread only yields when it is zero
+	std::chrono::milliseconds pause_{0};
+};
+
+
+  
+// Online backup of a database into another connection with sqlite3_backup_init/step/finish, a few pages per step.
+// The source is locked only during a step, so the foreground traffic goes on between steps. A write through another connection
+// restarts the copy from the first page, a write through the source connection is copied along.
+class Backup {
+
+	struct BackupTraits : public nullHandleTraits<sqlite3_backup *> {
+		static void close(sqlite3_backup *value) noexcept {
+			sqlite3_backup_finish(value);
+		}
+	};
+
+	UniqueHandle<BackupTraits> backupHandle_;
+	BackupOptions options_;
+	std::atomic<bool> cancelled_{false};
+	//as of the last step, finish() releases the handle they are read from
+	int remaining_{0};
+	int pageCount_{0};
+
+	void pause() const;
+
+  public:
+
+	//destinationName and sourceName are the schema names, "main", "temp" or the name of an attached database
+	Backup(const SqliteConnection &destination, const SqliteConnection &source, const BackupOptions &options = BackupOptions{}, const char *const destinationName = "main", const char *const sourceName = "main");
+
+	Backup(const Backup &) = delete;
+	Backup &operator=(const Backup &) = delete;
+
+	sqlite3_backup *getABI() const noexcept {
+		return backupHandle_.get();
+	}
+
+	//copies up to pagesPerStep_ pages, false once the copy is complete, a busy or locked source is a step copying nothing
+	//throws SQLITE_MISUSE after finish()
+	bool step();
+
+	//both known after the first step, and still after finish()
+	int remaining() const noexcept {
+		return remaining_;
+	}
+
+	int pageCount() const noexcept {
+		return pageCount_;
+	}
+
+	//steps until the copy is complete, pausing between steps, and calls progress(remaining(), pageCount()) after every step
+	//false when cancel() stopped it, finishing the backup then rolls the destination back
+	template <typename Progress>
+	bool run(Progress &&progress) {
+		while (!cancelled_.load(std::memory_order_relaxed)) {
+			const bool copying = step();
+			progress(remaining(), pageCount());
+			if (!copying) {
+				return true;
+			}
+			pause();
+		}
+		return false;
+	}
+
+	bool run() {
+		return run([](int, int) {});
+	}
+
+	//from any thread, run() returns after the step in progress
+	void cancel() noexcept {
+		cancelled_.store(true, std::memory_order_relaxed);
+	}
+
+	bool cancelled() const noexcept {
+		return cancelled_.load(std::memory_order_relaxed);
+	}
+
+	//releases the handle and the locks, throwing the error of a failed step, which the destructor ignores
+	void finish();
+
+	//hot copy of the main database of source into the database file filename
+	static void toFile(const SqliteConnection &source, const char *const filename, const BackupOptions &options = BackupOptions{});
+};
+
+}
+
+#endif
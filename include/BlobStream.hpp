@@ -0,0 +1,65 @@
+#ifndef IncludeSqliteBlobStream_
+#define IncludeSqliteBlobStream_
+
+#include "SqliteConnection.hpp"
+
+namespace Sqlite {
+
+// Incremental I/O on one BLOB, built on sqlite3_blob_open, so that large values are streamed through caller buffers with bounded memory.
+// The size of a BLOB cannot be changed through the stream, space for writing is allocated with zeroBlob.
+class BlobStream {
+
+	struct BlobStreamTraits : public nullHandleTraits<sqlite3_blob *> {
+		static void close(sqlite3_blob *value) noexcept {
+			sqlite3_blob_close(value);
+		}
+	};
+
+	UniqueHandle<BlobStreamTraits> blobHandle_;
+	sqlite3 *connection_{nullptr};
+	int position_{0};
+
+  public:
+
+	BlobStream() = default;
+
+	BlobStream(const SqliteConnection &connection, const char *const table, const char *const column, const long long rowId, const bool writable = false, const char *const database = "main");
+
+	explicit operator bool() const noexcept {
+		return static_cast<bool>(blobHandle_);
+	}
+
+	sqlite3_blob *getABI() const noexcept {
+		return blobHandle_.get();
+	}
+
+	void throwLastError() const;
+
+	int size() const noexcept {
+		return sqlite3_blob_bytes(getABI());
+	}
+
+	int position() const noexcept {
+		return position_;
+	}
+
+	void seek(const int position) noexcept {
+		position_ = position;
+	}
+
+	void read(void *const buffer, const int size, const int offset) const;
+
+	void write(const void *const buffer, const int size, const int offset) const;
+
+	//reads up to size bytes at the position and advances it, returns 0 at the end of the BLOB
+	int readNext(void *const buffer, const int size);
+
+	void writeNext(const void *const buffer, const int size);
+
+	//moves the open handle to the same column of another row, without allocating a new one
+	void reopen(const long long rowId);
+};
+
+}
+
+#endif
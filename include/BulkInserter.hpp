@@ -0,0 +1,138 @@
+#ifndef IncludeSqliteBulkInserter_
+#define IncludeSqliteBulkInserter_
+
+#include "Transaction.hpp"
+#include <chrono>
+#include <optional>
+#include <tuple>
+
+namespace Sqlite {
+
+//approximate number of bytes a bound value adds to a transaction
+inline std::size_t boundSize(const char *const value) noexcept {
+	return std::char_traits<char>::length(value);
+}
+
+inline std::size_t boundSize(const wchar_t *const value) noexcept {
+	return std::char_traits<wchar_t>::length(value) * sizeof(wchar_t);
+}
+
+inline std::size_t boundSize(const std::string &value) noexcept {
+	return value.size();
+}
+
+inline std::size_t boundSize(const std::wstring &value) noexcept {
+	return value.size() * sizeof(wchar_t);
+}
+
+inline std::size_t boundSize(const std::string_view value) noexcept {
+	return value.size();
+}
+
+inline std::size_t boundSize(const std::vector<std::byte> &value) noexcept {
+	return value.size();
+}
+
+inline std::size_t boundSize(const zeroBlob value) noexcept {
+	return value.size_;
+}
+
+inline std::size_t boundSize(std::nullptr_t) noexcept {
+	return 0;
+}
+
+template <typename T>
+std::size_t boundSize(const std::optional<T> &value) noexcept {
+	return value ? boundSize(*value) : 0;
+}
+
+template <typename T>
+constexpr std::size_t boundSize(const T &) noexcept {
+	return sizeof(T);
+}
+
+
+struct BulkInsertOptions {
+	std::size_t rowsPerTransaction_{10000};
+	//0 disables the limit on the bytes bound per transaction
+	std::size_t bytesPerTransaction_{0};
+};
+
+struct BulkInsertStats {
+	unsigned long long rows_{0};
+	unsigned long long bytes_{0};
+	unsigned long long transactions_{0};
+	std::chrono::nanoseconds elapsed_{0};
+
+	double rowsPerSecond() const noexcept {
+		return elapsed_.count() == 0 ? 0.0 : rows_ * 1e9 / elapsed_.count();
+	}
+};
+
+
+// Reuses one prepared insert statement and commits every rowsPerTransaction_ rows (or bytesPerTransaction_ bytes) in a BEGIN IMMEDIATE transaction.
+// The rows of the last, uncommitted chunk are rolled back if the inserter is destroyed before flush() or finish().
+class BulkInserter {
+
+	const SqliteConnection *connection_;
+	SqliteStatement statement_;
+	BulkInsertOptions options_;
+	BulkInsertStats stats_;
+	std::chrono::steady_clock::time_point start_{std::chrono::steady_clock::now()};
+	std::size_t pendingRows_{0};
+	std::size_t pendingBytes_{0};
+	std::optional<Transaction> transaction_;
+
+	void beginChunk();
+
+	void endChunk();
+
+  public:
+	template <typename CharacterSet>
+	BulkInserter(const SqliteConnection &connection, const CharacterSet *const text, const BulkInsertOptions options = BulkInsertOptions{}) : connection_{&connection}, statement_{connection, text}, options_{options} {
+	}
+
+	BulkInserter(const BulkInserter &) = delete;
+	BulkInserter &operator=(const BulkInserter &) = delete;
+
+	template <typename... Values>
+	void insert(Values &&... values) {
+		beginChunk();
+		//the error of a failed step was already thrown by execute(), so the result of the reset is not checked
+		sqlite3_reset(statement_.getABI());
+		if (options_.bytesPerTransaction_ != 0) {
+			pendingBytes_ += (std::size_t{0} + ... + boundSize(values));
+		}
+		statement_.bindAll(std::forward<Values>(values)...);
+		statement_.execute();
+		++pendingRows_;
+		endChunk();
+	}
+
+	//inserts every tuple of the range
+	template <typename Range>
+	void insertAll(const Range &rows) {
+		for (const auto &row : rows) {
+			std::apply([this](const auto &... values) { insert(values...); }, row);
+		}
+	}
+
+	//inserts the tuples returned by the generator until it returns an empty std::optional
+	template <typename Generator>
+	void insertFrom(Generator &&generator) {
+		while (auto row = generator()) {
+			std::apply([this](auto &&... values) { insert(std::forward<decltype(values)>(values)...); }, std::move(*row));
+		}
+	}
+
+	void flush();
+
+	BulkInsertStats finish();
+
+	//statistics of the committed rows
+	BulkInsertStats stats() const noexcept;
+};
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef IncludeSqliteConnectionPool_
+#define IncludeSqliteConnectionPool_
+
+#include "SqliteConnection.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Sqlite {
+
+// One read-write connection and N read-only connections to the same database file in WAL mode.
+// Readers never block each other, every lease keeps its own connection, with its own statement cache, until it is destroyed.
+class ConnectionPool {
+
+	struct Reader {
+		SqliteConnection connection_;
+		std::atomic<bool> busy_{false};
+	};
+
+	SqliteConnection writer_;
+	std::mutex writerMutex_;
+	std::unique_ptr<Reader[]> readers_;
+	std::size_t readerCount_;
+	std::mutex waitMutex_;
+	std::condition_variable released_;
+	std::atomic<std::size_t> waiters_{0};
+
+	Reader *tryAcquireReader(const std::size_t start) noexcept;
+
+	void releaseReader(Reader &reader) noexcept;
+
+  public:
+	class Lease {
+
+		friend class ConnectionPool;
+
+		ConnectionPool *pool_{nullptr};
+		Reader *reader_{nullptr};
+		const SqliteConnection *connection_{nullptr};
+		std::unique_lock<std::mutex> writerLock_;
+
+		Lease(ConnectionPool &pool, Reader &reader) noexcept : pool_{&pool}, reader_{&reader}, connection_{&reader.connection_} {
+		}
+
+		Lease(ConnectionPool &pool, std::unique_lock<std::mutex> &&writerLock) noexcept : pool_{&pool}, connection_{&pool.writer_}, writerLock_{std::move(writerLock)} {
+		}
+
+	  public:
+		Lease(const Lease &) = delete;
+		Lease &operator=(const Lease &) = delete;
+
+		Lease(Lease &&other) noexcept : pool_{other.pool_}, reader_{other.reader_}, connection_{other.connection_}, writerLock_{std::move(other.writerLock_)} {
+			other.reader_ = nullptr;
+		}
+
+		~Lease() noexcept {
+			if (reader_) {
+				pool_->releaseReader(*reader_);
+			}
+		}
+
+		const SqliteConnection &get() const noexcept {
+			return *connection_;
+		}
+
+		operator const SqliteConnection &() const noexcept {
+			return *connection_;
+		}
+
+		const SqliteConnection *operator->() const noexcept {
+			return connection_;
+		}
+	};
+
+	//the writer is opened with the options in WAL mode, the readers with the options as read-only connections
+	ConnectionPool(const char *const filename, const std::size_t readers = std::max(1u, std::thread::hardware_concurrency()), const OpenOptions &options = OpenOptions::readHeavy());
+
+	ConnectionPool(const ConnectionPool &) = delete;
+	ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+	//read-only connection, blocks while every reader is leased
+	Lease reader();
+
+	//the read-write connection, blocks while another thread holds it
+	Lease writer();
+
+	std::size_t readerCount() const noexcept {
+		return readerCount_;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef IncludeSqliteGlobalConfig_
+#define IncludeSqliteGlobalConfig_
+
+#include "SqliteConnection.hpp"
+#include <cstddef>
+
+namespace Sqlite {
+
+struct GlobalOptions {
+	//one page cache for every connection of the process, with one byte budget, instead of a page cache per connection
+	bool sharedPageCache_{false};
+	//bytes of clean pages the shared cache keeps for all connections together, PRAGMA cache_size no longer applies
+	std::size_t pageCacheBytes_{64 * 1024 * 1024};
+	//lock stripes of the shared cache, the pages of a connection live in one of them
+	std::size_t pageCacheShards_{16};
+	//size-class pools for SQLite's allocations of up to 1 KiB, with a cache of free blocks per thread, larger ones go to malloc
+	bool pooledAllocator_{false};
+};
+
+struct GlobalMemoryStats {
+	//the shared page cache, its bytes count the pages of on-disk databases, pinned or not
+	std::size_t pageCacheBytes_{0};
+	unsigned long long pageCacheHits_{0};
+	unsigned long long pageCacheMisses_{0};
+	unsigned long long pageCacheEvictions_{0};
+	//the pooled allocator, slabs are kept for the life of the process
+	std::size_t poolSlabBytes_{0};
+	std::size_t poolLargeBytes_{0};
+};
+
+// Process-wide configuration installed with sqlite3_config, which SQLite only accepts before it is initialized: configureSqlite
+// has to run before the first connection is opened, or anything else that initializes SQLite (registerIoUringVfs included).
+// The shared page cache is a sqlite3_pcache_methods2: the connections keep their own pages, as SQLite requires, but a single LRU per lock stripe
+// and one global budget decide which clean pages stay, so memory goes to the busiest connections instead of being reserved by every one of them.
+// When a stripe has nothing left to evict, the others are searched before a new page is refused or allocated over the budget.
+// The pooled allocator is a sqlite3_mem_methods carving the small allocations out of 64 KiB slabs by size class, which keeps
+// the short-lived parser, VDBE and value allocations of many connections from fragmenting the heap.
+
+//throws SQLITE_MISUSE when SQLite is already initialized or the configuration was already installed
+void configureSqlite(const GlobalOptions &options);
+
+GlobalMemoryStats globalMemoryStats() noexcept;
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef IncludeSqliteGroupCommitWriter_
+#define IncludeSqliteGroupCommitWriter_
+
+#include "AsyncExecutor.hpp"
+#include <chrono>
+
+namespace Sqlite {
+
+// Link of the intrusive queue of mpscQueue.
+struct mpscNode {
+	std::atomic<mpscNode *> next_{nullptr};
+};
+
+
+// Intrusive multiple producers, single consumer queue of Dmitry Vyukov.
+// push() is wait-free from any thread, pop() is lock-free and only called by the consumer.
+class mpscQueue {
+
+	alignas(64) std::atomic<mpscNode *> head_;
+	alignas(64) mpscNode *tail_;
+	mpscNode stub_;
+
+  public:
+
+	mpscQueue() noexcept : head_{&stub_}, tail_{&stub_} {
+	}
+
+	mpscQueue(const mpscQueue &) = delete;
+	mpscQueue &operator=(const mpscQueue &) = delete;
+
+	void push(mpscNode *const node) noexcept;
+
+	//nullptr when the queue is empty, or while the node pushed last is not linked yet
+	mpscNode *pop() noexcept;
+
+	//false while a node is being pushed, the sequentially consistent load of head_ pairs with the exchange in push()
+	bool empty() const noexcept {
+		return tail_ == &stub_ && head_.load() == &stub_;
+	}
+};
+
+
+// A write job of GroupCommitWriter, the queue links it through the node it holds.
+struct groupCommitNode : mpscNode {
+	asyncJob *const job_;
+
+	explicit groupCommitNode(asyncJob *const job) noexcept : job_{job} {
+	}
+};
+
+
+template <typename Function, typename Result>
+class groupCommitJob : public futureJob<Function, Result> {
+
+  public:
+
+	groupCommitNode node_{this};
+
+	using futureJob<Function, Result>::futureJob;
+};
+
+
+struct GroupCommitOptions {
+	std::size_t maxBatch_{1000};
+	//how long the first job of a batch waits for more jobs, 0 commits whatever was queued during the previous commit
+	std::chrono::microseconds maxLatency_{0};
+};
+
+
+// Group commit: write jobs are queued from any thread without locking, and a writer thread commits them in batches,
+// so that concurrent writers share one write lock and one journal sync per batch instead of paying one each and failing with SQLITE_BUSY.
+// Every job runs in its own savepoint, and its future is ready once the transaction of the batch is committed.
+class GroupCommitWriter {
+
+  public:
+
+	struct Stats {
+		unsigned long long jobs_{0};
+		unsigned long long batches_{0};
+	};
+
+  private:
+
+	SqliteConnection connection_;
+	const GroupCommitOptions options_;
+	mpscQueue queue_;
+
+	std::atomic<bool> idle_{false};
+	std::atomic<bool> stopping_{false};
+	std::atomic<unsigned long long> jobs_{0};
+	std::atomic<unsigned long long> batches_{0};
+	//only used to park the idle writer thread
+	std::mutex mutex_;
+	std::condition_variable condition_;
+
+	//declared last, so that it starts once everything else is constructed
+	std::thread worker_;
+
+	void push(groupCommitNode *const node) noexcept;
+
+	std::unique_ptr<asyncJob> pop() noexcept {
+		mpscNode *const node = queue_.pop();
+		return std::unique_ptr<asyncJob>(node ? static_cast<groupCommitNode *>(node)->job_ : nullptr);
+	}
+
+	bool ready() const noexcept {
+		return !queue_.empty() || stopping_.load();
+	}
+
+	//idle_ is set before the queue is checked, so a producer either sees it and notifies, or pushed before the check
+	void park();
+
+	void parkUntil(const std::chrono::steady_clock::time_point deadline);
+
+	void work() noexcept;
+
+  public:
+
+	explicit GroupCommitWriter(const char *const filename, const GroupCommitOptions &options = GroupCommitOptions{}, const OpenOptions &openOptions = OpenOptions::durable());
+
+	GroupCommitWriter(const GroupCommitWriter &) = delete;
+	GroupCommitWriter &operator=(const GroupCommitWriter &) = delete;
+
+	//the queued jobs are still committed
+	~GroupCommitWriter() noexcept;
+
+	//function(const SqliteConnection &) runs on the writer thread, in a savepoint of the transaction of its batch
+	template <typename Function>
+	std::future<jobResult<Function>> submit(Function &&function) {
+		auto job = std::make_unique<groupCommitJob<std::decay_t<Function>, jobResult<Function>>>(true, std::forward<Function>(function));
+		std::future<jobResult<Function>> future = job->future();
+		push(&job.release()->node_);
+		return future;
+	}
+
+	template <typename... Values>
+	std::future<void> execute(const char *const text, Values &&... values) {
+		return submit([prepare = deferredStatement(text, std::forward<Values>(values)...)](const SqliteConnection &connection) mutable {
+			const CachedStatement statement = prepare(connection);
+			while (statement.execute()) {
+			}
+		});
+	}
+
+	Stats stats() const noexcept {
+		return Stats{jobs_.load(std::memory_order_relaxed), batches_.load(std::memory_order_relaxed)};
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef IncludeSqliteIoUringVfs_
+#define IncludeSqliteIoUringVfs_
+
+#include "SqliteConnection.hpp"
+#include <cstddef>
+
+namespace Sqlite {
+
+struct IoUringVfsOptions {
+	//bytes of one read-ahead request, rounded up to a power of two of at least 64 KiB, so that no page straddles two requests
+	std::size_t readAheadSize_{256 * 1024};
+	//read-ahead requests kept in flight in front of a sequential scan
+	std::size_t readAheadDepth_{4};
+	//consecutive reads of adjacent pages before the read-ahead starts
+	int sequentialReads_{4};
+};
+
+struct IoUringVfsStats {
+	//reads of the database files that went to the kernel, and those served from a read-ahead request
+	unsigned long long reads_{0};
+	unsigned long long readAheadHits_{0};
+	unsigned long long readAheads_{0};
+	unsigned long long writes_{0};
+	//io_uring_enter calls, one for a read together with the read-ahead requests it starts
+	unsigned long long submissions_{0};
+};
+
+constexpr const char *ioUringVfsName = "io_uring";
+
+// A VFS named "io_uring" over the default one ("unix"), to be selected with SqliteConnection::open or OpenOptions::vfs_.
+// Reads and writes of main database files go through an io_uring per open file, the locks, shared memory, syncs and the
+// journal and WAL files stay with the default VFS. After a few reads of adjacent pages, the next readAheadDepth_ blocks of
+// the file are requested asynchronously in the same submission as the read, so a scan finds its pages already read.
+// The read-ahead is dropped on every lock change and on writes over it, so it never outlives the transaction it was read in.
+// Writes are not deferred past xWrite: SQLite orders them against journal deletion and WAL index updates, which the VFS
+// does not see. Where io_uring is unavailable (not Linux, a kernel before 5.6, or io_uring disabled) every call goes to the default VFS.
+
+//registers the VFS once per process, later calls only make it the default, returns whether io_uring is in use
+bool registerIoUringVfs(const IoUringVfsOptions &options = IoUringVfsOptions{}, const bool makeDefault = false);
+
+//counts of every file opened through the VFS since the process started
+IoUringVfsStats ioUringVfsStats() noexcept;
+
+}
+
+#endif
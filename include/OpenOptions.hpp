@@ -0,0 +1,83 @@
+#ifndef IncludeSqliteOpenOptions_
+#define IncludeSqliteOpenOptions_
+
+#include <optional>
+#include <string>
+
+namespace Sqlite {
+
+enum class JournalMode {
+	Delete,
+	Truncate,
+	Persist,
+	Memory,
+	Wal,
+	Off
+};
+
+enum class SynchronousMode {
+	Off,
+	Normal,
+	Full,
+	Extra
+};
+
+enum class TempStore {
+	Default,
+	File,
+	Memory
+};
+
+enum class ThreadingMode {
+	Default,
+	//SQLITE_OPEN_NOMUTEX, the connection must not be used by two threads at once
+	MultiThread,
+	//SQLITE_OPEN_FULLMUTEX
+	Serialized
+};
+
+enum class CacheMode {
+	Default,
+	Shared,
+	Private
+};
+
+
+// Open flags, VFS and tuning pragmas applied by SqliteConnection::open before the connection is handed out.
+// Pragmas that are not set keep the SQLite defaults.
+struct OpenOptions {
+	bool readOnly_{false};
+	bool create_{true};
+	bool uri_{false};
+	ThreadingMode threading_{ThreadingMode::Default};
+	CacheMode cache_{CacheMode::Default};
+	//empty for the default VFS
+	std::string vfs_;
+
+	std::optional<JournalMode> journalMode_;
+	std::optional<SynchronousMode> synchronous_;
+	//PRAGMA cache_size, pages when positive and KiB when negative
+	std::optional<int> cacheSize_;
+	std::optional<long long> mmapSize_;
+	std::optional<TempStore> tempStore_;
+	std::optional<int> busyTimeoutMilliseconds_;
+
+	int flags() const noexcept;
+
+	//the pragma statements for the set options
+	std::string pragmas() const;
+
+	//WAL without syncs and a 256 MiB page cache. An application crash can lose the last transactions but does not corrupt the
+	//database, an OS crash or a power failure can corrupt it; use SynchronousMode::Normal when that matters
+	static OpenOptions bulkLoad();
+
+	//WAL, so that readers do not block the writer, a 64 MiB page cache and 256 MiB of memory mapped I/O
+	static OpenOptions readHeavy();
+
+	//WAL with a sync on every commit
+	static OpenOptions durable();
+};
+
+}
+
+#endif
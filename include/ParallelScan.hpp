@@ -0,0 +1,138 @@
+#ifndef IncludeSqliteParallelScan_
+#define IncludeSqliteParallelScan_
+
+#include "Transaction.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace Sqlite {
+
+// The first and last key of a partition of a ParallelScan, both included.
+struct KeyRange {
+	long long first_;
+	long long last_;
+};
+
+
+  
+// Runs one query over partitions of a table in parallel, on N read-only connections with a worker thread each, and combines the partial results.
+// The readers all read from the same snapshot of the database: with SQLITE_ENABLE_SNAPSHOT (for an SQLite built with it) they open the snapshot
+// of the first reader with sqlite3_snapshot_open, otherwise the read-write connection holds the write lock while their read transactions begin.
+class ParallelScan {
+
+#ifdef SQLITE_ENABLE_SNAPSHOT
+	struct SnapshotTraits : public nullHandleTraits<sqlite3_snapshot *> {
+		static void close(sqlite3_snapshot *value) noexcept {
+			sqlite3_snapshot_free(value);
+		}
+	};
+#endif
+
+	//more partitions than readers, so that the readers done early take over the remaining ones
+	static constexpr std::size_t partitionsPerReader = 4;
+
+	SqliteConnection writer_;
+	std::unique_ptr<SqliteConnection[]> readers_;
+	std::size_t readerCount_;
+	std::vector<std::thread> workers_;
+	std::mutex scanMutex_;
+
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable finished_;
+	std::function<void(std::size_t)> task_;
+	std::size_t generation_{0};
+	std::size_t running_{0};
+	bool stopping_{false};
+	std::exception_ptr error_;
+	std::atomic<bool> failed_{false};
+
+	void work(const std::size_t reader);
+
+	void stop() noexcept;
+
+	//runs task(reader) on every worker and waits for them, rethrowing the first exception
+	void runOnReaders(std::function<void(std::size_t)> task);
+
+	//a read transaction begins with its first read, not with BEGIN
+	static void startRead(const SqliteConnection &connection);
+
+	std::vector<Transaction> beginReads();
+
+	//at most count ranges of equal width between the smallest and the largest key, looked up in two subqueries, since only a lone min() or max() is answered from the index
+	static std::vector<KeyRange> partition(const SqliteConnection &connection, const char *const table, const char *const key, std::size_t count);
+
+	template <typename Result, typename Partial, typename Reduce>
+	Result run(const std::vector<KeyRange> &ranges, const char *const query, Result initial, Partial &partial, Reduce &reduce) {
+		std::vector<std::optional<Result>> results(readerCount_);
+		std::atomic<std::size_t> next{0};
+		runOnReaders([&](const std::size_t reader) {
+			std::optional<SqliteStatement> statement;
+			for (std::size_t index = next++; index < ranges.size() && !failed_; index = next++) {
+				if (!statement) {
+					statement.emplace(readers_[reader], query);
+				}
+				statement->reset(ranges[index].first_, ranges[index].last_);
+				if (results[reader]) {
+					results[reader] = reduce(std::move(*results[reader]), partial(*statement));
+				}
+				else {
+					results[reader] = partial(*statement);
+				}
+			}
+		});
+
+		for (std::optional<Result> &result : results) {
+			if (result) {
+				initial = reduce(std::move(initial), std::move(*result));
+			}
+		}
+		return initial;
+	}
+
+  public:
+
+	//the read-write connection is opened with the options in WAL mode, the readers with the options as read-only connections
+	ParallelScan(const char *const filename, const std::size_t readers = std::max(1u, std::thread::hardware_concurrency()), const OpenOptions &options = OpenOptions::readHeavy());
+
+	ParallelScan(const ParallelScan &) = delete;
+	ParallelScan &operator=(const ParallelScan &) = delete;
+
+	~ParallelScan() noexcept;
+
+	std::size_t readerCount() const noexcept {
+		return readerCount_;
+	}
+
+	//splits the integer key of table into ranges and runs query, whose two parameters are bound to the first and last key of a range, once per range
+	//partial(SqliteStatement &) returns the result of a range and reduce(Result, Result) combines two results
+	//partial, and reduce for the results of one reader, run on the worker threads; reduce then folds the results of the readers into initial on the calling thread
+	//the smallest and largest key are looked up with min() and max(), which only an index on the key (or the rowid) makes cheap
+	template <typename Result, typename Partial, typename Reduce>
+	Result scan(const char *const table, const char *const key, const char *const query, Result initial, Partial partial, Reduce reduce) {
+		std::lock_guard<std::mutex> lock(scanMutex_);
+		const std::vector<Transaction> reads = beginReads();
+		const std::vector<KeyRange> ranges = partition(readers_[0], table, key, readerCount_ * partitionsPerReader);
+		return run(ranges, query, std::move(initial), partial, reduce);
+	}
+
+	//the same, over ranges given by the caller
+	template <typename Result, typename Partial, typename Reduce>
+	Result scan(const std::vector<KeyRange> &ranges, const char *const query, Result initial, Partial partial, Reduce reduce) {
+		std::lock_guard<std::mutex> lock(scanMutex_);
+		const std::vector<Transaction> reads = beginReads();
+		return run(ranges, query, std::move(initial), partial, reduce);
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef IncludeSqliteResultSet_
+#define IncludeSqliteResultSet_
+
+#include "SqliteConnection.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Sqlite {
+
+// Rows of a query materialized column by column, Arrow style: integers and reals in contiguous arrays, text and blobs
+// in one data buffer per column with an array of offsets, and a validity bitmap with a bit set for every value that is not null.
+// clear() keeps the buffers, so that a ResultSet reused across queries stops allocating once it has grown.
+class ResultSet {
+
+  public:
+
+	class Column {
+
+		friend class ResultSet;
+
+		std::string name_;
+		int type_{SQLITE_NULL};
+		std::size_t size_{0};
+		std::size_t nullCount_{0};
+		std::vector<std::uint8_t> validity_;
+		std::vector<long long> integers_;
+		std::vector<double> reals_;
+		std::vector<std::int32_t> offsets_{0};
+		std::vector<char> data_;
+
+		void clear() noexcept;
+
+		//the rows appended so far are all null
+		void setType(const int type);
+
+		void appendBytes(const void *const bytes, const int size);
+
+		void append(sqlite3_stmt *const statement, const int column);
+
+	  public:
+
+		const std::string &name() const noexcept {
+			return name_;
+		}
+
+		//SQLITE_INTEGER, SQLITE_FLOAT, SQLITE_TEXT, SQLITE_BLOB, or SQLITE_NULL while every value is null
+		int type() const noexcept {
+			return type_;
+		}
+
+		std::size_t size() const noexcept {
+			return size_;
+		}
+
+		std::size_t nullCount() const noexcept {
+			return nullCount_;
+		}
+
+		bool isNull(const std::size_t row) const noexcept {
+			return ((validity_[row / 8] >> (row % 8)) & 1u) == 0;
+		}
+
+		long long getInt64(const std::size_t row) const noexcept {
+			return integers_[row];
+		}
+
+		double getDouble(const std::size_t row) const noexcept {
+			return reals_[row];
+		}
+
+		std::string_view getText(const std::size_t row) const noexcept {
+			return std::string_view(data_.data() + offsets_[row], static_cast<std::size_t>(offsets_[row + 1] - offsets_[row]));
+		}
+
+		const void *getBlob(const std::size_t row) const noexcept {
+			return data_.data() + offsets_[row];
+		}
+
+		int getBlobLength(const std::size_t row) const noexcept {
+			return offsets_[row + 1] - offsets_[row];
+		}
+
+		//the buffers, for scans and zero-copy export
+		const std::vector<std::uint8_t> &validity() const noexcept {
+			return validity_;
+		}
+
+		const std::vector<long long> &integers() const noexcept {
+			return integers_;
+		}
+
+		const std::vector<double> &reals() const noexcept {
+			return reals_;
+		}
+
+		const std::vector<std::int32_t> &offsets() const noexcept {
+			return offsets_;
+		}
+
+		const std::vector<char> &data() const noexcept {
+			return data_;
+		}
+	};
+
+  private:
+
+	//may hold more columns than columnCount_, kept with their buffers from a previous query
+	std::vector<Column> columns_;
+	std::size_t columnCount_{0};
+	std::size_t rowCount_{0};
+
+	static bool containsNoCase(const char *const text, const std::string_view word) noexcept;
+
+	//the type given by the affinity of the declared type, SQLITE_NULL when it is taken from the first value instead
+	static int declaredType(const char *const declared) noexcept;
+
+  public:
+
+	void clear() noexcept;
+
+	//clears the result and sets up its columns from the statement
+	void start(sqlite3_stmt *const statement);
+
+	//appends the current row of the statement
+	void appendRow(sqlite3_stmt *const statement);
+
+	std::size_t rowCount() const noexcept {
+		return rowCount_;
+	}
+
+	std::size_t columnCount() const noexcept {
+		return columnCount_;
+	}
+
+	const Column &column(const std::size_t column) const noexcept {
+		return columns_[column];
+	}
+
+	const Column &operator[](const std::size_t column) const noexcept {
+		return columns_[column];
+	}
+
+	//fixes the type of a column whose values so far are all null, instead of taking it from its next value
+	void setColumnType(const std::size_t column, const int type);
+
+	//-1 when no column has that name
+	int columnIndex(const std::string_view name) const noexcept;
+};
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef IncludeSqliteScriptRunner_
+#define IncludeSqliteScriptRunner_
+
+#include "Transaction.hpp"
+#include <chrono>
+#include <string_view>
+#include <vector>
+
+namespace Sqlite {
+
+struct ScriptOptions {
+	//runs the whole script in one transaction, rolled back when a statement fails, the script must not begin or commit its own then
+	bool transaction_{false};
+	TransactionMode mode_{TransactionMode::Immediate};
+};
+
+struct ScriptStatement {
+	//points into the script, from the end of the previous statement to the end of this one, without the whitespace in between
+	std::string_view text_;
+	//prepare and all steps
+	std::chrono::nanoseconds elapsed_{0};
+	//sqlite3_changes after the statement, meaningful for INSERT, UPDATE and DELETE only
+	int changes_{0};
+};
+
+
+  
+// Runs every statement of a script in order, walking the tail pointer of sqlite3_prepare_v2 through the text, and times each one.
+// The text must be NUL terminated: SQLite copies the rest of an unterminated text on every prepare, which is quadratic on a long script.
+// As for SQLite, a NUL inside a std::string ends the script.
+// A failing statement throws, with the byte offset of the statement in the script appended to the message.
+std::vector<ScriptStatement> sqliteExecuteScript(const SqliteConnection &connection, const char *const script, const ScriptOptions &options = ScriptOptions{});
+
+std::vector<ScriptStatement> sqliteExecuteScript(const SqliteConnection &connection, const std::string &script, const ScriptOptions &options = ScriptOptions{});
+
+}
+
+#endif
@@ -1,6 +1,24 @@
+#ifndef IncludeSqliteConnection_
+#define IncludeSqliteConnection_
+
+#include "OpenOptions.hpp"
+#include "StatementCache.hpp"
 #include "UniqueHandle.hpp"
 #include <sqlite3.h>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __has_include(<span>)
+#include <span>
+#endif
 
 namespace Sqlite {
 	
@@ -12,9 +30,356 @@ struct exception
 	exception(sqlite3 *connection) : errorCode_{sqlite3_extended_errcode(connection)}, errorMessage_{sqlite3_errmsg(connection)}
 	{
 	}
+	
+	exception(const int errorCode, std::string errorMessage) : errorCode_{errorCode}, errorMessage_{std::move(errorMessage)}
+	{
+	}
 };
 	
 
+// Typed access to the arguments and the result of SQL functions, see SqliteConnection::createFunction and createAggregate.
+
+template <typename Value, typename Enable = void>
+struct valueReader;
+
+template <typename Value>
+struct valueReader<Value, std::enable_if_t<std::is_integral_v<Value>>> {
+	static Value read(sqlite3_value *const value) noexcept {
+		if constexpr (sizeof(Value) <= sizeof(int)) {
+			return static_cast<Value>(sqlite3_value_int(value));
+		}
+		else {
+			return static_cast<Value>(sqlite3_value_int64(value));
+		}
+	}
+};
+
+template <typename Value>
+struct valueReader<Value, std::enable_if_t<std::is_floating_point_v<Value>>> {
+	static Value read(sqlite3_value *const value) noexcept {
+		return static_cast<Value>(sqlite3_value_double(value));
+	}
+};
+
+template <>
+struct valueReader<const char *> {
+	static const char *read(sqlite3_value *const value) noexcept {
+		return reinterpret_cast<const char *>(sqlite3_value_text(value));
+	}
+};
+
+template <>
+struct valueReader<std::string_view> {
+	static std::string_view read(sqlite3_value *const value) noexcept {
+		//sqlite3_value_bytes must be called after sqlite3_value_text, which may convert the value
+		const char *const text = reinterpret_cast<const char *>(sqlite3_value_text(value));
+		return std::string_view(text, static_cast<std::size_t>(sqlite3_value_bytes(value)));
+	}
+};
+
+template <>
+struct valueReader<std::string> {
+	static std::string read(sqlite3_value *const value) {
+		return std::string(valueReader<std::string_view>::read(value));
+	}
+};
+
+#ifdef __cpp_lib_span
+template <>
+struct valueReader<std::span<const std::byte>> {
+	static std::span<const std::byte> read(sqlite3_value *const value) noexcept {
+		const std::byte *const blob = static_cast<const std::byte *>(sqlite3_value_blob(value));
+		return std::span<const std::byte>(blob, static_cast<std::size_t>(sqlite3_value_bytes(value)));
+	}
+};
+#endif
+
+//the argument as it is, for functions taking values of any type
+template <>
+struct valueReader<sqlite3_value *> {
+	static sqlite3_value *read(sqlite3_value *const value) noexcept {
+		return value;
+	}
+};
+
+template <typename Value>
+struct valueReader<std::optional<Value>> {
+	static std::optional<Value> read(sqlite3_value *const value) noexcept(noexcept(valueReader<Value>::read(value))) {
+		if (sqlite3_value_type(value) == SQLITE_NULL) {
+			return std::nullopt;
+		}
+		return valueReader<Value>::read(value);
+	}
+};
+
+template <typename Value, typename Enable = void>
+struct resultWriter;
+
+template <typename Value>
+struct resultWriter<Value, std::enable_if_t<std::is_integral_v<Value>>> {
+	static void write(sqlite3_context *const context, const Value value) noexcept {
+		if constexpr (sizeof(Value) < sizeof(int) || (sizeof(Value) == sizeof(int) && std::is_signed_v<Value>)) {
+			sqlite3_result_int(context, value);
+		}
+		else {
+			sqlite3_result_int64(context, static_cast<sqlite3_int64>(value));
+		}
+	}
+};
+
+template <typename Value>
+struct resultWriter<Value, std::enable_if_t<std::is_floating_point_v<Value>>> {
+	static void write(sqlite3_context *const context, const Value value) noexcept {
+		sqlite3_result_double(context, static_cast<double>(value));
+	}
+};
+
+//text and blobs are copied by SQLite, since the function's result is gone once it returns
+template <>
+struct resultWriter<std::string_view> {
+	static void write(sqlite3_context *const context, const std::string_view value) noexcept {
+		//a null pointer would make the result NULL instead of empty
+		sqlite3_result_text64(context, value.data() != nullptr ? value.data() : "", value.size(), SQLITE_TRANSIENT, SQLITE_UTF8);
+	}
+};
+
+template <>
+struct resultWriter<std::string> {
+	static void write(sqlite3_context *const context, const std::string &value) noexcept {
+		resultWriter<std::string_view>::write(context, value);
+	}
+};
+
+template <>
+struct resultWriter<const char *> {
+	static void write(sqlite3_context *const context, const char *const value) noexcept {
+		if (value == nullptr) {
+			sqlite3_result_null(context);
+		}
+		else {
+			sqlite3_result_text(context, value, -1, SQLITE_TRANSIENT);
+		}
+	}
+};
+
+template <>
+struct resultWriter<std::vector<std::byte>> {
+	static void write(sqlite3_context *const context, const std::vector<std::byte> &value) noexcept {
+		if (value.empty()) {
+			sqlite3_result_zeroblob(context, 0);
+		}
+		else {
+			sqlite3_result_blob64(context, value.data(), value.size(), SQLITE_TRANSIENT);
+		}
+	}
+};
+
+#ifdef __cpp_lib_span
+template <>
+struct resultWriter<std::span<const std::byte>> {
+	static void write(sqlite3_context *const context, const std::span<const std::byte> value) noexcept {
+		if (value.empty()) {
+			sqlite3_result_zeroblob(context, 0);
+		}
+		else {
+			sqlite3_result_blob64(context, value.data(), value.size(), SQLITE_TRANSIENT);
+		}
+	}
+};
+#endif
+
+template <>
+struct resultWriter<std::nullptr_t> {
+	static void write(sqlite3_context *const context, std::nullptr_t) noexcept {
+		sqlite3_result_null(context);
+	}
+};
+
+template <typename Value>
+struct resultWriter<std::optional<Value>> {
+	static void write(sqlite3_context *const context, const std::optional<Value> &value) noexcept {
+		if (value) {
+			resultWriter<Value>::write(context, *value);
+		}
+		else {
+			sqlite3_result_null(context);
+		}
+	}
+};
+
+// The argument types of a function, a function pointer or a callable object, such as a lambda.
+template <typename Function>
+struct functionTraits : public functionTraits<decltype(&Function::operator())> {
+};
+
+template <typename Result, typename... Arguments>
+struct functionTraits<Result (*)(Arguments...)> {
+	using arguments = std::tuple<Arguments...>;
+};
+
+template <typename Result, typename... Arguments>
+struct functionTraits<Result (*)(Arguments...) noexcept> : public functionTraits<Result (*)(Arguments...)> {
+};
+
+template <typename Class, typename Result, typename... Arguments>
+struct functionTraits<Result (Class::*)(Arguments...)> : public functionTraits<Result (*)(Arguments...)> {
+};
+
+template <typename Class, typename Result, typename... Arguments>
+struct functionTraits<Result (Class::*)(Arguments...) noexcept> : public functionTraits<Result (*)(Arguments...)> {
+};
+
+template <typename Class, typename Result, typename... Arguments>
+struct functionTraits<Result (Class::*)(Arguments...) const> : public functionTraits<Result (*)(Arguments...)> {
+};
+
+template <typename Class, typename Result, typename... Arguments>
+struct functionTraits<Result (Class::*)(Arguments...) const noexcept> : public functionTraits<Result (*)(Arguments...)> {
+};
+
+//runs call and hands what it returns, if anything, to SQLite as the result of the function
+template <typename Call>
+void setFunctionResult(sqlite3_context *const context, Call &&call) {
+	if constexpr (std::is_void_v<decltype(call())>) {
+		call();
+	}
+	else {
+		resultWriter<std::decay_t<decltype(call())>>::write(context, call());
+	}
+}
+
+//reports the exception being handled as the error of the function, the query fails with it
+inline void setFunctionError(sqlite3_context *const context) noexcept {
+	try {
+		throw;
+	}
+	catch (const exception &error) {
+		sqlite3_result_error(context, error.errorMessage_.c_str(), -1);
+		sqlite3_result_error_code(context, error.errorCode_ != SQLITE_OK ? error.errorCode_ : SQLITE_ERROR);
+	}
+	catch (const std::bad_alloc &) {
+		sqlite3_result_error_nomem(context);
+	}
+	catch (const std::exception &error) {
+		sqlite3_result_error(context, error.what(), -1);
+	}
+	catch (...) {
+		sqlite3_result_error(context, "unknown exception", -1);
+	}
+}
+
+template <typename Data>
+void destroyFunctionData(void *const data) noexcept {
+	delete static_cast<Data *>(data);
+}
+
+template <typename Function, typename Arguments = typename functionTraits<Function>::arguments>
+struct scalarFunction;
+
+template <typename Function, typename... Arguments>
+struct scalarFunction<Function, std::tuple<Arguments...>> {
+	template <std::size_t... Indexes>
+	static void invoke(sqlite3_context *const context, Function &function, sqlite3_value **const values, std::index_sequence<Indexes...>) {
+		setFunctionResult(context, [&]() -> decltype(auto) {
+			return function(valueReader<std::decay_t<Arguments>>::read(values[Indexes])...);
+		});
+	}
+
+	static void call(sqlite3_context *const context, int, sqlite3_value **const values) noexcept {
+		try {
+			invoke(context, *static_cast<Function *>(sqlite3_user_data(context)), values, std::index_sequence_for<Arguments...>{});
+		}
+		catch (...) {
+			setFunctionError(context);
+		}
+	}
+};
+
+// step(State &, Arguments...) folds a row into the state, which is value-initialized for every group, and finish(State &) returns the result.
+template <typename Step, typename Finish, typename Arguments = typename functionTraits<Step>::arguments>
+struct aggregateFunction;
+
+template <typename Step, typename Finish, typename State, typename... Arguments>
+struct aggregateFunction<Step, Finish, std::tuple<State &, Arguments...>> {
+	Step step_;
+	Finish finish_;
+
+	template <std::size_t... Indexes>
+	void callStep(State &state, sqlite3_value **const values, std::index_sequence<Indexes...>) {
+		step_(state, valueReader<std::decay_t<Arguments>>::read(values[Indexes])...);
+	}
+
+	//the aggregate context of SQLite holds a pointer to the state, so that the state is constructed and destroyed like a C++ object
+	static void step(sqlite3_context *const context, int, sqlite3_value **const values) noexcept {
+		try {
+			State **const slot = static_cast<State **>(sqlite3_aggregate_context(context, sizeof(State *)));
+			if (slot == nullptr) {
+				throw std::bad_alloc();
+			}
+			if (*slot == nullptr) {
+				*slot = new State();
+			}
+			static_cast<aggregateFunction *>(sqlite3_user_data(context))->callStep(**slot, values, std::index_sequence_for<Arguments...>{});
+		}
+		catch (...) {
+			setFunctionError(context);
+		}
+	}
+
+	static void finish(sqlite3_context *const context) noexcept {
+		State **const slot = static_cast<State **>(sqlite3_aggregate_context(context, 0));
+		std::unique_ptr<State> state(slot != nullptr ? *slot : nullptr);
+		try {
+			//a group without rows still has a result, from a fresh state
+			if (!state) {
+				state = std::make_unique<State>();
+			}
+			aggregateFunction &function = *static_cast<aggregateFunction *>(sqlite3_user_data(context));
+			setFunctionResult(context, [&]() -> decltype(auto) {
+				return function.finish_(*state);
+			});
+		}
+		catch (...) {
+			setFunctionError(context);
+		}
+	}
+};
+
+// Memory and page cache counters of a connection (sqlite3_db_status) and of the whole process (sqlite3_status64), see SqliteConnection::stats.
+struct ConnectionStats {
+	//heap bytes of the connection: its page cache, the part of a shared cache charged to it, its schemas and its prepared statements
+	long long cacheUsed_{0};
+	long long cacheUsedShared_{0};
+	long long schemaUsed_{0};
+	long long statementUsed_{0};
+	//page cache lookups and writes since the connection was opened or the counters were reset
+	long long cacheHits_{0};
+	long long cacheMisses_{0};
+	long long cacheWrites_{0};
+	long long cacheSpills_{0};
+	//lookaside slots in use now and at most, and the allocations served from them or missed because the slots were too small or all taken
+	long long lookasideUsed_{0};
+	long long lookasideHighwater_{0};
+	long long lookasideHits_{0};
+	long long lookasideMissesSize_{0};
+	long long lookasideMissesFull_{0};
+	//the heap of the process as counted by SQLite, for all connections
+	long long memoryUsed_{0};
+	long long memoryHighwater_{0};
+	long long allocations_{0};
+	long long largestAllocation_{0};
+	long long pagecacheOverflow_{0};
+
+	double cacheHitRate() const noexcept {
+		const long long lookups = cacheHits_ + cacheMisses_;
+		return lookups == 0 ? 0.0 : static_cast<double>(cacheHits_) / static_cast<double>(lookups);
+	}
+};
+
+template <typename Container, typename... Columns>
+class containerModule;
+
+
 class SqliteConnection {
 	
 	struct SqliteConnectionTraits : public nullHandleTraits<sqlite3 *> {
@@ -22,18 +387,40 @@ class SqliteConnection {
 			sqlite3_close(value);
 		}
 	};
+#ifdef SQLITECPP_ENABLE_PROFILING
+	//declared before the handle, so that it outlives the trace callback
+	std::unique_ptr<StatementProfiler> profiler_;
+#endif
 	UniqueHandle<SqliteConnectionTraits> connectionHandle_;
+	
+	//declared after the handle, so that the cached statements are finalized before the connection is closed
+	std::unique_ptr<StatementCache> statementCache_{std::make_unique<StatementCache>()};
+
+	//leases from and returns to statementCache_, which synchronizes itself
+	friend class CachedStatement;
 
 	template <typename Function, typename CharacterSet>
-	void internalOpen(Function openFunction, const CharacterSet *const filename);
+	void internalOpen(Function openFunction, const CharacterSet *const filename, const OpenOptions *const options = nullptr);
+	
+	void configure(const OpenOptions &options);
+
+	void pragma(const std::string &text) const;
 
   public:
 	SqliteConnection() = default;
 
 	template <typename CharacterSet>
-	explicit sqliteConnection(const CharacterSet *const filename) {
+	explicit SqliteConnection(const CharacterSet *const filename) {
 		open(filename);
 	}
+	
+	SqliteConnection(const char *const filename, const int flags, const char *const vfs = nullptr) {
+		open(filename, flags, vfs);
+	}
+	
+	SqliteConnection(const char *const filename, const OpenOptions &options) {
+		open(filename, options);
+	}
 
 	explicit operator bool() const noexcept {
 		return static_cast<bool>(connectionHandle_);
@@ -51,13 +438,86 @@ class SqliteConnection {
 		return connectionHandle_.get();
 	}
 	
+	const StatementCache &statementCache() const noexcept {
+		return *statementCache_;
+	}
+
+	StatementCache &statementCache() noexcept {
+		return *statementCache_;
+	}
+	
 	void throwLastError() const;
+	
+#ifdef SQLITECPP_ENABLE_PROFILING
+	//the profiler of the statements, nullptr while profiling is disabled
+	StatementProfiler *profiler() const noexcept {
+		return profiler_ && profiler_->enabled() ? profiler_.get() : nullptr;
+	}
+	
+	//the profiles are kept when profiling is disabled and enabled again
+	void enableProfiling();
+	
+	void disableProfiling() noexcept;
+	
+	std::vector<StatementProfile> profile() const;
+#endif
 
 	void open(const char *const filename);
 
 	void open(const wchar_t *const filename);
 	
+	//opens with sqlite3_open_v2, flags are the SQLITE_OPEN_* flags
+	void open(const char *const filename, const int flags, const char *const vfs = nullptr);
+	
+	void open(const char *const filename, const OpenOptions &options);
+	
+	//reset starts the hit, miss, write and spill counters and the lookaside highwaters of the connection over
+	ConnectionStats stats(const bool reset = false) const;
+
+	//bytes of the database file read through a memory map, 0 turns it off, capped by SQLITE_MAX_MMAP_SIZE
+	void setMmapSize(const long long bytes) const;
+
+	//pages when positive, KiB when negative, like PRAGMA cache_size
+	void setCacheSize(const long long size) const;
+
+	//slotCount slots of slotSize bytes, allocated by SQLite, for the small allocations of the connection, fails with SQLITE_BUSY while a slot is in use
+	void configureLookaside(const int slotSize, const int slotCount) const;
+
+	//registers function as the SQL function name, its arguments are read like get<Argument>() reads columns and its result is returned to SQL
+	//flags are added to SQLITE_UTF8, e.g. SQLITE_DETERMINISTIC, which lets the planner factor out calls and index the function, or SQLITE_INNOCUOUS
+	template <typename Function>
+	void createFunction(const char *const name, Function function, const int flags = 0) const {
+		using Arguments = typename functionTraits<Function>::arguments;
+		//SQLite deletes the function when the registration fails, is replaced or the connection is closed
+		if (SQLITE_OK != sqlite3_create_function_v2(getABI(), name, static_cast<int>(std::tuple_size_v<Arguments>), SQLITE_UTF8 | flags, new Function(std::move(function)), &scalarFunction<Function>::call, nullptr, nullptr, &destroyFunctionData<Function>)) {
+			throwLastError();
+		}
+	}
+
+	//registers an aggregate SQL function: step(State &, Arguments...) is called for every row of a group and finish(State &) returns its result
+	template <typename Step, typename Finish>
+	void createAggregate(const char *const name, Step step, Finish finish, const int flags = 0) const {
+		using Function = aggregateFunction<Step, Finish>;
+		const int argumentCount = static_cast<int>(std::tuple_size_v<typename functionTraits<Step>::arguments>) - 1;
+		if (SQLITE_OK != sqlite3_create_function_v2(getABI(), name, argumentCount, SQLITE_UTF8 | flags, new Function{std::move(step), std::move(finish)}, nullptr, &Function::step, &Function::finish, &destroyFunctionData<Function>)) {
+			throwLastError();
+		}
+	}
+
+	//exposes container to SQL as the read-only eponymous virtual table name, with the columns made by tableColumn and keyColumn
+	//the container is read in place, so it must outlive the connection and not change while a query reads it
+	template <typename Container, typename... Columns>
+	void createVirtualTable(const char *const name, const Container &container, Columns... columns) const {
+		using Module = containerModule<Container, Columns...>;
+		//SQLite deletes the module when the registration fails, is replaced or the connection is closed
+		if (SQLITE_OK != sqlite3_create_module_v2(getABI(), name, Module::module(), new Module(container, std::move(columns)...), &destroyFunctionData<Module>)) {
+			throwLastError();
+		}
+	}
+
 	long long lastRowId() const noexcept;
 };
 
 }
+
+#endif
@@ -1,6 +1,90 @@
+#ifndef IncludeSqliteStatement_
+#define IncludeSqliteStatement_
+
+#include "ResultSet.hpp"
 #include "SqliteConnection.hpp"
+#include "TextEncoding.hpp"
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __has_include(<span>)
+#include <span>
+#endif
 
 namespace Sqlite{
+  // Converts a column of the current row, specialized per C++ type so that the conversion is chosen at compile time.
+  // Text and blob views point into the statement and are valid until the next step, reset or conversion of the column.
+  template <typename Value, typename Enable = void>
+  struct columnReader;
+
+  template <typename Value>
+  struct columnReader<Value, std::enable_if_t<std::is_integral_v<Value>>> {
+	static Value read(sqlite3_stmt *const statement, const int columnNum) noexcept {
+		if constexpr (sizeof(Value) <= sizeof(int)) {
+			return static_cast<Value>(sqlite3_column_int(statement, columnNum));
+		}
+		else {
+			return static_cast<Value>(sqlite3_column_int64(statement, columnNum));
+		}
+	}
+  };
+
+  template <typename Value>
+  struct columnReader<Value, std::enable_if_t<std::is_floating_point_v<Value>>> {
+	static Value read(sqlite3_stmt *const statement, const int columnNum) noexcept {
+		return static_cast<Value>(sqlite3_column_double(statement, columnNum));
+	}
+  };
+
+  template <>
+  struct columnReader<const char *> {
+	static const char *read(sqlite3_stmt *const statement, const int columnNum) noexcept {
+		return reinterpret_cast<const char *>(sqlite3_column_text(statement, columnNum));
+	}
+  };
+
+  template <>
+  struct columnReader<std::string_view> {
+	static std::string_view read(sqlite3_stmt *const statement, const int columnNum) noexcept {
+		//sqlite3_column_bytes must be called after sqlite3_column_text, which may convert the value
+		const char *const text = reinterpret_cast<const char *>(sqlite3_column_text(statement, columnNum));
+		return std::string_view(text, static_cast<std::size_t>(sqlite3_column_bytes(statement, columnNum)));
+	}
+  };
+
+  template <>
+  struct columnReader<std::string> {
+	static std::string read(sqlite3_stmt *const statement, const int columnNum) {
+		return std::string(columnReader<std::string_view>::read(statement, columnNum));
+	}
+  };
+
+#ifdef __cpp_lib_span
+  template <>
+  struct columnReader<std::span<const std::byte>> {
+	static std::span<const std::byte> read(sqlite3_stmt *const statement, const int columnNum) noexcept {
+		const std::byte *const blob = static_cast<const std::byte *>(sqlite3_column_blob(statement, columnNum));
+		return std::span<const std::byte>(blob, static_cast<std::size_t>(sqlite3_column_bytes(statement, columnNum)));
+	}
+  };
+#endif
+
+  template <typename Value>
+  struct columnReader<std::optional<Value>> {
+	static std::optional<Value> read(sqlite3_stmt *const statement, const int columnNum) noexcept(noexcept(columnReader<Value>::read(statement, columnNum))) {
+		if (sqlite3_column_type(statement, columnNum) == SQLITE_NULL) {
+			return std::nullopt;
+		}
+		return columnReader<Value>::read(statement, columnNum);
+	}
+  };
+
+
   template <typename T>
   struct sqliteReader {
 	  
@@ -12,34 +96,152 @@ namespace Sqlite{
 		return reinterpret_cast<const char *>(sqlite3_column_text(static_cast<const T *>(this)->getABI(), columnNum));
 	}
 
-	constexpr const  wchar_t *getWideString(const int columnNum = 0) const noexcept {
-		return static_cast<const wchar_t *>(sqlite3_column_text16(static_cast<const T *>(this)->getABI(), columnNum));
+	//where wchar_t is UTF-32 the text is converted from UTF-8 into a buffer of the statement, valid until the next step or conversion of the column
+	const wchar_t *getWideString(const int columnNum = 0) const {
+		return getWideStringView(columnNum).data();
 	}
 
-	constexpr int getStringLength(const int columnNum) const ;
+	std::wstring_view getWideStringView(const int columnNum = 0) const {
+		return static_cast<const T *>(this)->wideText().column(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	constexpr int getStringLength(const int columnNum) const noexcept {
+		return sqlite3_column_bytes(static_cast<const T *>(this)->getABI(), columnNum);
+	}
 	
-	constexpr int getWideStringLength(const int columnNum) const noexcept ;
+	//converts the column again where wchar_t is UTF-32, getWideStringView returns the text and its length in one conversion
+	int getWideStringLength(const int columnNum) const {
+		return static_cast<int>(getWideStringView(columnNum).size());
+	}
+
+	long long getInt64(const int columnNum = 0) const noexcept {
+		return sqlite3_column_int64(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	double getDouble(const int columnNum = 0) const noexcept {
+		return sqlite3_column_double(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	const void *getBlob(const int columnNum = 0) const noexcept {
+		return sqlite3_column_blob(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	int getBlobLength(const int columnNum) const noexcept {
+		return sqlite3_column_bytes(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	//SQLITE_INTEGER, SQLITE_FLOAT, SQLITE_TEXT, SQLITE_BLOB or SQLITE_NULL
+	int getType(const int columnNum = 0) const noexcept {
+		return sqlite3_column_type(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+	bool isNull(const int columnNum = 0) const noexcept {
+		return getType(columnNum) == SQLITE_NULL;
+	}
 
+	int getColumnCount() const noexcept {
+		return sqlite3_column_count(static_cast<const T *>(this)->getABI());
+	}
+
+	//get<std::string_view>, get<std::span<const std::byte>>, get<long long>, get<double>, get<std::optional<...>>, ... without copying text or blobs
+	template <typename Value>
+	Value get(const int columnNum = 0) const noexcept(noexcept(columnReader<Value>::read(nullptr, 0))) {
+		return columnReader<Value>::read(static_cast<const T *>(this)->getABI(), columnNum);
+	}
+
+  };
+	
+  //placeholder bound as a BLOB of size_ zero bytes, to be filled later through a BlobStream
+  struct zeroBlob {
+	sqlite3_uint64 size_;
   };
 	
+  // Decoders of a whole row, the column conversions are expanded at compile time from the column types.
+  template <typename... Values>
+  struct tupleDecoder {
+	using value_type = std::tuple<Values...>;
+
+	static constexpr int columnCount = sizeof...(Values);
+
+	static value_type decode(sqlite3_stmt *const statement) {
+		return decode(statement, std::index_sequence_for<Values...>{});
+	}
+
+	template <std::size_t... Columns>
+	static value_type decode(sqlite3_stmt *const statement, std::index_sequence<Columns...>) {
+		return value_type(columnReader<Values>::read(statement, static_cast<int>(Columns))...);
+	}
+  };
+
+  template <typename Struct, typename... Values>
+  struct structDecoder {
+	using value_type = Struct;
+
+	static constexpr int columnCount = sizeof...(Values);
+
+	static value_type decode(sqlite3_stmt *const statement) {
+		return decode(statement, std::index_sequence_for<Values...>{});
+	}
+
+	template <std::size_t... Columns>
+	static value_type decode(sqlite3_stmt *const statement, std::index_sequence<Columns...>) {
+		return value_type{columnReader<Values>::read(statement, static_cast<int>(Columns))...};
+	}
+  };
+
+  template <typename Decoder>
+  class typedRows;
+
+
   class SqliteStatement : public sqliteReader<SqliteStatement> {
 	
-	struct SqliteStatementTraits {
+	struct SqliteStatementTraits : public nullHandleTraits<sqlite3_stmt *> {
 		static void close(sqlite3_stmt *value) noexcept {
 			sqlite3_finalize(value);
 		}
 	};
 
 	UniqueHandle<SqliteStatementTraits> statementHandle_;
+	
+	StatementParameters parameters_;
+	
+	mutable wideTextBuffers wideText_;
+	
+	//moved-in values bound with SQLITE_STATIC, by parameter index
+	mutable std::vector<std::pair<int, std::shared_ptr<void>>> ownedValues_;
+	
+	void keepAlive(const int index, std::shared_ptr<void> value) const;
+	
+#ifdef SQLITECPP_ENABLE_PROFILING
+	StatementProfiler *profiler_{nullptr};
+	mutable unsigned long long steps_{0};
+	mutable unsigned long long rows_{0};
+	
+	//hands the steps of the current run to the profiler, when it ends or the statement is reset
+	void flushProfile() const noexcept;
+#endif
 
 	template <typename PrepareFunction, typename CharacterSet, typename... VALUES>
 	void internalPrepare(const SqliteConnection &connection, const PrepareFunction prepare, const CharacterSet *const text, VALUES &&... values) {
+#ifdef SQLITECPP_ENABLE_PROFILING
+		profiler_ = connection.profiler();
+		const auto start = std::chrono::steady_clock::now();
+#endif
 		if (SQLITE_OK != prepare(connection.getABI(), text, -1, statementHandle_.set(), nullptr)) {
 			connection.throwLastError();
 		}
+		parameters_ = StatementParameters();
+#ifdef SQLITECPP_ENABLE_PROFILING
+		if (profiler_) {
+			profiler_->recordPrepare(getABI(), std::chrono::steady_clock::now() - start);
+		}
+#endif
 		bindAll(std::forward<VALUES>(values)...);
 	}
 	  
+	//throws SQLITE_RANGE when index is 0, the statement has no parameter named name
+	int namedIndex(const int index, const std::string_view name) const;
+
 	void internalBindAll(const int) const noexcept{
 	}
 	
@@ -48,6 +250,26 @@ namespace Sqlite{
 		bind(index, std::forward<FIRST>(first));
 		internalBindAll(index + 1, std::forward<REST_VALUES>(restValues)...);
 	}
+  protected:
+	SqliteStatement(sqlite3_stmt *const statement, StatementParameters &&parameters) noexcept : statementHandle_{statement}, parameters_{std::move(parameters)} {
+	}
+	
+	StatementParameters releaseParameters() noexcept {
+		return std::move(parameters_);
+	}
+	
+	sqlite3_stmt *releaseABI() noexcept {
+#ifdef SQLITECPP_ENABLE_PROFILING
+		flushProfile();
+#endif
+		return statementHandle_.release();
+	}
+	
+#ifdef SQLITECPP_ENABLE_PROFILING
+	void setProfiler(StatementProfiler *const profiler) noexcept {
+		profiler_ = profiler;
+	}
+#endif
   public:
 	SqliteStatement() = default;
 	  
@@ -66,6 +288,11 @@ namespace Sqlite{
 
 	void throwLastError() const;
 
+	//conversion buffers of the wide text columns and parameters
+	wideTextBuffers &wideText() const noexcept {
+		return wideText_;
+	}
+
 	template <typename... VALUES>
 	void prepare(const SqliteConnection &connection, const char *const characterSet, VALUES &&... values){
 		internalPrepare(connection, sqlite3_prepare_v2, characterSet, std::forward<VALUES>(values)...);
@@ -73,43 +300,239 @@ namespace Sqlite{
 		
 	template <typename... VALUES>
 	void prepare(const SqliteConnection &connection, const wchar_t *const characterSet, VALUES &&... values) {
-		internalPrepare(connection, sqlite3_prepare16_v2, characterSet, std::forward<VALUES>(values)...);
+		if constexpr (wideIsUtf32) {
+			std::string text;
+			wideToUtf8(characterSet, text);
+			internalPrepare(connection, sqlite3_prepare_v2, text.c_str(), std::forward<VALUES>(values)...);
+		}
+		else {
+			internalPrepare(connection, sqlite3_prepare16_v2, characterSet, std::forward<VALUES>(values)...);
+		}
 	}
 	  
 	bool execute() const ;  
 	  
 	void bind(const int index, const int value) const ;
 	
-	void bind(const int index, const char *const strValue, const int size ) const ;
+	void bind(const int index, const char *const strValue, const int size = -1) const ;
 	
-	void bind(const int index, const wchar_t *const strValue, const int size ) const ;
+	//size in bytes, where wchar_t is UTF-32 the text is bound as UTF-8 converted into a buffer of the statement
+	void bind(const int index, const wchar_t *const strValue, const int size = -1) const ;
 	
 	void bind(const int index, const std::string &strValue) const ;
 	
 	void bind(const int index, const std::wstring &strValue) const ;
 	
-	void bind(const int index, const std::string &&strValue) const ;
+	//the statement keeps the moved string alive instead of SQLite copying it with SQLITE_TRANSIENT
+	void bind(const int index, std::string &&strValue) const ;
+	
+	void bind(const int index, std::wstring &&strValue) const ;
 	
-	void bind(const int index, const std::wstring &&strValue) const ;
+	//every integer type but int, which has its own overload, and bool, which goes through it; unsigned values past the range of sqlite3_int64 throw SQLITE_RANGE
+	template <typename Integer, std::enable_if_t<std::is_integral_v<Integer> && !std::is_same_v<Integer, int> && !std::is_same_v<Integer, bool>, int> = 0>
+	void bind(const int index, const Integer value) const {
+		if constexpr (std::is_unsigned_v<Integer> && sizeof(Integer) >= sizeof(sqlite3_int64)) {
+			if (value > static_cast<Integer>(std::numeric_limits<sqlite3_int64>::max())) {
+				throw exception(SQLITE_RANGE, "the unsigned value does not fit in a 64-bit signed integer");
+			}
+		}
+		if (SQLITE_OK != sqlite3_bind_int64(getABI(), index, static_cast<sqlite3_int64>(value))) {
+			throwLastError();
+		}
+	}
+	
+	void bind(const int index, const double value) const ;
+	
+	void bind(const int index, std::nullptr_t) const ;
+	
+	template <typename Value>
+	void bind(const int index, const std::optional<Value> &value) const {
+		if (value) {
+			bind(index, *value);
+		}
+		else {
+			bind(index, nullptr);
+		}
+	}
+	
+	template <typename Value>
+	void bind(const int index, std::optional<Value> &&value) const {
+		if (value) {
+			bind(index, std::move(*value));
+		}
+		else {
+			bind(index, nullptr);
+		}
+	}
+	
+	void bind(const int index, const std::string_view strValue) const ;
+	
+	void bindBlob(const int index, const void *const blob, const sqlite3_uint64 size) const ;
+	
+	void bind(const int index, const std::vector<std::byte> &blob) const ;
+	
+	void bind(const int index, std::vector<std::byte> &&blob) const ;
+	
+	void bind(const int index, const zeroBlob blob) const ;
+	
+#ifdef __cpp_lib_span
+	void bind(const int index, const std::span<const std::byte> blob) const ;
+#endif
+	
+	//hands the buffer over to SQLite, which deletes it when it is no longer bound
+	void bind(const int index, std::unique_ptr<std::byte[]> &&blob, const sqlite3_uint64 size) const ;
+	
+	void bind(const int index, std::unique_ptr<char[]> &&strValue, const sqlite3_uint64 size) const ;
 
+	//index of the parameter named name, with its prefix character (":id", "@id", "$id"), 0 when there is none
+	int parameterIndex(const std::string_view name) const {
+		return parameters_.index(getABI(), name);
+	}
+	
+	template <typename Value>
+	void bind(const std::string_view name, Value &&value) const {
+		bind(namedIndex(parameters_.index(getABI(), name), name), std::forward<Value>(value));
+	}
+	
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+	//the index is looked up on the first bind of Name to this prepared statement only
+	template <parameterName Name, typename Value>
+	void bind(Value &&value) const {
+		static_assert(Name.text_[0] == ':' || Name.text_[0] == '@' || Name.text_[0] == '$' || Name.text_[0] == '?', "a parameter name starts with :, @, $ or ?");
+		bind(namedIndex(parameters_.index(getABI(), parameterSlot<Name>(), Name.view()), Name.view()), std::forward<Value>(value));
+	}
+#endif
+	
 	template <typename... Values>
 	void bindAll(Values &&... values) const {
 		internalBindAll(1, std::forward<Values>(values)...);
 	}
-	  
+	
 	template <typename ...Values>
-	void bindAll(Values &&... values) const {
-		internalBindAll(1, std::forward<Values>(values)...);
+	void reset(Values&&... values) {
+#ifdef SQLITECPP_ENABLE_PROFILING
+		flushProfile();
+#endif
+		if (SQLITE_OK != sqlite3_reset(getABI())) {
+			throwLastError();
+		}
+		bindAll(std::forward<Values>(values)...);
+	}
+
+	//steps through the remaining rows into result, which keeps its buffers from a previous query
+	void fetchAll(ResultSet &result) const ;
+	
+	ResultSet fetchAll() const ;
+
+	//the rows as std::tuple<Values...>
+	template <typename... Values>
+	typedRows<tupleDecoder<Values...>> rows() const {
+		return typedRows<tupleDecoder<Values...>>(*this);
+	}
+
+	//the rows as Struct{Values...}, one value per column
+	template <typename Struct, typename... Values>
+	typedRows<structDecoder<Struct, Values...>> rowsAs() const {
+		return typedRows<structDecoder<Struct, Values...>>(*this);
 	}
 	  
 
   };
+
+  template <typename Decoder>
+  class typedRowIterator {
+
+	SqliteStatement const *statement_{nullptr};
+
+    public:
+
+	typedRowIterator() noexcept = default;
+
+	explicit typedRowIterator(const SqliteStatement &statement) {
+		if (statement.execute()) {
+			statement_ = &statement;
+		}
+	}
+
+	typedRowIterator &operator++() {
+		if (!statement_->execute()) {
+			statement_ = nullptr;
+		}
+		return *this;
+	}
+
+	bool operator!=(const typedRowIterator &other) const noexcept {
+		return statement_ != other.statement_;
+	}
+
+	typename Decoder::value_type operator*() const {
+		return Decoder::decode(statement_->getABI());
+	}
+  };
+
+  // Range over the rows of a statement decoded by Decoder, the column count is checked once when the range is created.
+  template <typename Decoder>
+  class typedRows {
+
+	const SqliteStatement *statement_;
+
+    public:
+
+	explicit typedRows(const SqliteStatement &statement) : statement_{&statement} {
+		const int columnCount = sqlite3_column_count(statement.getABI());
+		if (columnCount != Decoder::columnCount) {
+			throw exception(SQLITE_RANGE, "the statement returns " + std::to_string(columnCount) + " columns, " + std::to_string(Decoder::columnCount) + " are decoded");
+		}
+	}
+
+	typedRowIterator<Decoder> begin() const {
+		return typedRowIterator<Decoder>(*statement_);
+	}
+
+	typedRowIterator<Decoder> end() const noexcept {
+		return typedRowIterator<Decoder>();
+	}
+  };
+
+
+  // SqliteStatement leased from the statement cache of the connection, the prepared statement is returned to the cache instead of being finalized
+  class CachedStatement : public SqliteStatement {
+
+	StatementCache *cache_{nullptr};
+	StatementCache::Lease lease_;
+
+	CachedStatement(StatementCache &cache, const StatementCache::Lease lease) noexcept : SqliteStatement(lease->statement_, std::move(lease->parameters_)), cache_{&cache}, lease_{lease} {
+	}
+
+  public:
+	template <typename... VALUES>
+	CachedStatement(const SqliteConnection &connection, const char *const text, VALUES &&... values) : CachedStatement(*connection.statementCache_, connection.statementCache_->acquire(connection.getABI(), text)) {
+#ifdef SQLITECPP_ENABLE_PROFILING
+		setProfiler(connection.profiler());
+#endif
+		bindAll(std::forward<VALUES>(values)...);
+	}
+
+	CachedStatement(CachedStatement &&other) noexcept : SqliteStatement(std::move(other)), cache_{other.cache_}, lease_{other.lease_} {
+		other.cache_ = nullptr;
+	}
+
+	CachedStatement &operator=(CachedStatement &&) = delete;
+
+	~CachedStatement() noexcept;
+  };
 	
   template <typename CharacterSet, typename... Values>
   void sqliteExecute(const SqliteConnection &connection, const CharacterSet *const text, Values &&... values) {
 	SqliteStatement(connection, text, std::forward<Values>(values)...).execute();
   }
 
+  template <typename... Values>
+  void sqliteExecute(const SqliteConnection &connection, const char *const text, Values &&... values) {
+	CachedStatement(connection, text, std::forward<Values>(values)...).execute();
+  }
+
 
 }
-	
+
+#endif
@@ -1,9 +1,28 @@
+#ifndef IncludeSqliteWrapper_
+#define IncludeSqliteWrapper_
+
+#include "ArrowExporter.hpp"
+#include "AsyncExecutor.hpp"
+#include "Backup.hpp"
+#include "BlobStream.hpp"
+#include "BulkInserter.hpp"
+#include "ConnectionPool.hpp"
+#include "GlobalConfig.hpp"
+#include "GroupCommitWriter.hpp"
+#include "IoUringVfs.hpp"
+#include "ParallelScan.hpp"
+#include "ScriptRunner.hpp"
 #include "SqliteStatement.hpp"
+#include "Transaction.hpp"
+#include "VirtualTable.hpp"
 
 namespace Sqlite {
 
 class SqliteRow : public sqliteReader<SqliteRow> {
 	sqlite3_stmt *statement_{nullptr};
+	wideTextBuffers *wideText_{nullptr};
+	//for a row made from a bare statement handle
+	mutable wideTextBuffers ownWideText_;
 
   public:
   
@@ -13,12 +32,19 @@ class SqliteRow : public sqliteReader<SqliteRow> {
 	
 	SqliteRow(sqlite3_stmt *const statement) noexcept : statement_{statement} {
 	}
+	
+	SqliteRow(const SqliteStatement &statement) noexcept : statement_{statement.getABI()}, wideText_{&statement.wideText()} {
+	}
+
+	wideTextBuffers &wideText() const noexcept {
+		return wideText_ ? *wideText_ : ownWideText_;
+	}
 };
 
 
 class rowIterator {
 	
-	const SqliteStatement const *statement_{nullptr};
+	const SqliteStatement *statement_{nullptr};
 
   public:
 	rowIterator() noexcept = default;
@@ -48,3 +74,5 @@ constexpr inline rowIterator end(const SqliteStatement &) noexcept {
 
 
 }
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef IncludeSqliteStatementCache_
+#define IncludeSqliteStatementCache_
+
+#include "StatementParameters.hpp"
+#include "StatementProfiler.hpp"
+#include "UniqueHandle.hpp"
+#include <sqlite3.h>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Sqlite {
+
+// LRU cache of prepared statements owned by a SqliteConnection.
+// Leased statements are taken out of the cache and returned, reset and with cleared bindings, on release.
+// The cache is guarded by the mutex of its connection, unless that was opened with SQLITE_OPEN_NOMUTEX.
+class StatementCache {
+
+  public:
+
+	struct Entry {
+		std::string text_;
+		sqlite3_stmt *statement_;
+		//lent to the CachedStatement along with the statement
+		StatementParameters parameters_;
+	};
+
+	using Lease = std::list<Entry>::iterator;
+
+	struct Stats {
+		unsigned long long hits_{0};
+		unsigned long long misses_{0};
+		unsigned long long evictions_{0};
+		std::size_t size_{0};
+		std::size_t capacity_{0};
+	};
+
+	static constexpr std::size_t defaultCapacity = 32;
+
+  private:
+
+	//most recently used first
+	std::list<Entry> idle_;
+	std::list<Entry> leased_;
+	std::unordered_map<std::string_view, Lease> index_;
+	std::size_t capacity_;
+	Stats stats_;
+	//the mutex of a serialized connection, nullptr for a NOMUTEX one (sqlite3_mutex_enter ignores it)
+	sqlite3_mutex *mutex_{nullptr};
+#ifdef SQLITECPP_ENABLE_PROFILING
+	StatementProfiler *profiler_{nullptr};
+#endif
+
+	struct preparedTraits : public nullHandleTraits<sqlite3_stmt *> {
+		static void close(sqlite3_stmt *value) noexcept {
+			sqlite3_finalize(value);
+		}
+	};
+
+	class lock {
+		sqlite3_mutex *const mutex_;
+
+	  public:
+		lock(const lock &) = delete;
+		lock &operator=(const lock &) = delete;
+
+		explicit lock(sqlite3_mutex *const mutex) noexcept : mutex_{mutex} {
+			sqlite3_mutex_enter(mutex_);
+		}
+
+		~lock() noexcept {
+			sqlite3_mutex_leave(mutex_);
+		}
+	};
+
+	void trim() noexcept;
+
+  public:
+
+	StatementCache(const StatementCache &) = delete;
+	StatementCache &operator=(const StatementCache &) = delete;
+
+	explicit StatementCache(const std::size_t capacity = defaultCapacity) noexcept : capacity_{capacity} {
+	}
+
+	~StatementCache() noexcept {
+		clear();
+	}
+
+	//called by SqliteConnection once the connection is open
+	void attach(sqlite3 *const connection) noexcept {
+		mutex_ = sqlite3_db_mutex(connection);
+	}
+
+	Lease acquire(sqlite3 *const connection, const char *const text);
+
+	void release(const Lease lease) noexcept;
+
+	void clear() noexcept;
+
+	std::size_t capacity() const noexcept {
+		const lock guard(mutex_);
+		return capacity_;
+	}
+
+	void setCapacity(const std::size_t capacity) noexcept;
+
+#ifdef SQLITECPP_ENABLE_PROFILING
+	void setProfiler(StatementProfiler *const profiler) noexcept {
+		profiler_ = profiler;
+	}
+#endif
+
+	Stats stats() const noexcept;
+};
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef IncludeSqliteStatementParameters_
+#define IncludeSqliteStatementParameters_
+
+#include <sqlite3.h>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Sqlite {
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+// Parameter name as a template argument, SqliteStatement::bind<":name">(value).
+template <std::size_t Size>
+struct parameterName {
+	char text_[Size]{};
+
+	constexpr parameterName(const char (&text)[Size]) noexcept {
+		for (std::size_t character = 0; character < Size; ++character) {
+			text_[character] = text[character];
+		}
+	}
+
+	constexpr std::string_view view() const noexcept {
+		return std::string_view(text_, Size - 1);
+	}
+};
+#endif
+
+// Index of the named parameters (:name, @name, $name, ?NNN) of a prepared statement, read on the first lookup by name,
+// so that statements bound by position only never build it. The names point into the prepared statement, which keeps them
+// until it is finalized. Lookups are binary searches, and the indexes of the compile-time names bound to the statement
+// are remembered by name slot, so that rebinding them costs no string comparison.
+class StatementParameters {
+
+	//sorted by name
+	mutable std::vector<std::pair<std::string_view, int>> names_;
+	mutable bool read_{false};
+	//sorted by slot, at most one entry per named parameter of the statement
+	mutable std::vector<std::pair<std::size_t, int>> slots_;
+
+	void read(sqlite3_stmt *const statement) const;
+
+  public:
+	//0 when statement has no parameter of that name, the name includes its prefix character
+	int index(sqlite3_stmt *const statement, const std::string_view name) const;
+
+	int index(sqlite3_stmt *const statement, const std::size_t slot, const std::string_view name) const;
+
+	//a slot per compile-time name, numbered in the order of first use in the process
+	static std::size_t nextSlot() noexcept;
+};
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+template <parameterName Name>
+std::size_t parameterSlot() noexcept {
+	static const std::size_t slot = StatementParameters::nextSlot();
+	return slot;
+}
+#endif
+
+}
+
+#endif
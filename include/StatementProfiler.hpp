@@ -0,0 +1,82 @@
+#ifndef IncludeSqliteStatementProfiler_
+#define IncludeSqliteStatementProfiler_
+
+#ifdef SQLITECPP_ENABLE_PROFILING
+
+#include <sqlite3.h>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Sqlite {
+
+// Counters of every run of one SQL text, summed over the statements prepared from it.
+struct StatementProfile {
+	std::string sql_;
+	unsigned long long prepares_{0};
+	unsigned long long runs_{0};
+	unsigned long long steps_{0};
+	unsigned long long rows_{0};
+	std::chrono::nanoseconds prepareTime_{0};
+	//measured by SQLite with the clock of the VFS, which has a resolution of one millisecond with the unix VFS
+	std::chrono::nanoseconds runTime_{0};
+	//sqlite3_stmt_status counters
+	unsigned long long fullscanSteps_{0};
+	unsigned long long sorts_{0};
+	unsigned long long autoindexes_{0};
+	unsigned long long vmSteps_{0};
+};
+
+
+// Per SQL text profiles of a SqliteConnection, only compiled in with SQLITECPP_ENABLE_PROFILING.
+// Run times and sqlite3_stmt_status counters come from the SQLITE_TRACE_PROFILE callback, prepare times, steps and rows from the statements of this wrapper.
+class StatementProfiler {
+
+	mutable std::mutex mutex_;
+	std::list<StatementProfile> profiles_;
+	std::unordered_map<std::string_view, StatementProfile *> index_;
+	std::atomic<bool> enabled_{false};
+
+	//called with the mutex held
+	StatementProfile &profile(sqlite3_stmt *const statement);
+
+	static int trace(const unsigned type, void *const context, void *const statement, void *const nanoseconds) noexcept;
+
+  public:
+
+	StatementProfiler() = default;
+
+	StatementProfiler(const StatementProfiler &) = delete;
+	StatementProfiler &operator=(const StatementProfiler &) = delete;
+
+	bool enabled() const noexcept {
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	void attach(sqlite3 *const connection) noexcept;
+
+	void detach(sqlite3 *const connection) noexcept;
+
+	//a profile that cannot be allocated is dropped, profiling never fails the statement
+	void recordPrepare(sqlite3_stmt *const statement, const std::chrono::nanoseconds elapsed) noexcept;
+
+	void recordSteps(sqlite3_stmt *const statement, const unsigned long long steps, const unsigned long long rows) noexcept;
+
+	void recordRun(sqlite3_stmt *const statement, const std::chrono::nanoseconds elapsed) noexcept;
+
+	//copy of the profiles, slowest total run time first
+	std::vector<StatementProfile> snapshot() const;
+
+	void clear() noexcept;
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef IncludeSqliteTextEncoding_
+#define IncludeSqliteTextEncoding_
+
+#include <sqlite3.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Sqlite {
+
+// Transcoding between wchar_t text and UTF-8. Where wchar_t is 4 bytes (Linux, macOS) it holds UTF-32, which SQLite has no
+// API for, so wide text is stored and read as UTF-8. Where it is 2 bytes (Windows) it is UTF-16 and goes to the sqlite3_*16 functions as it is.
+// Runs of ASCII are converted 16 characters at a time with SSE2, or 32 with AVX2 when the code is compiled for it, the rest one character at a time.
+// Lone surrogates, code points above U+10FFFF and malformed UTF-8 sequences are replaced by U+FFFD.
+
+constexpr bool wideIsUtf32 = sizeof(wchar_t) == 4;
+
+//UTF-32 to UTF-8, utf8 holds at least 4 * size bytes, returns the bytes written
+std::size_t wideToUtf8(const wchar_t *const wide, const std::size_t size, char *const utf8) noexcept;
+
+//UTF-8 to UTF-32, wide holds at least size characters, returns the characters written
+std::size_t utf8ToWide(const char *const utf8, const std::size_t size, wchar_t *const wide) noexcept;
+
+void wideToUtf8(const std::wstring_view wide, std::string &utf8);
+
+
+// The wide text of the columns and the UTF-8 of the wide parameters of one statement, where wchar_t is UTF-32.
+// The buffers only grow, so that reading or binding the same columns row after row does not allocate once they are large enough.
+class wideTextBuffers {
+
+	std::vector<std::vector<wchar_t>> columns_;
+	std::vector<std::vector<char>> parameters_;
+
+  public:
+
+	//NUL terminated, valid until the column is converted again or the statement is stepped, reset or finalized, a null data() for NULL
+	std::wstring_view column(sqlite3_stmt *const statement, const int column);
+
+	//kept until the parameter is converted again, so that it can be bound with SQLITE_STATIC
+	std::string_view parameter(const int index, const std::wstring_view text);
+};
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef IncludeSqliteTransaction_
+#define IncludeSqliteTransaction_
+
+#include "SqliteStatement.hpp"
+
+namespace Sqlite {
+
+enum class TransactionMode {
+	Deferred,
+	Immediate,
+	Exclusive
+};
+
+
+// Begins a transaction, which is committed by commit() or rolled back by the destructor.
+// Immediate and exclusive transactions take the write lock up front, so a writer never fails to upgrade a read lock with SQLITE_BUSY.
+// The BEGIN/COMMIT/ROLLBACK statements are prepared once through the statement cache of the connection.
+class Transaction {
+
+	const SqliteConnection *connection_;
+	bool active_{false};
+
+  public:
+	explicit Transaction(const SqliteConnection &connection, const TransactionMode mode = TransactionMode::Deferred);
+
+	Transaction(const Transaction &) = delete;
+	Transaction &operator=(const Transaction &) = delete;
+
+	Transaction(Transaction &&other) noexcept : connection_{other.connection_}, active_{other.active_} {
+		other.active_ = false;
+	}
+
+	~Transaction() noexcept;
+
+	bool active() const noexcept {
+		return active_;
+	}
+
+	void commit();
+
+	void rollback();
+};
+
+
+//name as a quoted SQL identifier, with its double quotes doubled so that it cannot end the identifier
+std::string quotedIdentifier(const std::string &name);
+
+
+// Nested transaction, released by commit() or rolled back to its start by the destructor.
+class Savepoint {
+
+	const SqliteConnection *connection_;
+	std::string release_;
+	std::string rollback_;
+	bool active_{false};
+
+  public:
+	explicit Savepoint(const SqliteConnection &connection, const std::string &name = "sqlitecpp");
+
+	Savepoint(const Savepoint &) = delete;
+	Savepoint &operator=(const Savepoint &) = delete;
+
+	Savepoint(Savepoint &&other) noexcept : connection_{other.connection_}, release_{std::move(other.release_)}, rollback_{std::move(other.rollback_)}, active_{other.active_} {
+		other.active_ = false;
+	}
+
+	~Savepoint() noexcept;
+
+	bool active() const noexcept {
+		return active_;
+	}
+
+	void commit();
+
+	void rollback();
+};
+
+}
+
+#endif
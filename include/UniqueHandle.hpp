@@ -1,3 +1,6 @@
+#ifndef IncludeSqliteUniqueHandle_
+#define IncludeSqliteUniqueHandle_
+
 namespace Sqlite {
 	
 	
@@ -32,7 +35,12 @@ class UniqueHandle
 	UniqueHandle(UniqueHandle &&other) : TypeValue_{other.release()} {
 	}
 	
-	UniqueHandle operator=(UniqueHandle &&other);
+	UniqueHandle &operator=(UniqueHandle &&other) noexcept {
+		if (this != &other) {
+			reset(other.release());
+		}
+		return *this;
+	}
 	
 	~UniqueHandle() noexcept {
 		close();
@@ -52,7 +60,13 @@ class UniqueHandle
 		return TypeValue;
 	}
 
-	[[maybe_unused]] bool reset(Type typeValue = Traits::invalid()) noexcept;
+	[[maybe_unused]] bool reset(Type typeValue = Traits::invalid()) noexcept {
+		if (typeValue != TypeValue_) {
+			close();
+			TypeValue_ = typeValue;
+		}
+		return static_cast<bool>(*this);
+	}
 
 	void swap(UniqueHandle<Traits> &other) noexcept {
 		Type temp = TypeValue_;
@@ -69,3 +83,5 @@ void swap(UniqueHandle<Traits> &left, UniqueHandle<Traits> &right) noexcept {
 
 
 }
+
+#endif
@@ -0,0 +1,489 @@
+#ifndef IncludeSqliteVirtualTable_
+#define IncludeSqliteVirtualTable_
+
+#include "SqliteConnection.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Sqlite {
+
+// A column of a virtual table over a container, getter_(element) returns its value, of any type a function created by createFunction may return.
+template <typename Getter, bool Key>
+struct virtualColumn {
+	const char *name_;
+	Getter getter_;
+};
+
+template <typename Getter>
+virtualColumn<Getter, false> tableColumn(const char *const name, Getter getter) {
+	return virtualColumn<Getter, false>{name, std::move(getter)};
+}
+
+//the column the container is looked up by: the key of an associative container, or the column a sequence is sorted by
+template <typename Getter>
+virtualColumn<Getter, true> keyColumn(const char *const name, Getter getter) {
+	return virtualColumn<Getter, true>{name, std::move(getter)};
+}
+
+
+// The sqlite3_module of an eponymous, read-only virtual table over a container, registered by SqliteConnection::createVirtualTable.
+// Equality constraints on the key column are looked up with equal_range, and range constraints with lower_bound and upper_bound unless the
+// container is hashed or not ordered by std::less. SQLite checks the constraints again on the rows returned, so a value that does not compare
+// like the key (another type, or another collation than BINARY) falls back to a full scan instead of a wrong lookup,
+// and an integer past the range of the key type makes its bound always true or always false instead of wrapping.
+template <typename Container, typename... Columns>
+class containerModule {
+
+	static_assert(sizeof...(Columns) > 0, "a virtual table has at least one column");
+
+	template <typename Column>
+	struct isKeyColumn : public std::false_type {
+	};
+
+	template <typename Getter>
+	struct isKeyColumn<virtualColumn<Getter, true>> : public std::true_type {
+	};
+
+	static_assert((0 + ... + static_cast<int>(isKeyColumn<Columns>::value)) <= 1, "a virtual table has at most one key column");
+
+	//the key of an associative container, otherwise the value of the key column
+	template <typename Type, typename Value, typename = void>
+	struct lookupKey {
+		using type = Value;
+		static constexpr bool associative = false;
+	};
+
+	template <typename Type, typename Value>
+	struct lookupKey<Type, Value, std::void_t<typename Type::key_type>> {
+		using type = typename Type::key_type;
+		static constexpr bool associative = true;
+	};
+
+	template <typename Type, typename = void>
+	struct isHashed : public std::false_type {
+	};
+
+	template <typename Type>
+	struct isHashed<Type, std::void_t<typename Type::hasher>> : public std::true_type {
+	};
+
+	//lower_bound and upper_bound walk the keys in ascending order, a sequence is sorted by its key column
+	template <typename Type, typename = void>
+	struct hasAscendingKeys : public std::true_type {
+	};
+
+	template <typename Type>
+	struct hasAscendingKeys<Type, std::void_t<typename Type::key_compare>> : public std::bool_constant<std::is_same_v<typename Type::key_compare, std::less<typename Type::key_type>> || std::is_same_v<typename Type::key_compare, std::less<>>> {
+	};
+
+	template <typename Type, typename = void>
+	struct hasUniqueKeys : public std::false_type {
+	};
+
+	template <typename Type>
+	struct hasUniqueKeys<Type, std::enable_if_t<std::is_same_v<decltype(std::declval<Type &>().insert(std::declval<const typename Type::value_type &>())), std::pair<typename Type::iterator, bool>>>> : public std::true_type {
+	};
+
+	static constexpr int findKeyColumn() noexcept {
+		constexpr bool keys[] = {isKeyColumn<Columns>::value...};
+		for (int column = 0; column != static_cast<int>(sizeof...(Columns)); ++column) {
+			if (keys[column]) {
+				return column;
+			}
+		}
+		return -1;
+	}
+
+	using Iterator = typename Container::const_iterator;
+	using Element = typename Container::value_type;
+	static constexpr int keyIndex = findKeyColumn();
+	using KeyColumn = std::tuple_element_t<keyIndex < 0 ? 0 : keyIndex, std::tuple<Columns...>>;
+	using KeyLookup = lookupKey<Container, std::decay_t<decltype(std::declval<const KeyColumn &>().getter_(std::declval<const Element &>()))>>;
+	using Key = typename KeyLookup::type;
+	static constexpr bool associative = KeyLookup::associative;
+	static constexpr bool hashed = isHashed<Container>::value;
+	//whether range constraints and ORDER BY on the key can be pushed down, not with another order than SQL's
+	static constexpr bool ordered = !hashed && hasAscendingKeys<Container>::value;
+	static constexpr bool uniqueKeys = associative && hasUniqueKeys<Container>::value;
+
+	//idxNum of the plan chosen by bestIndex
+	static constexpr int planEqual = 1;
+	static constexpr int planLower = 2;
+	static constexpr int planLowerExclusive = 4;
+	static constexpr int planUpper = 8;
+	static constexpr int planUpperExclusive = 16;
+
+	struct table : public sqlite3_vtab {
+		containerModule *module_;
+	};
+
+	struct cursor : public sqlite3_vtab_cursor {
+		Iterator current_;
+		Iterator end_;
+	};
+
+	const Container &container_;
+	std::tuple<Columns...> columns_;
+	std::string declaration_;
+
+	static void appendName(std::string &declaration, const char *name) {
+		declaration += '"';
+		for (; *name != '\0'; ++name) {
+			if (*name == '"') {
+				declaration += '"';
+			}
+			declaration += *name;
+		}
+		declaration += "\",";
+	}
+
+	static int fail(sqlite3_vtab *const table) noexcept {
+		sqlite3_free(table->zErrMsg);
+		table->zErrMsg = nullptr;
+		try {
+			throw;
+		}
+		catch (const exception &error) {
+			table->zErrMsg = sqlite3_mprintf("%s", error.errorMessage_.c_str());
+			return error.errorCode_ != SQLITE_OK ? error.errorCode_ : SQLITE_ERROR;
+		}
+		catch (const std::bad_alloc &) {
+			return SQLITE_NOMEM;
+		}
+		catch (const std::exception &error) {
+			table->zErrMsg = sqlite3_mprintf("%s", error.what());
+		}
+		catch (...) {
+			table->zErrMsg = sqlite3_mprintf("unknown exception");
+		}
+		return SQLITE_ERROR;
+	}
+
+	//whether the value compares with the keys like SQL compares it with the key column, which has no affinity
+	static bool comparable(sqlite3_value *const value) noexcept {
+		const int type = sqlite3_value_type(value);
+		if constexpr (std::is_integral_v<Key>) {
+			return type == SQLITE_INTEGER;
+		}
+		else if constexpr (std::is_floating_point_v<Key>) {
+			if (type == SQLITE_INTEGER && std::numeric_limits<Key>::digits < 63) {
+				//a rounded integer would move the bound past keys equal to it
+				const sqlite3_int64 exact = sqlite3_int64{1} << std::numeric_limits<Key>::digits;
+				const sqlite3_int64 integer = sqlite3_value_int64(value);
+				return integer >= -exact && integer <= exact;
+			}
+			return type == SQLITE_INTEGER || type == SQLITE_FLOAT;
+		}
+		else {
+			return type == SQLITE_TEXT;
+		}
+	}
+
+	//where a comparable value falls against the keys: -1 below every possible key, 1 above, 0 when it converts to a key without wrapping
+	static int keyRange(sqlite3_value *const value) noexcept {
+		if constexpr (std::is_integral_v<Key>) {
+			const sqlite3_int64 integer = sqlite3_value_int64(value);
+			if constexpr (std::is_signed_v<Key>) {
+				if (integer < static_cast<sqlite3_int64>(std::numeric_limits<Key>::min())) {
+					return -1;
+				}
+				if (integer > static_cast<sqlite3_int64>(std::numeric_limits<Key>::max())) {
+					return 1;
+				}
+			}
+			else {
+				if (integer < 0) {
+					return -1;
+				}
+				if (static_cast<sqlite3_uint64>(integer) > static_cast<sqlite3_uint64>(std::numeric_limits<Key>::max())) {
+					return 1;
+				}
+			}
+		}
+		return 0;
+	}
+
+	bool less(const Key &left, const Key &right) const {
+		if constexpr (associative && !hashed) {
+			return container_.key_comp()(left, right);
+		}
+		else {
+			return left < right;
+		}
+	}
+
+	Iterator lowerBound(const Key &key) const {
+		if constexpr (associative) {
+			return container_.lower_bound(key);
+		}
+		else {
+			const auto &getter = std::get<keyIndex>(columns_).getter_;
+			return std::lower_bound(container_.begin(), container_.end(), key, [&](const Element &element, const Key &value) {
+				return getter(element) < value;
+			});
+		}
+	}
+
+	Iterator upperBound(const Key &key) const {
+		if constexpr (associative) {
+			return container_.upper_bound(key);
+		}
+		else {
+			const auto &getter = std::get<keyIndex>(columns_).getter_;
+			return std::upper_bound(container_.begin(), container_.end(), key, [&](const Key &value, const Element &element) {
+				return value < getter(element);
+			});
+		}
+	}
+
+	void find(cursor &position, const int plan, const int argumentCount, sqlite3_value **const values) const {
+		position.current_ = container_.begin();
+		position.end_ = container_.end();
+		if constexpr (keyIndex >= 0) {
+			for (int argument = 0; argument != argumentCount; ++argument) {
+				//nothing compares true with NULL
+				if (sqlite3_value_type(values[argument]) == SQLITE_NULL) {
+					position.current_ = position.end_;
+					return;
+				}
+				if (!comparable(values[argument])) {
+					return;
+				}
+			}
+			if (plan & planEqual) {
+				if (keyRange(values[0]) != 0) {
+					position.current_ = position.end_;
+					return;
+				}
+				const Key key = valueReader<Key>::read(values[0]);
+				if constexpr (associative) {
+					std::tie(position.current_, position.end_) = container_.equal_range(key);
+				}
+				else {
+					position.current_ = lowerBound(key);
+					position.end_ = upperBound(key);
+				}
+			}
+			else if constexpr (ordered) {
+				int argument = 0;
+				std::optional<Key> lower;
+				std::optional<Key> upper;
+				//a bound past the range of the keys is always true, or never
+				if (plan & planLower) {
+					const int range = keyRange(values[argument]);
+					if (range > 0) {
+						position.current_ = position.end_;
+						return;
+					}
+					if (range == 0) {
+						lower = valueReader<Key>::read(values[argument]);
+						position.current_ = plan & planLowerExclusive ? upperBound(*lower) : lowerBound(*lower);
+					}
+					++argument;
+				}
+				if (plan & planUpper) {
+					const int range = keyRange(values[argument]);
+					if (range < 0) {
+						position.current_ = position.end_;
+						return;
+					}
+					if (range == 0) {
+						upper = valueReader<Key>::read(values[argument]);
+						position.end_ = plan & planUpperExclusive ? lowerBound(*upper) : upperBound(*upper);
+					}
+				}
+				//the bounds would be out of order
+				if (lower && upper && (less(*upper, *lower) || (!less(*lower, *upper) && (plan & (planLowerExclusive | planUpperExclusive))))) {
+					position.current_ = position.end_;
+				}
+			}
+		}
+	}
+
+	template <std::size_t... Indexes>
+	void columnValue(sqlite3_context *const context, const Element &element, const int column, std::index_sequence<Indexes...>) const {
+		((column == static_cast<int>(Indexes) ? (setFunctionResult(context, [&]() -> decltype(auto) {
+			return std::get<Indexes>(columns_).getter_(element);
+		}), true) : false) || ...);
+	}
+
+	static int connect(sqlite3 *const connection, void *const data, int, const char *const *, sqlite3_vtab **const out, char **) noexcept {
+		containerModule *const module = static_cast<containerModule *>(data);
+		const int result = sqlite3_declare_vtab(connection, module->declaration_.c_str());
+		if (SQLITE_OK != result) {
+			return result;
+		}
+		table *const created = new (std::nothrow) table();
+		if (created == nullptr) {
+			return SQLITE_NOMEM;
+		}
+		created->module_ = module;
+		*out = created;
+		return SQLITE_OK;
+	}
+
+	static int disconnect(sqlite3_vtab *const base) noexcept {
+		delete static_cast<table *>(base);
+		return SQLITE_OK;
+	}
+
+	static int bestIndex(sqlite3_vtab *const base, sqlite3_index_info *const info) noexcept {
+		const containerModule &module = *static_cast<table *>(base)->module_;
+		const double rows = static_cast<double>(std::max<std::size_t>(module.container_.size(), 1));
+		int equal = -1;
+		int lower = -1;
+		int upper = -1;
+		if constexpr (keyIndex >= 0) {
+			for (int index = 0; index != info->nConstraint; ++index) {
+				const auto &constraint = info->aConstraint[index];
+				if (!constraint.usable || constraint.iColumn != keyIndex) {
+					continue;
+				}
+				const char *const collation = sqlite3_vtab_collation(info, index);
+				if (collation != nullptr && sqlite3_stricmp(collation, "BINARY") != 0) {
+					continue;
+				}
+				if (constraint.op == SQLITE_INDEX_CONSTRAINT_EQ) {
+					equal = index;
+				}
+				else if (ordered && (constraint.op == SQLITE_INDEX_CONSTRAINT_GT || constraint.op == SQLITE_INDEX_CONSTRAINT_GE)) {
+					lower = index;
+				}
+				else if (ordered && (constraint.op == SQLITE_INDEX_CONSTRAINT_LT || constraint.op == SQLITE_INDEX_CONSTRAINT_LE)) {
+					upper = index;
+				}
+			}
+		}
+
+		//the constraints are not omitted, SQLite checks them again on the rows returned
+		int plan = 0;
+		double estimate = rows;
+		double cost = rows;
+		if (equal >= 0) {
+			plan = planEqual;
+			info->aConstraintUsage[equal].argvIndex = 1;
+			estimate = uniqueKeys ? 1 : std::min(rows, 10.0);
+			cost = (hashed ? 1 : std::log2(rows)) + estimate;
+			if (uniqueKeys) {
+				info->idxFlags |= SQLITE_INDEX_SCAN_UNIQUE;
+			}
+		}
+		else if (lower >= 0 || upper >= 0) {
+			int argument = 0;
+			if (lower >= 0) {
+				plan |= planLower | (info->aConstraint[lower].op == SQLITE_INDEX_CONSTRAINT_GT ? planLowerExclusive : 0);
+				info->aConstraintUsage[lower].argvIndex = ++argument;
+				estimate /= 4;
+			}
+			if (upper >= 0) {
+				plan |= planUpper | (info->aConstraint[upper].op == SQLITE_INDEX_CONSTRAINT_LT ? planUpperExclusive : 0);
+				info->aConstraintUsage[upper].argvIndex = ++argument;
+				estimate /= 4;
+			}
+			cost = std::log2(rows) + estimate;
+		}
+		info->idxNum = plan;
+		info->estimatedRows = static_cast<sqlite3_int64>(estimate);
+		info->estimatedCost = cost;
+
+		//ordered containers and sorted sequences are walked in the order of their key
+		if (keyIndex >= 0 && ordered && info->nOrderBy == 1 && info->aOrderBy[0].iColumn == keyIndex && !info->aOrderBy[0].desc) {
+			info->orderByConsumed = 1;
+		}
+		return SQLITE_OK;
+	}
+
+	static int open(sqlite3_vtab *, sqlite3_vtab_cursor **const out) noexcept {
+		cursor *const created = new (std::nothrow) cursor();
+		if (created == nullptr) {
+			return SQLITE_NOMEM;
+		}
+		*out = created;
+		return SQLITE_OK;
+	}
+
+	static int close(sqlite3_vtab_cursor *const base) noexcept {
+		delete static_cast<cursor *>(base);
+		return SQLITE_OK;
+	}
+
+	static int filter(sqlite3_vtab_cursor *const base, const int plan, const char *, const int argumentCount, sqlite3_value **const values) noexcept {
+		try {
+			static_cast<table *>(base->pVtab)->module_->find(*static_cast<cursor *>(base), plan, argumentCount, values);
+			return SQLITE_OK;
+		}
+		catch (...) {
+			return fail(base->pVtab);
+		}
+	}
+
+	static int next(sqlite3_vtab_cursor *const base) noexcept {
+		++static_cast<cursor *>(base)->current_;
+		return SQLITE_OK;
+	}
+
+	static int eof(sqlite3_vtab_cursor *const base) noexcept {
+		const cursor &position = *static_cast<cursor *>(base);
+		return position.current_ == position.end_;
+	}
+
+	static int column(sqlite3_vtab_cursor *const base, sqlite3_context *const context, const int column) noexcept {
+		try {
+			static_cast<table *>(base->pVtab)->module_->columnValue(context, *static_cast<cursor *>(base)->current_, column, std::index_sequence_for<Columns...>{});
+			return SQLITE_OK;
+		}
+		catch (...) {
+			setFunctionError(context);
+			return SQLITE_ERROR;
+		}
+	}
+
+	//the address of the element, which stays the same whichever lookup finds it
+	static int rowId(sqlite3_vtab_cursor *const base, sqlite3_int64 *const out) noexcept {
+		*out = static_cast<sqlite3_int64>(reinterpret_cast<std::uintptr_t>(std::addressof(*static_cast<cursor *>(base)->current_)));
+		return SQLITE_OK;
+	}
+
+  public:
+
+	containerModule(const Container &container, Columns... columns) : container_{container}, columns_{std::move(columns)...} {
+		declaration_ = "create table x(";
+		std::apply([this](const Columns &... column) {
+			(appendName(declaration_, column.name_), ...);
+		}, columns_);
+		declaration_.back() = ')';
+	}
+
+	//without xCreate, the table is eponymous only: it is used by the name of the module, without CREATE VIRTUAL TABLE
+	static const sqlite3_module *module() noexcept {
+		static const sqlite3_module module = [] {
+			sqlite3_module callbacks{};
+			callbacks.xConnect = &connect;
+			callbacks.xBestIndex = &bestIndex;
+			callbacks.xDisconnect = &disconnect;
+			callbacks.xDestroy = &disconnect;
+			callbacks.xOpen = &open;
+			callbacks.xClose = &close;
+			callbacks.xFilter = &filter;
+			callbacks.xNext = &next;
+			callbacks.xEof = &eof;
+			callbacks.xColumn = &column;
+			callbacks.xRowid = &rowId;
+			return callbacks;
+		}();
+		return &module;
+	}
+};
+
+}
+
+#endif
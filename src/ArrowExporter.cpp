@@ -0,0 +1,114 @@
+#include "ArrowExporter.hpp"
+#include <memory>
+
+const char *Sqlite::ArrowExporter::format(const int type) noexcept {
+	switch (type) {
+		case SQLITE_INTEGER:
+			return "l";
+		case SQLITE_FLOAT:
+			return "g";
+		case SQLITE_BLOB:
+			return "z";
+		default:
+			return "u";
+	}
+}
+
+void Sqlite::ArrowExporter::fill(ResultSet &result) {
+	result.start(statement_.getABI());
+	for (std::size_t column = 0; column < types_.size(); ++column) {
+		result.setColumnType(column, types_[column]);
+	}
+	//stepping again after the last row would rerun the statement
+	while (!done_ && result.rowCount() < batchSize_) {
+		if (statement_.execute()) {
+			result.appendRow(statement_.getABI());
+		}
+		else {
+			done_ = true;
+		}
+	}
+}
+
+void Sqlite::ArrowExporter::start() {
+	fill(pending_);
+	started_ = true;
+	hasPending_ = true;
+	for (std::size_t column = 0; column < pending_.columnCount(); ++column) {
+		if (pending_.column(column).type() == SQLITE_NULL) {
+			pending_.setColumnType(column, SQLITE_TEXT);
+		}
+		names_.push_back(pending_.column(column).name());
+		types_.push_back(pending_.column(column).type());
+	}
+}
+
+void Sqlite::ArrowExporter::exportSchema(ArrowSchema *const out) {
+	if (!started_) {
+		start();
+	}
+	std::unique_ptr<schemaData> data = std::make_unique<schemaData>();
+	const std::size_t count = types_.size();
+	data->names_ = names_;
+	data->children_.resize(count);
+	data->childPointers_.resize(count);
+	for (std::size_t column = 0; column < count; ++column) {
+		ArrowSchema &child = data->children_[column];
+		child = ArrowSchema{format(types_[column]), data->names_[column].c_str(), nullptr, ARROW_FLAG_NULLABLE, 0, nullptr, nullptr, &release<ArrowSchema>, data.get()};
+		data->childPointers_[column] = &child;
+	}
+	data->references_ = count + 1;
+	*out = ArrowSchema{"+s", "", nullptr, 0, static_cast<int64_t>(count), data->childPointers_.data(), nullptr, &release<ArrowSchema>, data.get()};
+	data.release();
+}
+
+bool Sqlite::ArrowExporter::exportBatch(ArrowArray *const out) {
+	if (!started_) {
+		start();
+	}
+	if (!hasPending_ && done_) {
+		return false;
+	}
+	std::unique_ptr<batchData> data = std::make_unique<batchData>();
+	if (hasPending_) {
+		data->result_ = std::move(pending_);
+		hasPending_ = false;
+	}
+	else {
+		fill(data->result_);
+	}
+	const ResultSet &result = data->result_;
+	if (result.rowCount() == 0) {
+		return false;
+	}
+
+	const std::size_t count = result.columnCount();
+	const int64_t length = static_cast<int64_t>(result.rowCount());
+	data->children_.resize(count);
+	data->childPointers_.resize(count);
+	data->buffers_.resize(count);
+	for (std::size_t column = 0; column < count; ++column) {
+		const ResultSet::Column &values = result.column(column);
+		std::array<const void *, 3> &buffers = data->buffers_[column];
+		buffers[0] = values.nullCount() == 0 ? nullptr : values.validity().data();
+		int64_t bufferCount = 2;
+		if (values.type() == SQLITE_INTEGER) {
+			buffers[1] = values.integers().data();
+		}
+		else if (values.type() == SQLITE_FLOAT) {
+			buffers[1] = values.reals().data();
+		}
+		else {
+			buffers[1] = values.offsets().data();
+			buffers[2] = values.data().data();
+			bufferCount = 3;
+		}
+		ArrowArray &child = data->children_[column];
+		child = ArrowArray{length, static_cast<int64_t>(values.nullCount()), 0, bufferCount, 0, buffers.data(), nullptr, nullptr, &release<ArrowArray>, data.get()};
+		data->childPointers_[column] = &child;
+	}
+	data->references_ = count + 1;
+	*out = ArrowArray{length, 0, 0, 1, static_cast<int64_t>(count), data->structBuffers_, data->childPointers_.data(), nullptr, &release<ArrowArray>, data.get()};
+	data.release();
+	return true;
+}
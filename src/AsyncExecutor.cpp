@@ -0,0 +1,78 @@
+#include "AsyncExecutor.hpp"
+#include <algorithm>
+
+void Sqlite::commitBatch(const SqliteConnection &connection, const std::vector<std::unique_ptr<asyncJob>> &batch) noexcept {
+	const asyncJob *rolledBackBy = nullptr;
+	try {
+		Transaction transaction(connection, TransactionMode::Immediate);
+		for (const auto &job : batch) {
+			Savepoint savepoint(connection);
+			if (job->run(connection)) {
+				savepoint.commit();
+			}
+			else if (sqlite3_get_autocommit(connection.getABI())) {
+				//SQLite rolled the whole transaction back (SQLITE_FULL, SQLITE_IOERR, SQLITE_BUSY, SQLITE_NOMEM), the job keeps its own error
+				rolledBackBy = job.get();
+				throw exception(SQLITE_ABORT, "the transaction of the batch was rolled back by a failed job");
+			}
+		}
+		transaction.commit();
+	}
+	catch (...) {
+		for (const auto &job : batch) {
+			if (job.get() != rolledBackBy) {
+				job->fail(std::current_exception());
+			}
+		}
+	}
+	for (const auto &job : batch) {
+		job->complete();
+	}
+}
+
+Sqlite::AsyncExecutor::AsyncExecutor(const char *const filename, const OpenOptions &options, const std::size_t maxWriteBatch) : connection_(filename, options), maxWriteBatch_{std::max<std::size_t>(maxWriteBatch, 1)}, worker_([this] { work(); }) {
+}
+
+Sqlite::AsyncExecutor::~AsyncExecutor() noexcept {
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	condition_.notify_one();
+	worker_.join();
+}
+
+void Sqlite::AsyncExecutor::push(std::unique_ptr<asyncJob> job) {
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		queue_.push_back(std::move(job));
+	}
+	condition_.notify_one();
+}
+
+void Sqlite::AsyncExecutor::work() noexcept {
+	std::vector<std::unique_ptr<asyncJob>> batch;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+			if (queue_.empty()) {
+				return;
+			}
+			batch.push_back(std::move(queue_.front()));
+			queue_.pop_front();
+			while (batch.front()->write_ && !queue_.empty() && queue_.front()->write_ && batch.size() < maxWriteBatch_) {
+				batch.push_back(std::move(queue_.front()));
+				queue_.pop_front();
+			}
+		}
+		if (batch.front()->write_) {
+			commitBatch(connection_, batch);
+		}
+		else {
+			batch.front()->run(connection_);
+			batch.front()->complete();
+		}
+		batch.clear();
+	}
+}
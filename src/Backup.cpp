@@ -0,0 +1,48 @@
+#include "Backup.hpp"
+#include <thread>
+
+void Sqlite::Backup::pause() const {
+	if (options_.pause_.count() > 0) {
+		std::this_thread::sleep_for(options_.pause_);
+	}
+	else {
+		std::this_thread::yield();
+	}
+}
+
+Sqlite::Backup::Backup(const SqliteConnection &destination, const SqliteConnection &source, const BackupOptions &options, const char *const destinationName, const char *const sourceName) : options_{options} {
+	backupHandle_.reset(sqlite3_backup_init(destination.getABI(), destinationName, source.getABI(), sourceName));
+	if (!backupHandle_) {
+		throw exception(destination.getABI());
+	}
+}
+
+bool Sqlite::Backup::step() {
+	if (!backupHandle_) {
+		throw exception(SQLITE_MISUSE, "the backup is already finished");
+	}
+	const int result = sqlite3_backup_step(getABI(), options_.pagesPerStep_);
+	remaining_ = sqlite3_backup_remaining(getABI());
+	pageCount_ = sqlite3_backup_pagecount(getABI());
+	if (result == SQLITE_DONE) {
+		return false;
+	}
+	if (result != SQLITE_OK && result != SQLITE_BUSY && result != SQLITE_LOCKED) {
+		throw exception(result, sqlite3_errstr(result));
+	}
+	return true;
+}
+
+void Sqlite::Backup::finish() {
+	const int result = sqlite3_backup_finish(backupHandle_.release());
+	if (result != SQLITE_OK) {
+		throw exception(result, sqlite3_errstr(result));
+	}
+}
+
+void Sqlite::Backup::toFile(const SqliteConnection &source, const char *const filename, const BackupOptions &options) {
+	const SqliteConnection destination(filename);
+	Backup backup(destination, source, options);
+	backup.run();
+	backup.finish();
+}
@@ -0,0 +1,46 @@
+#include "BlobStream.hpp"
+#include <algorithm>
+
+Sqlite::BlobStream::BlobStream(const SqliteConnection &connection, const char *const table, const char *const column, const long long rowId, const bool writable, const char *const database) : connection_{connection.getABI()} {
+	if (SQLITE_OK != sqlite3_blob_open(connection_, database, table, column, rowId, writable ? 1 : 0, blobHandle_.set())) {
+		throwLastError();
+	}
+}
+
+void Sqlite::BlobStream::throwLastError() const {
+	throw exception(connection_);
+}
+
+void Sqlite::BlobStream::read(void *const buffer, const int size, const int offset) const {
+	if (SQLITE_OK != sqlite3_blob_read(getABI(), buffer, size, offset)) {
+		throwLastError();
+	}
+}
+
+void Sqlite::BlobStream::write(const void *const buffer, const int size, const int offset) const {
+	if (SQLITE_OK != sqlite3_blob_write(getABI(), buffer, size, offset)) {
+		throwLastError();
+	}
+}
+
+int Sqlite::BlobStream::readNext(void *const buffer, const int size) {
+	const int count = std::min(size, this->size() - position_);
+	if (count <= 0) {
+		return 0;
+	}
+	read(buffer, count, position_);
+	position_ += count;
+	return count;
+}
+
+void Sqlite::BlobStream::writeNext(const void *const buffer, const int size) {
+	write(buffer, size, position_);
+	position_ += size;
+}
+
+void Sqlite::BlobStream::reopen(const long long rowId) {
+	if (SQLITE_OK != sqlite3_blob_reopen(getABI(), rowId)) {
+		throwLastError();
+	}
+	position_ = 0;
+}
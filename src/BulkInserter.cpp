@@ -0,0 +1,37 @@
+#include "BulkInserter.hpp"
+
+void Sqlite::BulkInserter::beginChunk() {
+	if (!transaction_) {
+		transaction_.emplace(*connection_, TransactionMode::Immediate);
+	}
+}
+
+void Sqlite::BulkInserter::endChunk() {
+	if (pendingRows_ >= options_.rowsPerTransaction_ || (options_.bytesPerTransaction_ != 0 && pendingBytes_ >= options_.bytesPerTransaction_)) {
+		flush();
+	}
+}
+
+void Sqlite::BulkInserter::flush() {
+	if (transaction_) {
+		transaction_->commit();
+		transaction_.reset();
+		stats_.rows_ += pendingRows_;
+		stats_.bytes_ += pendingBytes_;
+		++stats_.transactions_;
+		pendingRows_ = 0;
+		pendingBytes_ = 0;
+	}
+}
+
+Sqlite::BulkInsertStats Sqlite::BulkInserter::finish() {
+	flush();
+	sqlite3_clear_bindings(statement_.getABI());
+	return stats();
+}
+
+Sqlite::BulkInsertStats Sqlite::BulkInserter::stats() const noexcept {
+	BulkInsertStats stats = stats_;
+	stats.elapsed_ = std::chrono::steady_clock::now() - start_;
+	return stats;
+}
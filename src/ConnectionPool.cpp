@@ -0,0 +1,56 @@
+#include "ConnectionPool.hpp"
+
+Sqlite::ConnectionPool::Reader *Sqlite::ConnectionPool::tryAcquireReader(const std::size_t start) noexcept {
+	for (std::size_t offset = 0; offset != readerCount_; ++offset) {
+		Reader &reader = readers_[(start + offset) % readerCount_];
+		//sequentially consistent like the store in releaseReader: a waiter stores waiters_ and loads busy_, the releaser stores
+		//busy_ and loads waiters_, and a weaker load could let both miss the other's store and the waiter sleep forever
+		if (!reader.busy_.load() && !reader.busy_.exchange(true)) {
+			return &reader;
+		}
+	}
+	return nullptr;
+}
+
+void Sqlite::ConnectionPool::releaseReader(Reader &reader) noexcept {
+	reader.busy_.store(false);
+	if (waiters_.load() != 0) {
+		std::lock_guard<std::mutex> lock(waitMutex_);
+		released_.notify_one();
+	}
+}
+
+Sqlite::ConnectionPool::ConnectionPool(const char *const filename, const std::size_t readers, const OpenOptions &options) : readers_{std::make_unique<Reader[]>(std::max<std::size_t>(readers, 1))}, readerCount_{std::max<std::size_t>(readers, 1)} {
+	OpenOptions writerOptions = options;
+	writerOptions.readOnly_ = false;
+	writerOptions.threading_ = ThreadingMode::MultiThread;
+	writerOptions.journalMode_ = JournalMode::Wal;
+	writer_.open(filename, writerOptions);
+
+	OpenOptions readerOptions = options;
+	readerOptions.readOnly_ = true;
+	readerOptions.threading_ = ThreadingMode::MultiThread;
+	readerOptions.journalMode_.reset();
+	for (std::size_t index = 0; index != readerCount_; ++index) {
+		readers_[index].connection_.open(filename, readerOptions);
+	}
+}
+
+Sqlite::ConnectionPool::Lease Sqlite::ConnectionPool::reader() {
+	//every thread starts looking at its own reader, so that threads rarely compete for the same one
+	const std::size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id()) % readerCount_;
+	if (Reader *const reader = tryAcquireReader(start)) {
+		return Lease(*this, *reader);
+	}
+
+	std::unique_lock<std::mutex> lock(waitMutex_);
+	++waiters_;
+	Reader *reader = nullptr;
+	released_.wait(lock, [&] { return (reader = tryAcquireReader(start)) != nullptr; });
+	--waiters_;
+	return Lease(*this, *reader);
+}
+
+Sqlite::ConnectionPool::Lease Sqlite::ConnectionPool::writer() {
+	return Lease(*this, std::unique_lock<std::mutex>(writerMutex_));
+}
@@ -0,0 +1,635 @@
+#include "GlobalConfig.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+struct sharedPage;
+
+//the unpinned pages of one lock stripe, the oldest is evicted first
+struct pageCacheShard {
+	std::mutex mutex_;
+	sharedPage *oldest_{nullptr};
+	sharedPage *newest_{nullptr};
+};
+
+//the cache of one pager, guarded by the mutex of its stripe since evictions for other caches remove its pages
+struct sharedCache {
+	pageCacheShard *shard_;
+	std::size_t pageBytes_;
+	int pageSize_;
+	int extraSize_;
+	bool purgeable_;
+	std::vector<sharedPage *> buckets_;
+	unsigned pages_{0};
+};
+
+struct sharedPage {
+	sqlite3_pcache_page page_;
+	sharedCache *owner_;
+	sharedPage *hashNext_;
+	sharedPage *older_;
+	sharedPage *newer_;
+	std::size_t size_;
+	unsigned key_;
+	bool pinned_;
+};
+
+//the page buffer and the extra bytes follow the header in the same allocation
+constexpr std::size_t sharedPageHeader = (sizeof(sharedPage) + 7) & ~std::size_t{7};
+
+struct sharedPageCache {
+	std::unique_ptr<pageCacheShard[]> shards_;
+	std::size_t shardCount_{1};
+	std::size_t budget_{0};
+	std::atomic<std::size_t> bytes_{0};
+	std::atomic<std::size_t> nextShard_{0};
+	std::atomic<unsigned long long> hits_{0};
+	std::atomic<unsigned long long> misses_{0};
+	std::atomic<unsigned long long> evictions_{0};
+
+	bool overBudget(const std::size_t adding) const noexcept {
+		return bytes_.load(std::memory_order_relaxed) + adding > budget_;
+	}
+};
+
+//never destroyed, SQLite may release pages from the destructors of other statics
+sharedPageCache &sharedPages() noexcept {
+	static sharedPageCache *const cache = new sharedPageCache;
+	return *cache;
+}
+
+sharedCache &sharedCacheOf(sqlite3_pcache *const cache) noexcept {
+	return *reinterpret_cast<sharedCache *>(cache);
+}
+
+sharedPage *&sharedBucket(sharedCache &cache, const unsigned key) noexcept {
+	return cache.buckets_[key % cache.buckets_.size()];
+}
+
+sharedPage *findSharedPage(sharedCache &cache, const unsigned key) noexcept {
+	sharedPage *page = sharedBucket(cache, key);
+	while (page && page->key_ != key) {
+		page = page->hashNext_;
+	}
+	return page;
+}
+
+void linkSharedPage(sharedCache &cache, sharedPage &page) noexcept {
+	if (cache.pages_ >= cache.buckets_.size()) {
+		//without a larger table the chains only grow longer
+		try {
+			std::vector<sharedPage *> buckets(cache.buckets_.size() * 2, nullptr);
+			for (sharedPage *chain : cache.buckets_) {
+				while (chain) {
+					sharedPage *const next = chain->hashNext_;
+					chain->hashNext_ = buckets[chain->key_ % buckets.size()];
+					buckets[chain->key_ % buckets.size()] = chain;
+					chain = next;
+				}
+			}
+			cache.buckets_.swap(buckets);
+		}
+		catch (...) {
+		}
+	}
+	sharedPage *&bucket = sharedBucket(cache, page.key_);
+	page.hashNext_ = bucket;
+	bucket = &page;
+}
+
+void unlinkSharedPage(sharedCache &cache, sharedPage &page) noexcept {
+	sharedPage **link = &sharedBucket(cache, page.key_);
+	while (*link != &page) {
+		link = &(*link)->hashNext_;
+	}
+	*link = page.hashNext_;
+}
+
+void pushUnpinned(pageCacheShard &shard, sharedPage &page) noexcept {
+	page.newer_ = nullptr;
+	page.older_ = shard.newest_;
+	(shard.newest_ ? shard.newest_->newer_ : shard.oldest_) = &page;
+	shard.newest_ = &page;
+}
+
+void unlinkUnpinned(pageCacheShard &shard, sharedPage &page) noexcept {
+	(page.older_ ? page.older_->newer_ : shard.oldest_) = page.newer_;
+	(page.newer_ ? page.newer_->older_ : shard.newest_) = page.older_;
+}
+
+//takes the page out of its cache and of the budget, the caller frees or reuses it
+void removeSharedPage(sharedCache &cache, sharedPage &page) noexcept {
+	unlinkSharedPage(cache, page);
+	if (!page.pinned_) {
+		unlinkUnpinned(*cache.shard_, page);
+	}
+	--cache.pages_;
+	if (cache.purgeable_) {
+		sharedPages().bytes_.fetch_sub(page.size_, std::memory_order_relaxed);
+	}
+}
+
+//evicts the oldest unpinned pages of the stripe while the cache is over budget, returns one of size bytes for reuse
+sharedPage *evictFromShard(pageCacheShard &shard, const std::size_t size) noexcept {
+	sharedPageCache &pages = sharedPages();
+	sharedPage *reusable = nullptr;
+	while (shard.oldest_ && pages.overBudget(size)) {
+		sharedPage &victim = *shard.oldest_;
+		removeSharedPage(*victim.owner_, victim);
+		pages.evictions_.fetch_add(1, std::memory_order_relaxed);
+		if (!reusable && victim.size_ == size) {
+			reusable = &victim;
+		}
+		else {
+			sqlite3_free(&victim);
+		}
+	}
+	return reusable;
+}
+
+//other stripes, one lock at a time, for a stripe whose own pages are all pinned
+void evictFromOtherShards(const pageCacheShard &own, const std::size_t size) noexcept {
+	sharedPageCache &pages = sharedPages();
+	const std::size_t first = static_cast<std::size_t>(&own - pages.shards_.get());
+	for (std::size_t offset = 1; offset < pages.shardCount_ && pages.overBudget(size); ++offset) {
+		pageCacheShard &shard = pages.shards_[(first + offset) % pages.shardCount_];
+		const std::lock_guard<std::mutex> lock(shard.mutex_);
+		sqlite3_free(evictFromShard(shard, size));
+	}
+}
+
+void truncateSharedCache(sharedCache &cache, const unsigned limit) noexcept {
+	for (sharedPage *&bucket : cache.buckets_) {
+		sharedPage **link = &bucket;
+		while (sharedPage *const page = *link) {
+			if (page->key_ < limit) {
+				link = &page->hashNext_;
+				continue;
+			}
+			removeSharedPage(cache, *page);
+			sqlite3_free(page);
+		}
+	}
+}
+
+sqlite3_pcache *sharedCreate(const int pageSize, const int extraSize, const int purgeable) {
+	sharedPageCache &pages = sharedPages();
+	std::unique_ptr<sharedCache> cache(new (std::nothrow) sharedCache);
+	if (!cache) {
+		return nullptr;
+	}
+	try {
+		cache->buckets_.assign(64, nullptr);
+	}
+	catch (...) {
+		return nullptr;
+	}
+	cache->shard_ = &pages.shards_[pages.nextShard_.fetch_add(1, std::memory_order_relaxed) % pages.shardCount_];
+	cache->pageSize_ = pageSize;
+	cache->extraSize_ = extraSize;
+	cache->pageBytes_ = (sharedPageHeader + static_cast<std::size_t>(pageSize) + static_cast<std::size_t>(extraSize) + 7) & ~std::size_t{7};
+	cache->purgeable_ = purgeable != 0;
+	return reinterpret_cast<sqlite3_pcache *>(cache.release());
+}
+
+sqlite3_pcache_page *sharedFetch(sqlite3_pcache *const handle, const unsigned key, const int create) {
+	sharedCache &cache = sharedCacheOf(handle);
+	sharedPageCache &pages = sharedPages();
+	std::unique_lock<std::mutex> lock(cache.shard_->mutex_);
+	if (sharedPage *const page = findSharedPage(cache, key)) {
+		if (!page->pinned_) {
+			unlinkUnpinned(*cache.shard_, *page);
+			page->pinned_ = true;
+		}
+		pages.hits_.fetch_add(1, std::memory_order_relaxed);
+		return &page->page_;
+	}
+	if (create == 0) {
+		return nullptr;
+	}
+	pages.misses_.fetch_add(1, std::memory_order_relaxed);
+
+	sharedPage *page = nullptr;
+	if (cache.purgeable_) {
+		page = evictFromShard(*cache.shard_, cache.pageBytes_);
+		if (!page && pages.overBudget(cache.pageBytes_)) {
+			//only this cache adds its keys and SQLite serializes its calls, so the key cannot appear meanwhile
+			lock.unlock();
+			evictFromOtherShards(*cache.shard_, cache.pageBytes_);
+			lock.lock();
+			//SQLite spills dirty pages to unpin some and asks again with 2
+			if (create == 1 && pages.overBudget(cache.pageBytes_)) {
+				return nullptr;
+			}
+		}
+		pages.bytes_.fetch_add(cache.pageBytes_, std::memory_order_relaxed);
+	}
+	if (!page) {
+		page = static_cast<sharedPage *>(sqlite3_malloc64(cache.pageBytes_));
+		if (!page) {
+			if (cache.purgeable_) {
+				pages.bytes_.fetch_sub(cache.pageBytes_, std::memory_order_relaxed);
+			}
+			return nullptr;
+		}
+	}
+	char *const buffer = reinterpret_cast<char *>(page) + sharedPageHeader;
+	page->page_.pBuf = buffer;
+	page->page_.pExtra = buffer + cache.pageSize_;
+	//SQLite initializes a page whose extra bytes start with a null pointer
+	std::memset(page->page_.pExtra, 0, static_cast<std::size_t>(cache.extraSize_));
+	page->owner_ = &cache;
+	page->size_ = cache.pageBytes_;
+	page->key_ = key;
+	page->pinned_ = true;
+	linkSharedPage(cache, *page);
+	++cache.pages_;
+	return &page->page_;
+}
+
+void sharedUnpin(sqlite3_pcache *const handle, sqlite3_pcache_page *const unpinned, const int discard) {
+	sharedCache &cache = sharedCacheOf(handle);
+	sharedPage &page = *reinterpret_cast<sharedPage *>(unpinned);
+	const std::lock_guard<std::mutex> lock(cache.shard_->mutex_);
+	if (discard || !cache.purgeable_) {
+		removeSharedPage(cache, page);
+		sqlite3_free(&page);
+		return;
+	}
+	page.pinned_ = false;
+	pushUnpinned(*cache.shard_, page);
+	sqlite3_free(evictFromShard(*cache.shard_, 0));
+}
+
+void sharedRekey(sqlite3_pcache *const handle, sqlite3_pcache_page *const rekeyed, const unsigned, const unsigned newKey) {
+	sharedCache &cache = sharedCacheOf(handle);
+	sharedPage &page = *reinterpret_cast<sharedPage *>(rekeyed);
+	const std::lock_guard<std::mutex> lock(cache.shard_->mutex_);
+	if (sharedPage *const existing = findSharedPage(cache, newKey)) {
+		removeSharedPage(cache, *existing);
+		sqlite3_free(existing);
+	}
+	unlinkSharedPage(cache, page);
+	page.key_ = newKey;
+	page.hashNext_ = sharedBucket(cache, newKey);
+	sharedBucket(cache, newKey) = &page;
+}
+
+void sharedTruncate(sqlite3_pcache *const handle, const unsigned limit) {
+	sharedCache &cache = sharedCacheOf(handle);
+	const std::lock_guard<std::mutex> lock(cache.shard_->mutex_);
+	truncateSharedCache(cache, limit);
+}
+
+void sharedDestroy(sqlite3_pcache *const handle) {
+	sharedCache *const cache = &sharedCacheOf(handle);
+	{
+		const std::lock_guard<std::mutex> lock(cache->shard_->mutex_);
+		truncateSharedCache(*cache, 0);
+	}
+	delete cache;
+}
+
+void sharedShrink(sqlite3_pcache *const handle) {
+	sharedCache &cache = sharedCacheOf(handle);
+	const std::lock_guard<std::mutex> lock(cache.shard_->mutex_);
+	for (sharedPage *&bucket : cache.buckets_) {
+		sharedPage **link = &bucket;
+		while (sharedPage *const page = *link) {
+			if (page->pinned_) {
+				link = &page->hashNext_;
+				continue;
+			}
+			removeSharedPage(cache, *page);
+			sqlite3_free(page);
+		}
+	}
+}
+
+int sharedPageCount(sqlite3_pcache *const handle) {
+	sharedCache &cache = sharedCacheOf(handle);
+	const std::lock_guard<std::mutex> lock(cache.shard_->mutex_);
+	return static_cast<int>(cache.pages_);
+}
+
+sqlite3_pcache_methods2 sharedPageCacheMethods() noexcept {
+	sqlite3_pcache_methods2 methods{};
+	methods.iVersion = 1;
+	methods.xInit = [](void *) {
+		return SQLITE_OK;
+	};
+	methods.xCreate = sharedCreate;
+	//the budget is global, a per-connection size does not apply
+	methods.xCachesize = [](sqlite3_pcache *, int) {
+	};
+	methods.xPagecount = sharedPageCount;
+	methods.xFetch = sharedFetch;
+	methods.xUnpin = sharedUnpin;
+	methods.xRekey = sharedRekey;
+	methods.xTruncate = sharedTruncate;
+	methods.xDestroy = sharedDestroy;
+	methods.xShrink = sharedShrink;
+	return methods;
+}
+
+//block sizes of the pooled allocator, 16 bytes apart up to 128 and four classes per power of two above
+constexpr std::array<std::uint32_t, 20> poolSizes{16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+constexpr std::size_t poolClassCount = poolSizes.size();
+constexpr std::size_t poolLargest = poolSizes.back();
+constexpr std::size_t poolSlabBytes = 64 * 1024;
+//blocks moved between a thread and the shared lists at a time, and the most a thread keeps of a class
+constexpr unsigned poolBatch = 32;
+constexpr unsigned poolThreadLimit = 2 * poolBatch;
+//the size in front of every block keeps the 8-byte alignment SQLite needs
+constexpr std::size_t poolHeader = 8;
+
+constexpr std::array<std::uint8_t, poolLargest / 16 + 1> poolClassTable = [] {
+	std::array<std::uint8_t, poolLargest / 16 + 1> table{};
+	std::size_t sizeClass = 0;
+	for (std::size_t slot = 0; slot < table.size(); ++slot) {
+		while (poolSizes[sizeClass] < slot * 16) {
+			++sizeClass;
+		}
+		table[slot] = static_cast<std::uint8_t>(sizeClass);
+	}
+	return table;
+}();
+
+std::size_t poolClassOf(const std::size_t size) noexcept {
+	return poolClassTable[(size + 15) / 16];
+}
+
+struct poolBlock {
+	poolBlock *next_;
+};
+
+struct poolList {
+	std::mutex mutex_;
+	poolBlock *free_{nullptr};
+};
+
+struct poolShared {
+	std::array<poolList, poolClassCount> lists_;
+	std::atomic<std::size_t> slabBytes_{0};
+	std::atomic<std::size_t> largeBytes_{0};
+};
+
+//never destroyed, blocks are freed until the very end of the process
+poolShared &poolLists() noexcept {
+	static poolShared *const lists = new poolShared;
+	return *lists;
+}
+
+//takes up to a batch of blocks of a class from the shared list, carving a new slab when it is empty
+poolBlock *poolRefill(const std::size_t sizeClass, unsigned &count) noexcept {
+	poolShared &shared = poolLists();
+	poolList &list = shared.lists_[sizeClass];
+	const std::size_t stride = poolHeader + poolSizes[sizeClass];
+	const std::lock_guard<std::mutex> lock(list.mutex_);
+	if (!list.free_) {
+		char *const slab = static_cast<char *>(std::malloc(poolSlabBytes));
+		if (!slab) {
+			return nullptr;
+		}
+		shared.slabBytes_.fetch_add(poolSlabBytes, std::memory_order_relaxed);
+		for (std::size_t offset = 0; offset + stride <= poolSlabBytes; offset += stride) {
+			poolBlock *const block = reinterpret_cast<poolBlock *>(slab + offset);
+			block->next_ = list.free_;
+			list.free_ = block;
+		}
+	}
+	poolBlock *const first = list.free_;
+	poolBlock *last = first;
+	count = 1;
+	while (count < poolBatch && last->next_) {
+		last = last->next_;
+		++count;
+	}
+	list.free_ = last->next_;
+	last->next_ = nullptr;
+	return first;
+}
+
+void poolRelease(const std::size_t sizeClass, poolBlock *const first, poolBlock *const last) noexcept {
+	poolList &list = poolLists().lists_[sizeClass];
+	const std::lock_guard<std::mutex> lock(list.mutex_);
+	last->next_ = list.free_;
+	list.free_ = first;
+}
+
+//0 before the cache of the thread exists, 1 while it does, 2 after its destructor ran, when blocks go to the shared lists directly
+int &poolThreadState() noexcept {
+	thread_local int state = 0;
+	return state;
+}
+
+struct poolThreadCache {
+	std::array<poolBlock *, poolClassCount> free_{};
+	std::array<unsigned, poolClassCount> count_{};
+
+	~poolThreadCache() {
+		for (std::size_t sizeClass = 0; sizeClass < poolClassCount; ++sizeClass) {
+			if (poolBlock *const first = free_[sizeClass]) {
+				poolBlock *last = first;
+				while (last->next_) {
+					last = last->next_;
+				}
+				poolRelease(sizeClass, first, last);
+			}
+		}
+		poolThreadState() = 2;
+	}
+};
+
+poolThreadCache *poolCache() noexcept {
+	if (poolThreadState() == 2) {
+		return nullptr;
+	}
+	thread_local poolThreadCache cache;
+	poolThreadState() = 1;
+	return &cache;
+}
+
+void *poolAllocate(const std::size_t size) noexcept {
+	std::uint64_t *header;
+	if (size > poolLargest) {
+		header = static_cast<std::uint64_t *>(std::malloc(poolHeader + size));
+		if (!header) {
+			return nullptr;
+		}
+		poolLists().largeBytes_.fetch_add(size, std::memory_order_relaxed);
+	}
+	else {
+		const std::size_t sizeClass = poolClassOf(size);
+		poolBlock *block;
+		if (poolThreadCache *const cache = poolCache()) {
+			if (!cache->free_[sizeClass]) {
+				cache->free_[sizeClass] = poolRefill(sizeClass, cache->count_[sizeClass]);
+				if (!cache->free_[sizeClass]) {
+					return nullptr;
+				}
+			}
+			block = cache->free_[sizeClass];
+			cache->free_[sizeClass] = block->next_;
+			--cache->count_[sizeClass];
+		}
+		else {
+			unsigned count = 0;
+			block = poolRefill(sizeClass, count);
+			if (!block) {
+				return nullptr;
+			}
+			if (block->next_) {
+				poolBlock *last = block->next_;
+				while (last->next_) {
+					last = last->next_;
+				}
+				poolRelease(sizeClass, block->next_, last);
+			}
+		}
+		header = reinterpret_cast<std::uint64_t *>(block);
+	}
+	*header = size > poolLargest ? size : poolSizes[poolClassOf(size)];
+	return header + 1;
+}
+
+std::size_t poolSize(void *const memory) noexcept {
+	return static_cast<std::size_t>(static_cast<std::uint64_t *>(memory)[-1]);
+}
+
+void poolFree(void *const memory) noexcept {
+	std::uint64_t *const header = static_cast<std::uint64_t *>(memory) - 1;
+	const std::size_t size = static_cast<std::size_t>(*header);
+	if (size > poolLargest) {
+		poolLists().largeBytes_.fetch_sub(size, std::memory_order_relaxed);
+		std::free(header);
+		return;
+	}
+	const std::size_t sizeClass = poolClassOf(size);
+	poolBlock *const block = reinterpret_cast<poolBlock *>(header);
+	poolThreadCache *const cache = poolCache();
+	if (!cache) {
+		block->next_ = nullptr;
+		poolRelease(sizeClass, block, block);
+		return;
+	}
+	block->next_ = cache->free_[sizeClass];
+	cache->free_[sizeClass] = block;
+	if (++cache->count_[sizeClass] > poolThreadLimit) {
+		//the blocks of a thread that frees what others allocated go back a batch at a time
+		poolBlock *last = block;
+		for (unsigned released = 1; released < poolBatch; ++released) {
+			last = last->next_;
+		}
+		cache->free_[sizeClass] = last->next_;
+		cache->count_[sizeClass] -= poolBatch;
+		poolRelease(sizeClass, block, last);
+	}
+}
+
+std::size_t poolRoundup(const std::size_t size) noexcept {
+	return size > poolLargest ? (size + 7) & ~std::size_t{7} : poolSizes[poolClassOf(size)];
+}
+
+sqlite3_mem_methods pooledAllocatorMethods() noexcept {
+	sqlite3_mem_methods methods{};
+	methods.xMalloc = [](const int size) {
+		return poolAllocate(poolRoundup(static_cast<std::size_t>(size)));
+	};
+	methods.xFree = poolFree;
+	methods.xRealloc = [](void *const memory, const int size) -> void * {
+		const std::size_t wanted = poolRoundup(static_cast<std::size_t>(size));
+		const std::size_t current = poolSize(memory);
+		if (wanted == current) {
+			return memory;
+		}
+		if (wanted > poolLargest && current > poolLargest) {
+			std::uint64_t *const header = static_cast<std::uint64_t *>(std::realloc(static_cast<std::uint64_t *>(memory) - 1, poolHeader + wanted));
+			if (!header) {
+				return nullptr;
+			}
+			poolLists().largeBytes_.fetch_add(wanted - current, std::memory_order_relaxed);
+			*header = wanted;
+			return header + 1;
+		}
+		void *const moved = poolAllocate(wanted);
+		if (moved) {
+			std::memcpy(moved, memory, std::min(wanted, current));
+			poolFree(memory);
+		}
+		return moved;
+	};
+	methods.xSize = [](void *const memory) {
+		return static_cast<int>(poolSize(memory));
+	};
+	methods.xRoundup = [](const int size) {
+		return static_cast<int>(poolRoundup(static_cast<std::size_t>(size)));
+	};
+	methods.xInit = [](void *) {
+		return SQLITE_OK;
+	};
+	methods.xShutdown = [](void *) {
+	};
+	return methods;
+}
+
+}
+
+void Sqlite::configureSqlite(const GlobalOptions &options) {
+	static std::mutex mutex;
+	static bool configured = false;
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (configured) {
+		throw exception(SQLITE_MISUSE, "the global configuration is already installed");
+	}
+	//what is installed now, put back when a later step fails so that configureSqlite can be called again
+	sqlite3_mem_methods previousAllocator{};
+	sqlite3_pcache_methods2 previousPageCache{};
+	int result = sqlite3_config(SQLITE_CONFIG_GETMALLOC, &previousAllocator);
+	if (result == SQLITE_OK) {
+		result = sqlite3_config(SQLITE_CONFIG_GETPCACHE2, &previousPageCache);
+	}
+	if (result != SQLITE_OK) {
+		throw exception(result, "configureSqlite has to run before SQLite is initialized");
+	}
+	const auto restore = [&previousAllocator, &previousPageCache] {
+		sqlite3_config(SQLITE_CONFIG_PCACHE2, &previousPageCache);
+		sqlite3_config(SQLITE_CONFIG_MALLOC, &previousAllocator);
+	};
+	if (options.sharedPageCache_) {
+		sharedPageCache &pages = sharedPages();
+		pages.shardCount_ = std::max<std::size_t>(1, options.pageCacheShards_);
+		pages.shards_.reset(new pageCacheShard[pages.shardCount_]);
+		pages.budget_ = options.pageCacheBytes_;
+		const sqlite3_pcache_methods2 methods = sharedPageCacheMethods();
+		result = sqlite3_config(SQLITE_CONFIG_PCACHE2, &methods);
+	}
+	if (result == SQLITE_OK && options.pooledAllocator_) {
+		const sqlite3_mem_methods methods = pooledAllocatorMethods();
+		result = sqlite3_config(SQLITE_CONFIG_MALLOC, &methods);
+	}
+	if (result == SQLITE_OK) {
+		result = sqlite3_initialize();
+	}
+	if (result != SQLITE_OK) {
+		restore();
+		throw exception(result, sqlite3_errstr(result));
+	}
+	configured = true;
+}
+
+Sqlite::GlobalMemoryStats Sqlite::globalMemoryStats() noexcept {
+	const sharedPageCache &pages = sharedPages();
+	const poolShared &pool = poolLists();
+	return GlobalMemoryStats{pages.bytes_.load(std::memory_order_relaxed), pages.hits_.load(std::memory_order_relaxed), pages.misses_.load(std::memory_order_relaxed),
+		pages.evictions_.load(std::memory_order_relaxed), pool.slabBytes_.load(std::memory_order_relaxed), pool.largeBytes_.load(std::memory_order_relaxed)};
+}
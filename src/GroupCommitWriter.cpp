@@ -0,0 +1,114 @@
+#include "GroupCommitWriter.hpp"
+#include <algorithm>
+
+void Sqlite::mpscQueue::push(mpscNode *const node) noexcept {
+	node->next_.store(nullptr, std::memory_order_relaxed);
+	mpscNode *const previous = head_.exchange(node);
+	previous->next_.store(node, std::memory_order_release);
+}
+
+Sqlite::mpscNode *Sqlite::mpscQueue::pop() noexcept {
+	mpscNode *tail = tail_;
+	mpscNode *next = tail->next_.load(std::memory_order_acquire);
+	if (tail == &stub_) {
+		if (next == nullptr) {
+			return nullptr;
+		}
+		tail_ = next;
+		tail = next;
+		next = next->next_.load(std::memory_order_acquire);
+	}
+	if (next != nullptr) {
+		tail_ = next;
+		return tail;
+	}
+	if (tail != head_.load()) {
+		return nullptr;
+	}
+	push(&stub_);
+	next = tail->next_.load(std::memory_order_acquire);
+	if (next != nullptr) {
+		tail_ = next;
+		return tail;
+	}
+	return nullptr;
+}
+
+Sqlite::GroupCommitWriter::GroupCommitWriter(const char *const filename, const GroupCommitOptions &options, const OpenOptions &openOptions) : connection_(filename, openOptions), options_{std::max<std::size_t>(options.maxBatch_, 1), options.maxLatency_}, worker_([this] { work(); }) {
+}
+
+Sqlite::GroupCommitWriter::~GroupCommitWriter() noexcept {
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		stopping_.store(true);
+	}
+	condition_.notify_one();
+	worker_.join();
+}
+
+void Sqlite::GroupCommitWriter::push(groupCommitNode *const node) noexcept {
+	queue_.push(node);
+	if (idle_.load()) {
+		//taking the mutex orders the notification after the writer either checked the queue or started waiting
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+		}
+		condition_.notify_one();
+	}
+}
+
+void Sqlite::GroupCommitWriter::park() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	idle_.store(true);
+	condition_.wait(lock, [this] { return ready(); });
+	idle_.store(false);
+}
+
+void Sqlite::GroupCommitWriter::parkUntil(const std::chrono::steady_clock::time_point deadline) {
+	std::unique_lock<std::mutex> lock(mutex_);
+	idle_.store(true);
+	condition_.wait_until(lock, deadline, [this] { return ready(); });
+	idle_.store(false);
+}
+
+void Sqlite::GroupCommitWriter::work() noexcept {
+	std::vector<std::unique_ptr<asyncJob>> batch;
+	for (;;) {
+		std::unique_ptr<asyncJob> job = pop();
+		if (!job) {
+			if (!queue_.empty()) {
+				//a producer is between its exchange and its link
+				std::this_thread::yield();
+			}
+			else if (stopping_.load()) {
+				return;
+			}
+			else {
+				park();
+			}
+			continue;
+		}
+
+		batch.push_back(std::move(job));
+		const auto deadline = std::chrono::steady_clock::now() + options_.maxLatency_;
+		while (batch.size() < options_.maxBatch_) {
+			if ((job = pop())) {
+				batch.push_back(std::move(job));
+			}
+			else if (options_.maxLatency_.count() == 0 || std::chrono::steady_clock::now() >= deadline) {
+				break;
+			}
+			else if (queue_.empty()) {
+				parkUntil(deadline);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+
+		commitBatch(connection_, batch);
+		jobs_.fetch_add(batch.size(), std::memory_order_relaxed);
+		batches_.fetch_add(1, std::memory_order_relaxed);
+		batch.clear();
+	}
+}
@@ -0,0 +1,734 @@
+#include "IoUringVfs.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#define SQLITECPP_IO_URING
+#endif
+
+namespace {
+
+struct uringCounters {
+	std::atomic<unsigned long long> reads_{0};
+	std::atomic<unsigned long long> readAheadHits_{0};
+	std::atomic<unsigned long long> readAheads_{0};
+	std::atomic<unsigned long long> writes_{0};
+	std::atomic<unsigned long long> submissions_{0};
+};
+
+uringCounters &uringCounts() noexcept {
+	static uringCounters counts;
+	return counts;
+}
+
+void uringCount(std::atomic<unsigned long long> &counter) noexcept {
+	counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+//the completion of one submitted read or write, the user_data of its submission entry
+struct uringRequest {
+	int result_{0};
+	bool done_{true};
+};
+
+enum class uringOperation {
+	Read,
+	Write
+};
+
+#ifdef SQLITECPP_IO_URING
+
+// The submission and completion rings shared with the kernel, driven with the raw system calls so that liburing is not needed.
+// Requests in flight are kept below the size of the submission ring, the completion ring is twice as large and never overflows.
+class uringQueue {
+	int descriptor_{-1};
+	void *submissionRing_{MAP_FAILED};
+	std::size_t submissionRingSize_{0};
+	void *completionRing_{MAP_FAILED};
+	std::size_t completionRingSize_{0};
+	void *entries_{MAP_FAILED};
+	std::size_t entriesSize_{0};
+
+	unsigned *submissionTail_{nullptr};
+	unsigned *submissionArray_{nullptr};
+	unsigned submissionMask_{0};
+	unsigned *completionHead_{nullptr};
+	unsigned *completionTail_{nullptr};
+	io_uring_cqe *completions_{nullptr};
+	unsigned completionMask_{0};
+
+	unsigned capacity_{0};
+	unsigned tail_{0};
+	unsigned prepared_{0};
+	unsigned inFlight_{0};
+	//the completion of the cancellation settle() submits
+	uringRequest cancel_;
+
+	void *map(const std::size_t size, const long long offset) const noexcept {
+		return mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor_, offset);
+	}
+
+  public:
+
+	uringQueue() = default;
+	uringQueue(const uringQueue &) = delete;
+	uringQueue &operator=(const uringQueue &) = delete;
+
+	~uringQueue() {
+		close();
+	}
+
+	bool open(const unsigned depth) noexcept {
+		io_uring_params parameters{};
+		descriptor_ = static_cast<int>(syscall(__NR_io_uring_setup, depth, &parameters));
+		//IORING_OP_READ and IORING_OP_WRITE came with IORING_FEAT_RW_CUR_POS, in Linux 5.6
+		if (descriptor_ < 0 || !(parameters.features & IORING_FEAT_RW_CUR_POS)) {
+			close();
+			return false;
+		}
+		submissionRingSize_ = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+		completionRingSize_ = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+		const bool singleMap = (parameters.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (singleMap) {
+			submissionRingSize_ = completionRingSize_ = std::max(submissionRingSize_, completionRingSize_);
+		}
+		submissionRing_ = map(submissionRingSize_, IORING_OFF_SQ_RING);
+		completionRing_ = singleMap ? submissionRing_ : map(completionRingSize_, IORING_OFF_CQ_RING);
+		entriesSize_ = parameters.sq_entries * sizeof(io_uring_sqe);
+		entries_ = map(entriesSize_, IORING_OFF_SQES);
+		if (submissionRing_ == MAP_FAILED || completionRing_ == MAP_FAILED || entries_ == MAP_FAILED) {
+			close();
+			return false;
+		}
+
+		char *const submission = static_cast<char *>(submissionRing_);
+		submissionTail_ = reinterpret_cast<unsigned *>(submission + parameters.sq_off.tail);
+		submissionArray_ = reinterpret_cast<unsigned *>(submission + parameters.sq_off.array);
+		submissionMask_ = *reinterpret_cast<unsigned *>(submission + parameters.sq_off.ring_mask);
+		char *const completion = static_cast<char *>(completionRing_);
+		completionHead_ = reinterpret_cast<unsigned *>(completion + parameters.cq_off.head);
+		completionTail_ = reinterpret_cast<unsigned *>(completion + parameters.cq_off.tail);
+		completions_ = reinterpret_cast<io_uring_cqe *>(completion + parameters.cq_off.cqes);
+		completionMask_ = *reinterpret_cast<unsigned *>(completion + parameters.cq_off.ring_mask);
+		capacity_ = parameters.sq_entries;
+		tail_ = *submissionTail_;
+		return true;
+	}
+
+	void close() noexcept {
+		if (entries_ != MAP_FAILED) {
+			munmap(entries_, entriesSize_);
+		}
+		if (completionRing_ != MAP_FAILED && completionRing_ != submissionRing_) {
+			munmap(completionRing_, completionRingSize_);
+		}
+		if (submissionRing_ != MAP_FAILED) {
+			munmap(submissionRing_, submissionRingSize_);
+		}
+		if (descriptor_ >= 0) {
+			::close(descriptor_);
+		}
+		descriptor_ = -1;
+		submissionRing_ = completionRing_ = entries_ = MAP_FAILED;
+	}
+
+	io_uring_sqe &nextEntry(uringRequest &request) noexcept {
+		const unsigned index = tail_ & submissionMask_;
+		io_uring_sqe &entry = static_cast<io_uring_sqe *>(entries_)[index];
+		std::memset(&entry, 0, sizeof(entry));
+		entry.user_data = reinterpret_cast<unsigned long long>(&request);
+		submissionArray_[index] = index;
+		++tail_;
+		++prepared_;
+		++inFlight_;
+		request.done_ = false;
+		return entry;
+	}
+
+	//takes back the entries the kernel has not consumed, which it only does inside io_uring_enter, their requests end with -ECANCELED
+	void withdraw() noexcept {
+		for (; prepared_ > 0; --prepared_) {
+			--tail_;
+			--inFlight_;
+			const io_uring_sqe &entry = static_cast<io_uring_sqe *>(entries_)[tail_ & submissionMask_];
+			uringRequest &request = *reinterpret_cast<uringRequest *>(entry.user_data);
+			request.result_ = -ECANCELED;
+			request.done_ = true;
+		}
+		__atomic_store_n(submissionTail_, tail_, __ATOMIC_RELEASE);
+	}
+
+	// After io_uring_enter failed: the kernel may still read or write the buffer of request, which belongs to the caller,
+	// so it is cancelled and waited for. Completions are posted to the shared ring whether or not io_uring_enter succeeds.
+	void settle(uringRequest &request) noexcept {
+		withdraw();
+		reap();
+		if (!request.done_ && cancel_.done_ && inFlight_ < capacity_) {
+			io_uring_sqe &entry = nextEntry(cancel_);
+			entry.opcode = IORING_OP_ASYNC_CANCEL;
+			entry.fd = -1;
+			entry.addr = reinterpret_cast<unsigned long long>(&request);
+			if (!submit(false)) {
+				withdraw();
+			}
+		}
+		while (!request.done_ || !cancel_.done_) {
+			if (!submit(true)) {
+				std::this_thread::yield();
+			}
+			reap();
+		}
+	}
+
+	//queues a read or write of size bytes at offset without submitting it, false when the ring is full
+	bool prepare(const uringOperation operation, const int file, void *const buffer, const unsigned size, const long long offset, uringRequest &request) noexcept {
+		if (inFlight_ == capacity_) {
+			return false;
+		}
+		io_uring_sqe &entry = nextEntry(request);
+		entry.opcode = operation == uringOperation::Read ? IORING_OP_READ : IORING_OP_WRITE;
+		entry.fd = file;
+		entry.addr = reinterpret_cast<unsigned long long>(buffer);
+		entry.len = size;
+		entry.off = static_cast<unsigned long long>(offset);
+		return true;
+	}
+
+	//hands every prepared entry to the kernel in one call, which also waits for a completion when wait is set
+	bool submit(const bool wait) noexcept {
+		if (prepared_ == 0 && !wait) {
+			return true;
+		}
+		__atomic_store_n(submissionTail_, tail_, __ATOMIC_RELEASE);
+		for (;;) {
+			const long submitted = syscall(__NR_io_uring_enter, descriptor_, prepared_, wait ? 1u : 0u, wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+			if (submitted < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return false;
+			}
+			uringCount(uringCounts().submissions_);
+			prepared_ -= static_cast<unsigned>(submitted);
+			if (prepared_ == 0) {
+				return true;
+			}
+		}
+	}
+
+	//marks the requests the kernel completed as done
+	void reap() noexcept {
+		unsigned head = *completionHead_;
+		const unsigned tail = __atomic_load_n(completionTail_, __ATOMIC_ACQUIRE);
+		for (; head != tail; ++head) {
+			const io_uring_cqe &completion = completions_[head & completionMask_];
+			uringRequest &request = *reinterpret_cast<uringRequest *>(completion.user_data);
+			request.result_ = completion.res;
+			request.done_ = true;
+			--inFlight_;
+		}
+		__atomic_store_n(completionHead_, head, __ATOMIC_RELEASE);
+	}
+
+	//submits what is prepared and waits until request is done, false when io_uring_enter failed, the request is then cancelled or done anyway
+	bool wait(uringRequest &request) noexcept {
+		reap();
+		while (!request.done_) {
+			if (!submit(true)) {
+				settle(request);
+				return false;
+			}
+			reap();
+		}
+		return true;
+	}
+};
+
+// The unix VFS keeps the descriptor after the methods, VFS and inode pointers of its unixFile, a layout unchanged since 3.7.
+// It is only used when fstat finds the file opened under that name behind it, every other file stays with the unix VFS.
+int unixDescriptor(sqlite3_file *const real, const char *const name) noexcept {
+	struct unixFilePrefix {
+		const sqlite3_io_methods *methods_;
+		sqlite3_vfs *vfs_;
+		void *inode_;
+		int descriptor_;
+	};
+	const int descriptor = reinterpret_cast<const unixFilePrefix *>(real)->descriptor_;
+	struct stat opened{};
+	struct stat named{};
+	if (descriptor < 0 || fstat(descriptor, &opened) != 0 || stat(name, &named) != 0 || opened.st_dev != named.st_dev || opened.st_ino != named.st_ino) {
+		return -1;
+	}
+	return descriptor;
+}
+
+bool uringTransient(const int result) noexcept {
+	return result == -EINTR || result == -EAGAIN;
+}
+
+bool uringFull(const int result) noexcept {
+	return result == -ENOSPC || result == -EDQUOT;
+}
+
+#else
+
+class uringQueue {
+  public:
+
+	bool open(const unsigned) noexcept {
+		return false;
+	}
+
+	bool prepare(const uringOperation, const int, void *const, const unsigned, const long long, uringRequest &) noexcept {
+		return false;
+	}
+
+	bool submit(const bool) noexcept {
+		return false;
+	}
+
+	void reap() noexcept {
+	}
+
+	bool wait(uringRequest &request) noexcept {
+		return request.done_;
+	}
+};
+
+int unixDescriptor(sqlite3_file *const, const char *const) noexcept {
+	return -1;
+}
+
+bool uringTransient(const int) noexcept {
+	return false;
+}
+
+bool uringFull(const int) noexcept {
+	return false;
+}
+
+#endif
+
+//one read-ahead request, offset_ is -1 once it is dropped, its buffer is reused only after the kernel is done with it
+struct readAheadBlock {
+	std::unique_ptr<char[]> buffer_;
+	long long offset_{-1};
+	uringRequest request_;
+};
+
+struct uringFileState {
+	uringQueue queue_;
+	int descriptor_{-1};
+	long long blockSize_{0};
+	int sequentialReads_{0};
+	std::vector<readAheadBlock> blocks_;
+	//where the next read starts if the access is sequential, and how many reads in a row were
+	long long nextOffset_{-1};
+	int streak_{0};
+};
+
+struct uringFile {
+	sqlite3_file base_;
+	sqlite3_file *real_;
+	uringFileState *state_;
+};
+
+//the file of the unix VFS follows the wrapper in the memory SQLite allocates for szOsFile
+constexpr std::size_t uringRealFileOffset = (sizeof(uringFile) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+uringFile &uringFileOf(sqlite3_file *const file) noexcept {
+	return *reinterpret_cast<uringFile *>(file);
+}
+
+sqlite3_file *uringReal(sqlite3_file *const file) noexcept {
+	return uringFileOf(file).real_;
+}
+
+readAheadBlock *findReadAhead(uringFileState &state, const long long offset, const int amount) noexcept {
+	for (readAheadBlock &block : state.blocks_) {
+		if (block.offset_ >= 0 && block.offset_ <= offset && offset + amount <= block.offset_ + state.blockSize_) {
+			return &block;
+		}
+	}
+	return nullptr;
+}
+
+void dropReadAhead(uringFileState &state, const long long offset = 0, const long long end = LLONG_MAX) noexcept {
+	for (readAheadBlock &block : state.blocks_) {
+		if (block.offset_ >= 0 && block.offset_ < end && offset < block.offset_ + state.blockSize_) {
+			block.offset_ = -1;
+		}
+	}
+}
+
+//prepares requests for the blocks from the one holding offset on, into blocks the scan has passed, without submitting them
+void startReadAhead(uringFileState &state, const long long offset) noexcept {
+	if (state.streak_ < state.sequentialReads_) {
+		return;
+	}
+	state.queue_.reap();
+	const long long first = offset & ~(state.blockSize_ - 1);
+	for (std::size_t ahead = 0; ahead < state.blocks_.size(); ++ahead) {
+		const long long wanted = first + static_cast<long long>(ahead) * state.blockSize_;
+		if (std::any_of(state.blocks_.begin(), state.blocks_.end(), [wanted](const readAheadBlock &block) { return block.offset_ == wanted; })) {
+			continue;
+		}
+		const auto passed = std::find_if(state.blocks_.begin(), state.blocks_.end(), [first](const readAheadBlock &block) {
+			return block.request_.done_ && block.offset_ < first;
+		});
+		if (passed == state.blocks_.end()) {
+			return;
+		}
+		if (!passed->buffer_) {
+			passed->buffer_.reset(new (std::nothrow) char[static_cast<std::size_t>(state.blockSize_)]);
+		}
+		if (!passed->buffer_ || !state.queue_.prepare(uringOperation::Read, state.descriptor_, passed->buffer_.get(), static_cast<unsigned>(state.blockSize_), wanted, passed->request_)) {
+			return;
+		}
+		passed->offset_ = wanted;
+		uringCount(uringCounts().readAheads_);
+	}
+}
+
+int readFromReadAhead(uringFileState &state, readAheadBlock &block, char *const target, const int amount, const long long offset) noexcept {
+	const long long available = std::clamp<long long>(block.request_.result_ - (offset - block.offset_), 0, amount);
+	std::memcpy(target, block.buffer_.get() + (offset - block.offset_), static_cast<std::size_t>(available));
+	uringCount(uringCounts().readAheadHits_);
+	//a read the read-ahead served keeps it going, even when the scan skipped a page
+	state.streak_ = std::max(state.streak_, state.sequentialReads_);
+	startReadAhead(state, offset + amount);
+	state.queue_.submit(false);
+	if (available < amount) {
+		std::memset(target + available, 0, static_cast<std::size_t>(amount - available));
+		return SQLITE_IOERR_SHORT_READ;
+	}
+	return SQLITE_OK;
+}
+
+int uringRead(sqlite3_file *const file, void *const buffer, const int amount, const sqlite3_int64 offset) {
+	uringFile &self = uringFileOf(file);
+	if (!self.state_) {
+		return self.real_->pMethods->xRead(self.real_, buffer, amount, offset);
+	}
+	uringFileState &state = *self.state_;
+	state.streak_ = offset == state.nextOffset_ ? state.streak_ + 1 : 0;
+	state.nextOffset_ = offset + amount;
+	char *const target = static_cast<char *>(buffer);
+	if (readAheadBlock *const block = findReadAhead(state, offset, amount)) {
+		if (!state.queue_.wait(block->request_)) {
+			return SQLITE_IOERR_READ;
+		}
+		if (block->request_.result_ >= 0) {
+			return readFromReadAhead(state, *block, target, amount, offset);
+		}
+		block->offset_ = -1;
+	}
+
+	//the read goes to the kernel in the same submission as the read-ahead it starts
+	int done = 0;
+	while (done < amount) {
+		uringRequest request;
+		if (!state.queue_.prepare(uringOperation::Read, state.descriptor_, target + done, static_cast<unsigned>(amount - done), offset + done, request)) {
+			return SQLITE_IOERR_READ;
+		}
+		if (done == 0) {
+			startReadAhead(state, offset + amount);
+		}
+		if (!state.queue_.wait(request)) {
+			return SQLITE_IOERR_READ;
+		}
+		uringCount(uringCounts().reads_);
+		if (uringTransient(request.result_)) {
+			continue;
+		}
+		if (request.result_ < 0) {
+			return SQLITE_IOERR_READ;
+		}
+		if (request.result_ == 0) {
+			std::memset(target + done, 0, static_cast<std::size_t>(amount - done));
+			return SQLITE_IOERR_SHORT_READ;
+		}
+		done += request.result_;
+	}
+	return SQLITE_OK;
+}
+
+int uringWrite(sqlite3_file *const file, const void *const buffer, const int amount, const sqlite3_int64 offset) {
+	uringFile &self = uringFileOf(file);
+	if (!self.state_) {
+		return self.real_->pMethods->xWrite(self.real_, buffer, amount, offset);
+	}
+	uringFileState &state = *self.state_;
+	dropReadAhead(state, offset, offset + amount);
+	char *const source = static_cast<char *>(const_cast<void *>(buffer));
+	int done = 0;
+	while (done < amount) {
+		uringRequest request;
+		if (!state.queue_.prepare(uringOperation::Write, state.descriptor_, source + done, static_cast<unsigned>(amount - done), offset + done, request) || !state.queue_.wait(request)) {
+			return SQLITE_IOERR_WRITE;
+		}
+		if (uringTransient(request.result_)) {
+			continue;
+		}
+		if (uringFull(request.result_)) {
+			return SQLITE_FULL;
+		}
+		if (request.result_ <= 0) {
+			return SQLITE_IOERR_WRITE;
+		}
+		done += request.result_;
+	}
+	uringCount(uringCounts().writes_);
+	return SQLITE_OK;
+}
+
+int uringClose(sqlite3_file *const file) {
+	uringFile &self = uringFileOf(file);
+	if (uringFileState *const state = self.state_) {
+		//the kernel may still be reading into dropped blocks, their buffers are leaked if it cannot be waited for
+		if (std::all_of(state->blocks_.begin(), state->blocks_.end(), [state](readAheadBlock &block) { return state->queue_.wait(block.request_); })) {
+			delete state;
+		}
+		self.state_ = nullptr;
+	}
+	return self.real_->pMethods->xClose(self.real_);
+}
+
+//a lock change can follow writes of another connection, so the read-ahead is dropped
+void dropOnLockChange(sqlite3_file *const file) noexcept {
+	if (uringFileState *const state = uringFileOf(file).state_) {
+		dropReadAhead(*state);
+	}
+}
+
+const sqlite3_io_methods *uringMethods(const int version) noexcept {
+	static const std::array<sqlite3_io_methods, 3> versions = [] {
+		std::array<sqlite3_io_methods, 3> methods{};
+		for (int level = 1; level <= 3; ++level) {
+			sqlite3_io_methods &method = methods[level - 1];
+			method.iVersion = level;
+			method.xClose = uringClose;
+			method.xRead = uringRead;
+			method.xWrite = uringWrite;
+			method.xTruncate = [](sqlite3_file *const file, const sqlite3_int64 size) {
+				dropOnLockChange(file);
+				return uringReal(file)->pMethods->xTruncate(uringReal(file), size);
+			};
+			method.xSync = [](sqlite3_file *const file, const int flags) {
+				return uringReal(file)->pMethods->xSync(uringReal(file), flags);
+			};
+			method.xFileSize = [](sqlite3_file *const file, sqlite3_int64 *const size) {
+				return uringReal(file)->pMethods->xFileSize(uringReal(file), size);
+			};
+			method.xLock = [](sqlite3_file *const file, const int lock) {
+				dropOnLockChange(file);
+				return uringReal(file)->pMethods->xLock(uringReal(file), lock);
+			};
+			method.xUnlock = [](sqlite3_file *const file, const int lock) {
+				dropOnLockChange(file);
+				return uringReal(file)->pMethods->xUnlock(uringReal(file), lock);
+			};
+			method.xCheckReservedLock = [](sqlite3_file *const file, int *const reserved) {
+				return uringReal(file)->pMethods->xCheckReservedLock(uringReal(file), reserved);
+			};
+			method.xFileControl = [](sqlite3_file *const file, const int operation, void *const argument) {
+				return uringReal(file)->pMethods->xFileControl(uringReal(file), operation, argument);
+			};
+			method.xSectorSize = [](sqlite3_file *const file) {
+				return uringReal(file)->pMethods->xSectorSize(uringReal(file));
+			};
+			method.xDeviceCharacteristics = [](sqlite3_file *const file) {
+				return uringReal(file)->pMethods->xDeviceCharacteristics(uringReal(file));
+			};
+			if (level >= 2) {
+				method.xShmMap = [](sqlite3_file *const file, const int page, const int pageSize, const int extend, void volatile **const memory) {
+					return uringReal(file)->pMethods->xShmMap(uringReal(file), page, pageSize, extend, memory);
+				};
+				//every WAL read transaction starts with a shared memory lock, which covers checkpoints of other connections
+				method.xShmLock = [](sqlite3_file *const file, const int offset, const int count, const int flags) {
+					dropOnLockChange(file);
+					return uringReal(file)->pMethods->xShmLock(uringReal(file), offset, count, flags);
+				};
+				method.xShmBarrier = [](sqlite3_file *const file) {
+					dropOnLockChange(file);
+					uringReal(file)->pMethods->xShmBarrier(uringReal(file));
+				};
+				method.xShmUnmap = [](sqlite3_file *const file, const int deleteFlag) {
+					return uringReal(file)->pMethods->xShmUnmap(uringReal(file), deleteFlag);
+				};
+			}
+			if (level >= 3) {
+				method.xFetch = [](sqlite3_file *const file, const sqlite3_int64 offset, const int amount, void **const pointer) {
+					return uringReal(file)->pMethods->xFetch(uringReal(file), offset, amount, pointer);
+				};
+				method.xUnfetch = [](sqlite3_file *const file, const sqlite3_int64 offset, void *const pointer) {
+					return uringReal(file)->pMethods->xUnfetch(uringReal(file), offset, pointer);
+				};
+			}
+		}
+		return methods;
+	}();
+	return &versions[static_cast<std::size_t>(std::clamp(version, 1, 3) - 1)];
+}
+
+struct uringVfs {
+	sqlite3_vfs vfs_{};
+	sqlite3_vfs *base_{nullptr};
+	long long blockSize_{0};
+	std::size_t depth_{0};
+	int sequentialReads_{0};
+	bool available_{false};
+};
+
+sqlite3_vfs *uringBase(sqlite3_vfs *const vfs) noexcept {
+	return static_cast<uringVfs *>(vfs->pAppData)->base_;
+}
+
+uringFileState *openUringState(const uringVfs &vfs, sqlite3_file *const real, const char *const name) noexcept {
+	const int descriptor = unixDescriptor(real, name);
+	if (descriptor < 0) {
+		return nullptr;
+	}
+	try {
+		auto state = std::make_unique<uringFileState>();
+		state->descriptor_ = descriptor;
+		state->blockSize_ = vfs.blockSize_;
+		state->sequentialReads_ = vfs.sequentialReads_;
+		state->blocks_.resize(vfs.depth_);
+		//one entry for the read or the write, one to spare
+		if (!state->queue_.open(static_cast<unsigned>(vfs.depth_) + 2)) {
+			return nullptr;
+		}
+		return state.release();
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+int uringOpen(sqlite3_vfs *const vfs, const char *const name, sqlite3_file *const file, const int flags, int *const outFlags) {
+	const uringVfs &self = *static_cast<const uringVfs *>(vfs->pAppData);
+	uringFile &wrapper = uringFileOf(file);
+	wrapper.base_.pMethods = nullptr;
+	wrapper.real_ = reinterpret_cast<sqlite3_file *>(reinterpret_cast<char *>(file) + uringRealFileOffset);
+	wrapper.state_ = nullptr;
+	const int result = self.base_->xOpen(self.base_, name, wrapper.real_, flags, outFlags);
+	//SQLite closes a file with methods even when opening it failed
+	if (wrapper.real_->pMethods) {
+		if (result == SQLITE_OK && self.available_ && name && (flags & SQLITE_OPEN_MAIN_DB)) {
+			wrapper.state_ = openUringState(self, wrapper.real_, name);
+		}
+		wrapper.base_.pMethods = uringMethods(wrapper.real_->pMethods->iVersion);
+	}
+	return result;
+}
+
+void forwardToBase(sqlite3_vfs &vfs) noexcept {
+	vfs.xOpen = uringOpen;
+	vfs.xDelete = [](sqlite3_vfs *const self, const char *const name, const int syncDirectory) {
+		return uringBase(self)->xDelete(uringBase(self), name, syncDirectory);
+	};
+	vfs.xAccess = [](sqlite3_vfs *const self, const char *const name, const int flags, int *const result) {
+		return uringBase(self)->xAccess(uringBase(self), name, flags, result);
+	};
+	vfs.xFullPathname = [](sqlite3_vfs *const self, const char *const name, const int size, char *const path) {
+		return uringBase(self)->xFullPathname(uringBase(self), name, size, path);
+	};
+	vfs.xDlOpen = [](sqlite3_vfs *const self, const char *const name) {
+		return uringBase(self)->xDlOpen(uringBase(self), name);
+	};
+	vfs.xDlError = [](sqlite3_vfs *const self, const int size, char *const message) {
+		uringBase(self)->xDlError(uringBase(self), size, message);
+	};
+	vfs.xDlSym = [](sqlite3_vfs *const self, void *const library, const char *const symbol) {
+		return uringBase(self)->xDlSym(uringBase(self), library, symbol);
+	};
+	vfs.xDlClose = [](sqlite3_vfs *const self, void *const library) {
+		uringBase(self)->xDlClose(uringBase(self), library);
+	};
+	vfs.xRandomness = [](sqlite3_vfs *const self, const int size, char *const output) {
+		return uringBase(self)->xRandomness(uringBase(self), size, output);
+	};
+	vfs.xSleep = [](sqlite3_vfs *const self, const int microseconds) {
+		return uringBase(self)->xSleep(uringBase(self), microseconds);
+	};
+	vfs.xCurrentTime = [](sqlite3_vfs *const self, double *const time) {
+		return uringBase(self)->xCurrentTime(uringBase(self), time);
+	};
+	vfs.xGetLastError = [](sqlite3_vfs *const self, const int size, char *const message) {
+		return uringBase(self)->xGetLastError(uringBase(self), size, message);
+	};
+	vfs.xCurrentTimeInt64 = [](sqlite3_vfs *const self, sqlite3_int64 *const time) {
+		return uringBase(self)->xCurrentTimeInt64(uringBase(self), time);
+	};
+	vfs.xSetSystemCall = [](sqlite3_vfs *const self, const char *const name, const sqlite3_syscall_ptr call) {
+		return uringBase(self)->xSetSystemCall(uringBase(self), name, call);
+	};
+	vfs.xGetSystemCall = [](sqlite3_vfs *const self, const char *const name) {
+		return uringBase(self)->xGetSystemCall(uringBase(self), name);
+	};
+	vfs.xNextSystemCall = [](sqlite3_vfs *const self, const char *const name) {
+		return uringBase(self)->xNextSystemCall(uringBase(self), name);
+	};
+}
+
+}
+
+bool Sqlite::registerIoUringVfs(const IoUringVfsOptions &options, const bool makeDefault) {
+	static std::mutex mutex;
+	static uringVfs vfs;
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (vfs.base_) {
+		if (makeDefault) {
+			sqlite3_vfs_register(&vfs.vfs_, 1);
+		}
+		return vfs.available_;
+	}
+
+	sqlite3_vfs *const base = sqlite3_vfs_find(nullptr);
+	if (!base) {
+		throw exception(SQLITE_ERROR, "no default VFS to register the io_uring VFS over");
+	}
+	long long blockSize = 64 * 1024;
+	while (blockSize < static_cast<long long>(options.readAheadSize_) && blockSize < (1LL << 30)) {
+		blockSize *= 2;
+	}
+	vfs.blockSize_ = blockSize;
+	vfs.depth_ = std::min<std::size_t>(options.readAheadDepth_, 64);
+	vfs.sequentialReads_ = options.sequentialReads_;
+	uringQueue probe;
+	vfs.available_ = std::strncmp(base->zName, "unix", 4) == 0 && probe.open(2);
+
+	vfs.vfs_.iVersion = base->iVersion;
+	vfs.vfs_.szOsFile = static_cast<int>(uringRealFileOffset) + base->szOsFile;
+	vfs.vfs_.mxPathname = base->mxPathname;
+	vfs.vfs_.zName = ioUringVfsName;
+	vfs.vfs_.pAppData = &vfs;
+	forwardToBase(vfs.vfs_);
+	vfs.base_ = base;
+	const int result = sqlite3_vfs_register(&vfs.vfs_, makeDefault ? 1 : 0);
+	if (result != SQLITE_OK) {
+		vfs.base_ = nullptr;
+		throw exception(result, sqlite3_errstr(result));
+	}
+	return vfs.available_;
+}
+
+Sqlite::IoUringVfsStats Sqlite::ioUringVfsStats() noexcept {
+	const uringCounters &counts = uringCounts();
+	return IoUringVfsStats{counts.reads_.load(std::memory_order_relaxed), counts.readAheadHits_.load(std::memory_order_relaxed), counts.readAheads_.load(std::memory_order_relaxed),
+		counts.writes_.load(std::memory_order_relaxed), counts.submissions_.load(std::memory_order_relaxed)};
+}
@@ -0,0 +1,78 @@
+#include "OpenOptions.hpp"
+#include <sqlite3.h>
+
+int Sqlite::OpenOptions::flags() const noexcept {
+	int flags = readOnly_ ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE;
+	if (create_ && !readOnly_) {
+		flags |= SQLITE_OPEN_CREATE;
+	}
+	if (uri_) {
+		flags |= SQLITE_OPEN_URI;
+	}
+	if (threading_ == ThreadingMode::MultiThread) {
+		flags |= SQLITE_OPEN_NOMUTEX;
+	}
+	else if (threading_ == ThreadingMode::Serialized) {
+		flags |= SQLITE_OPEN_FULLMUTEX;
+	}
+	if (cache_ == CacheMode::Shared) {
+		flags |= SQLITE_OPEN_SHAREDCACHE;
+	}
+	else if (cache_ == CacheMode::Private) {
+		flags |= SQLITE_OPEN_PRIVATECACHE;
+	}
+	return flags;
+}
+
+std::string Sqlite::OpenOptions::pragmas() const {
+	static const char *const journalModes[] = {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"};
+	static const char *const synchronousModes[] = {"OFF", "NORMAL", "FULL", "EXTRA"};
+	static const char *const tempStores[] = {"DEFAULT", "FILE", "MEMORY"};
+
+	std::string text;
+	if (journalMode_) {
+		text += std::string("PRAGMA journal_mode=") + journalModes[static_cast<int>(*journalMode_)] + ';';
+	}
+	if (synchronous_) {
+		text += std::string("PRAGMA synchronous=") + synchronousModes[static_cast<int>(*synchronous_)] + ';';
+	}
+	if (cacheSize_) {
+		text += "PRAGMA cache_size=" + std::to_string(*cacheSize_) + ';';
+	}
+	if (mmapSize_) {
+		text += "PRAGMA mmap_size=" + std::to_string(*mmapSize_) + ';';
+	}
+	if (tempStore_) {
+		text += std::string("PRAGMA temp_store=") + tempStores[static_cast<int>(*tempStore_)] + ';';
+	}
+	return text;
+}
+
+Sqlite::OpenOptions Sqlite::OpenOptions::bulkLoad() {
+	OpenOptions options;
+	options.journalMode_ = JournalMode::Wal;
+	options.synchronous_ = SynchronousMode::Off;
+	options.cacheSize_ = -262144;
+	options.tempStore_ = TempStore::Memory;
+	options.busyTimeoutMilliseconds_ = 5000;
+	return options;
+}
+
+Sqlite::OpenOptions Sqlite::OpenOptions::readHeavy() {
+	OpenOptions options;
+	options.journalMode_ = JournalMode::Wal;
+	options.synchronous_ = SynchronousMode::Normal;
+	options.cacheSize_ = -65536;
+	options.mmapSize_ = 268435456;
+	options.tempStore_ = TempStore::Memory;
+	options.busyTimeoutMilliseconds_ = 5000;
+	return options;
+}
+
+Sqlite::OpenOptions Sqlite::OpenOptions::durable() {
+	OpenOptions options;
+	options.journalMode_ = JournalMode::Wal;
+	options.synchronous_ = SynchronousMode::Full;
+	options.busyTimeoutMilliseconds_ = 5000;
+	return options;
+}
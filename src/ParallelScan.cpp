@@ -0,0 +1,151 @@
+#include "ParallelScan.hpp"
+#include <string>
+#include <utility>
+
+void Sqlite::ParallelScan::work(const std::size_t reader) {
+	std::size_t generation = 0;
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		wake_.wait(lock, [&] { return stopping_ || generation_ != generation; });
+		if (stopping_) {
+			return;
+		}
+		generation = generation_;
+		lock.unlock();
+
+		std::exception_ptr error;
+		try {
+			task_(reader);
+		}
+		catch (...) {
+			failed_ = true;
+			error = std::current_exception();
+		}
+
+		lock.lock();
+		if (error && !error_) {
+			error_ = std::move(error);
+		}
+		if (--running_ == 0) {
+			finished_.notify_one();
+		}
+	}
+}
+
+void Sqlite::ParallelScan::stop() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	wake_.notify_all();
+	for (std::thread &worker : workers_) {
+		worker.join();
+	}
+}
+
+void Sqlite::ParallelScan::runOnReaders(std::function<void(std::size_t)> task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		task_ = std::move(task);
+		error_ = nullptr;
+		failed_ = false;
+		running_ = readerCount_;
+		++generation_;
+	}
+	wake_.notify_all();
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	finished_.wait(lock, [this] { return running_ == 0; });
+	task_ = nullptr;
+	if (error_) {
+		std::rethrow_exception(std::exchange(error_, nullptr));
+	}
+}
+
+void Sqlite::ParallelScan::startRead(const SqliteConnection &connection) {
+	sqliteExecute(connection, "select 1 from sqlite_master limit 1");
+}
+
+std::vector<Sqlite::Transaction> Sqlite::ParallelScan::beginReads() {
+	std::vector<Transaction> reads;
+	reads.reserve(readerCount_);
+#ifdef SQLITE_ENABLE_SNAPSHOT
+	reads.emplace_back(readers_[0]);
+	startRead(readers_[0]);
+	UniqueHandle<SnapshotTraits> snapshot;
+	int result = sqlite3_snapshot_get(readers_[0].getABI(), "main", snapshot.set());
+	if (SQLITE_OK != result) {
+		throw exception(result, sqlite3_errstr(result));
+	}
+	for (std::size_t reader = 1; reader != readerCount_; ++reader) {
+		reads.emplace_back(readers_[reader]);
+		result = sqlite3_snapshot_open(readers_[reader].getABI(), "main", snapshot.get());
+		if (SQLITE_OK != result) {
+			throw exception(result, sqlite3_errstr(result));
+		}
+	}
+#else
+	const Transaction writeLock(writer_, TransactionMode::Immediate);
+	for (std::size_t reader = 0; reader != readerCount_; ++reader) {
+		reads.emplace_back(readers_[reader]);
+		startRead(readers_[reader]);
+	}
+#endif
+	return reads;
+}
+
+std::vector<Sqlite::KeyRange> Sqlite::ParallelScan::partition(const SqliteConnection &connection, const char *const table, const char *const key, std::size_t count) {
+	const std::string quotedKey = quotedIdentifier(key);
+	const std::string quotedTable = quotedIdentifier(table);
+	const std::string text = "select (select min(" + quotedKey + ") from " + quotedTable + "), (select max(" + quotedKey + ") from " + quotedTable + ")";
+	SqliteStatement bounds(connection, text.c_str());
+	std::vector<KeyRange> ranges;
+	if (!bounds.execute() || sqlite3_column_type(bounds.getABI(), 0) == SQLITE_NULL) {
+		return ranges;
+	}
+
+	const long long first = bounds.get<long long>(0);
+	const unsigned long long span = static_cast<unsigned long long>(bounds.get<long long>(1)) - static_cast<unsigned long long>(first);
+	if (span < count) {
+		count = static_cast<std::size_t>(span) + 1;
+	}
+	const unsigned long long width = std::max<unsigned long long>(span / count, 1);
+	ranges.reserve(count);
+	for (std::size_t index = 0; index != count; ++index) {
+		const unsigned long long lower = static_cast<unsigned long long>(first) + width * index;
+		const unsigned long long upper = index + 1 == count ? static_cast<unsigned long long>(first) + span : lower + width - 1;
+		ranges.push_back(KeyRange{static_cast<long long>(lower), static_cast<long long>(upper)});
+	}
+	return ranges;
+}
+
+Sqlite::ParallelScan::ParallelScan(const char *const filename, const std::size_t readers, const OpenOptions &options) : readers_{std::make_unique<SqliteConnection[]>(std::max<std::size_t>(readers, 1))}, readerCount_{std::max<std::size_t>(readers, 1)} {
+	OpenOptions writerOptions = options;
+	writerOptions.readOnly_ = false;
+	writerOptions.threading_ = ThreadingMode::MultiThread;
+	writerOptions.journalMode_ = JournalMode::Wal;
+	writer_.open(filename, writerOptions);
+
+	OpenOptions readerOptions = options;
+	readerOptions.readOnly_ = true;
+	readerOptions.threading_ = ThreadingMode::MultiThread;
+	readerOptions.journalMode_.reset();
+	for (std::size_t reader = 0; reader != readerCount_; ++reader) {
+		readers_[reader].open(filename, readerOptions);
+	}
+
+	workers_.reserve(readerCount_);
+	try {
+		for (std::size_t reader = 0; reader != readerCount_; ++reader) {
+			workers_.emplace_back([this, reader] { work(reader); });
+		}
+	}
+	catch (...) {
+		stop();
+		throw;
+	}
+}
+
+Sqlite::ParallelScan::~ParallelScan() noexcept {
+	stop();
+}
@@ -0,0 +1,156 @@
+#include "ResultSet.hpp"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+
+void Sqlite::ResultSet::Column::clear() noexcept {
+	type_ = SQLITE_NULL;
+	size_ = 0;
+	nullCount_ = 0;
+	validity_.clear();
+	integers_.clear();
+	reals_.clear();
+	offsets_.assign(1, 0);
+	data_.clear();
+}
+
+void Sqlite::ResultSet::Column::setType(const int type) {
+	type_ = type;
+	if (type == SQLITE_INTEGER) {
+		integers_.resize(size_);
+	}
+	else if (type == SQLITE_FLOAT) {
+		reals_.resize(size_);
+	}
+	else {
+		offsets_.resize(size_ + 1);
+	}
+}
+
+void Sqlite::ResultSet::Column::appendBytes(const void *const bytes, const int size) {
+	if (data_.size() + static_cast<std::size_t>(size) > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+		throw exception(SQLITE_TOOBIG, "the text or blobs of column " + name_ + " exceed 2 GiB");
+	}
+	const char *const begin = static_cast<const char *>(bytes);
+	data_.insert(data_.end(), begin, begin + size);
+	offsets_.push_back(static_cast<std::int32_t>(data_.size()));
+}
+
+void Sqlite::ResultSet::Column::append(sqlite3_stmt *const statement, const int column) {
+	const bool valid = sqlite3_column_type(statement, column) != SQLITE_NULL;
+	if (valid && type_ == SQLITE_NULL) {
+		setType(sqlite3_column_type(statement, column));
+	}
+	if (size_ % 8 == 0) {
+		validity_.push_back(0);
+	}
+	if (valid) {
+		validity_.back() |= static_cast<std::uint8_t>(1u << (size_ % 8));
+	}
+	else {
+		++nullCount_;
+	}
+	++size_;
+
+	//the values are converted to the type of the column, like sqlite3_column_* does
+	switch (type_) {
+		case SQLITE_INTEGER:
+			integers_.push_back(valid ? sqlite3_column_int64(statement, column) : 0);
+			break;
+		case SQLITE_FLOAT:
+			reals_.push_back(valid ? sqlite3_column_double(statement, column) : 0.0);
+			break;
+		case SQLITE_TEXT:
+			if (valid) {
+				const unsigned char *const text = sqlite3_column_text(statement, column);
+				appendBytes(text, sqlite3_column_bytes(statement, column));
+			}
+			else {
+				offsets_.push_back(offsets_.back());
+			}
+			break;
+		case SQLITE_BLOB:
+			if (valid) {
+				const void *const blob = sqlite3_column_blob(statement, column);
+				appendBytes(blob, sqlite3_column_bytes(statement, column));
+			}
+			else {
+				offsets_.push_back(offsets_.back());
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+bool Sqlite::ResultSet::containsNoCase(const char *const text, const std::string_view word) noexcept {
+	const std::string_view view(text);
+	return std::search(view.begin(), view.end(), word.begin(), word.end(), [](const char left, const char right) { return std::toupper(static_cast<unsigned char>(left)) == right; }) != view.end();
+}
+
+int Sqlite::ResultSet::declaredType(const char *const declared) noexcept {
+	if (declared == nullptr) {
+		return SQLITE_NULL;
+	}
+	if (containsNoCase(declared, "INT")) {
+		return SQLITE_INTEGER;
+	}
+	if (containsNoCase(declared, "CHAR") || containsNoCase(declared, "CLOB") || containsNoCase(declared, "TEXT")) {
+		return SQLITE_TEXT;
+	}
+	if (containsNoCase(declared, "REAL") || containsNoCase(declared, "FLOA") || containsNoCase(declared, "DOUB")) {
+		return SQLITE_FLOAT;
+	}
+	return SQLITE_NULL;
+}
+
+void Sqlite::ResultSet::clear() noexcept {
+	for (std::size_t column = 0; column < columnCount_; ++column) {
+		columns_[column].clear();
+	}
+	columnCount_ = 0;
+	rowCount_ = 0;
+}
+
+void Sqlite::ResultSet::start(sqlite3_stmt *const statement) {
+	clear();
+	columnCount_ = static_cast<std::size_t>(sqlite3_column_count(statement));
+	if (columns_.size() < columnCount_) {
+		columns_.resize(columnCount_);
+	}
+	for (std::size_t column = 0; column < columnCount_; ++column) {
+		const int index = static_cast<int>(column);
+		columns_[column].name_ = sqlite3_column_name(statement, index);
+		const int type = declaredType(sqlite3_column_decltype(statement, index));
+		if (type != SQLITE_NULL) {
+			columns_[column].setType(type);
+		}
+	}
+}
+
+void Sqlite::ResultSet::appendRow(sqlite3_stmt *const statement) {
+	for (std::size_t column = 0; column < columnCount_; ++column) {
+		columns_[column].append(statement, static_cast<int>(column));
+	}
+	++rowCount_;
+}
+
+void Sqlite::ResultSet::setColumnType(const std::size_t column, const int type) {
+	Column &values = columns_[column];
+	if (values.type_ == type) {
+		return;
+	}
+	if (values.type_ != SQLITE_NULL) {
+		throw exception(SQLITE_MISUSE, "column " + values.name_ + " already has a type");
+	}
+	values.setType(type);
+}
+
+int Sqlite::ResultSet::columnIndex(const std::string_view name) const noexcept {
+	for (std::size_t column = 0; column < columnCount_; ++column) {
+		if (columns_[column].name_ == name) {
+			return static_cast<int>(column);
+		}
+	}
+	return -1;
+}
@@ -0,0 +1,91 @@
+#include "ScriptRunner.hpp"
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <optional>
+
+namespace {
+
+struct scriptStatementTraits : public Sqlite::nullHandleTraits<sqlite3_stmt *> {
+	static void close(sqlite3_stmt *value) noexcept {
+		sqlite3_finalize(value);
+	}
+};
+
+[[noreturn]] void throwScriptError(const Sqlite::SqliteConnection &connection, const std::size_t offset) {
+	throw Sqlite::exception(sqlite3_extended_errcode(connection.getABI()), std::string(sqlite3_errmsg(connection.getABI())) + " (statement at byte " + std::to_string(offset) + ')');
+}
+
+std::vector<Sqlite::ScriptStatement> runScript(const Sqlite::SqliteConnection &connection, const char *const script, const std::size_t length, const Sqlite::ScriptOptions &options) {
+	std::optional<Sqlite::Transaction> transaction;
+	if (options.transaction_) {
+		transaction.emplace(connection, options.mode_);
+	}
+#ifdef SQLITECPP_ENABLE_PROFILING
+	Sqlite::StatementProfiler *const profiler = connection.profiler();
+#endif
+	std::vector<Sqlite::ScriptStatement> statements;
+	const char *const end = script + length;
+	const char *text = script;
+	while (text < end) {
+		while (text != end && (std::isspace(static_cast<unsigned char>(*text)) || *text == ';')) {
+			++text;
+		}
+		if (text == end) {
+			break;
+		}
+		//the terminating NUL is counted, so that SQLite parses the text in place
+		const std::size_t remaining = static_cast<std::size_t>(end - text) + 1;
+		const int size = remaining > static_cast<std::size_t>(INT_MAX) ? -1 : static_cast<int>(remaining);
+		const auto start = std::chrono::steady_clock::now();
+		Sqlite::UniqueHandle<scriptStatementTraits> statement;
+		const char *tail = nullptr;
+		if (SQLITE_OK != sqlite3_prepare_v2(connection.getABI(), text, size, statement.set(), &tail)) {
+			throwScriptError(connection, static_cast<std::size_t>(text - script));
+		}
+		//comments only, or an embedded NUL where SQLite stops reading, which ends the script
+		if (!statement) {
+			if (tail == text) {
+				break;
+			}
+			text = tail;
+			continue;
+		}
+#ifdef SQLITECPP_ENABLE_PROFILING
+		if (profiler && profiler->enabled()) {
+			profiler->recordPrepare(statement.get(), std::chrono::steady_clock::now() - start);
+		}
+		unsigned long long rows = 0;
+#endif
+		int result;
+		while (SQLITE_ROW == (result = sqlite3_step(statement.get()))) {
+#ifdef SQLITECPP_ENABLE_PROFILING
+			++rows;
+#endif
+		}
+#ifdef SQLITECPP_ENABLE_PROFILING
+		if (profiler && profiler->enabled()) {
+			profiler->recordSteps(statement.get(), rows + 1, rows);
+		}
+#endif
+		if (SQLITE_DONE != result) {
+			throwScriptError(connection, static_cast<std::size_t>(text - script));
+		}
+		statements.push_back(Sqlite::ScriptStatement{std::string_view(text, static_cast<std::size_t>(tail - text)), std::chrono::steady_clock::now() - start, sqlite3_changes(connection.getABI())});
+		text = tail;
+	}
+	if (transaction) {
+		transaction->commit();
+	}
+	return statements;
+}
+
+}
+
+std::vector<Sqlite::ScriptStatement> Sqlite::sqliteExecuteScript(const SqliteConnection &connection, const char *const script, const ScriptOptions &options) {
+	return runScript(connection, script, std::strlen(script), options);
+}
+
+std::vector<Sqlite::ScriptStatement> Sqlite::sqliteExecuteScript(const SqliteConnection &connection, const std::string &script, const ScriptOptions &options) {
+	return runScript(connection, script.c_str(), script.size(), options);
+}
@@ -1,30 +1,165 @@
 #include "SqliteConnection.hpp"
+#include "TextEncoding.hpp"
 
 template <typename Function, typename CharacterSet>
-void Sqlite::SqliteConnection::internalOpen(Function openFunction, const CharacterSet *const filename) {
+void Sqlite::SqliteConnection::internalOpen(Function openFunction, const CharacterSet *const filename, const OpenOptions *const options) {
 	
 	SqliteConnection tempConnection;
 	
 	if (SQLITE_OK != openFunction(filename, tempConnection.connectionHandle_.set())) {
 		tempConnection.throwLastError();
 	}
+	tempConnection.statementCache_->attach(tempConnection.getABI());
+	
+	if (options) {
+		tempConnection.configure(*options);
+	}
+	
+	if (statementCache_) {
+		tempConnection.statementCache_->setCapacity(statementCache_->capacity());
+	}
 	
 	swap(connectionHandle_, tempConnection.connectionHandle_);
+	statementCache_.swap(tempConnection.statementCache_);
+#ifdef SQLITECPP_ENABLE_PROFILING
+	if (profiler_ && profiler_->enabled()) {
+		enableProfiling();
+	}
+#endif
+}
+
+void Sqlite::SqliteConnection::configure(const OpenOptions &options) {
+	if (options.busyTimeoutMilliseconds_) {
+		sqlite3_busy_timeout(getABI(), *options.busyTimeoutMilliseconds_);
+	}
+	const std::string pragmas = options.pragmas();
+	if (!pragmas.empty() && SQLITE_OK != sqlite3_exec(getABI(), pragmas.c_str(), nullptr, nullptr, nullptr)) {
+		throwLastError();
+	}
+}
+
+void Sqlite::SqliteConnection::pragma(const std::string &text) const {
+	if (SQLITE_OK != sqlite3_exec(getABI(), text.c_str(), nullptr, nullptr, nullptr)) {
+		throwLastError();
+	}
 }
 
 void Sqlite::SqliteConnection::throwLastError() const {
 	throw exception(getABI());
 }
 
+#ifdef SQLITECPP_ENABLE_PROFILING
+void Sqlite::SqliteConnection::enableProfiling() {
+	if (!profiler_) {
+		profiler_ = std::make_unique<StatementProfiler>();
+	}
+	profiler_->attach(getABI());
+	statementCache_->setProfiler(profiler_.get());
+}
+
+void Sqlite::SqliteConnection::disableProfiling() noexcept {
+	if (profiler_) {
+		profiler_->detach(getABI());
+	}
+	statementCache_->setProfiler(nullptr);
+}
+
+std::vector<Sqlite::StatementProfile> Sqlite::SqliteConnection::profile() const {
+	return profiler_ ? profiler_->snapshot() : std::vector<StatementProfile>{};
+}
+#endif
+
 void Sqlite::SqliteConnection::open(const char *const filename) {
 	internalOpen(sqlite3_open, filename);
 }
 
 void Sqlite::SqliteConnection::open(const wchar_t *const filename) {
-	internalOpen(sqlite3_open16, filename);
+	if constexpr (wideIsUtf32) {
+		std::string utf8;
+		wideToUtf8(filename, utf8);
+		internalOpen(sqlite3_open, utf8.c_str());
+	}
+	else {
+		internalOpen(sqlite3_open16, filename);
+	}
+}
+
+void Sqlite::SqliteConnection::open(const char *const filename, const int flags, const char *const vfs) {
+	internalOpen([flags, vfs](const char *const name, sqlite3 **const handle) { return sqlite3_open_v2(name, handle, flags, vfs); }, filename);
+}
+
+void Sqlite::SqliteConnection::open(const char *const filename, const OpenOptions &options) {
+	const char *const vfs = options.vfs_.empty() ? nullptr : options.vfs_.c_str();
+	internalOpen([&options, vfs](const char *const name, sqlite3 **const handle) { return sqlite3_open_v2(name, handle, options.flags(), vfs); }, filename, &options);
 }
 
 long long Sqlite::SqliteConnection::lastRowId() const noexcept {
         return sqlite3_last_insert_rowid(getABI());
 }	
 
+Sqlite::ConnectionStats Sqlite::SqliteConnection::stats(const bool reset) const {
+	ConnectionStats stats;
+	int current = 0;
+	int highwater = 0;
+	const auto status = [&](const int operation) {
+		current = 0;
+		highwater = 0;
+		sqlite3_db_status(getABI(), operation, &current, &highwater, reset ? 1 : 0);
+	};
+	status(SQLITE_DBSTATUS_CACHE_USED);
+	stats.cacheUsed_ = current;
+	status(SQLITE_DBSTATUS_CACHE_USED_SHARED);
+	stats.cacheUsedShared_ = current;
+	status(SQLITE_DBSTATUS_SCHEMA_USED);
+	stats.schemaUsed_ = current;
+	status(SQLITE_DBSTATUS_STMT_USED);
+	stats.statementUsed_ = current;
+	status(SQLITE_DBSTATUS_CACHE_HIT);
+	stats.cacheHits_ = current;
+	status(SQLITE_DBSTATUS_CACHE_MISS);
+	stats.cacheMisses_ = current;
+	status(SQLITE_DBSTATUS_CACHE_WRITE);
+	stats.cacheWrites_ = current;
+#ifdef SQLITE_DBSTATUS_CACHE_SPILL
+	status(SQLITE_DBSTATUS_CACHE_SPILL);
+	stats.cacheSpills_ = current;
+#endif
+	status(SQLITE_DBSTATUS_LOOKASIDE_USED);
+	stats.lookasideUsed_ = current;
+	stats.lookasideHighwater_ = highwater;
+	//these only have a highwater
+	status(SQLITE_DBSTATUS_LOOKASIDE_HIT);
+	stats.lookasideHits_ = highwater;
+	status(SQLITE_DBSTATUS_LOOKASIDE_MISS_SIZE);
+	stats.lookasideMissesSize_ = highwater;
+	status(SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL);
+	stats.lookasideMissesFull_ = highwater;
+
+	sqlite3_int64 used = 0;
+	sqlite3_int64 most = 0;
+	sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &used, &most, 0);
+	stats.memoryUsed_ = used;
+	stats.memoryHighwater_ = most;
+	sqlite3_status64(SQLITE_STATUS_MALLOC_COUNT, &used, &most, 0);
+	stats.allocations_ = used;
+	sqlite3_status64(SQLITE_STATUS_MALLOC_SIZE, &used, &most, 0);
+	stats.largestAllocation_ = most;
+	sqlite3_status64(SQLITE_STATUS_PAGECACHE_OVERFLOW, &used, &most, 0);
+	stats.pagecacheOverflow_ = used;
+	return stats;
+}
+
+void Sqlite::SqliteConnection::setMmapSize(const long long bytes) const {
+	pragma("PRAGMA mmap_size=" + std::to_string(bytes));
+}
+
+void Sqlite::SqliteConnection::setCacheSize(const long long size) const {
+	pragma("PRAGMA cache_size=" + std::to_string(size));
+}
+
+void Sqlite::SqliteConnection::configureLookaside(const int slotSize, const int slotCount) const {
+	const int result = sqlite3_db_config(getABI(), SQLITE_DBCONFIG_LOOKASIDE, nullptr, slotSize, slotCount);
+	if (SQLITE_OK != result) {
+		throw exception(result, sqlite3_errstr(result));
+	}
+}
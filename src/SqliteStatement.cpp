@@ -1,25 +1,38 @@
 #include "SqliteStatement.hpp"
 
-template <typename T>
-constexpr int Sqlite::sqliteReader<T>::getStringLength(const int columnNum) const noexcept {
-        return sqlite3_column_bytes(static_cast<const T *>(this)->getABI(), columnNum);
-}
-	
-template <typename T>
-constexpr int Sqlite::sqliteReader<T>::getWideStringLength(const int columnNum) const noexcept
-{
-	return (sqlite3_column_bytes16(static_cast<const T *>(this)->getABI(), columnNum) / sizeof(wchar_t));
+void Sqlite::SqliteStatement::throwLastError() const {
+	throw exception(sqlite3_db_handle(getABI()));
 }
 
+int Sqlite::SqliteStatement::namedIndex(const int index, const std::string_view name) const {
+	if (index == 0) {
+		throw exception(SQLITE_RANGE, "the statement has no parameter named " + std::string(name));
+	}
+	return index;
+}
 
 
-void Sqlite::SqliteStatement::throwLastError() const {
-	throw exception(sqlite3_db_handle(getABI()));
+#ifdef SQLITECPP_ENABLE_PROFILING
+void Sqlite::SqliteStatement::flushProfile() const noexcept {
+	if (profiler_ && steps_ != 0 && profiler_->enabled()) {
+		profiler_->recordSteps(getABI(), steps_, rows_);
+	}
+	steps_ = 0;
+	rows_ = 0;
 }
-
+#endif
 
 bool Sqlite::SqliteStatement::execute() const {
 	const int result = sqlite3_step(getABI());
+#ifdef SQLITECPP_ENABLE_PROFILING
+	++steps_;
+	if (result == SQLITE_ROW) {
+		++rows_;
+	}
+	else {
+		flushProfile();
+	}
+#endif
 	if (result == SQLITE_ROW)
 		return true;
 	else if (result == SQLITE_DONE)
@@ -38,14 +51,25 @@ void Sqlite::SqliteStatement::bind(const int index, const int value) const {
 	}
 }
 
-void Sqlite::SqliteStatement::bind(const int index, const char *const strValue, const int size = -1) const {
+void Sqlite::SqliteStatement::bind(const int index, const char *const strValue, const int size) const {
 	if (SQLITE_OK != sqlite3_bind_text(getABI(), index, strValue, size, SQLITE_STATIC)) {
 		throwLastError();
 	}
 }
 
-void Sqlite::SqliteStatement::bind(const int index, const wchar_t *const strValue, const int size = -1) const {
-	if (SQLITE_OK != sqlite3_bind_text16(getABI(), index, strValue, size, SQLITE_STATIC)) {
+void Sqlite::SqliteStatement::bind(const int index, const wchar_t *const strValue, const int size) const {
+	if constexpr (wideIsUtf32) {
+		if (!strValue) {
+			bind(index, nullptr);
+			return;
+		}
+		const std::wstring_view text(strValue, size < 0 ? std::char_traits<wchar_t>::length(strValue) : static_cast<std::size_t>(size) / sizeof(wchar_t));
+		const std::string_view utf8 = wideText_.parameter(index, text);
+		if (SQLITE_OK != sqlite3_bind_text64(getABI(), index, utf8.data(), utf8.size(), SQLITE_STATIC, SQLITE_UTF8)) {
+			throwLastError();
+		}
+	}
+	else if (SQLITE_OK != sqlite3_bind_text16(getABI(), index, strValue, size, SQLITE_STATIC)) {
 		throwLastError();
 	}
 }
@@ -58,14 +82,110 @@ void Sqlite::SqliteStatement::bind(const int index, const std::wstring &strValue
 	bind(index, strValue.c_str(), static_cast<int>((strValue.size() * sizeof(wchar_t))));
 }
 
-void Sqlite::SqliteStatement::bind(const int index, const std::string &&strValue) const {
-	if (SQLITE_OK != sqlite3_bind_text(getABI(), index, strValue.c_str(), static_cast<int>(strValue.size()), SQLITE_TRANSIENT)) {
+void Sqlite::SqliteStatement::keepAlive(const int index, std::shared_ptr<void> value) const {
+	for (auto &owned : ownedValues_) {
+		if (owned.first == index) {
+			owned.second = std::move(value);
+			return;
+		}
+	}
+	ownedValues_.emplace_back(index, std::move(value));
+}
+
+void Sqlite::SqliteStatement::bind(const int index, std::string &&strValue) const {
+	const auto owned = std::make_shared<std::string>(std::move(strValue));
+	bind(index, owned->c_str(), static_cast<int>(owned->size()));
+	keepAlive(index, owned);
+}
+
+void Sqlite::SqliteStatement::bind(const int index, std::wstring &&strValue) const {
+	//converted into a buffer of the statement anyway
+	if constexpr (wideIsUtf32) {
+		bind(index, static_cast<const std::wstring &>(strValue));
+		return;
+	}
+	const auto owned = std::make_shared<std::wstring>(std::move(strValue));
+	bind(index, owned->c_str(), static_cast<int>((owned->size() * sizeof(wchar_t))));
+	keepAlive(index, owned);
+}
+
+void Sqlite::SqliteStatement::bind(const int index, const double value) const {
+	if (SQLITE_OK != sqlite3_bind_double(getABI(), index, value)) {
 		throwLastError();
 	}
 }
 
-void Sqlite::SqliteStatement::bind(const int index, const std::wstring &&strValue) const {
-	if (SQLITE_OK != sqlite3_bind_text16(getABI(), index, strValue.c_str(), static_cast<int>((strValue.size() * sizeof(wchar_t))), SQLITE_TRANSIENT)) {
+void Sqlite::SqliteStatement::bind(const int index, std::nullptr_t) const {
+	if (SQLITE_OK != sqlite3_bind_null(getABI(), index)) {
 		throwLastError();
 	}
 }
+
+void Sqlite::SqliteStatement::bind(const int index, const std::string_view strValue) const {
+	//a null pointer would bind NULL instead of an empty text
+	if (SQLITE_OK != sqlite3_bind_text64(getABI(), index, strValue.data() != nullptr ? strValue.data() : "", strValue.size(), SQLITE_STATIC, SQLITE_UTF8)) {
+		throwLastError();
+	}
+}
+
+void Sqlite::SqliteStatement::bindBlob(const int index, const void *const blob, const sqlite3_uint64 size) const {
+	//a null pointer would bind NULL instead of an empty blob
+	if (SQLITE_OK != (blob != nullptr ? sqlite3_bind_blob64(getABI(), index, blob, size, SQLITE_STATIC) : sqlite3_bind_zeroblob(getABI(), index, 0))) {
+		throwLastError();
+	}
+}
+
+void Sqlite::SqliteStatement::bind(const int index, const std::vector<std::byte> &blob) const {
+	bindBlob(index, blob.data(), blob.size());
+}
+
+void Sqlite::SqliteStatement::bind(const int index, const zeroBlob blob) const {
+	if (SQLITE_OK != sqlite3_bind_zeroblob64(getABI(), index, blob.size_)) {
+		throwLastError();
+	}
+}
+
+void Sqlite::SqliteStatement::bind(const int index, std::vector<std::byte> &&blob) const {
+	const auto owned = std::make_shared<std::vector<std::byte>>(std::move(blob));
+	bindBlob(index, owned->data(), owned->size());
+	keepAlive(index, owned);
+}
+
+#ifdef __cpp_lib_span
+void Sqlite::SqliteStatement::bind(const int index, const std::span<const std::byte> blob) const {
+	bindBlob(index, blob.data(), blob.size());
+}
+#endif
+
+void Sqlite::SqliteStatement::bind(const int index, std::unique_ptr<std::byte[]> &&blob, const sqlite3_uint64 size) const {
+	if (SQLITE_OK != sqlite3_bind_blob64(getABI(), index, blob.release(), size, [](void *const owned) { delete[] static_cast<std::byte *>(owned); })) {
+		throwLastError();
+	}
+}
+
+void Sqlite::SqliteStatement::bind(const int index, std::unique_ptr<char[]> &&strValue, const sqlite3_uint64 size) const {
+	if (SQLITE_OK != sqlite3_bind_text64(getABI(), index, strValue.release(), size, [](void *const owned) { delete[] static_cast<char *>(owned); }, SQLITE_UTF8)) {
+		throwLastError();
+	}
+}
+
+void Sqlite::SqliteStatement::fetchAll(ResultSet &result) const {
+	result.start(getABI());
+	while (execute()) {
+		result.appendRow(getABI());
+	}
+}
+
+Sqlite::ResultSet Sqlite::SqliteStatement::fetchAll() const {
+	ResultSet result;
+	fetchAll(result);
+	return result;
+}
+
+Sqlite::CachedStatement::~CachedStatement() noexcept {
+	if (cache_) {
+		lease_->parameters_ = releaseParameters();
+		releaseABI();
+		cache_->release(lease_);
+	}
+}
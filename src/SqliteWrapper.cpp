@@ -1,4 +1,4 @@
-#include "SQLiteWrapper.hpp"
+#include "SqliteWrapper.hpp"
 	
 Sqlite::rowIterator& Sqlite::rowIterator::operator++() {
 	if (!statement_->execute()) {
@@ -8,5 +8,5 @@ Sqlite::rowIterator& Sqlite::rowIterator::operator++() {
 }
 
 Sqlite::SqliteRow Sqlite::rowIterator::operator*() const noexcept {
-	return SqliteRow(statement_->getABI());
+	return SqliteRow(*statement_);
 }
@@ -0,0 +1,81 @@
+#include "SqliteConnection.hpp"
+
+void Sqlite::StatementCache::trim() noexcept {
+	while (idle_.size() > capacity_) {
+		index_.erase(idle_.back().text_);
+		sqlite3_finalize(idle_.back().statement_);
+		idle_.pop_back();
+		++stats_.evictions_;
+	}
+}
+
+Sqlite::StatementCache::Lease Sqlite::StatementCache::acquire(sqlite3 *const connection, const char *const text) {
+	const lock guard(mutex_);
+	const auto found = index_.find(text);
+	if (found != index_.end()) {
+		const Lease lease = found->second;
+		index_.erase(found);
+		leased_.splice(leased_.begin(), idle_, lease);
+		++stats_.hits_;
+		return lease;
+	}
+
+	++stats_.misses_;
+	//finalized unless the list node holding it is created
+	UniqueHandle<preparedTraits> statement;
+#ifdef SQLITECPP_ENABLE_PROFILING
+	const auto start = std::chrono::steady_clock::now();
+#endif
+	if (SQLITE_OK != sqlite3_prepare_v2(connection, text, -1, statement.set(), nullptr)) {
+		throw exception(connection);
+	}
+#ifdef SQLITECPP_ENABLE_PROFILING
+	if (profiler_) {
+		profiler_->recordPrepare(statement.get(), std::chrono::steady_clock::now() - start);
+	}
+#endif
+	leased_.push_front(Entry{text, nullptr, StatementParameters()});
+	leased_.front().statement_ = statement.release();
+	return leased_.begin();
+}
+
+void Sqlite::StatementCache::release(const Lease lease) noexcept {
+	const lock guard(mutex_);
+	sqlite3_stmt *const statement = lease->statement_;
+	sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+
+	//an idle copy of the same text is already cached (or there is nothing to cache)
+	if (statement == nullptr || capacity_ == 0 || index_.count(lease->text_) != 0) {
+		sqlite3_finalize(statement);
+		leased_.erase(lease);
+		return;
+	}
+
+	idle_.splice(idle_.begin(), leased_, lease);
+	index_.emplace(lease->text_, lease);
+	trim();
+}
+
+void Sqlite::StatementCache::clear() noexcept {
+	const lock guard(mutex_);
+	index_.clear();
+	for (const Entry &entry : idle_) {
+		sqlite3_finalize(entry.statement_);
+	}
+	idle_.clear();
+}
+
+void Sqlite::StatementCache::setCapacity(const std::size_t capacity) noexcept {
+	const lock guard(mutex_);
+	capacity_ = capacity;
+	trim();
+}
+
+Sqlite::StatementCache::Stats Sqlite::StatementCache::stats() const noexcept {
+	const lock guard(mutex_);
+	Stats stats = stats_;
+	stats.size_ = idle_.size();
+	stats.capacity_ = capacity_;
+	return stats;
+}
@@ -0,0 +1,45 @@
+#include "StatementParameters.hpp"
+#include <algorithm>
+#include <atomic>
+
+void Sqlite::StatementParameters::read(sqlite3_stmt *const statement) const {
+	const int count = sqlite3_bind_parameter_count(statement);
+	for (int index = 1; index <= count; ++index) {
+		//anonymous ? parameters have no name
+		if (const char *const name = sqlite3_bind_parameter_name(statement, index)) {
+			names_.emplace_back(name, index);
+		}
+	}
+	std::sort(names_.begin(), names_.end());
+	read_ = true;
+}
+
+int Sqlite::StatementParameters::index(sqlite3_stmt *const statement, const std::string_view name) const {
+	if (!read_) {
+		read(statement);
+	}
+	const auto found = std::lower_bound(names_.begin(), names_.end(), name, [](const std::pair<std::string_view, int> &entry, const std::string_view key) {
+		return entry.first < key;
+	});
+	return found != names_.end() && found->first == name ? found->second : 0;
+}
+
+int Sqlite::StatementParameters::index(sqlite3_stmt *const statement, const std::size_t slot, const std::string_view name) const {
+	const auto found = std::lower_bound(slots_.begin(), slots_.end(), slot, [](const std::pair<std::size_t, int> &entry, const std::size_t key) {
+		return entry.first < key;
+	});
+	if (found != slots_.end() && found->first == slot) {
+		return found->second;
+	}
+	const int resolved = index(statement, name);
+	//a name the statement does not have is not remembered, it throws anyway
+	if (resolved != 0) {
+		slots_.emplace(found, slot, resolved);
+	}
+	return resolved;
+}
+
+std::size_t Sqlite::StatementParameters::nextSlot() noexcept {
+	static std::atomic<std::size_t> next{0};
+	return next.fetch_add(1, std::memory_order_relaxed);
+}
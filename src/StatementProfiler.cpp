@@ -0,0 +1,91 @@
+#include "StatementProfiler.hpp"
+
+#ifdef SQLITECPP_ENABLE_PROFILING
+
+#include <algorithm>
+
+Sqlite::StatementProfile &Sqlite::StatementProfiler::profile(sqlite3_stmt *const statement) {
+	const char *const text = sqlite3_sql(statement);
+	const std::string_view sql = text ? text : "";
+	const auto found = index_.find(sql);
+	if (found != index_.end()) {
+		return *found->second;
+	}
+	StatementProfile &profile = profiles_.emplace_back();
+	profile.sql_ = sql;
+	index_.emplace(profile.sql_, &profile);
+	return profile;
+}
+
+int Sqlite::StatementProfiler::trace(const unsigned type, void *const context, void *const statement, void *const nanoseconds) noexcept {
+	if (type == SQLITE_TRACE_PROFILE) {
+		static_cast<StatementProfiler *>(context)->recordRun(static_cast<sqlite3_stmt *>(statement), std::chrono::nanoseconds(*static_cast<const sqlite3_int64 *>(nanoseconds)));
+	}
+	return 0;
+}
+
+void Sqlite::StatementProfiler::attach(sqlite3 *const connection) noexcept {
+	sqlite3_trace_v2(connection, SQLITE_TRACE_PROFILE, &trace, this);
+	enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Sqlite::StatementProfiler::detach(sqlite3 *const connection) noexcept {
+	sqlite3_trace_v2(connection, 0, nullptr, nullptr);
+	enabled_.store(false, std::memory_order_relaxed);
+}
+
+void Sqlite::StatementProfiler::recordPrepare(sqlite3_stmt *const statement, const std::chrono::nanoseconds elapsed) noexcept {
+	try {
+		const std::lock_guard<std::mutex> lock(mutex_);
+		StatementProfile &profile = this->profile(statement);
+		++profile.prepares_;
+		profile.prepareTime_ += elapsed;
+	}
+	catch (...) {
+	}
+}
+
+void Sqlite::StatementProfiler::recordSteps(sqlite3_stmt *const statement, const unsigned long long steps, const unsigned long long rows) noexcept {
+	try {
+		const std::lock_guard<std::mutex> lock(mutex_);
+		StatementProfile &profile = this->profile(statement);
+		profile.steps_ += steps;
+		profile.rows_ += rows;
+	}
+	catch (...) {
+	}
+}
+
+void Sqlite::StatementProfiler::recordRun(sqlite3_stmt *const statement, const std::chrono::nanoseconds elapsed) noexcept {
+	try {
+		const std::lock_guard<std::mutex> lock(mutex_);
+		StatementProfile &profile = this->profile(statement);
+		++profile.runs_;
+		profile.runTime_ += elapsed;
+		//reset after reading, so that every run adds only its own counts
+		profile.fullscanSteps_ += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+		profile.sorts_ += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_SORT, 1);
+		profile.autoindexes_ += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+		profile.vmSteps_ += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_VM_STEP, 1);
+	}
+	catch (...) {
+	}
+}
+
+std::vector<Sqlite::StatementProfile> Sqlite::StatementProfiler::snapshot() const {
+	std::vector<StatementProfile> profiles;
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		profiles.assign(profiles_.begin(), profiles_.end());
+	}
+	std::sort(profiles.begin(), profiles.end(), [](const StatementProfile &left, const StatementProfile &right) { return left.runTime_ > right.runTime_; });
+	return profiles;
+}
+
+void Sqlite::StatementProfiler::clear() noexcept {
+	const std::lock_guard<std::mutex> lock(mutex_);
+	index_.clear();
+	profiles_.clear();
+}
+
+#endif
@@ -0,0 +1,245 @@
+#include "TextEncoding.hpp"
+#include <algorithm>
+#include <cstdint>
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr std::uint32_t replacementCharacter = 0xFFFD;
+
+//characters are converted one at a time for at least this many after a vector of them held non-ASCII text
+constexpr std::size_t scalarRun = 16;
+
+//converts the leading ASCII characters of wide a vector at a time, returns how many
+std::size_t asciiToUtf8(const wchar_t *const wide, const std::size_t size, char *const utf8) noexcept {
+	std::size_t done = 0;
+#if defined(__AVX2__)
+	{
+		const __m256i nonAscii = _mm256_set1_epi32(~0x7F);
+		//packs work within 128-bit lanes, this puts the four 32-bit groups of each lane back in order
+		const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		for (; done + 32 <= size; done += 32) {
+			const __m256i *const source = reinterpret_cast<const __m256i *>(wide + done);
+			const __m256i first = _mm256_loadu_si256(source);
+			const __m256i second = _mm256_loadu_si256(source + 1);
+			const __m256i third = _mm256_loadu_si256(source + 2);
+			const __m256i fourth = _mm256_loadu_si256(source + 3);
+			if (!_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(first, second), _mm256_or_si256(third, fourth)), nonAscii)) {
+				break;
+			}
+			const __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(first, second), _mm256_packs_epi32(third, fourth));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(utf8 + done), _mm256_permutevar8x32_epi32(bytes, order));
+		}
+	}
+#endif
+#if defined(__SSE2__)
+	{
+		const __m128i nonAscii = _mm_set1_epi32(~0x7F);
+		const __m128i zero = _mm_setzero_si128();
+		for (; done + 16 <= size; done += 16) {
+			const __m128i *const source = reinterpret_cast<const __m128i *>(wide + done);
+			const __m128i first = _mm_loadu_si128(source);
+			const __m128i second = _mm_loadu_si128(source + 1);
+			const __m128i third = _mm_loadu_si128(source + 2);
+			const __m128i fourth = _mm_loadu_si128(source + 3);
+			const __m128i high = _mm_and_si128(_mm_or_si128(_mm_or_si128(first, second), _mm_or_si128(third, fourth)), nonAscii);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, zero)) != 0xFFFF) {
+				break;
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(utf8 + done), _mm_packus_epi16(_mm_packs_epi32(first, second), _mm_packs_epi32(third, fourth)));
+		}
+	}
+#endif
+	return done;
+}
+
+//converts the leading ASCII bytes of utf8 a vector at a time, returns how many
+std::size_t asciiToWide(const char *const utf8, const std::size_t size, wchar_t *const wide) noexcept {
+	std::size_t done = 0;
+#if defined(__AVX2__)
+	for (; done + 32 <= size; done += 32) {
+		const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(utf8 + done));
+		if (_mm256_movemask_epi8(bytes) != 0) {
+			break;
+		}
+		const __m128i low = _mm256_castsi256_si128(bytes);
+		const __m128i high = _mm256_extracti128_si256(bytes, 1);
+		__m256i *const target = reinterpret_cast<__m256i *>(wide + done);
+		_mm256_storeu_si256(target, _mm256_cvtepu8_epi32(low));
+		_mm256_storeu_si256(target + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+		_mm256_storeu_si256(target + 2, _mm256_cvtepu8_epi32(high));
+		_mm256_storeu_si256(target + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+	}
+#endif
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	for (; done + 16 <= size; done += 16) {
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(utf8 + done));
+		if (_mm_movemask_epi8(bytes) != 0) {
+			break;
+		}
+		const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+		const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+		__m128i *const target = reinterpret_cast<__m128i *>(wide + done);
+		_mm_storeu_si128(target, _mm_unpacklo_epi16(low, zero));
+		_mm_storeu_si128(target + 1, _mm_unpackhi_epi16(low, zero));
+		_mm_storeu_si128(target + 2, _mm_unpacklo_epi16(high, zero));
+		_mm_storeu_si128(target + 3, _mm_unpackhi_epi16(high, zero));
+	}
+#endif
+	return done;
+}
+
+std::size_t encodeUtf8(std::uint32_t code, char *const utf8) noexcept {
+	if (code < 0x80) {
+		utf8[0] = static_cast<char>(code);
+		return 1;
+	}
+	if (code < 0x800) {
+		utf8[0] = static_cast<char>(0xC0 | (code >> 6));
+		utf8[1] = static_cast<char>(0x80 | (code & 0x3F));
+		return 2;
+	}
+	if ((code >= 0xD800 && code <= 0xDFFF) || code > 0x10FFFF) {
+		code = replacementCharacter;
+	}
+	if (code < 0x10000) {
+		utf8[0] = static_cast<char>(0xE0 | (code >> 12));
+		utf8[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+		utf8[2] = static_cast<char>(0x80 | (code & 0x3F));
+		return 3;
+	}
+	utf8[0] = static_cast<char>(0xF0 | (code >> 18));
+	utf8[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+	utf8[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+	utf8[3] = static_cast<char>(0x80 | (code & 0x3F));
+	return 4;
+}
+
+//decodes the sequence at utf8[0], a malformed one becomes one U+FFFD per maximal valid prefix, returns the bytes consumed
+std::size_t decodeUtf8(const unsigned char *const utf8, const std::size_t size, std::uint32_t &code) noexcept {
+	const unsigned char lead = utf8[0];
+	if (lead < 0x80) {
+		code = lead;
+		return 1;
+	}
+	std::size_t length = 0;
+	unsigned char low = 0x80;
+	unsigned char high = 0xBF;
+	if (lead >= 0xC2 && lead <= 0xDF) {
+		length = 2;
+		code = lead & 0x1F;
+	}
+	else if (lead >= 0xE0 && lead <= 0xEF) {
+		length = 3;
+		code = lead & 0x0F;
+		//no overlong forms and no surrogates
+		low = lead == 0xE0 ? 0xA0 : 0x80;
+		high = lead == 0xED ? 0x9F : 0xBF;
+	}
+	else if (lead >= 0xF0 && lead <= 0xF4) {
+		length = 4;
+		code = lead & 0x07;
+		//no overlong forms and nothing above U+10FFFF
+		low = lead == 0xF0 ? 0x90 : 0x80;
+		high = lead == 0xF4 ? 0x8F : 0xBF;
+	}
+	else {
+		code = replacementCharacter;
+		return 1;
+	}
+	std::size_t used = 1;
+	for (; used < length && used < size; ++used) {
+		const unsigned char next = utf8[used];
+		if (next < low || next > high) {
+			break;
+		}
+		code = (code << 6) | (next & 0x3F);
+		low = 0x80;
+		high = 0xBF;
+	}
+	if (used != length) {
+		code = replacementCharacter;
+	}
+	return used;
+}
+
+}
+
+std::size_t Sqlite::wideToUtf8(const wchar_t *const wide, const std::size_t size, char *const utf8) noexcept {
+	std::size_t read = 0;
+	std::size_t written = 0;
+	while (read < size) {
+		const std::size_t ascii = asciiToUtf8(wide + read, size - read, utf8 + written);
+		read += ascii;
+		written += ascii;
+		const std::size_t end = std::min(size, read + scalarRun);
+		for (; read < end; ++read) {
+			written += encodeUtf8(static_cast<std::uint32_t>(wide[read]), utf8 + written);
+		}
+	}
+	return written;
+}
+
+std::size_t Sqlite::utf8ToWide(const char *const utf8, const std::size_t size, wchar_t *const wide) noexcept {
+	const unsigned char *const bytes = reinterpret_cast<const unsigned char *>(utf8);
+	std::size_t read = 0;
+	std::size_t written = 0;
+	while (read < size) {
+		const std::size_t ascii = asciiToWide(utf8 + read, size - read, wide + written);
+		read += ascii;
+		written += ascii;
+		const std::size_t end = std::min(size, read + scalarRun);
+		while (read < end) {
+			std::uint32_t code;
+			read += decodeUtf8(bytes + read, size - read, code);
+			wide[written++] = static_cast<wchar_t>(code);
+		}
+	}
+	return written;
+}
+
+void Sqlite::wideToUtf8(const std::wstring_view wide, std::string &utf8) {
+	utf8.resize(wide.size() * 4);
+	utf8.resize(wideToUtf8(wide.data(), wide.size(), utf8.data()));
+}
+
+std::wstring_view Sqlite::wideTextBuffers::column(sqlite3_stmt *const statement, const int column) {
+	if constexpr (!wideIsUtf32) {
+		const wchar_t *const text = static_cast<const wchar_t *>(sqlite3_column_text16(statement, column));
+		return std::wstring_view(text, text ? static_cast<std::size_t>(sqlite3_column_bytes16(statement, column)) / sizeof(wchar_t) : 0);
+	}
+	const char *const text = reinterpret_cast<const char *>(sqlite3_column_text(statement, column));
+	if (!text) {
+		return std::wstring_view();
+	}
+	const std::size_t size = static_cast<std::size_t>(sqlite3_column_bytes(statement, column));
+	if (columns_.size() <= static_cast<std::size_t>(column)) {
+		columns_.resize(static_cast<std::size_t>(column) + 1);
+	}
+	std::vector<wchar_t> &buffer = columns_[static_cast<std::size_t>(column)];
+	if (buffer.size() < size + 1) {
+		buffer.resize(size + 1);
+	}
+	const std::size_t length = utf8ToWide(text, size, buffer.data());
+	buffer[length] = L'\0';
+	return std::wstring_view(buffer.data(), length);
+}
+
+std::string_view Sqlite::wideTextBuffers::parameter(const int index, const std::wstring_view text) {
+	//left to sqlite3_bind_text to reject
+	if (index < 0) {
+		return std::string_view();
+	}
+	if (parameters_.size() <= static_cast<std::size_t>(index)) {
+		parameters_.resize(static_cast<std::size_t>(index) + 1);
+	}
+	std::vector<char> &buffer = parameters_[static_cast<std::size_t>(index)];
+	//at least one byte, so that an empty string is bound as text and not as NULL
+	if (buffer.size() < text.size() * 4 + 1) {
+		buffer.resize(text.size() * 4 + 1);
+	}
+	return std::string_view(buffer.data(), wideToUtf8(text.data(), text.size(), buffer.data()));
+}
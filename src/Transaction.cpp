@@ -0,0 +1,85 @@
+#include "Transaction.hpp"
+
+namespace {
+
+const char *beginText(const Sqlite::TransactionMode mode) noexcept {
+	switch (mode) {
+		case Sqlite::TransactionMode::Immediate:
+			return "BEGIN IMMEDIATE";
+		case Sqlite::TransactionMode::Exclusive:
+			return "BEGIN EXCLUSIVE";
+		default:
+			return "BEGIN DEFERRED";
+	}
+}
+
+
+}
+
+Sqlite::Transaction::Transaction(const SqliteConnection &connection, const TransactionMode mode) : connection_{&connection} {
+	sqliteExecute(connection, beginText(mode));
+	active_ = true;
+}
+
+Sqlite::Transaction::~Transaction() noexcept {
+	if (active_) {
+		try {
+			rollback();
+		}
+		catch (...) {
+		}
+	}
+}
+
+void Sqlite::Transaction::commit() {
+	sqliteExecute(*connection_, "COMMIT");
+	active_ = false;
+}
+
+void Sqlite::Transaction::rollback() {
+	active_ = false;
+	//SQLite may already have rolled the transaction back after an error
+	if (!sqlite3_get_autocommit(connection_->getABI())) {
+		sqliteExecute(*connection_, "ROLLBACK");
+	}
+}
+
+std::string Sqlite::quotedIdentifier(const std::string &name) {
+	std::string quoted(1, '"');
+	for (const char character : name) {
+		if (character == '"') {
+			quoted += '"';
+		}
+		quoted += character;
+	}
+	quoted += '"';
+	return quoted;
+}
+
+Sqlite::Savepoint::Savepoint(const SqliteConnection &connection, const std::string &name) : connection_{&connection}, release_{"RELEASE " + quotedIdentifier(name)}, rollback_{"ROLLBACK TO " + quotedIdentifier(name)} {
+	sqliteExecute(connection, ("SAVEPOINT " + quotedIdentifier(name)).c_str());
+	active_ = true;
+}
+
+Sqlite::Savepoint::~Savepoint() noexcept {
+	if (active_) {
+		try {
+			rollback();
+		}
+		catch (...) {
+		}
+	}
+}
+
+void Sqlite::Savepoint::commit() {
+	sqliteExecute(*connection_, release_.c_str());
+	active_ = false;
+}
+
+void Sqlite::Savepoint::rollback() {
+	active_ = false;
+	if (!sqlite3_get_autocommit(connection_->getABI())) {
+		sqliteExecute(*connection_, rollback_.c_str());
+		sqliteExecute(*connection_, release_.c_str());
+	}
+}